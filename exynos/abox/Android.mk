@@ -4,6 +4,10 @@ include $(CLEAR_VARS)
 LOCAL_SRC_FILES := main_abox.cpp
 LOCAL_MODULE := main_abox
 LOCAL_SHARED_LIBRARIES := libc libcutils liblog
+ifeq ($(BOARD_USE_ABOX_DUMP_LZ4), true)
+LOCAL_CFLAGS += -DSUPPORT_LZ4_DUMP
+LOCAL_STATIC_LIBRARIES += liblz4
+endif
 LOCAL_MODULE_TAGS := optional
 LOCAL_PROPRIETARY_MODULE := true
 include $(BUILD_EXECUTABLE)
@@ -26,14 +26,22 @@
 #include <dirent.h>
 #include <time.h>
 #include <fnmatch.h>
+#include <pthread.h>
 #include <sys/epoll.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <log/log.h>
 #include <cutils/uevent.h>
+#ifdef SUPPORT_LZ4_DUMP
+#include <lz4frame.h>
+#endif
 
 #define MAX_EPOLL_EVENTS (8)
 #define BUFFER_SIZE (4096)
 #define MAX_DUMP_COUNT (10)
+#define MAX_DUMP_TOTAL_SIZE (256 * 1024 * 1024)
+#define COPY_CHUNK_SIZE (256 * 1024)
+#define MAX_DUMP_FILES (8)
 
 #define DEVPATH "DEVPATH="
 #define SYS_PATH "/sys"
@@ -52,6 +60,8 @@
 #define REGISTERS_FILE "/registers"
 #define LOG_FILE "/log-00"
 #define COUNT "COUNT="
+#define LZ4_SUFFIX ".lz4"
+#define LZ4_OPTION "lz4"
 
 struct abox_t {
     int fd;
@@ -72,18 +82,50 @@ static char regmap_path[128];
 static int regmap_path_len;
 static char out_path[128];
 static int out_path_len;
+static bool compress_dump;
+
+/* one dump file, copied by its own worker thread */
+struct dump_job {
+    const char *in_prefix;
+    const char *in_prefix_leg;  /* tried when in_prefix fails, can be NULL */
+    const char *in_file;
+    const char *str_time;
+    pthread_t thread;
+    bool threaded;
+};
 
-static void rm_old_dump(const char *path, const char *prefix)
-{
-    struct dirent **list;
-    char pattern[128];
-    int n, m;
+struct dump_entry {
+    char *name;
+    const char *suffix;         /* time stamp after the prefix */
+    off_t size;
+};
 
-    ALOGD("%s(%s, %s)", __func__, path, prefix);
+static int compare_dump_entry(const void *a, const void *b)
+{
+    /* newest first */
+    return strcmp(((const struct dump_entry *)b)->suffix, ((const struct dump_entry *)a)->suffix);
+}
 
-    if (snprintf(pattern, sizeof(pattern), "%s*", prefix + 1) < 0) {
-        ALOGE("%s: pattern error: %s", __func__, strerror(errno));
-        return;
+/*
+ * Keeps MAX_DUMP_COUNT dumps of each file, then removes the oldest ones until all of
+ * them fit in MAX_DUMP_TOTAL_SIZE. Files of the current dump are never removed.
+ */
+static void rm_old_dump(const char *path, const struct dump_job *jobs, int job_count, const char *current)
+{
+    struct dirent **list;
+    struct dump_entry *entries;
+    char pattern[MAX_DUMP_FILES][128];
+    int count[MAX_DUMP_FILES] = {0};
+    int n, i, entry_count = 0;
+    long long total = 0;
+
+    ALOGD("%s(%s)", __func__, path);
+
+    for (i = 0; i < job_count; i++) {
+        if (snprintf(pattern[i], sizeof(pattern[i]), "%s_*", jobs[i].in_file + 1) < 0) {
+            ALOGE("%s: pattern error: %s", __func__, strerror(errno));
+            return;
+        }
     }
 
     n = scandir(path, &list, NULL, alphasort);
@@ -91,29 +133,156 @@ static void rm_old_dump(const char *path, const char *prefix)
         ALOGE("%s: scandir failed: %s", __func__, strerror(errno));
         return;
     }
-    m = 0;
+
+    entries = (struct dump_entry *)calloc(n > 0 ? n : 1, sizeof(*entries));
     while (n--) {
-        if (!fnmatch(pattern, list[n]->d_name, FNM_FILE_NAME)) {
-            if (++m > MAX_DUMP_COUNT) {
-                char *tgt;
+        for (i = 0; i < job_count; i++) {
+            if (!fnmatch(pattern[i], list[n]->d_name, FNM_FILE_NAME))
+                break;
+        }
+
+        if (i < job_count) {
+            char *tgt;
 
-                if (asprintf(&tgt, "%s/%s", path, list[n]->d_name) != -1) {
+            if (asprintf(&tgt, "%s/%s", path, list[n]->d_name) != -1) {
+                struct stat st;
+
+                if (++count[i] > MAX_DUMP_COUNT) {
                     remove(tgt);
                     free(tgt);
+                } else if (entries && stat(tgt, &st) == 0) {
+                    entries[entry_count].name = tgt;
+                    entries[entry_count].suffix = tgt + strlen(path) + strlen(jobs[i].in_file) + 1;
+                    entries[entry_count].size = st.st_size;
+                    entry_count++;
+                } else {
+                    free(tgt);
                 }
             }
         }
         free(list[n]);
     }
     free(list);
+
+    if (!entries)
+        return;
+
+    qsort(entries, entry_count, sizeof(*entries), compare_dump_entry);
+    for (i = 0; i < entry_count; i++) {
+        total += entries[i].size;
+        if (total > MAX_DUMP_TOTAL_SIZE && strncmp(entries[i].suffix, current, strlen(current))) {
+            ALOGD("%s: remove %s, total size %lld", __func__, entries[i].name, total);
+            remove(entries[i].name);
+            total -= entries[i].size;
+        }
+        free(entries[i].name);
+    }
+    free(entries);
 }
 
-static int __dump(const char *in_prefix, const char *in_file, const char *out_prefix, const char *out_suffix)
+static bool write_all(int fd, const char *buf, size_t size)
 {
-    char buf[4096], in_path[128], out_path[128];
-    int fd_in, fd_out, n;
-    int total = 0;
-    mode_t mask;
+    while (size > 0) {
+        ssize_t n = write(fd, buf, size);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("%s: write error: %s", __func__, strerror(errno));
+            return false;
+        }
+        buf += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+/* Copies in the kernel, debugfs files without splice_read fall back to read/write */
+static long long copy_file(int fd_in, int fd_out)
+{
+    long long total = 0;
+    ssize_t n;
+    char *buf;
+
+    while ((n = sendfile(fd_out, fd_in, NULL, COPY_CHUNK_SIZE)) > 0)
+        total += n;
+
+    if (n == 0 || total > 0 || (errno != EINVAL && errno != ENOSYS))
+        return total;
+
+    buf = (char *)malloc(COPY_CHUNK_SIZE);
+    if (!buf) {
+        ALOGE("%s: out of memory", __func__);
+        return -1;
+    }
+
+    while ((n = read(fd_in, buf, COPY_CHUNK_SIZE)) > 0) {
+        if (!write_all(fd_out, buf, n))
+            break;
+        total += n;
+    }
+
+    free(buf);
+    return total;
+}
+
+#ifdef SUPPORT_LZ4_DUMP
+/* Streams LZ4 frame, so a dump is never held in memory as a whole */
+static long long copy_file_lz4(int fd_in, int fd_out)
+{
+    LZ4F_compressionContext_t ctx;
+    size_t zbuf_size = LZ4F_compressBound(COPY_CHUNK_SIZE, NULL);
+    long long total = -1;
+    char *buf = NULL, *zbuf = NULL;
+    size_t zn;
+    ssize_t n;
+
+    if (LZ4F_isError(LZ4F_createCompressionContext(&ctx, LZ4F_VERSION))) {
+        ALOGE("%s: LZ4F_createCompressionContext failed", __func__);
+        return -1;
+    }
+
+    buf = (char *)malloc(COPY_CHUNK_SIZE);
+    zbuf = (char *)malloc(zbuf_size);
+    if (!buf || !zbuf) {
+        ALOGE("%s: out of memory", __func__);
+        goto out;
+    }
+
+    zn = LZ4F_compressBegin(ctx, zbuf, zbuf_size, NULL);
+    if (LZ4F_isError(zn) || !write_all(fd_out, zbuf, zn))
+        goto out;
+
+    total = 0;
+    while ((n = read(fd_in, buf, COPY_CHUNK_SIZE)) > 0) {
+        zn = LZ4F_compressUpdate(ctx, zbuf, zbuf_size, buf, n, NULL);
+        if (LZ4F_isError(zn)) {
+            ALOGE("%s: LZ4F_compressUpdate failed: %s", __func__, LZ4F_getErrorName(zn));
+            break;
+        }
+        if (!write_all(fd_out, zbuf, zn))
+            break;
+        total += n;
+    }
+
+    zn = LZ4F_compressEnd(ctx, zbuf, zbuf_size, NULL);
+    if (!LZ4F_isError(zn))
+        write_all(fd_out, zbuf, zn);
+
+out:
+    free(zbuf);
+    free(buf);
+    LZ4F_freeCompressionContext(ctx);
+    return total;
+}
+#endif
+
+static long long __dump(const char *in_prefix, const char *in_file, const char *out_prefix, const char *out_suffix)
+{
+    char in_path[128], out_path[128];
+    int fd_in, fd_out;
+    long long total = 0;
 
     ALOGD("%s(%s, %s, %s, %s)", __func__, in_prefix, in_file, out_prefix, out_suffix);
 
@@ -122,24 +291,25 @@ static int __dump(const char *in_prefix, const char *in_file, const char *out_pr
         return -1;
     }
 
-    if (snprintf(out_path, sizeof(out_path), "%s%s_%s", out_prefix, in_file, out_suffix) < 0) {
+    if (snprintf(out_path, sizeof(out_path), "%s%s_%s%s", out_prefix, in_file, out_suffix,
+                 compress_dump ? LZ4_SUFFIX : "") < 0) {
         ALOGE("%s: out path error: %s", __func__, strerror(errno));
         return -1;
     }
 
-    mask = umask(002);
-
     fd_in = open(in_path, O_RDONLY | O_NONBLOCK);
     if (fd_in > -1) {
-        fd_out = open(out_path, O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+        fd_out = open(out_path, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
         if (fd_out > -1) {
-            while((n = read(fd_in, buf, sizeof(buf))) > 0) {
-                if (write(fd_out, buf, n) < 0) {
-                    ALOGE("%s: write error: %s", __func__, strerror(errno));
-                }
-                total += n;
-            }
+#ifdef SUPPORT_LZ4_DUMP
+            if (compress_dump)
+                total = copy_file_lz4(fd_in, fd_out);
+            else
+#endif
+                total = copy_file(fd_in, fd_out);
             close(fd_out);
+            if (total <= 0)
+                remove(out_path);
         } else {
             ALOGE("%s: open error: %s, fd_out=%s", __func__, strerror(errno), out_path);
             total = -1;
@@ -150,12 +320,20 @@ static int __dump(const char *in_prefix, const char *in_file, const char *out_pr
         total = -1;
     }
 
-    mask = umask(mask);
-
-    rm_old_dump(out_prefix, in_file);
+    ALOGD("%s: %s%s %lld bytes", __func__, in_prefix, in_file, total);
     return total;
 }
 
+static void *dump_worker(void *arg)
+{
+    struct dump_job *job = (struct dump_job *)arg;
+
+    if (__dump(job->in_prefix, job->in_file, out_path, job->str_time) <= 0 && job->in_prefix_leg)
+        __dump(job->in_prefix_leg, job->in_file, out_path, job->str_time);
+
+    return NULL;
+}
+
 static void dump(void)
 {
     char str_time[32];
@@ -178,18 +356,37 @@ static void dump(void)
         ALOGW("mkdir(%s) failed: %s", out_path, strerror(errno));
     }
 
-    if (__dump(debug_path, SRAM_FILE, out_path, str_time) <= 0)
-        __dump(debug_path_leg, SRAM_FILE, out_path, str_time);
-    if (__dump(debug_path, DRAM_FILE, out_path, str_time) <= 0)
-        __dump(debug_path_leg, DRAM_FILE, out_path, str_time);
-    if (__dump(debug_path, PRIV_FILE, out_path, str_time) <= 0)
-        __dump(debug_path_leg, PRIV_FILE, out_path, str_time);
-    if (__dump(debug_path, SLOG_FILE, out_path, str_time) <= 0)
-        __dump(debug_path_leg, SLOG_FILE, out_path, str_time);
-    if (__dump(debug_path, GPR_FILE, out_path, str_time) <= 0)
-        __dump(debug_path_leg, GPR_FILE, out_path, str_time);
-    __dump(DEBUG_PATH, LOG_FILE, out_path, str_time);
-    __dump(regmap_path, REGISTERS_FILE, out_path, str_time);
+    struct dump_job jobs[] = {
+        { debug_path, debug_path_leg, SRAM_FILE, str_time, 0, false },
+        { debug_path, debug_path_leg, DRAM_FILE, str_time, 0, false },
+        { debug_path, debug_path_leg, PRIV_FILE, str_time, 0, false },
+        { debug_path, debug_path_leg, SLOG_FILE, str_time, 0, false },
+        { debug_path, debug_path_leg, GPR_FILE, str_time, 0, false },
+        { DEBUG_PATH, NULL, LOG_FILE, str_time, 0, false },
+        { regmap_path, NULL, REGISTERS_FILE, str_time, 0, false },
+    };
+    const int job_count = sizeof(jobs) / sizeof(jobs[0]);
+    mode_t mask;
+    int i;
+
+    /* Files are copied in parallel, the big DRAM dump does not delay the others */
+    mask = umask(002);
+    for (i = 0; i < job_count; i++) {
+        jobs[i].threaded = (pthread_create(&jobs[i].thread, NULL, dump_worker, &jobs[i]) == 0);
+        if (!jobs[i].threaded) {
+            ALOGW("%s: pthread_create failed, dump %s in place", __func__, jobs[i].in_file);
+            dump_worker(&jobs[i]);
+        }
+    }
+
+    /* Every dump has to be finished before reset() lets ABOX overwrite its memory */
+    for (i = 0; i < job_count; i++) {
+        if (jobs[i].threaded)
+            pthread_join(jobs[i].thread, NULL);
+    }
+    umask(mask);
+
+    rm_old_dump(out_path, jobs, job_count, str_time);
 }
 
 static void reset(void)
@@ -353,6 +550,15 @@ int main(int argc, char **argv)
             return -1;
         }
         ALOGD("out_path=%s", out_path);
+
+        if (argc > 3 && !strcmp(argv[3], LZ4_OPTION)) {
+#ifdef SUPPORT_LZ4_DUMP
+            compress_dump = true;
+            ALOGD("dumps are compressed with LZ4");
+#else
+            ALOGW("LZ4 dump is not supported");
+#endif
+        }
     } else {
         ALOGE("insufficient argument");
         return -1;
@@ -17,6 +17,7 @@
 
 TOP_LOCAL_PATH := $(call my-dir)
 MALI_GRALLOC_API_TESTS?=0
+MALI_GRALLOC_BENCHMARKS?=0
 
 ifdef GRALLOC_USE_GRALLOC1_API
     ifdef GRALLOC_API_VERSION
@@ -56,6 +57,11 @@ $(info Build gralloc API tests.)
 include $(TOP_LOCAL_PATH)/api_tests/Android.mk
 endif
 
+ifeq ($(MALI_GRALLOC_BENCHMARKS), 1)
+$(info Build gralloc benchmarks.)
+include $(TOP_LOCAL_PATH)/benchmark/Android.mk
+endif
+
 ####################################################################################################
 
 include $(CLEAR_VARS)
@@ -0,0 +1,31 @@
+#
+# Copyright (C) 2019 ARM Limited. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := gralloc_alloc_benchmark
+LOCAL_SRC_FILES := gralloc_alloc_benchmark.cpp
+LOCAL_C_INCLUDES := $(TOP)/hardware/samsung_slsi/exynos/include
+LOCAL_CFLAGS := -Werror
+LOCAL_SHARED_LIBRARIES := liblog libcutils libutils libhidlbase libGrallocWrapper \
+	android.hardware.graphics.allocator@2.0 android.hardware.graphics.mapper@2.0
+
+ifeq ($(BOARD_USES_VENDORIMAGE), true)
+LOCAL_PROPRIETARY_MODULE := true
+endif
+
+include $(BUILD_NATIVE_BENCHMARK)
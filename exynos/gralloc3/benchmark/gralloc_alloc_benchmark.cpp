@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Allocation microbenchmark. Allocates and frees bursts of buffers with the
+ * descriptors used by SurfaceFlinger and the camera on reconfiguration, so
+ * that the CPU cost of the allocation path (format selection, size
+ * calculation, ION allocation) can be compared between gralloc builds.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <GrallocWrapper.h>
+
+using namespace android::GrallocWrapper;
+
+static const Mapper &getMapper()
+{
+    static const Mapper mapper;
+    return mapper;
+}
+
+static const Allocator &getAllocator()
+{
+    static const Allocator allocator(getMapper());
+    return allocator;
+}
+
+static const struct {
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+    PixelFormat format;
+    uint64_t usage;
+} descriptors[] = {
+    { "display_fb", 1080, 2280, PixelFormat::RGBA_8888,
+      static_cast<uint64_t>(BufferUsage::GPU_RENDER_TARGET | BufferUsage::COMPOSER_OVERLAY |
+                            BufferUsage::COMPOSER_CLIENT_TARGET) },
+    { "app_surface", 1080, 2280, PixelFormat::RGBA_8888,
+      static_cast<uint64_t>(BufferUsage::GPU_RENDER_TARGET | BufferUsage::GPU_TEXTURE |
+                            BufferUsage::COMPOSER_OVERLAY) },
+    { "camera_preview", 1920, 1080, PixelFormat::IMPLEMENTATION_DEFINED,
+      static_cast<uint64_t>(BufferUsage::CAMERA_OUTPUT | BufferUsage::GPU_TEXTURE |
+                            BufferUsage::COMPOSER_OVERLAY) },
+    { "camera_yuv", 4032, 3024, PixelFormat::YCBCR_420_888,
+      static_cast<uint64_t>(BufferUsage::CAMERA_OUTPUT | BufferUsage::CPU_READ_OFTEN) },
+    { "video_decode", 3840, 2160, PixelFormat::IMPLEMENTATION_DEFINED,
+      static_cast<uint64_t>(BufferUsage::VIDEO_DECODER | BufferUsage::GPU_TEXTURE |
+                            BufferUsage::COMPOSER_OVERLAY) },
+};
+
+static void BM_allocate_burst(benchmark::State &state)
+{
+    const auto &desc = descriptors[state.range(0)];
+    const uint32_t count = static_cast<uint32_t>(state.range(1));
+    IMapper::BufferDescriptorInfo info = {};
+    BufferDescriptor descriptor;
+    buffer_handle_t handles[16];
+    uint32_t stride;
+
+    info.width = desc.width;
+    info.height = desc.height;
+    info.layerCount = 1;
+    info.format = desc.format;
+    info.usage = desc.usage;
+
+    state.SetLabel(desc.name);
+
+    if (getMapper().createDescriptor(info, &descriptor) != Error::NONE) {
+        state.SkipWithError("createDescriptor failed");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        if (getAllocator().allocate(descriptor, count, &stride, handles) != Error::NONE) {
+            state.SkipWithError("allocate failed");
+            break;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+            getMapper().freeBuffer(handles[i]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void burst_args(benchmark::internal::Benchmark *b)
+{
+    for (int i = 0; i < static_cast<int>(sizeof(descriptors) / sizeof(descriptors[0])); i++) {
+        b->Args({i, 1});
+        b->Args({i, 4});
+        b->Args({i, 16});
+    }
+}
+
+BENCHMARK(BM_allocate_burst)->Apply(burst_args);
+
+BENCHMARK_MAIN();
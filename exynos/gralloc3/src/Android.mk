@@ -243,6 +243,7 @@ LOCAL_SRC_FILES := \
     mali_gralloc_bufferallocation.cpp \
     mali_gralloc_bufferdescriptor.cpp \
     mali_gralloc_ion.cpp \
+    mali_gralloc_recycle.cpp \
     mali_gralloc_formats.cpp \
     mali_gralloc_reference.cpp \
     mali_gralloc_debug.cpp \
@@ -45,6 +45,7 @@
 #define GRALLOC_ALIGN(value, base) ((((value) + (base) -1) / (base)) * (base))
 
 #define GRALLOC_MAX(a, b) (((a)>(b))?(a):(b))
+#define GRALLOC_MIN(a, b) (((a)<(b))?(a):(b))
 
 #define GRALLOC_UNUSED(x) ((void)x)
 
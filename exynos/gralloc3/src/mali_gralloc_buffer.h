@@ -280,6 +280,14 @@ struct private_handle_t
 	int     PRIVATE_2 = 0;
 	int     plane_count = 1;
 
+	/*
+	 * Rows locked for CPU access, used again for cache maintenance on unlock.
+	 * lock_height 0 means the whole buffer.
+	 */
+	int     lock_top = 0;
+	int     lock_height = 0;
+	int     lock_count = 0;     /* nested locks not unlocked yet */
+
 #ifdef __cplusplus
 	/*
 	 * We track the number of integers in the structure. There are 16 unconditional
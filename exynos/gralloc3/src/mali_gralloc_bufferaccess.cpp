@@ -72,18 +72,47 @@ static enum tx_direction get_tx_direction(const uint64_t usage)
 }
 
 static void buffer_sync(private_handle_t * const hnd,
-                        const enum tx_direction direction)
+                        const enum tx_direction direction,
+                        const int t = 0, const int h = 0)
 {
 	if (hnd->flags & private_handle_t::PRIV_FLAGS_USES_ION)
 	{
 		if (direction != TX_NONE)
 		{
-			hnd->cpu_read = (direction == TX_FROM_DEVICE || direction == TX_BOTH) ? 1 : 0;
-			hnd->cpu_write = (direction == TX_TO_DEVICE || direction == TX_BOTH) ? 1 : 0;
+			const int read = (direction == TX_FROM_DEVICE || direction == TX_BOTH) ? 1 : 0;
+			const int write = (direction == TX_TO_DEVICE || direction == TX_BOTH) ? 1 : 0;
 
-			const int status = mali_gralloc_ion_sync_start(hnd,
-			                                               hnd->cpu_read ? true : false,
-			                                               hnd->cpu_write ? true : false);
+			if (hnd->lock_count == 0)
+			{
+				hnd->lock_top = t;
+				hnd->lock_height = h;
+			}
+			else if (hnd->lock_height > 0)
+			{
+				/* Nested lock: unlock must cover the rows of both locks */
+				if (h <= 0)
+				{
+					hnd->lock_top = 0;
+					hnd->lock_height = 0;
+				}
+				else
+				{
+					const int bottom = GRALLOC_MAX(hnd->lock_top + hnd->lock_height, t + h);
+
+					hnd->lock_top = GRALLOC_MIN(hnd->lock_top, t);
+					hnd->lock_height = bottom - hnd->lock_top;
+				}
+			}
+
+			/* Nested lock: the last unlock syncs for every direction locked so far */
+			hnd->cpu_read |= read;
+			hnd->cpu_write |= write;
+			hnd->lock_count++;
+
+			const int status = mali_gralloc_ion_sync_range_start(hnd,
+			                                                     read ? true : false,
+			                                                     write ? true : false,
+			                                                     t, h);
 			if (status < 0)
 			{
 				return;
@@ -91,9 +120,16 @@ static void buffer_sync(private_handle_t * const hnd,
 		}
 		else if (hnd->cpu_read || hnd->cpu_write)
 		{
-			const int status = mali_gralloc_ion_sync_end(hnd,
-			                                             hnd->cpu_read ? true : false,
-			                                             hnd->cpu_write ? true : false);
+			if (hnd->lock_count > 1)
+			{
+				hnd->lock_count--;
+				return;
+			}
+
+			const int status = mali_gralloc_ion_sync_range_end(hnd,
+			                                                   hnd->cpu_read ? true : false,
+			                                                   hnd->cpu_write ? true : false,
+			                                                   hnd->lock_top, hnd->lock_height);
 			if (status < 0)
 			{
 				return;
@@ -101,6 +137,9 @@ static void buffer_sync(private_handle_t * const hnd,
 
 			hnd->cpu_read = 0;
 			hnd->cpu_write = 0;
+			hnd->lock_top = 0;
+			hnd->lock_height = 0;
+			hnd->lock_count = 0;
 		}
 	}
 }
@@ -346,7 +385,7 @@ int mali_gralloc_lock(const mali_gralloc_module * const m, buffer_handle_t buffe
 
 		*vaddr = (void *)hnd->base;
 
-		buffer_sync(hnd, get_tx_direction(usage));
+		buffer_sync(hnd, get_tx_direction(usage), t, h);
 	}
 
 	return 0;
@@ -469,7 +508,7 @@ int mali_gralloc_lock_ycbcr(const mali_gralloc_module *m,
 			return -EINVAL;
 		}
 
-		buffer_sync(hnd, get_tx_direction(usage));
+		buffer_sync(hnd, get_tx_direction(usage), t, h);
 	}
 	else
 	{
@@ -1057,7 +1096,7 @@ int mali_gralloc_lock_flex_async(const mali_gralloc_module *m,
 			return GRALLOC1_ERROR_UNSUPPORTED;
 		}
 
-		buffer_sync(hnd, get_tx_direction(usage));
+		buffer_sync(hnd, get_tx_direction(usage), t, h);
 
 		return GRALLOC1_ERROR_NONE;
 	}
@@ -1312,7 +1351,7 @@ int mali_gralloc_lock_flex_async(const mali_gralloc_module *m,
 		return GRALLOC1_ERROR_UNSUPPORTED;
 	}
 
-	buffer_sync(hnd, get_tx_direction(usage));
+	buffer_sync(hnd, get_tx_direction(usage), t, h);
 
 	return GRALLOC1_ERROR_NONE;
 }
@@ -31,6 +31,7 @@
 #include "mali_gralloc_module.h"
 #include "gralloc_priv.h"
 #include "mali_gralloc_debug.h"
+#include "mali_gralloc_recycle.h"
 
 static pthread_mutex_t dump_lock = PTHREAD_MUTEX_INITIALIZER;
 static std::vector<private_handle_t *> dump_buffers;
@@ -104,6 +105,7 @@ void mali_gralloc_dump_buffers(android::String8 &dumpStrings, uint32_t *outSize)
 	pthread_mutex_unlock(&dump_lock);
 	mali_gralloc_dump_string(
 	    dumpStrings, "---------------------End dump Gralloc buffers info with num %zu----------------------\n", num);
+	mali_gralloc_recycle_dump(dumpStrings);
 
 	*outSize = dumpStrings.size();
 }
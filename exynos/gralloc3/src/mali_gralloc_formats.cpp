@@ -21,6 +21,7 @@
 #include <inttypes.h>
 #include <log/log.h>
 #include <assert.h>
+#include <atomic>
 #include <vector>
 
 #if GRALLOC_VERSION_MAJOR == 1
@@ -43,6 +44,11 @@ static mali_gralloc_format_caps cam_runtime_caps;
 /* Writing to runtime_caps_read is guarded by mutex caps_init_mutex. */
 static pthread_mutex_t caps_init_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool runtime_caps_read = false;
+/*
+ * Incremented whenever runtime capabilities are (re)loaded. Zero until the
+ * first load. Invalidates all format selections memoized so far.
+ */
+static std::atomic<uint32_t> caps_generation(0);
 
 #define MALI_GRALLOC_GPU_LIB_NAME "libGLES_mali.so"
 #define MALI_GRALLOC_VPU_LIB_NAME "libstagefrighthw.so"
@@ -229,6 +235,7 @@ static void get_ip_capabilities(void)
 #endif
 
 	runtime_caps_read = true;
+	caps_generation.fetch_add(1, std::memory_order_release);
 
 already_init:
 	pthread_mutex_unlock(&caps_init_mutex);
@@ -1001,6 +1008,34 @@ static uint64_t get_afbc_format(const uint32_t base_format,
 	return alloc_format;
 }
 
+/*
+ * Buffer size thresholds which affect format selection. Format selection
+ * depends on buffer size only through these, so allocations of the same class
+ * select the same format.
+ */
+#define SIZE_CLASS_AFBC_MIN       (1U << 0)
+#define SIZE_CLASS_DPU_AFBC_MIN   (1U << 1)
+
+static uint32_t get_size_class(const int buffer_size)
+{
+	uint32_t size_class = 0;
+
+	if (buffer_size > (192 * 192))
+	{
+		size_class |= SIZE_CLASS_AFBC_MIN;
+	}
+
+#if GRALLOC_DISP_W != 0 && GRALLOC_DISP_H != 0
+	if (((buffer_size * 100) / (GRALLOC_DISP_W * GRALLOC_DISP_H)) >= GRALLOC_AFBC_MIN_SIZE)
+#endif
+	{
+		size_class |= SIZE_CLASS_DPU_AFBC_MIN;
+	}
+
+	return size_class;
+}
+
+
 /*
  * Obtains the 'active' capabilities (for producers/consumers) by applying
  * additional constraints to the capabilities declared for each IP. Some rules
@@ -1040,15 +1075,15 @@ static void get_active_caps(const format_info_t format,
 		consumer_mask &= ~MALI_GRALLOC_FORMAT_CAPABILITY_AFBCENABLE_MASK;
 	}
 
-	afbc_allowed = buffer_size > (192 * 192);
+	const uint32_t size_class = get_size_class(buffer_size);
+
+	afbc_allowed = (size_class & SIZE_CLASS_AFBC_MIN) != 0;
 
-#if GRALLOC_DISP_W != 0 && GRALLOC_DISP_H != 0
 	if (consumers & MALI_GRALLOC_CONSUMER_DPU)
 	{
 		/* Disable AFBC based on buffer dimensions */
-		afbc_allowed = afbc_allowed && ((buffer_size * 100) / (GRALLOC_DISP_W * GRALLOC_DISP_H)) >= GRALLOC_AFBC_MIN_SIZE;
+		afbc_allowed = afbc_allowed && (size_class & SIZE_CLASS_DPU_AFBC_MIN) != 0;
 	}
-#endif
 	if (!afbc_allowed)
 	{
 		consumer_mask &= ~MALI_GRALLOC_FORMAT_CAPABILITY_AFBCENABLE_MASK;
@@ -1590,6 +1625,107 @@ uint32_t get_base_format(const uint64_t req_format,
 }
 
 
+/*
+ * Memo of format selections.
+ *
+ * Format selection only depends on the requested format, format type, usage
+ * and buffer size class, while it is repeated for every allocation. Results
+ * are kept in a small direct-mapped table. Each entry is guarded by a sequence
+ * count so that lookups never block: a reader that races with a writer
+ * simply misses. Entries are tagged with the capability
+ * generation and become stale when capabilities are reloaded.
+ */
+#define FORMAT_MEMO_ENTRIES 64
+
+typedef struct
+{
+	std::atomic<uint32_t> seq;
+	std::atomic<uint32_t> generation;
+	std::atomic<uint32_t> type_size_class;
+	std::atomic<uint64_t> req_format;
+	std::atomic<uint64_t> usage;
+	std::atomic<uint64_t> alloc_format;
+	std::atomic<uint64_t> internal_format;
+} format_memo_entry;
+
+static format_memo_entry format_memo[FORMAT_MEMO_ENTRIES];
+
+static format_memo_entry *get_format_memo_entry(const uint64_t req_format,
+                                                const uint64_t usage,
+                                                const uint32_t type_size_class)
+{
+	uint64_t hash = req_format * 0x9e3779b97f4a7c15ULL;
+
+	hash ^= usage + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	hash ^= type_size_class + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+
+	return &format_memo[(hash ^ (hash >> 32)) & (FORMAT_MEMO_ENTRIES - 1)];
+}
+
+static bool format_memo_lookup(const uint32_t generation,
+                               const uint64_t req_format,
+                               const uint64_t usage,
+                               const uint32_t type_size_class,
+                               uint64_t * const alloc_format,
+                               uint64_t * const internal_format)
+{
+	format_memo_entry *entry = get_format_memo_entry(req_format, usage, type_size_class);
+	const uint32_t seq = entry->seq.load(std::memory_order_acquire);
+
+	if (seq & 1)
+	{
+		return false;
+	}
+
+	const bool match = entry->generation.load(std::memory_order_relaxed) == generation &&
+	                   entry->req_format.load(std::memory_order_relaxed) == req_format &&
+	                   entry->usage.load(std::memory_order_relaxed) == usage &&
+	                   entry->type_size_class.load(std::memory_order_relaxed) == type_size_class;
+	const uint64_t alloc = entry->alloc_format.load(std::memory_order_relaxed);
+	const uint64_t internal = entry->internal_format.load(std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if (!match || entry->seq.load(std::memory_order_relaxed) != seq)
+	{
+		return false;
+	}
+
+	*alloc_format = alloc;
+	*internal_format = internal;
+
+	return true;
+}
+
+static void format_memo_insert(const uint32_t generation,
+                               const uint64_t req_format,
+                               const uint64_t usage,
+                               const uint32_t type_size_class,
+                               const uint64_t alloc_format,
+                               const uint64_t internal_format)
+{
+	format_memo_entry *entry = get_format_memo_entry(req_format, usage, type_size_class);
+	uint32_t seq = entry->seq.load(std::memory_order_relaxed);
+
+	/* Another thread is updating this entry. Skip rather than wait. */
+	if ((seq & 1) || !entry->seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	std::atomic_thread_fence(std::memory_order_release);
+
+	entry->generation.store(generation, std::memory_order_relaxed);
+	entry->req_format.store(req_format, std::memory_order_relaxed);
+	entry->usage.store(usage, std::memory_order_relaxed);
+	entry->type_size_class.store(type_size_class, std::memory_order_relaxed);
+	entry->alloc_format.store(alloc_format, std::memory_order_relaxed);
+	entry->internal_format.store(internal_format, std::memory_order_relaxed);
+
+	entry->seq.store(seq + 2, std::memory_order_release);
+}
+
+
 /*
  * Select pixel format (base + modifier) for allocation.
  *
@@ -1603,11 +1739,11 @@ uint32_t get_base_format(const uint64_t req_format,
  *         MALI_GRALLOC_FORMAT_INTERNAL_UNDEFINED, where no suitable
  *         format could be found.
  */
-uint64_t mali_gralloc_select_format(const uint64_t req_format,
-                                    const mali_gralloc_format_type type,
-                                    const uint64_t usage,
-                                    const int buffer_size,
-                                    uint64_t * const internal_format)
+static uint64_t select_format(const uint64_t req_format,
+                              const mali_gralloc_format_type type,
+                              const uint64_t usage,
+                              const int buffer_size,
+                              uint64_t * const internal_format)
 {
 	uint64_t alloc_format = MALI_GRALLOC_FORMAT_INTERNAL_UNDEFINED;
 
@@ -1735,6 +1871,38 @@ out:
 	return alloc_format;
 }
 
+
+/*
+ * Select pixel format (base + modifier) for allocation. Memoized wrapper of
+ * select_format(), which has the same parameters and return value.
+ */
+uint64_t mali_gralloc_select_format(const uint64_t req_format,
+                                    const mali_gralloc_format_type type,
+                                    const uint64_t usage,
+                                    const int buffer_size,
+                                    uint64_t * const internal_format)
+{
+	const uint32_t generation = caps_generation.load(std::memory_order_acquire);
+	const uint32_t type_size_class = ((uint32_t)type << 8) | get_size_class(buffer_size);
+	uint64_t alloc_format;
+
+	if (generation != 0 &&
+	    format_memo_lookup(generation, req_format, usage, type_size_class, &alloc_format, internal_format))
+	{
+		return alloc_format;
+	}
+
+	alloc_format = select_format(req_format, type, usage, buffer_size, internal_format);
+
+	/* Failures are not memoized so that they are always reported. */
+	if (generation != 0 && alloc_format != MALI_GRALLOC_FORMAT_INTERNAL_UNDEFINED)
+	{
+		format_memo_insert(generation, req_format, usage, type_size_class, alloc_format, *internal_format);
+	}
+
+	return alloc_format;
+}
+
 bool is_exynos_format(uint32_t base_format)
 {
 	switch (base_format)
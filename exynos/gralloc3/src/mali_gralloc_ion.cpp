@@ -45,6 +45,8 @@
 #include "mali_gralloc_usages.h"
 #include "mali_gralloc_bufferdescriptor.h"
 #include "mali_gralloc_bufferallocation.h"
+#include "format_info.h"
+#include "mali_gralloc_recycle.h"
 
 #include <hardware/exynos/ion.h>
 #include <hardware/exynos/dmabuf_container.h>
@@ -303,7 +305,20 @@ static int alloc_from_ion_heap(uint64_t usage, size_t size,
 	}
 
 	unsigned int heap_mask = select_heap_mask(usage);
-	shared_fd = exynos_ion_alloc(ion_client, size, heap_mask, flags);
+	shared_fd = mali_gralloc_recycle_get(ion_client, heap_mask, flags, size);
+	if (shared_fd < 0)
+	{
+		shared_fd = exynos_ion_alloc(ion_client, size, heap_mask, flags);
+
+		/* Release pooled buffers back to ION before falling back to another heap. */
+		if (shared_fd < 0 && mali_gralloc_recycle_trim(0) > 0)
+		{
+			shared_fd = exynos_ion_alloc(ion_client, size, heap_mask, flags);
+		}
+	}
+
+	/* Recycled buffers are tracked again so that they can be parked on the next free. */
+	mali_gralloc_recycle_track(shared_fd, heap_mask, flags, size);
 
 	/* Check if allocation from selected heap failed and fall back to system
 	 * heap if possible.
@@ -524,18 +539,57 @@ int mali_gralloc_ion_open(void)
 }
 
 /*
- * Signal start of CPU access to the DMABUF exported from ION.
+ * Computes the byte range of rows [top, top + height) in the first fd.
  *
- * @param hnd   [in]    Buffer handle
- * @param read  [in]    Flag indicating CPU read access to memory
- * @param write [in]    Flag indicating CPU write access to memory
+ * Only single-plane, single-layer, uncompressed RGB buffers are limited to
+ * the requested rows. YUV planes are subsampled and the Exynos YUV and SBWC
+ * layouts are not row addressable, so those keep whole-buffer maintenance.
  *
- * @return              0 in case of success
- *                      errno for all error cases
+ * @return true if the range is limited, false for the whole buffer.
  */
-int mali_gralloc_ion_sync_start(const private_handle_t * const hnd,
-                                const bool read,
-                                const bool write)
+static bool get_sync_rows_range(const private_handle_t * const hnd,
+                                const int top, const int height,
+                                off_t *offset, size_t *len)
+{
+	if (height <= 0 || hnd->layer_count > 1 || hnd->get_num_ion_fds() > 1)
+	{
+		return false;
+	}
+
+	if ((hnd->alloc_format & MALI_GRALLOC_INTFMT_EXT_MASK) != 0)
+	{
+		return false;
+	}
+
+	const int32_t format_idx = get_format_index(hnd->alloc_format & MALI_GRALLOC_INTFMT_FMT_MASK);
+	if (format_idx == -1 || formats[format_idx].is_yuv || formats[format_idx].npln != 1)
+	{
+		return false;
+	}
+
+	const size_t stride = hnd->plane_info[0].byte_stride;
+	const size_t start = hnd->plane_info[0].offset + (size_t)top * stride;
+	const size_t end = start + (size_t)height * stride;
+
+	if (stride == 0 || end > (size_t)hnd->sizes[0])
+	{
+		return false;
+	}
+
+	*offset = start;
+	*len = end - start;
+
+	return true;
+}
+
+
+/*
+ * Performs CPU cache maintenance for the given access direction on every ION
+ * fd of the buffer, limited to rows [top, top + height) where possible.
+ */
+static int mali_gralloc_ion_sync(const private_handle_t * const hnd,
+                                 const bool read, const bool write,
+                                 const bool start, const int top, const int height)
 {
 	if (hnd == NULL)
 	{
@@ -555,15 +609,35 @@ int mali_gralloc_ion_sync_start(const private_handle_t * const hnd,
 		}
 	}
 
-	GRALLOC_UNUSED(read);
-	GRALLOC_UNUSED(write);
+	const int direction = (read ? ION_SYNC_READ : 0) | (write ? ION_SYNC_WRITE : 0);
+
+	if (direction == 0)
+	{
+		return 0;
+	}
 
 	if (hnd->flags & private_handle_t::PRIV_FLAGS_USES_ION &&
 		!(hnd->flags & private_handle_t::PRIV_FLAGS_USES_ION_DMA_HEAP))
 	{
+		off_t offset = 0;
+		size_t len = 0;
+
+		if (!get_sync_rows_range(hnd, top, height, &offset, &len))
+		{
+			offset = 0;
+			len = 0;
+		}
+
 		for (int idx = 0; idx < hnd->get_num_ion_fds(); idx++)
 		{
-			exynos_ion_sync_fd(ion_client, hnd->fds[idx]);
+			if (start)
+			{
+				exynos_ion_sync_start_partial(ion_client, hnd->fds[idx], direction, offset, len);
+			}
+			else
+			{
+				exynos_ion_sync_end_partial(ion_client, hnd->fds[idx], direction, offset, len);
+			}
 		}
 	}
 
@@ -571,6 +645,24 @@ int mali_gralloc_ion_sync_start(const private_handle_t * const hnd,
 }
 
 
+/*
+ * Signal start of CPU access to the DMABUF exported from ION.
+ *
+ * @param hnd   [in]    Buffer handle
+ * @param read  [in]    Flag indicating CPU read access to memory
+ * @param write [in]    Flag indicating CPU write access to memory
+ *
+ * @return              0 in case of success
+ *                      errno for all error cases
+ */
+int mali_gralloc_ion_sync_start(const private_handle_t * const hnd,
+                                const bool read,
+                                const bool write)
+{
+	return mali_gralloc_ion_sync(hnd, read, write, true, 0, 0);
+}
+
+
 /*
  * Signal end of CPU access to the DMABUF exported from ION.
  *
@@ -585,38 +677,47 @@ int mali_gralloc_ion_sync_end(const private_handle_t * const hnd,
                               const bool read,
                               const bool write)
 {
-	if (hnd == NULL)
-	{
-		return -EINVAL;
-	}
-
-	if (ion_client <= 0)
-	{
-		/* a second user process must obtain a client handle first via ion_open before it can obtain the shared ion buffer*/
-		AWAR("ion_client not specified");
-
-		int status = 0;
-		status = open_and_query_ion();
-		if (status < 0)
-		{
-			return status;
-		}
-	}
+	return mali_gralloc_ion_sync(hnd, read, write, false, 0, 0);
+}
 
 
-	GRALLOC_UNUSED(read);
-	GRALLOC_UNUSED(write);
+/*
+ * Signal start of CPU access to rows of the DMABUF exported from ION.
+ *
+ * @param hnd    [in]    Buffer handle
+ * @param read   [in]    Flag indicating CPU read access to memory
+ * @param write  [in]    Flag indicating CPU write access to memory
+ * @param top    [in]    First row accessed by the CPU (in pixels)
+ * @param height [in]    Number of rows accessed, 0 for the whole buffer
+ *
+ * @return               0 in case of success
+ *                       errno for all error cases
+ */
+int mali_gralloc_ion_sync_range_start(const private_handle_t * const hnd,
+                                      const bool read, const bool write,
+                                      const int top, const int height)
+{
+	return mali_gralloc_ion_sync(hnd, read, write, true, top, height);
+}
 
-	if (hnd->flags & private_handle_t::PRIV_FLAGS_USES_ION &&
-		!(hnd->flags & private_handle_t::PRIV_FLAGS_USES_ION_DMA_HEAP))
-	{
-		for (int idx = 0; idx < hnd->get_num_ion_fds(); idx++)
-		{
-			exynos_ion_sync_fd(ion_client, hnd->fds[idx]);
-		}
-	}
 
-	return 0;
+/*
+ * Signal end of CPU access to rows of the DMABUF exported from ION.
+ *
+ * @param hnd    [in]    Buffer handle
+ * @param read   [in]    Flag indicating CPU read access to memory
+ * @param write  [in]    Flag indicating CPU write access to memory
+ * @param top    [in]    First row accessed by the CPU (in pixels)
+ * @param height [in]    Number of rows accessed, 0 for the whole buffer
+ *
+ * @return               0 in case of success
+ *                       errno for all error cases
+ */
+int mali_gralloc_ion_sync_range_end(const private_handle_t * const hnd,
+                                    const bool read, const bool write,
+                                    const int top, const int height)
+{
+	return mali_gralloc_ion_sync(hnd, read, write, false, top, height);
 }
 
 
@@ -642,7 +743,10 @@ void mali_gralloc_ion_free(private_handle_t * const hnd)
 					}
 				}
 
-				close(hnd->fds[idx]);
+				if (!mali_gralloc_recycle_put(hnd->fds[idx]))
+				{
+					close(hnd->fds[idx]);
+				}
 			}
 		}
 
@@ -663,6 +767,16 @@ static void mali_gralloc_ion_free_internal(buffer_handle_t * const pHandle,
 	}
 }
 
+/*
+ * Closes an fd allocated by alloc_from_ion_heap() that is not handed out in a
+ * handle, so that the recycle pool forgets it.
+ */
+static void close_ion_fd(int fd)
+{
+	mali_gralloc_recycle_untrack(fd);
+	close(fd);
+}
+
 static int allocate_to_fds(buffer_descriptor_t *bufDescriptor, enum ion_heap_type heap_type,
 		uint32_t ion_flags, uint32_t *priv_heap_flag, int *min_pgsz, int* fd0, int* fd1, int* fd2)
 {
@@ -723,7 +837,7 @@ err:
 	{
 		if (fd_arr[i] >= 0)
 		{
-			close(fd_arr[i]);
+			close_ion_fd(fd_arr[i]);
 		}
 	}
 
@@ -776,7 +890,7 @@ static int allocate_to_container(buffer_descriptor_t *bufDescriptor, enum ion_he
 		if (err)
 		{
 			for (int j = 0; j < i; j++)
-				close(fd_arr[j]);
+				close_ion_fd(fd_arr[j]);
 
 			goto finish;
 		}
@@ -786,7 +900,7 @@ finish:
 	/* free single fds to make ref count to 1 */
 	for (int i = 0; i < 3; i++)
 		for (int j = 0; j < layer_count; j++)
-			if (hfr_fds[i][j] >= 0) close(hfr_fds[i][j]);
+			if (hfr_fds[i][j] >= 0) close_ion_fd(hfr_fds[i][j]);
 
 	return err;
 }
@@ -878,7 +992,7 @@ int mali_gralloc_ion_allocate(const gralloc_buffer_descriptor_t *descriptors,
 					 * max_bufDescriptor is also not closed */
 					if (i < max_buffer_index)
 					{
-						close(shared_fd);
+						close_ion_fd(shared_fd);
 					}
 
 					/* Need to free already allocated memory. */
@@ -898,7 +1012,7 @@ int mali_gralloc_ion_allocate(const gralloc_buffer_descriptor_t *descriptors,
 				if (fd_arr[1] >= 0)
 				{
 					ALOGW("Warning afbc flag fd already exists during create. Closing.");
-					close(fd_arr[1]);
+					close_ion_fd(fd_arr[1]);
 				}
 
 				bufDescriptor->sizes[1] = sizeof(int);
@@ -924,13 +1038,13 @@ int mali_gralloc_ion_allocate(const gralloc_buffer_descriptor_t *descriptors,
 				AERR("Private handle could not be created for descriptor:%d of shared usecase", i);
 
 				/* Close the obtained shared file descriptor for the current handle */
-				close(tmp_fd);
+				close_ion_fd(tmp_fd);
 
 				/* It is possible that already opened shared_fd for the
 				 * max_bufDescriptor is also not closed */
 				if (i < max_buffer_index)
 				{
-					close(shared_fd);
+					close_ion_fd(shared_fd);
 				}
 
 				/* Free the resources allocated for the previous handles */
@@ -998,7 +1112,7 @@ int mali_gralloc_ion_allocate(const gralloc_buffer_descriptor_t *descriptors,
 				if (fd_arr[1] >= 0)
 				{
 					ALOGW("Warning afbc flag fd already exists during create. Closing.");
-					close(fd_arr[1]);
+					close_ion_fd(fd_arr[1]);
 				}
 
 				bufDescriptor->sizes[1] = sizeof(int);
@@ -1026,7 +1140,7 @@ int mali_gralloc_ion_allocate(const gralloc_buffer_descriptor_t *descriptors,
 				AERR("Private handle could not be created for descriptor:%d in non-shared usecase", i);
 
 				/* Close the obtained shared file descriptor for the current handle */
-				close(shared_fd);
+				close_ion_fd(shared_fd);
 				mali_gralloc_ion_free_internal(pHandle, numDescriptors);
 				return -1;
 			}
@@ -1183,6 +1297,9 @@ void mali_gralloc_ion_unmap(private_handle_t *hnd)
 		{
 			hnd->cpu_read = 0;
 			hnd->cpu_write = 0;
+			hnd->lock_top = 0;
+			hnd->lock_height = 0;
+			hnd->lock_count = 0;
 		}
 	}
 }
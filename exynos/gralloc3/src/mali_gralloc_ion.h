@@ -29,6 +29,12 @@ int mali_gralloc_ion_sync_start(const private_handle_t * const hnd,
                                 const bool read, const bool write);
 int mali_gralloc_ion_sync_end(const private_handle_t * const hnd,
                               const bool read, const bool write);
+int mali_gralloc_ion_sync_range_start(const private_handle_t * const hnd,
+                                      const bool read, const bool write,
+                                      const int top, const int height);
+int mali_gralloc_ion_sync_range_end(const private_handle_t * const hnd,
+                                    const bool read, const bool write,
+                                    const int top, const int height);
 int mali_gralloc_ion_map(private_handle_t *hnd);
 void mali_gralloc_ion_unmap(private_handle_t *hnd);
 void mali_gralloc_ion_close(void);
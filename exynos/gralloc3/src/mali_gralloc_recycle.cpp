@@ -0,0 +1,583 @@
+/*
+ * Copyright (C) 2019 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Recycle pool of ION buffers.
+ *
+ * BufferQueue resizes, rotations and camera reconfigurations free and
+ * reallocate buffers with identical descriptors. Instead of returning such
+ * buffers to ION, the allocating process parks its fd here, keyed by heap
+ * mask, ION flags and size, and hands it out again for the next allocation
+ * with the same key.
+ *
+ * The allocator frees its handle as soon as the buffer has been passed to the
+ * client, so a parked buffer is usually still in use elsewhere. A parked
+ * buffer is only reused once the pool holds the last reference to the
+ * dma-buf, which is read from the "count:" field of /proc/self/fdinfo.
+ * Kernels without that field cannot tell, so the pool stays disabled there.
+ * fdinfo is read, and buffers are wiped and closed, without the pool lock.
+ *
+ * Reused buffers are zeroed unless they were allocated with
+ * ION_FLAG_NOZEROED. Protected buffers cannot be wiped by the CPU and are
+ * never pooled.
+ *
+ * The pool is opt-in: ro.vendor.gralloc.recycle_pool_kb sets its capacity
+ * and defaults to 0 (disabled). Idle buffers are released after
+ * RECYCLE_IDLE_TIMEOUT_MS, when the pool exceeds its capacity, and all at
+ * once when an ION allocation fails. The timeouts are enforced by a reaper
+ * thread that runs while the pool is not empty, so buffers parked before the
+ * process goes quiet do not hold ION memory until the next free.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <log/log.h>
+#include <cutils/properties.h>
+#include <hardware/exynos/ion.h>
+
+#include "gralloc_helper.h"
+#include "mali_gralloc_recycle.h"
+
+#define RECYCLE_MAX_ENTRIES        64
+#define RECYCLE_IDLE_TIMEOUT_MS    2000
+#define RECYCLE_BUSY_TIMEOUT_MS    60000
+#define RECYCLE_REAP_INTERVAL_MS   (RECYCLE_IDLE_TIMEOUT_MS / 2)
+
+struct recycle_key
+{
+	unsigned int heap_mask;
+	unsigned int flags;
+	size_t size;
+
+	bool operator==(const recycle_key &other) const
+	{
+		return heap_mask == other.heap_mask && flags == other.flags && size == other.size;
+	}
+};
+
+struct recycle_entry
+{
+	int fd;
+	recycle_key key;
+	uint64_t serial;     /* Identifies the entry while recycle_lock is dropped. */
+	int64_t parked_ms;
+	int64_t idle_ms;     /* When the pool was first seen holding the only reference, or 0. */
+};
+
+/* dma-buf fields of /proc/self/fdinfo */
+struct dmabuf_info
+{
+	int count;
+	size_t size;
+	char exp_name[32];
+};
+
+struct recycle_tracked
+{
+	recycle_key key;
+	dmabuf_info info;
+};
+
+struct recycle_stats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t parked;
+	uint64_t rejected;
+	uint64_t evicted;
+	uint64_t wiped_bytes;
+};
+
+static pthread_mutex_t recycle_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<recycle_entry> recycle_pool;
+static std::unordered_map<int, recycle_tracked> recycle_fds;
+static recycle_stats stats;
+static size_t recycle_capacity;
+static size_t recycle_pool_size;
+static uint64_t recycle_serial;
+static bool recycle_initialized;
+static bool recycle_reaping;
+
+static int64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Reads the dma-buf fields of the fdinfo of @fd. Fields the kernel does not
+ * report are left as -1, 0 and "".
+ */
+static void get_dmabuf_info(int fd, dmabuf_info *info)
+{
+	char path[64];
+	char line[128];
+
+	info->count = -1;
+	info->size = 0;
+	info->exp_name[0] = '\0';
+
+	snprintf(path, sizeof(path), "/proc/self/fdinfo/%d", fd);
+
+	FILE *fp = fopen(path, "re");
+	if (fp == NULL)
+	{
+		return;
+	}
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		if (strncmp(line, "count:", 6) == 0)
+		{
+			sscanf(line + 6, "%d", &info->count);
+		}
+		else if (strncmp(line, "size:", 5) == 0)
+		{
+			sscanf(line + 5, "%zu", &info->size);
+		}
+		else if (strncmp(line, "exp_name:", 9) == 0)
+		{
+			sscanf(line + 9, "%31s", info->exp_name);
+		}
+	}
+
+	fclose(fp);
+}
+
+/*
+ * Returns the number of references to the file behind @fd, or -1 if the
+ * kernel does not report it.
+ */
+static int get_file_count(int fd)
+{
+	dmabuf_info info;
+
+	get_dmabuf_info(fd, &info);
+
+	return info.count;
+}
+
+static bool recycle_enabled_locked(const dmabuf_info &info)
+{
+	if (!recycle_initialized)
+	{
+		recycle_initialized = true;
+		recycle_capacity = (size_t)property_get_int32("ro.vendor.gralloc.recycle_pool_kb", 0) * 1024;
+
+		if (recycle_capacity > 0 && info.count < 0)
+		{
+			AWAR("dma-buf reference count is not available, recycle pool disabled");
+			recycle_capacity = 0;
+		}
+	}
+
+	return recycle_capacity > 0;
+}
+
+/* Removes entry @idx from the pool, the caller closes the returned fd. */
+static int evict_locked(size_t idx)
+{
+	const int fd = recycle_pool[idx].fd;
+
+	recycle_pool_size -= recycle_pool[idx].key.size;
+	recycle_pool.erase(recycle_pool.begin() + idx);
+	stats.evicted++;
+
+	return fd;
+}
+
+/*
+ * Releases expired buffers, then the oldest ones until the pool fits in
+ * @target_size bytes.
+ *
+ * A buffer becomes idle once the pool holds its last reference and nothing
+ * can take a new one, so only buffers not yet seen idle have their fdinfo read.
+ */
+static size_t trim(size_t target_size)
+{
+	std::vector<std::pair<uint64_t, int>> pending;
+	std::vector<uint64_t> idle;
+	std::vector<int> victims;
+	size_t released = 0;
+
+	pthread_mutex_lock(&recycle_lock);
+	for (const recycle_entry &entry : recycle_pool)
+	{
+		if (entry.idle_ms == 0)
+		{
+			pending.push_back({ entry.serial, entry.fd });
+		}
+	}
+	pthread_mutex_unlock(&recycle_lock);
+
+	/* An fd evicted meanwhile may read another file, its serial is gone then. */
+	for (const auto &p : pending)
+	{
+		if (get_file_count(p.second) == 1)
+		{
+			idle.push_back(p.first);
+		}
+	}
+
+	pthread_mutex_lock(&recycle_lock);
+
+	const int64_t now = now_ms();
+
+	for (size_t i = 0; i < recycle_pool.size();)
+	{
+		recycle_entry &entry = recycle_pool[i];
+
+		if (entry.idle_ms == 0 &&
+		    std::find(idle.begin(), idle.end(), entry.serial) != idle.end())
+		{
+			entry.idle_ms = now;
+		}
+
+		if ((entry.idle_ms != 0 && now - entry.idle_ms > RECYCLE_IDLE_TIMEOUT_MS) ||
+		    (now - entry.parked_ms > RECYCLE_BUSY_TIMEOUT_MS))
+		{
+			released += entry.key.size;
+			victims.push_back(evict_locked(i));
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	while (!recycle_pool.empty() &&
+	       (recycle_pool_size > target_size || recycle_pool.size() > RECYCLE_MAX_ENTRIES))
+	{
+		released += recycle_pool[0].key.size;
+		victims.push_back(evict_locked(0));
+	}
+
+	pthread_mutex_unlock(&recycle_lock);
+
+	for (int fd : victims)
+	{
+		close(fd);
+	}
+
+	return released;
+}
+
+static void *reaper_main(void *)
+{
+	pthread_mutex_lock(&recycle_lock);
+
+	while (!recycle_pool.empty())
+	{
+		pthread_mutex_unlock(&recycle_lock);
+		usleep(RECYCLE_REAP_INTERVAL_MS * 1000);
+		trim(recycle_capacity);
+		pthread_mutex_lock(&recycle_lock);
+	}
+
+	recycle_reaping = false;
+	pthread_mutex_unlock(&recycle_lock);
+
+	return NULL;
+}
+
+/* Starts the reaper unless it is running already, called with recycle_lock held. */
+static void start_reaper_locked(void)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+
+	if (recycle_reaping)
+	{
+		return;
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	if (pthread_create(&thread, &attr, reaper_main, NULL) == 0)
+	{
+		recycle_reaping = true;
+	}
+	else
+	{
+		AWAR("could not start recycle pool reaper, idle buffers are released on free only");
+	}
+
+	pthread_attr_destroy(&attr);
+}
+
+static bool wipe_buffer(int ion_client, int fd, const recycle_key &key)
+{
+	if (key.flags & ION_FLAG_NOZEROED)
+	{
+		return true;
+	}
+
+	void *ptr = mmap(NULL, key.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED)
+	{
+		AERR("could not mmap recycled buffer fd(%d): %s", fd, strerror(errno));
+		return false;
+	}
+
+	memset(ptr, 0, key.size);
+	munmap(ptr, key.size);
+
+	if (key.flags & ION_FLAG_CACHED)
+	{
+		exynos_ion_sync_end(ion_client, fd, ION_SYNC_WRITE);
+	}
+
+	pthread_mutex_lock(&recycle_lock);
+	stats.wiped_bytes += key.size;
+	pthread_mutex_unlock(&recycle_lock);
+
+	return true;
+}
+
+/*
+ * Takes a buffer matching the key out of the pool.
+ *
+ * @return fd of a zeroed buffer, or -1 if none is available.
+ */
+int mali_gralloc_recycle_get(int ion_client, unsigned int heap_mask, unsigned int flags, size_t size)
+{
+	const recycle_key key = { heap_mask, flags, size };
+	std::vector<recycle_entry> busy;
+	int fd = -1;
+
+	if (flags & ION_FLAG_PROTECTED)
+	{
+		return -1;
+	}
+
+	pthread_mutex_lock(&recycle_lock);
+
+	if (recycle_capacity == 0)
+	{
+		pthread_mutex_unlock(&recycle_lock);
+		return -1;
+	}
+
+	/*
+	 * Matching buffers are taken out of the pool while their fdinfo is read,
+	 * and those still in use elsewhere are put back at the front afterwards.
+	 */
+	while (fd < 0)
+	{
+		auto it = std::find_if(recycle_pool.begin(), recycle_pool.end(),
+		                       [&key](const recycle_entry &e) { return e.key == key; });
+		if (it == recycle_pool.end())
+		{
+			break;
+		}
+
+		const recycle_entry entry = *it;
+		recycle_pool_size -= entry.key.size;
+		recycle_pool.erase(it);
+
+		if (entry.idle_ms != 0)
+		{
+			fd = entry.fd;
+			break;
+		}
+
+		pthread_mutex_unlock(&recycle_lock);
+		const int count = get_file_count(entry.fd);
+		pthread_mutex_lock(&recycle_lock);
+
+		if (count == 1)
+		{
+			fd = entry.fd;
+		}
+		else
+		{
+			busy.push_back(entry);
+		}
+	}
+
+	for (const recycle_entry &entry : busy)
+	{
+		recycle_pool_size += entry.key.size;
+	}
+	recycle_pool.insert(recycle_pool.begin(), busy.begin(), busy.end());
+
+	pthread_mutex_unlock(&recycle_lock);
+
+	if (fd >= 0 && !wipe_buffer(ion_client, fd, key))
+	{
+		close(fd);
+		fd = -1;
+	}
+
+	pthread_mutex_lock(&recycle_lock);
+	if (fd >= 0)
+	{
+		stats.hits++;
+	}
+	else
+	{
+		stats.misses++;
+	}
+	pthread_mutex_unlock(&recycle_lock);
+
+	return fd;
+}
+
+/*
+ * Registers a buffer allocated from ION so that it can be parked on free.
+ */
+void mali_gralloc_recycle_track(int fd, unsigned int heap_mask, unsigned int flags, size_t size)
+{
+	dmabuf_info info;
+
+	if (fd < 0 || (flags & ION_FLAG_PROTECTED))
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&recycle_lock);
+	const bool disabled = recycle_initialized && recycle_capacity == 0;
+	pthread_mutex_unlock(&recycle_lock);
+
+	if (disabled)
+	{
+		return;
+	}
+
+	get_dmabuf_info(fd, &info);
+
+	pthread_mutex_lock(&recycle_lock);
+
+	if (recycle_enabled_locked(info))
+	{
+		recycle_fds[fd] = { { heap_mask, flags, size }, info };
+	}
+
+	pthread_mutex_unlock(&recycle_lock);
+}
+
+/*
+ * Forgets a tracked buffer that is closed without going through
+ * mali_gralloc_recycle_put(), so that its fd number is not taken for it later.
+ */
+void mali_gralloc_recycle_untrack(int fd)
+{
+	pthread_mutex_lock(&recycle_lock);
+	recycle_fds.erase(fd);
+	pthread_mutex_unlock(&recycle_lock);
+}
+
+/*
+ * Offers a buffer that is being freed to the pool.
+ *
+ * @return true if the pool took ownership of @fd, false if the caller must
+ *         close it.
+ */
+bool mali_gralloc_recycle_put(int fd)
+{
+	dmabuf_info info;
+	bool parked = false;
+
+	pthread_mutex_lock(&recycle_lock);
+
+	auto it = recycle_fds.find(fd);
+	if (it == recycle_fds.end())
+	{
+		pthread_mutex_unlock(&recycle_lock);
+		return false;
+	}
+
+	const recycle_tracked tracked = it->second;
+	recycle_fds.erase(it);
+
+	pthread_mutex_unlock(&recycle_lock);
+
+	/*
+	 * The fd number may have been closed and reused since it was tracked.
+	 * All dma-bufs share one anonymous inode, so compare the dma-buf itself.
+	 */
+	get_dmabuf_info(fd, &info);
+
+	const bool same = info.size == tracked.info.size &&
+	                  strcmp(info.exp_name, tracked.info.exp_name) == 0;
+
+	pthread_mutex_lock(&recycle_lock);
+
+	if (same && tracked.key.size <= recycle_capacity)
+	{
+		recycle_pool.push_back({ fd, tracked.key, ++recycle_serial, now_ms(), 0 });
+		recycle_pool_size += tracked.key.size;
+		stats.parked++;
+		parked = true;
+		start_reaper_locked();
+	}
+	else
+	{
+		stats.rejected++;
+	}
+
+	pthread_mutex_unlock(&recycle_lock);
+
+	if (parked)
+	{
+		trim(recycle_capacity);
+	}
+
+	return parked;
+}
+
+/*
+ * Releases pooled buffers until the pool fits in @target_size bytes.
+ *
+ * @return number of bytes released.
+ */
+size_t mali_gralloc_recycle_trim(size_t target_size)
+{
+	return trim(target_size);
+}
+
+void mali_gralloc_recycle_dump(android::String8 &buf)
+{
+	pthread_mutex_lock(&recycle_lock);
+
+	const uint64_t lookups = stats.hits + stats.misses;
+
+	buf.appendFormat("Recycle pool: capacity %zu KB, pooled %zu KB in %zu buffers\n",
+	                 recycle_capacity / 1024, recycle_pool_size / 1024, recycle_pool.size());
+	buf.appendFormat("    hits %" PRIu64 " misses %" PRIu64 " (hit rate %" PRIu64 "%%) parked %" PRIu64
+	                 " rejected %" PRIu64 " evicted %" PRIu64 " wiped %" PRIu64 " KB\n",
+	                 stats.hits, stats.misses, lookups ? (stats.hits * 100) / lookups : 0,
+	                 stats.parked, stats.rejected, stats.evicted, stats.wiped_bytes / 1024);
+
+	pthread_mutex_unlock(&recycle_lock);
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2019 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MALI_GRALLOC_RECYCLE_H_
+#define MALI_GRALLOC_RECYCLE_H_
+
+#include <stddef.h>
+#include <utils/String8.h>
+
+int mali_gralloc_recycle_get(int ion_client, unsigned int heap_mask, unsigned int flags, size_t size);
+void mali_gralloc_recycle_track(int fd, unsigned int heap_mask, unsigned int flags, size_t size);
+void mali_gralloc_recycle_untrack(int fd);
+bool mali_gralloc_recycle_put(int fd);
+size_t mali_gralloc_recycle_trim(size_t target_size);
+void mali_gralloc_recycle_dump(android::String8 &buf);
+
+#endif /* MALI_GRALLOC_RECYCLE_H_ */
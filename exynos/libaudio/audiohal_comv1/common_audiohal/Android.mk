@@ -22,6 +22,7 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
 	audio_hw.c \
+	audio_volume.c \
 	../odm_specific/voice_manager.c \
 	../odm_specific/factory_manager.c \
 	../odm_specific/audio_odm_impl.c
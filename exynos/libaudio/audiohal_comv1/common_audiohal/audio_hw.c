@@ -189,39 +189,15 @@ static char *bool_to_str(int value)
 static void adjust_out_volume(struct audio_stream_out *stream, const void* buffer, size_t bytes)
 {
     struct stream_out *out = (struct stream_out *)stream;
-    int num_req_channels = audio_channel_count_from_in_mask(out->common.requested_channel_mask);
-    int frames = bytes / (num_req_channels *
-        audio_bytes_per_sample(out->common.requested_format));
-    int i = 0;
-    int leftvolume = 0;
-    int16_t *pcm16_buf = NULL;
-    int32_t *pcm32_buf = NULL;
-
-    if (out->common.requested_format == AUDIO_FORMAT_PCM_16_BIT) {
-        pcm16_buf = (int16_t *)buffer;
-    } else if (out->common.requested_format == AUDIO_FORMAT_PCM_8_24_BIT ||
-        out->common.requested_format == AUDIO_FORMAT_PCM_32_BIT) {
-        pcm32_buf = (int32_t *)buffer;
-    } else {
-        ALOGE("Unknown format %u\n", out->common.requested_format);
+
+    // PCM configuration can be changed while the stream is not working
+    if (volume_ramp_configure(&out->direct_volume, out->common.requested_format,
+                              out->common.requested_channel_mask,
+                              out->common.requested_sample_rate) != 0)
         return;
-    }
 
-    leftvolume = (int)(out->vol_left * DIRECT_PLAYBACK_VOLUME_MAX);
-    while(frames--) {
-        for (i = 0; i < num_req_channels; i++) {
-            if (out->common.requested_format == AUDIO_FORMAT_PCM_16_BIT) {
-                *pcm16_buf = clamp16((int32_t)(*pcm16_buf * leftvolume) >> 12);
-                pcm16_buf++;
-            } else if (out->common.requested_format == AUDIO_FORMAT_PCM_32_BIT){
-                *pcm32_buf = clamp32(((int64_t)*pcm32_buf * leftvolume) >> 12);
-                pcm32_buf++;
-            } else {
-                *pcm32_buf = clamp24_from_q8_23((int32_t)(*pcm32_buf * leftvolume) >> 12);
-                pcm32_buf++;
-            }
-        }
-    }
+    volume_ramp_set_volume(&out->direct_volume, out->vol_left, out->vol_right);
+    volume_ramp_process(&out->direct_volume, (void *)buffer, bytes);
 
     return;
 }
@@ -29,6 +29,7 @@
 #include "audio_devices.h"
 #include "audio_offload.h"
 #include "audio_definition.h"
+#include "audio_volume.h"
 
 /* Voice call - RIL interface */
 #include "voice_manager.h"
@@ -95,6 +96,7 @@ struct stream_out {
     struct stream_offload offload;
     float  vol_left, vol_right;
     bool direct_volume_enabled;
+    struct volume_ramp direct_volume;
 
     /* Force Routing */
     force_route force;
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_hw_volume"
+//#define LOG_NDEBUG 0
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <log/log.h>
+#include <audio_utils/primitives.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "audio_definition.h"
+#include "audio_volume.h"
+
+#define Q8_23_MAX   ((1 << 23) - 1)
+#define Q8_23_MIN   (-(1 << 23))
+
+/******************************************************************************/
+/**                                                                          **/
+/** Local Functions                                                          **/
+/**                                                                          **/
+/******************************************************************************/
+static bool is_left_channel(uint32_t bit)
+{
+    return (bit & (AUDIO_CHANNEL_OUT_FRONT_LEFT | AUDIO_CHANNEL_OUT_BACK_LEFT |
+                   AUDIO_CHANNEL_OUT_FRONT_LEFT_OF_CENTER | AUDIO_CHANNEL_OUT_SIDE_LEFT |
+                   AUDIO_CHANNEL_OUT_TOP_FRONT_LEFT | AUDIO_CHANNEL_OUT_TOP_BACK_LEFT)) != 0;
+}
+
+static bool is_right_channel(uint32_t bit)
+{
+    return (bit & (AUDIO_CHANNEL_OUT_FRONT_RIGHT | AUDIO_CHANNEL_OUT_BACK_RIGHT |
+                   AUDIO_CHANNEL_OUT_FRONT_RIGHT_OF_CENTER | AUDIO_CHANNEL_OUT_SIDE_RIGHT |
+                   AUDIO_CHANNEL_OUT_TOP_FRONT_RIGHT | AUDIO_CHANNEL_OUT_TOP_BACK_RIGHT)) != 0;
+}
+
+static inline int32_t clamp_q8_23(int64_t sample)
+{
+    return (sample > Q8_23_MAX) ? Q8_23_MAX : ((sample < Q8_23_MIN) ? Q8_23_MIN : (int32_t)sample);
+}
+
+static int32_t volume_to_gain(float volume)
+{
+    if (volume < 0.0f)
+        volume = 0.0f;
+    else if (volume > 1.0f)
+        volume = 1.0f;
+
+    return (int32_t)(volume * DIRECT_PLAYBACK_VOLUME_MAX);
+}
+
+static void calc_channel_gains(struct volume_ramp *vr, float left, float right, int32_t *gain)
+{
+    int32_t left_gain = volume_to_gain(left);
+    int32_t right_gain = volume_to_gain(right);
+    unsigned int ch;
+
+    if (audio_channel_mask_get_representation(vr->channel_mask) == AUDIO_CHANNEL_REPRESENTATION_POSITION &&
+        vr->channels > 1) {
+        uint32_t bits = audio_channel_mask_get_bits(vr->channel_mask);
+
+        for (ch = 0; ch < vr->channels; ch++) {
+            uint32_t bit = bits & -bits;  // channels are interleaved in order of bit position
+
+            if (is_left_channel(bit))
+                gain[ch] = left_gain;
+            else if (is_right_channel(bit))
+                gain[ch] = right_gain;
+            else
+                gain[ch] = (left_gain + right_gain) / 2;
+
+            bits &= ~bit;
+        }
+    } else {
+        // mono and index masks : left to the first one, right to the second one
+        for (ch = 0; ch < vr->channels; ch++)
+            gain[ch] = (ch == 1) ? right_gain : left_gain;
+    }
+}
+
+static void update_pattern(struct volume_ramp *vr)
+{
+    unsigned int i;
+
+    vr->unity = true;
+    for (i = 0; i < vr->channels; i++) {
+        if (vr->gain[i] != VOLUME_UNITY_GAIN)
+            vr->unity = false;
+    }
+
+    vr->pattern_length = vr->channels * 8;
+    for (i = 0; i < vr->pattern_length; i++) {
+        vr->pattern16[i] = (int16_t)vr->gain[i % vr->channels];
+        vr->pattern32[i] = vr->gain[i % vr->channels];
+    }
+}
+
+/*
+ * Constant Gain
+ * Samples are handled in units of the pattern, so that gains need not to be
+ * looked up by channel.
+ */
+static void apply_gain_16(struct volume_ramp *vr, int16_t *buf, size_t samples)
+{
+    const int16_t *pattern = vr->pattern16;
+    unsigned int length = vr->pattern_length;
+    unsigned int i;
+
+    for (; samples >= length; samples -= length, buf += length) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (i = 0; i < length; i += 8) {
+            int16x8_t s = vld1q_s16(buf + i);
+            int16x8_t g = vld1q_s16(pattern + i);
+            int32x4_t lo = vmull_s16(vget_low_s16(s), vget_low_s16(g));
+            int32x4_t hi = vmull_s16(vget_high_s16(s), vget_high_s16(g));
+
+            vst1q_s16(buf + i, vcombine_s16(vqshrn_n_s32(lo, 12), vqshrn_n_s32(hi, 12)));
+        }
+#else
+        for (i = 0; i < length; i++)
+            buf[i] = clamp16(((int32_t)buf[i] * pattern[i]) >> 12);
+#endif
+    }
+
+    for (i = 0; i < samples; i++)
+        buf[i] = clamp16(((int32_t)buf[i] * pattern[i]) >> 12);
+}
+
+static void apply_gain_32(struct volume_ramp *vr, int32_t *buf, size_t samples, bool q8_23)
+{
+    const int32_t *pattern = vr->pattern32;
+    unsigned int length = vr->pattern_length;
+    unsigned int i;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const int32x4_t max = vdupq_n_s32(q8_23 ? Q8_23_MAX : INT32_MAX);
+    const int32x4_t min = vdupq_n_s32(q8_23 ? Q8_23_MIN : INT32_MIN);
+#endif
+
+    for (; samples >= length; samples -= length, buf += length) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (i = 0; i < length; i += 4) {
+            int32x4_t s = vld1q_s32(buf + i);
+            int32x4_t g = vld1q_s32(pattern + i);
+            int64x2_t lo = vmull_s32(vget_low_s32(s), vget_low_s32(g));
+            int64x2_t hi = vmull_s32(vget_high_s32(s), vget_high_s32(g));
+            int32x4_t r = vcombine_s32(vqshrn_n_s64(lo, 12), vqshrn_n_s64(hi, 12));
+
+            vst1q_s32(buf + i, vminq_s32(vmaxq_s32(r, min), max));
+        }
+#else
+        if (q8_23) {
+            for (i = 0; i < length; i++)
+                buf[i] = clamp_q8_23(((int64_t)buf[i] * pattern[i]) >> 12);
+        } else {
+            for (i = 0; i < length; i++)
+                buf[i] = clamp32(((int64_t)buf[i] * pattern[i]) >> 12);
+        }
+#endif
+    }
+
+    for (i = 0; i < samples; i++) {
+        int64_t r = ((int64_t)buf[i] * pattern[i]) >> 12;
+
+        buf[i] = q8_23 ? clamp_q8_23(r) : clamp32(r);
+    }
+}
+
+/*
+ * Ramping Gain
+ * It is short, so it is done frame by frame with Q12.20 gains.
+ */
+static void apply_ramp(struct volume_ramp *vr, void *buffer, size_t frames)
+{
+    int16_t *pcm16 = (int16_t *)buffer;
+    int32_t *pcm32 = (int32_t *)buffer;
+    unsigned int ch;
+
+    for (; frames > 0; frames--) {
+        for (ch = 0; ch < vr->channels; ch++) {
+            int32_t gain = (int32_t)(vr->ramp_gain[ch] >> VOLUME_RAMP_SHIFT);
+            int64_t r;
+
+            if (vr->format == AUDIO_FORMAT_PCM_16_BIT) {
+                *pcm16 = clamp16(((int32_t)*pcm16 * gain) >> 12);
+                pcm16++;
+            } else {
+                r = ((int64_t)*pcm32 * gain) >> 12;
+                if (vr->format == AUDIO_FORMAT_PCM_8_24_BIT)
+                    *pcm32 = clamp_q8_23(r);
+                else
+                    *pcm32 = clamp32(r);
+                pcm32++;
+            }
+
+            vr->ramp_gain[ch] += vr->ramp_step[ch];
+        }
+
+        if (--vr->ramp_frames == 0) {
+            memcpy(vr->gain, vr->ramp_target, sizeof(vr->gain));
+            update_pattern(vr);
+            frames--;
+            break;
+        }
+    }
+
+    if (frames > 0 && !vr->unity) {
+        // ramp is over in the middle
+        size_t samples = frames * vr->channels;
+
+        if (vr->format == AUDIO_FORMAT_PCM_16_BIT)
+            apply_gain_16(vr, pcm16, samples);
+        else
+            apply_gain_32(vr, pcm32, samples, vr->format == AUDIO_FORMAT_PCM_8_24_BIT);
+    }
+}
+
+/******************************************************************************/
+/**                                                                          **/
+/** Interfaces                                                               **/
+/**                                                                          **/
+/******************************************************************************/
+int volume_ramp_configure(struct volume_ramp *vr, audio_format_t format,
+                          audio_channel_mask_t channel_mask, unsigned int rate)
+{
+    unsigned int channels = audio_channel_count_from_out_mask(channel_mask);
+    unsigned int ch;
+
+    if (vr->format == format && vr->channel_mask == channel_mask && vr->rate == rate && vr->channels != 0)
+        return 0;
+
+    if ((format != AUDIO_FORMAT_PCM_16_BIT && format != AUDIO_FORMAT_PCM_8_24_BIT &&
+         format != AUDIO_FORMAT_PCM_32_BIT) ||
+        channels == 0 || channels > VOLUME_MAX_CHANNELS) {
+        ALOGE("volume-%s: not supported format(%#x) or channel mask(%#x)", __func__, format, channel_mask);
+        memset(vr, 0, sizeof(struct volume_ramp));
+        return -EINVAL;
+    }
+
+    memset(vr, 0, sizeof(struct volume_ramp));
+    vr->format = format;
+    vr->channel_mask = channel_mask;
+    vr->channels = channels;
+    vr->rate = rate;
+    vr->frame_size = channels * audio_bytes_per_sample(format);
+    vr->ramp_length = ((rate ? rate : 48000) * VOLUME_RAMP_MS) / 1000;
+    if (vr->ramp_length == 0)
+        vr->ramp_length = 1;
+
+    // samples are not touched until a volume is set
+    vr->left = vr->right = -1.0f;
+    for (ch = 0; ch < channels; ch++)
+        vr->gain[ch] = VOLUME_UNITY_GAIN;
+    update_pattern(vr);
+
+    ALOGV("volume-%s: format(%#x) channels(%u) ramp(%u frames)", __func__, format, channels, vr->ramp_length);
+    return 0;
+}
+
+void volume_ramp_set_volume(struct volume_ramp *vr, float left, float right)
+{
+    unsigned int ch;
+
+    if (vr->channels == 0 || (vr->left == left && vr->right == right))
+        return;
+
+    // the first volume is applied at once, there is nothing played with another one yet
+    if (vr->left < 0.0f) {
+        calc_channel_gains(vr, left, right, vr->gain);
+        update_pattern(vr);
+        vr->ramp_frames = 0;
+        vr->left = left;
+        vr->right = right;
+        return;
+    }
+
+    // ramp from the gains now applied, even in the middle of the previous ramp
+    for (ch = 0; ch < vr->channels; ch++) {
+        if (vr->ramp_frames == 0)
+            vr->ramp_gain[ch] = (int64_t)vr->gain[ch] << VOLUME_RAMP_SHIFT;
+    }
+
+    calc_channel_gains(vr, left, right, vr->ramp_target);
+    for (ch = 0; ch < vr->channels; ch++)
+        vr->ramp_step[ch] = (((int64_t)vr->ramp_target[ch] << VOLUME_RAMP_SHIFT) - vr->ramp_gain[ch]) /
+                            (int64_t)vr->ramp_length;
+
+    vr->ramp_frames = vr->ramp_length;
+    vr->left = left;
+    vr->right = right;
+    vr->unity = false;
+}
+
+void volume_ramp_process(struct volume_ramp *vr, void *buffer, size_t bytes)
+{
+    size_t frames;
+
+    if (vr->channels == 0 || buffer == NULL)
+        return;
+
+    frames = bytes / vr->frame_size;
+    if (vr->ramp_frames > 0) {
+        apply_ramp(vr, buffer, frames);
+    } else if (!vr->unity) {
+        if (vr->format == AUDIO_FORMAT_PCM_16_BIT)
+            apply_gain_16(vr, (int16_t *)buffer, frames * vr->channels);
+        else
+            apply_gain_32(vr, (int32_t *)buffer, frames * vr->channels, vr->format == AUDIO_FORMAT_PCM_8_24_BIT);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __EXYNOS_AUDIOHAL_VOLUME_H__
+#define __EXYNOS_AUDIOHAL_VOLUME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <system/audio.h>
+
+/*
+ * Software Volume for Direct Stream
+ *
+ * Gains are Q12 and a volume of 1.0 is DIRECT_PLAYBACK_VOLUME_MAX.
+ * Left gain is applied to the left side channels, right gain to the right side ones
+ * and the average of both to the others. The first volume is applied at once, and
+ * a new volume after it is ramped in linearly during VOLUME_RAMP_MS so that there is no click.
+ */
+#define VOLUME_MAX_CHANNELS     FCC_8
+#define VOLUME_UNITY_GAIN       4096        // 1.0 in Q12
+#define VOLUME_RAMP_MS          20
+#define VOLUME_RAMP_SHIFT       20          // fraction bits of gains under ramping
+
+struct volume_ramp {
+    audio_format_t          format;
+    audio_channel_mask_t    channel_mask;
+    unsigned int            channels;
+    unsigned int            rate;
+    unsigned int            frame_size;
+    unsigned int            ramp_length;    // in frames
+
+    float                   left, right;    // volume under applying
+    int32_t                 gain[VOLUME_MAX_CHANNELS];
+    bool                    unity;          // all gains are VOLUME_UNITY_GAIN
+
+    int64_t                 ramp_gain[VOLUME_MAX_CHANNELS];
+    int64_t                 ramp_step[VOLUME_MAX_CHANNELS];
+    int32_t                 ramp_target[VOLUME_MAX_CHANNELS];
+    unsigned int            ramp_frames;    // remained frames of ramp
+
+    // gains repeated as interleaved samples, its length is a multiple of channels and vector size
+    int16_t                 pattern16[VOLUME_MAX_CHANNELS * 8];
+    int32_t                 pattern32[VOLUME_MAX_CHANNELS * 8];
+    unsigned int            pattern_length;
+};
+
+int  volume_ramp_configure(struct volume_ramp *vr, audio_format_t format,
+                           audio_channel_mask_t channel_mask, unsigned int rate);
+void volume_ramp_set_volume(struct volume_ramp *vr, float left, float right);
+void volume_ramp_process(struct volume_ramp *vr, void *buffer, size_t bytes);
+
+#endif  // __EXYNOS_AUDIOHAL_VOLUME_H__
@@ -0,0 +1,45 @@
+# Copyright (C) 2019 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Direct Stream Volume Benchmark
+#
+ifeq ($(BOARD_USE_AUDIOHAL_COMV1), true)
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := audio_volume_benchmark
+
+LOCAL_SRC_FILES := \
+	audio_volume_benchmark.c \
+	../common_audiohal/audio_volume.c
+
+LOCAL_C_INCLUDES += \
+	$(TOP)/hardware/samsung_slsi/exynos/include/libaudio/audiohal_comv1 \
+	$(TOP)/hardware/samsung_slsi/exynos/libaudio/audiohal_comv1/common_audiohal \
+	$(TOP)/hardware/samsung_slsi/exynos/libaudio/audiohal_comv1/odm_specific \
+	$(call include-path-for, audio-utils)
+
+LOCAL_HEADER_LIBRARIES := libhardware_headers
+LOCAL_SHARED_LIBRARIES := liblog libcutils
+
+LOCAL_CFLAGS += -Wno-unused-parameter -Wno-unused-variable -Wno-unused-function
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_PROPRIETARY_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+endif
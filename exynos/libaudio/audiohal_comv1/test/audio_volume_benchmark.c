@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file            : audio_volume_benchmark.c
+ * @brief           : Direct stream software volume benchmark
+ * @version         : 1.0
+ * @history
+ *   2019.06.12     : Create
+ *
+ * Runs the former sample by sample volume loop of out_write and volume_ramp_process
+ * over the same buffers, checks that both make the same output at a constant volume
+ * and prints the cost per period.
+ *
+ *   audio_volume_benchmark [-r rate] [-p period frames] [-n periods]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <audio_utils/primitives.h>
+
+#include "audio_definition.h"
+#include "audio_volume.h"
+
+struct bench_case {
+    const char *name;
+    audio_format_t format;
+    audio_channel_mask_t channel_mask;
+};
+
+static const struct bench_case bench_cases[] = {
+    { "16bit stereo",  AUDIO_FORMAT_PCM_16_BIT,   AUDIO_CHANNEL_OUT_STEREO },
+    { "8.24 stereo",   AUDIO_FORMAT_PCM_8_24_BIT, AUDIO_CHANNEL_OUT_STEREO },
+    { "32bit stereo",  AUDIO_FORMAT_PCM_32_BIT,   AUDIO_CHANNEL_OUT_STEREO },
+    { "16bit 7.1",     AUDIO_FORMAT_PCM_16_BIT,   AUDIO_CHANNEL_OUT_7POINT1 },
+    { "32bit 5.1",     AUDIO_FORMAT_PCM_32_BIT,   AUDIO_CHANNEL_OUT_5POINT1 },
+    { "32bit 7.1",     AUDIO_FORMAT_PCM_32_BIT,   AUDIO_CHANNEL_OUT_7POINT1 },
+};
+
+static long long bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((long long)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/* former adjust_out_volume() of audio_hw.c */
+static void legacy_volume(audio_format_t format, int channels, float volume, void *buffer, size_t bytes)
+{
+    int frames = bytes / (channels * audio_bytes_per_sample(format));
+    int leftvolume = (int)(volume * DIRECT_PLAYBACK_VOLUME_MAX);
+    int16_t *pcm16_buf = (int16_t *)buffer;
+    int32_t *pcm32_buf = (int32_t *)buffer;
+    int i;
+
+    while (frames--) {
+        for (i = 0; i < channels; i++) {
+            if (format == AUDIO_FORMAT_PCM_16_BIT) {
+                *pcm16_buf = clamp16((int32_t)(*pcm16_buf * leftvolume) >> 12);
+                pcm16_buf++;
+            } else if (format == AUDIO_FORMAT_PCM_32_BIT) {
+                *pcm32_buf = clamp32(((int64_t)*pcm32_buf * leftvolume) >> 12);
+                pcm32_buf++;
+            } else {
+                /* 64bit product, the former 32bit one overflows */
+                *pcm32_buf = clamp24_from_q8_23(clamp32(((int64_t)*pcm32_buf * leftvolume) >> 12));
+                pcm32_buf++;
+            }
+        }
+    }
+}
+
+static void fill_buffer(audio_format_t format, void *buffer, size_t samples)
+{
+    int16_t *pcm16 = (int16_t *)buffer;
+    int32_t *pcm32 = (int32_t *)buffer;
+    size_t i;
+
+    for (i = 0; i < samples; i++) {
+        if (format == AUDIO_FORMAT_PCM_16_BIT)
+            pcm16[i] = (int16_t)rand();
+        else if (format == AUDIO_FORMAT_PCM_8_24_BIT)
+            pcm32[i] = (rand() & 0xFFFFFF) - 0x800000;
+        else
+            pcm32[i] = (int32_t)((uint32_t)rand() << 1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int rate = 192000;
+    unsigned int period = 1920;
+    unsigned int periods = 2000;
+    int failed = 0;
+    int opt;
+    size_t c;
+
+    while ((opt = getopt(argc, argv, "r:p:n:")) != -1) {
+        switch (opt) {
+        case 'r': rate = (unsigned int)atoi(optarg); break;
+        case 'p': period = (unsigned int)atoi(optarg); break;
+        case 'n': periods = (unsigned int)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r rate] [-p period frames] [-n periods]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (rate == 0 || period == 0 || periods == 0) {
+        fprintf(stderr, "usage: %s [-r rate] [-p period frames] [-n periods]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u Hz, %u frames per period, %u periods\n", rate, period, periods);
+
+    for (c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        const struct bench_case *bc = &bench_cases[c];
+        unsigned int channels = audio_channel_count_from_out_mask(bc->channel_mask);
+        size_t bytes = period * channels * audio_bytes_per_sample(bc->format);
+        void *source = malloc(bytes);
+        void *legacy = malloc(bytes);
+        void *engine = malloc(bytes);
+        struct volume_ramp vr;
+        long long start, legacy_ns, engine_ns;
+        unsigned int i;
+
+        if (source == NULL || legacy == NULL || engine == NULL) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+
+        srand(1);
+        fill_buffer(bc->format, source, period * channels);
+
+        memset(&vr, 0, sizeof(vr));
+        volume_ramp_configure(&vr, bc->format, bc->channel_mask, rate);
+        volume_ramp_set_volume(&vr, 0.3f, 0.3f);
+
+        /* run out the ramp, then the outputs have to be the same */
+        while (vr.ramp_frames > 0) {
+            memcpy(engine, source, bytes);
+            volume_ramp_process(&vr, engine, bytes);
+        }
+
+        memcpy(legacy, source, bytes);
+        legacy_volume(bc->format, channels, 0.3f, legacy, bytes);
+        memcpy(engine, source, bytes);
+        volume_ramp_process(&vr, engine, bytes);
+        if (memcmp(legacy, engine, bytes) != 0) {
+            printf("%-14s : output mismatch\n", bc->name);
+            failed = 1;
+        }
+
+        start = bench_now();
+        for (i = 0; i < periods; i++)
+            legacy_volume(bc->format, channels, 0.3f, legacy, bytes);
+        legacy_ns = bench_now() - start;
+
+        start = bench_now();
+        for (i = 0; i < periods; i++)
+            volume_ramp_process(&vr, engine, bytes);
+        engine_ns = bench_now() - start;
+
+        printf("%-14s : legacy %8.2f us, engine %8.2f us per period (x%.1f), %.2f%% of real time\n",
+               bc->name, legacy_ns / 1000.0 / periods, engine_ns / 1000.0 / periods,
+               (double)legacy_ns / (engine_ns ? engine_ns : 1),
+               100.0 * (engine_ns / 1E9) / ((double)period * periods / rate));
+
+        free(source);
+        free(legacy);
+        free(engine);
+    }
+
+    return failed;
+}
@@ -23,6 +23,7 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
 	audio_hw.c \
+	audio_resampler.c \
 	../voicemanager/ww/voice_manager.c
 
 LOCAL_C_INCLUDES += \
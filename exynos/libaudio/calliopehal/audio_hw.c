@@ -36,7 +36,6 @@
 
 #include <audio_utils/primitives.h>
 #include <audio_utils/channels.h>
-#include <audio_utils/resampler.h>
 
 #include "audio_hw.h"
 #include "audio_hw_def.h"
@@ -492,6 +491,9 @@ static void clean_dangling_streams(
 
                 remove_audio_usage(adev, type, (void *)dangling_in);
 
+                if (dangling_in->resampler)
+                    capture_resampler_release(&adev->resampler_pool, dangling_in->resampler);
+
                 pthread_mutex_destroy(&dangling_in->lock);
                 free(dangling_in);
             }
@@ -550,6 +552,10 @@ static bool init_route(struct audio_device *adev)
             }
             trinfo->card_num = (unsigned int)SOUND_CARD0;
             trinfo->aroute = ar;
+
+            /* Controls used at runtime are looked up once, it is a linear search by name */
+            adev->vol_ctrl = mixer_get_ctl_by_name(adev->mixerinfo, OFFLOAD_VOLUME_CONTROL_NAME);
+            adev->mode_ctrl = mixer_get_ctl_by_name(adev->mixerinfo, ABOX_AUDIOMODE_CONTROL_NAME);
         } else {
             ALOGE("device-%s: Cannot open Mixer for %d!", __func__, SOUND_CARD0);
             free(trinfo);
@@ -574,6 +580,7 @@ static void deinit_route(struct audio_device *adev)
 
     if (trinfo && ar) {
         adev->vol_ctrl = NULL;
+        adev->mode_ctrl = NULL;
 
         audio_route_free(ar);
         if (adev->mixerinfo) {
@@ -1155,7 +1162,7 @@ static int do_set_volume(struct stream_out *out, float left, float right)
     int ret = -ENAVAIL;
     int val[2];
 
-    ctrl = mixer_get_ctl_by_name(adev->mixerinfo, OFFLOAD_VOLUME_CONTROL_NAME);
+    ctrl = adev->vol_ctrl;
     if (ctrl) {
         val[0] = (int)(left * COMPRESS_PLAYBACK_VOLUME_MAX);
         val[1] = (int)(right * COMPRESS_PLAYBACK_VOLUME_MAX);
@@ -1809,6 +1816,7 @@ static int do_read_buffer(struct stream_in *in, void* buffer, size_t bytes)
                 int data_mono;
                 short *vc_buf = (short *)in->resample_buf;
                 size_t i = 0;
+                /* Rx/Tx are mixed to mono and packed, so only one channel is resampled */
                 for (i; i < in->pcmconfig.period_size; i++){
                     if (in->source == AUDIO_SOURCE_VOICE_UPLINK) {
                         data_mono = (int16_t)((int32_t)*(vc_buf+2*i+1)); //Tx
@@ -1818,17 +1826,21 @@ static int do_read_buffer(struct stream_in *in, void* buffer, size_t bytes)
                         data_mono = (int16_t)(((int32_t)*(vc_buf+2*i) + (int32_t)*(vc_buf+2*i+1)) >> 1); //mix Rx/Tx
                     }
 
-                    *(vc_buf + 2 * i) = (int16_t)data_mono;
-                    *(vc_buf + 2 * i + 1) = (int16_t)data_mono;
+                    *(vc_buf + i) = (int16_t)data_mono;
                 }
 
                 if (in->resampler) {
-                    size_t inframe_cnt = pcm_bytes_to_frames(in->pcminfo, src_bytes); //bytes/bytes_per_sample;
+                    size_t inframe_cnt = in->pcmconfig.period_size;
                     size_t outframe_cnt = bytes /audio_stream_in_frame_size(&in->stream);
-                    in->resampler->resample_from_input(in->resampler, in->resample_buf,
-                                                                    &inframe_cnt, (int16_t *)buffer, &outframe_cnt);
+                    size_t done = capture_resampler_process(in->resampler, in->resample_buf,
+                                                            inframe_cnt, (int16_t *)buffer, outframe_cnt);
+                    if (done < outframe_cnt)
+                        memset((int16_t *)buffer + done, 0, (outframe_cnt - done) * sizeof(int16_t));
+
+                    if (audio_channel_count_from_in_mask(in->channel_mask) == 2)
+                        adjust_channels(buffer, 1, buffer, 2, sizeof(int16_t), outframe_cnt * sizeof(int16_t)); // Mono to Stereo
                     ALOGVV("%s-%s: Resample Done (%u bytes) inframe count %zu outframe count %zu", usage_table[in->ausage],
-                                            __func__, (unsigned int)bytes, inframe_cnt, outframe_cnt);
+                                            __func__, (unsigned int)bytes, inframe_cnt, done);
                     read = bytes;
                 } else
                     ALOGE("%s-%s: Resampler not created", usage_table[in->ausage], __func__);
@@ -2772,29 +2784,8 @@ static ssize_t in_read(
     /* Check Device is opened */
     if (in->sstate == STATE_STANDBY) {
         pthread_mutex_lock(&adev->lock);
-        if (in->ausage == AUSAGE_CAPTURE_VOICE_CALL) {
-            if (in->resampler) {
-                ALOGW("%s-%s: resampler should be re-created", usage_table[in->ausage], __func__);
-                release_resampler(in->resampler);
-                in->resampler = NULL;
-            }
-             if (in->sample_rate != in->pcmconfig.rate) {
-                ret = create_resampler(in->pcmconfig.rate,
-                                                 in->sample_rate,
-                                                 2,
-                                                 RESAMPLER_QUALITY_DEFAULT,
-                                                 NULL,
-                                                 &in->resampler);
-                if (ret !=0) {
-                    ALOGE("%s-%s: Failed to create resampler", usage_table[in->ausage], __func__);
-                } else {
-                    ALOGD("%s-%s: resampler created in-samplerate %d out-samplereate %d", usage_table[in->ausage],  __func__,
-                                in->pcmconfig.rate, in->sample_rate);
-                    in->resampler->reset(in->resampler);
-                }
-            }
-        }
-
+        /* Resampler of VoiceCall capture is kept with its filter state, there is
+           nothing to re-create when the stream comes back from standby */
         ret = do_open_input_stream(in);
         if (ret != 0) {
             ALOGE("%s-%s: Fail to open Input Stream!", usage_table[in->ausage], __func__);
@@ -3402,7 +3393,7 @@ static int adev_set_mode(struct audio_hw_device *dev, audio_mode_t mode)
     if (adev->amode != mode) {
         /* Set Audio Mode to Kernel */
         val = (int)mode;
-        ctrl = mixer_get_ctl_by_name(adev->mixerinfo, ABOX_AUDIOMODE_CONTROL_NAME);
+        ctrl = adev->mode_ctrl;
         if (ctrl) {
             ret = mixer_ctl_set_value(ctrl, 0,val);
             if (ret != 0)
@@ -3593,6 +3584,18 @@ static int adev_open_input_stream(
             if (!in->resample_buf) {
                 ret = -ENOMEM;
             }
+
+            /* Rx/Tx are mixed to mono before resampling */
+            in->resampler = capture_resampler_acquire(&adev->resampler_pool);
+            if (in->resampler) {
+                if (capture_resampler_configure(in->resampler, in->pcmconfig.rate, in->sample_rate, 1) == 0) {
+                    capture_resampler_reset(in->resampler);
+                } else {
+                    ALOGE("device-%s: Failed to configure resampler", __func__);
+                    capture_resampler_release(&adev->resampler_pool, in->resampler);
+                    in->resampler = NULL;
+                }
+            }
         } else {
             /* Case: Capture For Primary Recording */
             ALOGD("device-%s: Requested open Primary input", __func__);
@@ -3665,7 +3668,7 @@ static void adev_close_input_stream(
         if (in->ausage == AUSAGE_CAPTURE_VOICE_CALL) {
             if (in->resampler) {
                 ALOGD("device-%s: Audio Usage(%s) release resampler", __func__, usage_table[id]);
-                release_resampler(in->resampler);
+                capture_resampler_release(&adev->resampler_pool, in->resampler);
                 in->resampler = NULL;
             }
 
@@ -3779,6 +3782,7 @@ static int adev_close(hw_device_t *device)
         }
 
         pthread_mutex_unlock(&adev->lock);
+        capture_resampler_pool_deinit(&adev->resampler_pool);
         pthread_mutex_destroy(&adev->inpcm_lock);
         pthread_mutex_destroy(&adev->lock);
 
@@ -3859,6 +3863,7 @@ static int adev_open(
     /* Set Platform-specific information */
     pthread_mutex_init(&adev->lock, (const pthread_mutexattr_t *) NULL);
     pthread_mutex_init(&adev->inpcm_lock, (const pthread_mutexattr_t *) NULL);
+    capture_resampler_pool_init(&adev->resampler_pool);
 
     pthread_mutex_lock(&adev->lock);
 
@@ -3887,6 +3892,7 @@ static int adev_open(
             voice_deinit(adev->voice);
         adev->voice = NULL;
         pthread_mutex_unlock(&adev->lock);
+        capture_resampler_pool_deinit(&adev->resampler_pool);
         pthread_mutex_destroy(&adev->lock);
         free(adev);
         *device = NULL;
@@ -20,7 +20,6 @@
 #include <cutils/list.h>
 
 #include <audio_route/audio_route.h>
-#include <audio_utils/resampler.h>
 
 /* Definition of AudioHAL */
 #include <hardware/hardware.h>
@@ -40,6 +39,9 @@
 /* Voice call - RIL interface */
 #include "../voicemanager/ww/voice_manager.h"
 
+/* Capture resampler */
+#include "audio_resampler.h"
+
 
 
 /* Mixer Path configuration file for working AudioHAL */
@@ -329,7 +331,7 @@ struct stream_in {
         CP downlink data : L-channel contains CP Rx data
         CP Uplink data: R-channel CP Tx data */
     int16_t *resample_buf;
-    struct resampler_itfe *resampler;
+    struct capture_resampler *resampler;  // from resampler_pool of audio_device
 
     unsigned long err_count;
     struct audio_device *adev;
@@ -385,6 +387,9 @@ struct audio_device {
     struct route_info *rinfo;
     struct mixer *mixerinfo;             // For Volume control & Mute
     struct mixer_ctl * vol_ctrl;
+    struct mixer_ctl * mode_ctrl;
+
+    struct capture_resampler_pool resampler_pool;
 
     struct listnode audio_usage_list;
 
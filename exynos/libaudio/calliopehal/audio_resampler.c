@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_hw_resampler"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <log/log.h>
+#include <audio_utils/primitives.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "audio_resampler.h"
+
+#define KAISER_BETA         7.0     // about 70dB of stop band attenuation
+#define CUTOFF_RATIO        0.92    // pass band edge against the lower Nyquist frequency
+
+/****************************************************************************/
+/**                                                                        **/
+/** Filter Design                                                          **/
+/**                                                                        **/
+/****************************************************************************/
+static unsigned int get_gcd(unsigned int a, unsigned int b)
+{
+    while (b != 0) {
+        unsigned int r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+// Zeroth order modified Bessel function of the first kind
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
+
+/*
+ * Tap k of phase p weights input frame (pos + k) for the output at
+ * (pos + taps / 2 - 1 + p / phases), so each phase is the same windowed sinc
+ * delayed by a fraction of an input frame. Every phase is normalized to unity DC gain.
+ */
+static void make_coefs(struct capture_resampler *rs, double cutoff)
+{
+    const double center = (double)rs->taps / 2.0 - 1.0;
+    const double half = (double)rs->taps / 2.0;
+    const double i0_beta = bessel_i0(KAISER_BETA);
+    double proto[RESAMPLER_MAX_TAPS];
+    unsigned int p, k;
+
+    for (p = 0; p < rs->phases; p++) {
+        int16_t *coef = rs->coefs + p * rs->taps;
+        double sum = 0.0;
+        int32_t qsum = 0;
+        unsigned int peak = 0;
+
+        for (k = 0; k < rs->taps; k++) {
+            double d = (double)k - center - (double)p / rs->phases;
+            double r = d / half;
+            double w = (r * r < 1.0) ? bessel_i0(KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta : 0.0;
+            double x = M_PI * cutoff * d;
+
+            proto[k] = w * ((fabs(x) < 1e-9) ? 1.0 : sin(x) / x);
+            sum += proto[k];
+        }
+
+        for (k = 0; k < rs->taps; k++) {
+            coef[k] = (int16_t)lrint(proto[k] / sum * (1 << RESAMPLER_COEF_SHIFT));
+            qsum += coef[k];
+            if (coef[k] > coef[peak])
+                peak = k;
+        }
+
+        // Rounding error goes to the biggest tap, so that DC passes as it is
+        coef[peak] += (int16_t)((1 << RESAMPLER_COEF_SHIFT) - qsum);
+    }
+
+    for (p = 0; p < rs->phases; p++) {
+        rs->advance[p] = (uint16_t)((p + rs->step) / rs->phases);
+        rs->next_phase[p] = (uint16_t)((p + rs->step) % rs->phases);
+    }
+}
+
+static void free_filter(struct capture_resampler *rs)
+{
+    free(rs->coefs);
+    free(rs->next_phase);
+    free(rs->advance);
+    free(rs->frames);
+
+    rs->coefs = NULL;
+    rs->next_phase = NULL;
+    rs->advance = NULL;
+    rs->frames = NULL;
+    rs->frame_capacity = 0;
+    rs->frame_count = 0;
+    rs->in_rate = 0;
+    rs->out_rate = 0;
+    rs->channels = 0;
+}
+
+/****************************************************************************/
+/**                                                                        **/
+/** FIR Kernels                                                            **/
+/**                                                                        **/
+/****************************************************************************/
+static inline int16_t round_output(int32_t acc)
+{
+    return clamp16((acc + (1 << (RESAMPLER_COEF_SHIFT - 1))) >> RESAMPLER_COEF_SHIFT);
+}
+
+static inline int16_t fir_mono(const int16_t *in, const int16_t *coef, unsigned int taps)
+{
+    unsigned int k;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t acc = vdupq_n_s32(0);
+    int32x2_t sum;
+
+    for (k = 0; k < taps; k += 8) {
+        int16x8_t x = vld1q_s16(in + k);
+        int16x8_t h = vld1q_s16(coef + k);
+
+        acc = vmlal_s16(acc, vget_low_s16(x), vget_low_s16(h));
+        acc = vmlal_s16(acc, vget_high_s16(x), vget_high_s16(h));
+    }
+
+    sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    sum = vpadd_s32(sum, sum);
+
+    return round_output(vget_lane_s32(sum, 0));
+#else
+    int32_t acc = 0;
+
+    for (k = 0; k < taps; k++)
+        acc += in[k] * coef[k];
+
+    return round_output(acc);
+#endif
+}
+
+static inline void fir_stereo(const int16_t *in, const int16_t *coef, unsigned int taps, int16_t *out)
+{
+    unsigned int k;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t acc_l = vdupq_n_s32(0);
+    int32x4_t acc_r = vdupq_n_s32(0);
+    int32x2_t sum_l, sum_r;
+
+    for (k = 0; k < taps; k += 8) {
+        int16x8x2_t x = vld2q_s16(in + 2 * k);
+        int16x8_t h = vld1q_s16(coef + k);
+
+        acc_l = vmlal_s16(acc_l, vget_low_s16(x.val[0]), vget_low_s16(h));
+        acc_l = vmlal_s16(acc_l, vget_high_s16(x.val[0]), vget_high_s16(h));
+        acc_r = vmlal_s16(acc_r, vget_low_s16(x.val[1]), vget_low_s16(h));
+        acc_r = vmlal_s16(acc_r, vget_high_s16(x.val[1]), vget_high_s16(h));
+    }
+
+    sum_l = vadd_s32(vget_low_s32(acc_l), vget_high_s32(acc_l));
+    sum_r = vadd_s32(vget_low_s32(acc_r), vget_high_s32(acc_r));
+    sum_l = vpadd_s32(sum_l, sum_r);
+
+    out[0] = round_output(vget_lane_s32(sum_l, 0));
+    out[1] = round_output(vget_lane_s32(sum_l, 1));
+#else
+    int32_t acc_l = 0, acc_r = 0;
+
+    for (k = 0; k < taps; k++) {
+        acc_l += in[2 * k] * coef[k];
+        acc_r += in[2 * k + 1] * coef[k];
+    }
+
+    out[0] = round_output(acc_l);
+    out[1] = round_output(acc_r);
+#endif
+}
+
+/* Fast path for integer decimation like 48kHz to 16kHz, there is only one phase */
+static size_t run_decimation(struct capture_resampler *rs, int16_t *out, size_t out_frames, size_t *used)
+{
+    const int16_t *frames = rs->frames;
+    size_t pos = 0, n = 0;
+
+    if (rs->channels == 1) {
+        for (; n < out_frames && pos + rs->taps <= rs->frame_count; n++, pos += rs->step)
+            out[n] = fir_mono(frames + pos, rs->coefs, rs->taps);
+    } else {
+        for (; n < out_frames && pos + rs->taps <= rs->frame_count; n++, pos += rs->step)
+            fir_stereo(frames + 2 * pos, rs->coefs, rs->taps, out + 2 * n);
+    }
+
+    *used = pos;
+    return n;
+}
+
+/* Any other ratio like 48kHz to 44.1kHz, phase and input step come from the tables */
+static size_t run_polyphase(struct capture_resampler *rs, int16_t *out, size_t out_frames, size_t *used)
+{
+    const int16_t *frames = rs->frames;
+    unsigned int phase = rs->phase;
+    size_t pos = 0, n = 0;
+
+    for (; n < out_frames && pos + rs->taps <= rs->frame_count; n++) {
+        const int16_t *coef = rs->coefs + phase * rs->taps;
+
+        if (rs->channels == 1)
+            out[n] = fir_mono(frames + pos, coef, rs->taps);
+        else
+            fir_stereo(frames + 2 * pos, coef, rs->taps, out + 2 * n);
+
+        pos += rs->advance[phase];
+        phase = rs->next_phase[phase];
+    }
+
+    rs->phase = phase;
+    *used = pos;
+    return n;
+}
+
+/****************************************************************************/
+/**                                                                        **/
+/** Interfaces                                                             **/
+/**                                                                        **/
+/****************************************************************************/
+void capture_resampler_pool_init(struct capture_resampler_pool *pool)
+{
+    pthread_mutex_init(&pool->lock, (const pthread_mutexattr_t *) NULL);
+    memset(pool->resampler, 0, sizeof(pool->resampler));
+
+    return ;
+}
+
+void capture_resampler_pool_deinit(struct capture_resampler_pool *pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < RESAMPLER_POOL_SIZE; i++) {
+        if (pool->resampler[i].in_use)
+            ALOGW("%s: resampler(%d) is not released yet", __func__, i);
+        free_filter(&pool->resampler[i]);
+        pool->resampler[i].in_use = false;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_destroy(&pool->lock);
+
+    return ;
+}
+
+struct capture_resampler *capture_resampler_acquire(struct capture_resampler_pool *pool)
+{
+    struct capture_resampler *rs = NULL;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < RESAMPLER_POOL_SIZE; i++) {
+        if (!pool->resampler[i].in_use) {
+            rs = &pool->resampler[i];
+            rs->in_use = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!rs) {
+        rs = (struct capture_resampler *)calloc(1, sizeof(struct capture_resampler));
+        if (rs) {
+            rs->in_use = true;
+            rs->allocated = true;
+            ALOGI("%s: all resamplers are in use, allocated one", __func__);
+        } else {
+            ALOGE("%s: failed to allocate resampler", __func__);
+        }
+    }
+
+    return rs;
+}
+
+/* Filter and buffers stay with the slot, the next stream with the same rates reuses them */
+void capture_resampler_release(struct capture_resampler_pool *pool, struct capture_resampler *rs)
+{
+    if (rs->allocated) {
+        free_filter(rs);
+        free(rs);
+        return ;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    rs->in_use = false;
+    pthread_mutex_unlock(&pool->lock);
+
+    return ;
+}
+
+int capture_resampler_configure(
+        struct capture_resampler *rs,
+        unsigned int in_rate,
+        unsigned int out_rate,
+        unsigned int channels)
+{
+    unsigned int gcd, taps;
+    double cutoff;
+
+    if (in_rate == 0 || out_rate == 0 || channels == 0 || channels > RESAMPLER_MAX_CHANNELS) {
+        ALOGE("%s: unsupported %u Hz to %u Hz, %u channels", __func__, in_rate, out_rate, channels);
+        return -EINVAL;
+    }
+
+    /* Same configuration, filter state is kept */
+    if (rs->in_rate == in_rate && rs->out_rate == out_rate && rs->channels == channels)
+        return 0;
+
+    free_filter(rs);
+
+    gcd = get_gcd(in_rate, out_rate);
+    rs->phases = out_rate / gcd;
+    rs->step = in_rate / gcd;
+    rs->channels = channels;
+
+    if (rs->phases == rs->step) {
+        /* Same rate, nothing to filter */
+        rs->taps = 0;
+    } else {
+        cutoff = (rs->phases < rs->step) ? (double)rs->phases / rs->step : 1.0;
+        cutoff *= CUTOFF_RATIO;
+
+        taps = (unsigned int)ceil(2.0 * RESAMPLER_ZERO_CROSSINGS / cutoff);
+        taps = (taps + 7) & ~7U;
+        if (taps > RESAMPLER_MAX_TAPS)
+            taps = RESAMPLER_MAX_TAPS;
+        if (taps * rs->phases > RESAMPLER_MAX_COEFS)
+            taps = (RESAMPLER_MAX_COEFS / rs->phases) & ~7U;
+        if (taps < 8 || (rs->step / rs->phases) >= UINT16_MAX) {
+            ALOGE("%s: too many phases for %u Hz to %u Hz", __func__, in_rate, out_rate);
+            return -EINVAL;
+        }
+        rs->taps = taps;
+
+        rs->coefs = (int16_t *)malloc(sizeof(int16_t) * rs->phases * rs->taps);
+        rs->next_phase = (uint16_t *)malloc(sizeof(uint16_t) * rs->phases);
+        rs->advance = (uint16_t *)malloc(sizeof(uint16_t) * rs->phases);
+        if (!rs->coefs || !rs->next_phase || !rs->advance) {
+            ALOGE("%s: failed to allocate filter", __func__);
+            free_filter(rs);
+            return -ENOMEM;
+        }
+
+        make_coefs(rs, cutoff);
+    }
+
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+
+    capture_resampler_reset(rs);
+
+    ALOGD("%s: %u Hz to %u Hz, %u channels, %u phases x %u taps", __func__,
+          in_rate, out_rate, channels, rs->phases, rs->taps);
+    return 0;
+}
+
+void capture_resampler_reset(struct capture_resampler *rs)
+{
+    /* History starts with silence, so that outputs come from the first input */
+    rs->phase = 0;
+    rs->frame_count = (rs->taps > 0) ? rs->taps - 1 : 0;
+    if (rs->frames)
+        memset(rs->frames, 0, rs->frame_count * rs->channels * sizeof(int16_t));
+    else
+        rs->frame_count = 0;
+
+    return ;
+}
+
+size_t capture_resampler_process(
+        struct capture_resampler *rs,
+        const int16_t *in,
+        size_t in_frames,
+        int16_t *out,
+        size_t out_frames)
+{
+    const size_t frame_size = rs->channels * sizeof(int16_t);
+    size_t done = 0, used = 0;
+
+    if (rs->taps == 0) {
+        done = (in_frames < out_frames) ? in_frames : out_frames;
+        memcpy(out, in, done * frame_size);
+        return done;
+    }
+
+    /* Buffer grows only at the first read or when the input becomes bigger */
+    if (rs->frames == NULL || rs->frame_count + in_frames > rs->frame_capacity) {
+        size_t capacity = rs->taps + 2 * in_frames;
+        int16_t *frames = (int16_t *)realloc(rs->frames, capacity * frame_size);
+
+        if (!frames) {
+            ALOGE("%s: failed to allocate %zu frames", __func__, capacity);
+            return 0;
+        }
+
+        if (rs->frames == NULL) {
+            rs->frame_count = rs->taps - 1;
+            memset(frames, 0, rs->frame_count * frame_size);
+        }
+
+        rs->frames = frames;
+        rs->frame_capacity = capacity;
+    }
+
+    memcpy(rs->frames + rs->frame_count * rs->channels, in, in_frames * frame_size);
+    rs->frame_count += in_frames;
+
+    if (rs->phases == 1)
+        done = run_decimation(rs, out, out_frames, &used);
+    else
+        done = run_polyphase(rs, out, out_frames, &used);
+
+    if (used > rs->frame_count)
+        used = rs->frame_count;
+
+    /* Keep the backlog of unread input under one read, otherwise latency goes up */
+    if (rs->frame_count - used > rs->taps - 1 + in_frames) {
+        ALOGV("%s: dropped %zu frames", __func__, rs->frame_count - used - (rs->taps - 1 + in_frames));
+        used = rs->frame_count - (rs->taps - 1 + in_frames);
+    }
+
+    rs->frame_count -= used;
+    memmove(rs->frames, rs->frames + used * rs->channels, rs->frame_count * frame_size);
+
+    return done;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __EXYNOS_AUDIOHAL_RESAMPLER_H__
+#define __EXYNOS_AUDIOHAL_RESAMPLER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/**
+ ** Polyphase Resampler for Capture
+ **
+ ** Ratio out_rate/in_rate is reduced to phases/step. Integer decimation such as
+ ** 48kHz to 16kHz has only one phase and runs as a plain decimating FIR, other ratios
+ ** such as 48kHz to 44.1kHz walk a phase table which is made once at configuration.
+ ** Coefficients are Q14 so that a 16bit by 16bit product sum never overflows 32bit.
+ **
+ ** Resamplers are taken from the pool of the audio device, and they keep their filter
+ ** state while a stream goes to standby and is opened again for other device.
+ ** When all of them are in use, one is allocated for the stream and freed on release.
+ **/
+#define RESAMPLER_POOL_SIZE         2
+#define RESAMPLER_MAX_CHANNELS      2
+#define RESAMPLER_ZERO_CROSSINGS    12      // taps on each side of the center at unity ratio
+#define RESAMPLER_MAX_TAPS          128     // taps per phase
+#define RESAMPLER_MAX_COEFS         16384   // taps x phases
+#define RESAMPLER_COEF_SHIFT        14
+
+struct capture_resampler {
+    bool                in_use;
+    bool                allocated;  // not in the pool, freed on release
+
+    unsigned int        in_rate;
+    unsigned int        out_rate;
+    unsigned int        channels;
+
+    unsigned int        phases;     // interpolation factor
+    unsigned int        step;       // decimation factor
+    unsigned int        taps;       // taps per phase, multiple of 8
+    int16_t            *coefs;      // [phases][taps]
+    uint16_t           *next_phase; // [phases]
+    uint16_t           *advance;    // [phases], input frames to move after each output
+
+    unsigned int        phase;      // phase of the next output
+    int16_t            *frames;     // history followed by input not used yet
+    size_t              frame_count;
+    size_t              frame_capacity;
+};
+
+struct capture_resampler_pool {
+    pthread_mutex_t             lock;
+    struct capture_resampler    resampler[RESAMPLER_POOL_SIZE];
+};
+
+void capture_resampler_pool_init(struct capture_resampler_pool *pool);
+void capture_resampler_pool_deinit(struct capture_resampler_pool *pool);
+
+struct capture_resampler *capture_resampler_acquire(struct capture_resampler_pool *pool);
+void capture_resampler_release(struct capture_resampler_pool *pool, struct capture_resampler *rs);
+
+int  capture_resampler_configure(struct capture_resampler *rs, unsigned int in_rate,
+                                 unsigned int out_rate, unsigned int channels);
+void capture_resampler_reset(struct capture_resampler *rs);
+size_t capture_resampler_process(struct capture_resampler *rs, const int16_t *in, size_t in_frames,
+                                 int16_t *out, size_t out_frames);
+
+#endif  // __EXYNOS_AUDIOHAL_RESAMPLER_H__
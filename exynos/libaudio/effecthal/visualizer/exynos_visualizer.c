@@ -25,6 +25,10 @@
 #include <sys/prctl.h>
 #include <pthread.h>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "exynos_visualizer.h"
 
 
@@ -220,7 +224,8 @@ void *capture_thread_loop(void *arg __unused)
 {
     int16_t data[AUDIO_CAPTURE_PERIOD_SIZE * AUDIO_CAPTURE_CHANNEL_COUNT * sizeof(int16_t)];
     audio_buffer_t buf;
-    buf.frameCount = AUDIO_CAPTURE_PERIOD_SIZE;
+    /* pcm_read() below fills whole data, so every frame of it has to be processed */
+    buf.frameCount = sizeof(data) / (AUDIO_CAPTURE_CHANNEL_COUNT * sizeof(int16_t));
     buf.s16 = data;
     bool capture_enabled = false;
     int ret;
@@ -273,9 +278,10 @@ void *capture_thread_loop(void *arg __unused)
                 output_context_t *out_ctxt = node_to_item(out_node, output_context_t, outputs_list_node);
                 struct listnode *fx_node;
 
+                /* Inactive effects are skipped, there is nobody to read their captures */
                 list_for_each(fx_node, &out_ctxt->effects_list) {
                     effect_context_t *fx_ctxt = node_to_item(fx_node, effect_context_t, output_node);
-                    if (fx_ctxt->ops.process != NULL)
+                    if (fx_ctxt->state == EFFECT_STATE_ACTIVE && fx_ctxt->ops.process != NULL)
                         fx_ctxt->ops.process(fx_ctxt, &buf, &buf);
                 }
             }
@@ -445,16 +451,45 @@ void get_config(effect_context_t *context, effect_config_t *config)
     *config = context->config;
 }
 
+/* Capture thread side: makes capture_idx and the current time visible to the readers */
+static void visualizer_publish_capture(visualizer_context_t *visu_ctxt, bool update_time)
+{
+    uint32_t seq = atomic_load_explicit(&visu_ctxt->snapshot_seq, memory_order_relaxed) + 1;
+    capture_snapshot_t *snapshot = &visu_ctxt->snapshot[seq & 1];
+
+    snapshot->capture_idx = visu_ctxt->capture_idx;
+    if (!update_time || clock_gettime(CLOCK_MONOTONIC, &snapshot->update_time) < 0) {
+        snapshot->update_time.tv_sec = 0;
+        snapshot->update_time.tv_nsec = 0;
+    }
+
+    /* the captured samples and the snapshot are written before it is flipped */
+    atomic_store_explicit(&visu_ctxt->snapshot_seq, seq, memory_order_release);
+}
+
+/* Reader side: copies the latest snapshot, it retries only when the capture thread has
+   published a new one during the copy */
+static void visualizer_get_snapshot(visualizer_context_t *visu_ctxt, capture_snapshot_t *snapshot)
+{
+    uint32_t seq;
+
+    do {
+        seq = atomic_load_explicit(&visu_ctxt->snapshot_seq, memory_order_acquire);
+        *snapshot = visu_ctxt->snapshot[seq & 1];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&visu_ctxt->snapshot_seq, memory_order_relaxed) != seq);
+}
+
 uint32_t visualizer_get_delta_time_ms_from_updated_time(
-        visualizer_context_t* visu_ctxt)
+        const capture_snapshot_t *snapshot)
 {
     uint32_t delta_ms = 0;
-    if (visu_ctxt->buffer_update_time.tv_sec != 0) {
+    if (snapshot->update_time.tv_sec != 0) {
         struct timespec ts;
 
         if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
-            time_t secs = ts.tv_sec - visu_ctxt->buffer_update_time.tv_sec;
-            long nsec = ts.tv_nsec - visu_ctxt->buffer_update_time.tv_nsec;
+            time_t secs = ts.tv_sec - snapshot->update_time.tv_sec;
+            long nsec = ts.tv_nsec - snapshot->update_time.tv_nsec;
             if (nsec < 0) {
                 --secs;
                 nsec += 1000000000;
@@ -471,16 +506,18 @@ int visualizer_reset(effect_context_t *context)
 
     visu_ctxt->capture_idx = 0;
     visu_ctxt->last_capture_idx = 0;
-    visu_ctxt->buffer_update_time.tv_sec = 0;
+    visu_ctxt->capture_stalled = false;
     visu_ctxt->latency = DSP_OUTPUT_LATENCY_MS;
     memset(visu_ctxt->capture_buf, 0x80, CAPTURE_BUF_SIZE);
+    visualizer_publish_capture(visu_ctxt, false);
 
     return 0;
 }
 
-int visualizer_enable(effect_context_t *context __unused)
+int visualizer_enable(effect_context_t *context)
 {
-    return 0;
+    /* Capture thread does not process inactive effect, so the captures are old ones */
+    return visualizer_reset(context);
 }
 
 int visualizer_disable(effect_context_t *context __unused)
@@ -502,6 +539,94 @@ int visualizer_stop(
     return 0;
 }
 
+typedef struct visualizer_stats_s {
+    uint16_t peak;          /* the biggest absolute value, saturated to 32767 */
+    uint16_t magnitude;     /* the biggest of x for positive and -x - 1 for negative samples */
+    uint64_t sum_squares;
+} visualizer_stats_t;
+
+/* Measures peak, normalization magnitude and sum of squares in one pass */
+static void visualizer_get_stats(const int16_t *samples, uint32_t count, visualizer_stats_t *stats)
+{
+    int32_t peak = 0;
+    int32_t magnitude = 0;
+    uint64_t sum_squares = 0;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int16x8_t vpeak = vdupq_n_s16(0);
+    int16x8_t vmagnitude = vdupq_n_s16(0);
+    uint64x2_t vsum = vdupq_n_u64(0);
+
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(samples + i);
+
+        vpeak = vmaxq_s16(vpeak, vqabsq_s16(v));
+        vmagnitude = vmaxq_s16(vmagnitude, veorq_s16(v, vshrq_n_s16(v, 15)));
+
+        /* a square is 2^30 at most, so a sum of two still fits to unsigned 32bit */
+        uint32x4_t square = vaddq_u32(
+                vreinterpretq_u32_s32(vmull_s16(vget_low_s16(v), vget_low_s16(v))),
+                vreinterpretq_u32_s32(vmull_s16(vget_high_s16(v), vget_high_s16(v))));
+        vsum = vpadalq_u32(vsum, square);
+    }
+
+    int16x4_t p = vpmax_s16(vget_low_s16(vpeak), vget_high_s16(vpeak));
+    int16x4_t m = vpmax_s16(vget_low_s16(vmagnitude), vget_high_s16(vmagnitude));
+    p = vpmax_s16(p, p);
+    m = vpmax_s16(m, m);
+    p = vpmax_s16(p, p);
+    m = vpmax_s16(m, m);
+    peak = vget_lane_s16(p, 0);
+    magnitude = vget_lane_s16(m, 0);
+    sum_squares = vgetq_lane_u64(vsum, 0) + vgetq_lane_u64(vsum, 1);
+#endif
+
+    for (; i < count; i++) {
+        int32_t smp = samples[i];
+        int32_t abs_smp = (smp < 0) ? -smp : smp;
+        int32_t mag_smp = smp ^ (smp >> 31);    /* -smp - 1 keeps the max negative in range */
+
+        if (abs_smp > INT16_MAX)
+            abs_smp = INT16_MAX;
+        if (abs_smp > peak)
+            peak = abs_smp;
+        if (mag_smp > magnitude)
+            magnitude = mag_smp;
+        sum_squares += (uint32_t)(smp * smp);
+    }
+
+    stats->peak = (uint16_t)peak;
+    stats->magnitude = (uint16_t)magnitude;
+    stats->sum_squares = sum_squares;
+}
+
+/* Mixes stereo frames down to the 8bit unsigned samples of the capture buffer */
+static void visualizer_downmix(const int16_t *samples, uint32_t frames, int32_t shift, uint8_t *dst)
+{
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const int32x4_t vshift = vdupq_n_s32(-shift);
+    const uint8x8_t vbias = vdup_n_u8(0x80);
+
+    for (; i + 8 <= frames; i += 8) {
+        int16x8x2_t v = vld2q_s16(samples + 2 * i);
+        int32x4_t lo = vshlq_s32(vaddl_s16(vget_low_s16(v.val[0]), vget_low_s16(v.val[1])), vshift);
+        int32x4_t hi = vshlq_s32(vaddl_s16(vget_high_s16(v.val[0]), vget_high_s16(v.val[1])), vshift);
+        int16x8_t mix = vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+
+        vst1_u8(dst + i, veor_u8(vreinterpret_u8_s8(vmovn_s16(mix)), vbias));
+    }
+#endif
+
+    for (; i < frames; i++) {
+        int32_t smp = samples[2 * i] + samples[2 * i + 1];
+        smp = smp >> shift;
+        dst[i] = ((uint8_t)smp)^0x80;
+    }
+}
+
 int visualizer_process(
         effect_context_t *context,
         audio_buffer_t *in_buf,
@@ -519,45 +644,32 @@ int visualizer_process(
         return -EINVAL;
     }
 
+    /* all code below assumes stereo 16 bit PCM output and input */
+    const uint32_t sample_count = in_buf->frameCount * visu_ctxt->channel_count;
+    const bool measure = (visu_ctxt->meas_mode & MEASUREMENT_MODE_PEAK_RMS) != 0;
+    const bool normalize = (visu_ctxt->scaling_mode == VISUALIZER_SCALING_MODE_NORMALIZED);
+    visualizer_stats_t stats;
+    int32_t shift;
+
+    if (measure || normalize)
+        visualizer_get_stats(in_buf->s16, sample_count, &stats);
+
     // perform measurements if needed
-    if (visu_ctxt->meas_mode & MEASUREMENT_MODE_PEAK_RMS) {
-        // find the peak and RMS squared for the new buffer
-        uint32_t inIdx;
-        int16_t max_sample = 0;
-        float rms_squared_acc = 0;
-        for (inIdx = 0 ; inIdx < in_buf->frameCount * visu_ctxt->channel_count ; inIdx++) {
-            if (in_buf->s16[inIdx] > max_sample) {
-                max_sample = in_buf->s16[inIdx];
-            } else if (-in_buf->s16[inIdx] > max_sample) {
-                max_sample = -in_buf->s16[inIdx];
-            }
-            rms_squared_acc += (in_buf->s16[inIdx] * in_buf->s16[inIdx]);
-        }
-        // store the measurement
-        visu_ctxt->past_meas[visu_ctxt->meas_buffer_idx].peak_u16 = (uint16_t)max_sample;
+    if (measure) {
+        // store the peak and RMS squared for the new buffer
+        visu_ctxt->past_meas[visu_ctxt->meas_buffer_idx].peak_u16 = stats.peak;
         visu_ctxt->past_meas[visu_ctxt->meas_buffer_idx].rms_squared =
-                rms_squared_acc / (in_buf->frameCount * visu_ctxt->channel_count);
+                (float)stats.sum_squares / sample_count;
         visu_ctxt->past_meas[visu_ctxt->meas_buffer_idx].is_valid = true;
         if (++visu_ctxt->meas_buffer_idx >= visu_ctxt->meas_wndw_size_in_buffers) {
             visu_ctxt->meas_buffer_idx = 0;
         }
     }
 
-    /* all code below assumes stereo 16 bit PCM output and input */
-    int32_t shift;
-
-    if (visu_ctxt->scaling_mode == VISUALIZER_SCALING_MODE_NORMALIZED) {
+    if (normalize) {
         /* derive capture scaling factor from peak value in current buffer
                 * this gives more interesting captures for display. */
-        shift = 32;
-        int len = in_buf->frameCount * 2;
-        int i;
-        for (i = 0; i < len; i++) {
-            int32_t smp = in_buf->s16[i];
-            if (smp < 0) smp = -smp - 1; /* take care to keep the max negative in range */
-            int32_t clz = __builtin_clz(smp);
-            if (shift > clz) shift = clz;
-        }
+        shift = (stats.magnitude == 0) ? 32 : __builtin_clz(stats.magnitude);
         /* A maximum amplitude signal will have 17 leading zeros, which we want to
                 * translate to a shift of 8 (for converting 16 bit to 8 bit) */
         shift = 25 - shift;
@@ -573,28 +685,27 @@ int visualizer_process(
         shift = 9;
     }
 
-    uint32_t capt_idx;
-    uint32_t in_idx;
-    uint8_t *buf = visu_ctxt->capture_buf;
-    for (in_idx = 0, capt_idx = visu_ctxt->capture_idx;
-         in_idx < in_buf->frameCount;
-         in_idx++, capt_idx++) {
+    uint32_t capt_idx = visu_ctxt->capture_idx;
+    uint32_t in_idx = 0;
+    while (in_idx < in_buf->frameCount) {
+        uint32_t frames = in_buf->frameCount - in_idx;
+
+        if (frames > CAPTURE_BUF_SIZE - capt_idx)
+            frames = CAPTURE_BUF_SIZE - capt_idx;
+
+        visualizer_downmix(in_buf->s16 + 2 * in_idx, frames, shift, visu_ctxt->capture_buf + capt_idx);
+
+        in_idx += frames;
+        capt_idx += frames;
         if (capt_idx >= CAPTURE_BUF_SIZE) {
             /* wrap around */
             capt_idx = 0;
         }
-        int32_t smp = in_buf->s16[2 * in_idx] + in_buf->s16[2 * in_idx + 1];
-        smp = smp >> shift;
-        buf[capt_idx] = ((uint8_t)smp)^0x80;
     }
 
-    /* XXX the following two should really be atomic, though it probably doesn't
-         * matter much for visualization purposes */
+    /* new write position and buffer update time stamp go to the readers together */
     visu_ctxt->capture_idx = capt_idx;
-    /* update last buffer update time stamp */
-    if (clock_gettime(CLOCK_MONOTONIC, &visu_ctxt->buffer_update_time) < 0) {
-        visu_ctxt->buffer_update_time.tv_sec = 0;
-    }
+    visualizer_publish_capture(visu_ctxt, true);
 
     if (context->state != EFFECT_STATE_ACTIVE) {
         ALOGV("%s DONE inactive", __func__);
@@ -704,8 +815,14 @@ int visualizer_command(
                 ALOGE("%s: Command(%u) has Invalid Parameter", __func__, cmd_code);
             } else {
                 if (context->state == EFFECT_STATE_ACTIVE) {
+                    capture_snapshot_t snapshot;
+                    uint8_t *reply = (uint8_t *)reply_data;
+
+                    /* never waits for the capture thread, it keeps writing ahead of this */
+                    visualizer_get_snapshot(visu_ctxt, &snapshot);
+
                     int32_t latency_ms = visu_ctxt->latency;
-                    const uint32_t delta_ms = visualizer_get_delta_time_ms_from_updated_time(visu_ctxt);
+                    const uint32_t delta_ms = visualizer_get_delta_time_ms_from_updated_time(&snapshot);
                     latency_ms -= delta_ms;
 
                     if (latency_ms < 0)
@@ -713,32 +830,37 @@ int visualizer_command(
 
                     const uint32_t delta_smp = context->config.inputCfg.samplingRate * latency_ms / 1000;
 
-                    int32_t capture_point = visu_ctxt->capture_idx - visu_ctxt->capture_size - delta_smp;
-                    int32_t capture_size = visu_ctxt->capture_size;
-                    if (capture_point < 0) {
-                        int32_t size = -capture_point;
-                        if (size > capture_size)
-                            size = capture_size;
-
-                        memcpy(reply_data, visu_ctxt->capture_buf + CAPTURE_BUF_SIZE + capture_point, size);
-                        reply_data = (void *)((size_t)reply_data + size);
-                        capture_size -= size;
-                        capture_point = 0;
-                    }
-                    memcpy(reply_data, visu_ctxt->capture_buf + capture_point, capture_size);
-
+                    if (visu_ctxt->last_capture_idx != snapshot.capture_idx)
+                        visu_ctxt->capture_stalled = false;
 
                     /* if audio framework has stopped playing audio although the effect is still
-                     * active we must clear the capture buffer to return silence */
-                    if ((visu_ctxt->last_capture_idx == visu_ctxt->capture_idx)
-                                && (visu_ctxt->buffer_update_time.tv_sec != 0)) {
+                     * active we must return silence */
+                    if ((visu_ctxt->last_capture_idx == snapshot.capture_idx)
+                                && (snapshot.update_time.tv_sec != 0) && !visu_ctxt->capture_stalled) {
                         if (delta_ms > MAX_STALL_TIME_MS) {
                             ALOGV("%s capture going to idle", __func__);
-                            visu_ctxt->buffer_update_time.tv_sec = 0;
-                            memset(reply_data, 0x80, visu_ctxt->capture_size);
+                            visu_ctxt->capture_stalled = true;
+                        }
+                    }
+                    visu_ctxt->last_capture_idx = snapshot.capture_idx;
+
+                    if (visu_ctxt->capture_stalled) {
+                        memset(reply, 0x80, visu_ctxt->capture_size);
+                    } else {
+                        int32_t capture_point = snapshot.capture_idx - visu_ctxt->capture_size - delta_smp;
+                        int32_t capture_size = visu_ctxt->capture_size;
+                        if (capture_point < 0) {
+                            int32_t size = -capture_point;
+                            if (size > capture_size)
+                                size = capture_size;
+
+                            memcpy(reply, visu_ctxt->capture_buf + CAPTURE_BUF_SIZE + capture_point, size);
+                            reply += size;
+                            capture_size -= size;
+                            capture_point = 0;
                         }
+                        memcpy(reply, visu_ctxt->capture_buf + capture_point, capture_size);
                     }
-                    visu_ctxt->last_capture_idx = visu_ctxt->capture_idx;
                 } else {
                     memset(reply_data, 0x80, visu_ctxt->capture_size);
                 }
@@ -747,13 +869,15 @@ int visualizer_command(
         break;
 
     case VISUALIZER_CMD_MEASURE: {
+            capture_snapshot_t snapshot;
             uint16_t peak_u16 = 0;
             float sum_rms_squared = 0.0f;
             uint8_t nb_valid_meas = 0;
 
             /* reset measurements if last measurement was too long ago (which implies stored
                           * measurements aren't relevant anymore and shouldn't bias the new one) */
-            const int32_t delay_ms = visualizer_get_delta_time_ms_from_updated_time(visu_ctxt);
+            visualizer_get_snapshot(visu_ctxt, &snapshot);
+            const int32_t delay_ms = visualizer_get_delta_time_ms_from_updated_time(&snapshot);
             if (delay_ms > DISCARD_MEASUREMENTS_TIME_MS) {
                 uint32_t i;
                 ALOGV("Discarding measurements, last measurement is %dms old", delay_ms);
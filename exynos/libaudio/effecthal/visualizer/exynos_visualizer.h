@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <stdatomic.h>
 #include <cutils/list.h>
 #include <log/log.h>
 #include <system/thread_defs.h>
@@ -90,15 +91,25 @@ typedef struct buffer_stats_s {
     float rms_squared; /* the average square of the samples in a buffer */
 } buffer_stats_t;
 
+/* write position of the capture buffer and the time it was updated. The capture thread
+   fills the slot which is not in use and flips snapshot_seq, so that VISUALIZER_CMD_CAPTURE
+   never waits for the capture thread and never sees a position with a wrong time */
+typedef struct capture_snapshot_s {
+    uint32_t capture_idx;
+    struct timespec update_time;
+} capture_snapshot_t;
+
 typedef struct visualizer_context_s {
     effect_context_t common;
 
-    uint32_t capture_idx;
+    uint32_t capture_idx; /* only for the capture thread, readers use snapshot */
     uint32_t capture_size;
     uint32_t scaling_mode;
     uint32_t last_capture_idx;
+    bool capture_stalled; /* no update for MAX_STALL_TIME_MS, returning silence */
     uint32_t latency;
-    struct timespec buffer_update_time;
+    capture_snapshot_t snapshot[2];
+    atomic_uint snapshot_seq; /* snapshot[snapshot_seq & 1] is the latest one */
     uint8_t capture_buf[CAPTURE_BUF_SIZE];
     /* for measurements */
     uint8_t channel_count; /* to avoid recomputing it every time a buffer is processed */
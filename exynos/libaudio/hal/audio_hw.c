@@ -539,6 +539,9 @@ static bool init_route(struct audio_device *adev)
             }
             trinfo->card_num = (unsigned int)SOUND_CARD0;
             trinfo->aroute = ar;
+
+            /* Controls used at runtime are looked up once, it is a linear search by name */
+            adev->vol_ctrl = mixer_get_ctl_by_name(adev->mixerinfo, OFFLOAD_VOLUME_CONTROL_NAME);
         } else {
             ALOGE("device-%s: Cannot open Mixer for %d!", __func__, SOUND_CARD0);
             free(trinfo);
@@ -1072,7 +1075,7 @@ static int do_set_volume(struct stream_out *out, float left, float right)
     int ret = -ENAVAIL;
     int val[2];
 
-    ctrl = mixer_get_ctl_by_name(adev->mixerinfo, OFFLOAD_VOLUME_CONTROL_NAME);
+    ctrl = adev->vol_ctrl;
     if (ctrl) {
         val[0] = (int)(left * COMPRESS_PLAYBACK_VOLUME_MAX);
         val[1] = (int)(right * COMPRESS_PLAYBACK_VOLUME_MAX);
@@ -40,6 +40,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
+#include <time.h>
 #include <sys/prctl.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
@@ -68,63 +69,471 @@ static int stdev_stop_recognition(const struct sound_trigger_hw_device *dev,
 static int stdev_stop_recognition_l(struct sound_trigger_device *stdev,
                                     sound_model_handle_t handle);
 static void handle_stop_recognition_l(struct sound_trigger_device *stdev);
+static void stdev_vts_set_power(struct sound_trigger_device *stdev,
+                                int enabled_algorithms);
+static inline int stdev_active_callback_bitmask(struct sound_trigger_device* stdev);
+static void sample_ring_stop(struct sample_ring *ring, bool end_session);
 
 
 // Since there's only ever one sound_trigger_device, keep it as a global so that other people can
 // dlopen this lib to get at the streaming audio.
-static struct sound_trigger_device g_stdev = { .lock = PTHREAD_MUTEX_INITIALIZER };
+static struct sound_trigger_device g_stdev = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .model_upload_lock = PTHREAD_MUTEX_INITIALIZER,
+    .streaming_ring = {
+        .wait_lock = PTHREAD_MUTEX_INITIALIZER,
+        .wait_cond = PTHREAD_COND_INITIALIZER,
+    },
+    .recording_ring = {
+        .wait_lock = PTHREAD_MUTEX_INITIALIZER,
+        .wait_cond = PTHREAD_COND_INITIALIZER,
+    },
+};
+
+static int64_t stdev_get_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Sample ring
+// Hotword and recording samples are read from the VTS PCM nodes by a capture thread per node,
+// so the audio HAL reads them without the stdev->lock and without waiting for ALSA.
+static void sample_ring_wake(struct sample_ring *ring)
+{
+    if (atomic_load(&ring->waiters) > 0) {
+        pthread_mutex_lock(&ring->wait_lock);
+        pthread_cond_broadcast(&ring->wait_cond);
+        pthread_mutex_unlock(&ring->wait_lock);
+    }
+}
+
+// Sleeps until the other side moves head or tail. waiters is raised before the caller
+// checks the ring again, so a wake between the check and the sleep is not lost.
+static void sample_ring_wait(struct sample_ring *ring, size_t head, size_t tail)
+{
+    struct timespec ts;
+
+    /* wait_cond uses the default clock */
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += SAMPLE_RING_WAIT_MS * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&ring->wait_lock);
+    atomic_fetch_add(&ring->waiters, 1);
+    if (atomic_load(&ring->head) == head && atomic_load(&ring->tail) == tail &&
+            atomic_load(&ring->opened))
+        pthread_cond_timedwait(&ring->wait_cond, &ring->wait_lock, &ts);
+    atomic_fetch_sub(&ring->waiters, 1);
+    pthread_mutex_unlock(&ring->wait_lock);
+}
+
+// Waits for the readers to leave the ring before its buffer is freed or replaced. head and tail
+// are reset only when none is left, a reader in the middle of a copy would store its old tail
+// over the reset one. A reader coming in later finds nothing to copy and the session ended.
+static void sample_ring_drain_readers(struct sample_ring *ring)
+{
+    atomic_store(&ring->opened, false);
+
+    pthread_mutex_lock(&ring->wait_lock);
+    while (ring->readers > 0) {
+        pthread_cond_broadcast(&ring->wait_cond);
+        pthread_cond_wait(&ring->wait_cond, &ring->wait_lock);
+    }
+    /* readers enter under the wait_lock, so they see the reset ring */
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+    pthread_mutex_unlock(&ring->wait_lock);
+}
+
+static void *sample_ring_capture_loop(void *context)
+{
+    struct sample_ring *ring = (struct sample_ring *)context;
+    size_t mask = ring->size - 1;
+    char *bounce = NULL;
+    int errors = 0;
+
+    prctl(PR_SET_NAME, (unsigned long)ring->name, 0, 0, 0);
+
+    while (atomic_load(&ring->running)) {
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        size_t tail = atomic_load(&ring->tail);
+        size_t offset = head & mask;
+        char *dst;
+        int ret;
+
+        if (ring->size - (head - tail) < ring->period_bytes) {
+            ring->overruns++;
+            sample_ring_wait(ring, head, tail);
+            continue;
+        }
+
+        /* Read straight into the ring unless the period wraps around */
+        if (offset + ring->period_bytes <= ring->size) {
+            dst = ring->buffer + offset;
+        } else {
+            if (!bounce)
+                bounce = (char *)malloc(ring->period_bytes);
+            if (!bounce) {
+                ALOGE("%s: %s failed to allocate bounce buffer", __func__, ring->name);
+                break;
+            }
+            dst = bounce;
+        }
+
+        ret = pcm_read(ring->pcm, dst, ring->period_bytes);
+        if (ret) {
+            if (!atomic_load(&ring->running))
+                break;
+            ALOGE("%s: %s Read Fail = %s", __func__, ring->name, pcm_get_error(ring->pcm));
+            if (++errors >= SAMPLE_RING_MAX_ERRORS) {
+                ALOGE("%s: %s too many read errors, stop capture", __func__, ring->name);
+                break;
+            }
+            continue;
+        }
+        errors = 0;
+
+        if (dst == bounce) {
+            size_t first = ring->size - offset;
+
+            memcpy(ring->buffer + offset, bounce, first);
+            memcpy(ring->buffer, bounce + first, ring->period_bytes - first);
+        }
+
+        atomic_store(&ring->head, head + ring->period_bytes);
+        sample_ring_wake(ring);
+    }
+
+    free(bounce);
+    atomic_store(&ring->running, false);
+    sample_ring_wake(ring);
+
+    return NULL;
+}
+
+// Starts the capture thread on the opened PCM. A new session starts from an empty ring, else
+// the reader continues with the samples of the reopened PCM. Must be called with the
+// stdev->lock held.
+static int sample_ring_start(
+        struct sample_ring *ring,
+        struct pcm *pcm,
+        const char *name,
+        int preroll_ms)
+{
+    size_t period_bytes = pcm_config_vt_capture.period_size * pcm_config_vt_capture.channels *
+                          sizeof(int16_t);
+    size_t preroll_bytes = (size_t)preroll_ms * pcm_config_vt_capture.rate / 1000 *
+                           pcm_config_vt_capture.channels * sizeof(int16_t);
+    size_t size = 1;
+    int ret;
+
+    if (ring->thread_active)
+        sample_ring_stop(ring, false);
+
+    if (!atomic_load(&ring->opened)) {
+        /* A reader of the previous session can be still copying from the ring */
+        sample_ring_drain_readers(ring);
+
+        while (size < preroll_bytes + 2 * period_bytes)
+            size <<= 1;
+
+        if (size > ring->buffer_alloc) {
+            free(ring->buffer);
+            ring->buffer = (char *)malloc(size);
+            ring->buffer_alloc = ring->buffer ? size : 0;
+            if (!ring->buffer) {
+                ALOGE("%s: %s failed to allocate %zu bytes", __func__, name, size);
+                return -ENOMEM;
+            }
+        }
+
+        ring->size = size;
+        ring->period_bytes = period_bytes;
+        ring->overruns = 0;
+        atomic_store(&ring->head, 0);
+        atomic_store(&ring->tail, 0);
+        atomic_store(&ring->opened, true);
+        ALOGI("%s: %s ring %zu bytes, period %zu bytes, preroll %d ms", __func__, name,
+              ring->size, ring->period_bytes, preroll_ms);
+    }
+
+    ring->pcm = pcm;
+    ring->name = name;
+    atomic_store(&ring->running, true);
+    ret = pthread_create(&ring->thread, (const pthread_attr_t *) NULL,
+                         sample_ring_capture_loop, ring);
+    if (ret) {
+        ALOGE("%s: %s failed to create capture thread %d", __func__, name, ret);
+        atomic_store(&ring->running, false);
+        ring->pcm = NULL;
+        return -ret;
+    }
+    ring->thread_active = true;
+
+    return 0;
+}
+
+// Stops the capture thread before its PCM is closed. If end_session is set, the reader gets
+// the samples left and then an error. Must be called with the stdev->lock held.
+static void sample_ring_stop(struct sample_ring *ring, bool end_session)
+{
+    if (ring->thread_active) {
+        atomic_store(&ring->running, false);
+        /* Wakes the capture thread up from pcm_read */
+        if (ring->pcm)
+            pcm_stop(ring->pcm);
+        sample_ring_wake(ring);
+
+        pthread_join(ring->thread, (void **)NULL);
+        ring->thread_active = false;
+        ring->pcm = NULL;
+
+        if (ring->overruns)
+            ALOGW("%s: %s reader was late %u times", __func__, ring->name, ring->overruns);
+    }
+
+    if (end_session && atomic_load(&ring->opened)) {
+        atomic_store(&ring->opened, false);
+        sample_ring_wake(ring);
+    }
+}
+
+// Copies len bytes to the reader, waiting for the capture thread as pcm_read() did.
+// Returns 0 or negative error, never takes the stdev->lock.
+static int sample_ring_read(struct sample_ring *ring, void *buffer, size_t len)
+{
+    int64_t deadline = stdev_get_time_us() + SAMPLE_RING_READ_TIMEOUT_MS * 1000LL;
+    char *dst = (char *)buffer;
+    size_t mask, copied = 0;
+    int ret = 0;
+
+    pthread_mutex_lock(&ring->wait_lock);
+    ring->readers++;
+    pthread_mutex_unlock(&ring->wait_lock);
+
+    while (copied < len) {
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t head = atomic_load(&ring->head);
+        size_t avail = head - tail;
+        size_t count, offset, first;
+
+        if (avail == 0) {
+            if (!atomic_load(&ring->opened)) {
+                ret = -EINVAL;
+                break;
+            }
+            if (stdev_get_time_us() > deadline) {
+                ret = -ETIMEDOUT;
+                break;
+            }
+            sample_ring_wait(ring, head, tail);
+            continue;
+        }
+
+        mask = ring->size - 1;
+        count = len - copied;
+        if (count > avail)
+            count = avail;
+        offset = tail & mask;
+        first = ring->size - offset;
+        if (first > count)
+            first = count;
+
+        memcpy(dst + copied, ring->buffer + offset, first);
+        memcpy(dst + copied + first, ring->buffer, count - first);
+        copied += count;
+
+        atomic_store(&ring->tail, tail + count);
+        sample_ring_wake(ring);
+    }
+
+    /* sample_ring_drain_readers() may be waiting for this one */
+    pthread_mutex_lock(&ring->wait_lock);
+    if (--ring->readers == 0)
+        pthread_cond_broadcast(&ring->wait_cond);
+    pthread_mutex_unlock(&ring->wait_lock);
+
+    return ret;
+}
+
+// Frees the ring after the session is ended by sample_ring_stop().
+static void sample_ring_release(struct sample_ring *ring)
+{
+    sample_ring_drain_readers(ring);
+    free(ring->buffer);
+    ring->buffer = NULL;
+    ring->buffer_alloc = 0;
+}
+
+// Mixer control index
+// VTS card has hundreds of controls and mixer_get_ctl_by_name() walks all of them,
+// so names are hashed(FNV-1a) into an open addressing table once at mixer open.
+static unsigned int mixer_ctl_hash(const char *name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void build_mixer_ctl_index(struct sound_trigger_device *stdev)
+{
+    unsigned int num_ctls = mixer_get_num_ctls(stdev->mixer);
+    unsigned int size = MIXER_CTL_INDEX_MIN;
+    unsigned int i, slot;
+
+    while (size < num_ctls * 2)
+        size <<= 1;
+
+    stdev->mixer_ctl_index = (struct mixer_ctl **)calloc(size, sizeof(struct mixer_ctl *));
+    if (!stdev->mixer_ctl_index) {
+        ALOGW("%s: failed to allocate, controls will be searched one by one", __func__);
+        stdev->mixer_ctl_index_size = 0;
+        return;
+    }
+    stdev->mixer_ctl_index_size = size;
+
+    for (i = 0; i < num_ctls; i++) {
+        struct mixer_ctl *ctl = mixer_get_ctl(stdev->mixer, i);
+        const char *name = ctl ? mixer_ctl_get_name(ctl) : NULL;
+
+        if (!name)
+            continue;
+
+        // the first one wins for the same name like as mixer_get_ctl_by_name()
+        slot = mixer_ctl_hash(name) & (size - 1);
+        while (stdev->mixer_ctl_index[slot] &&
+               strcmp(mixer_ctl_get_name(stdev->mixer_ctl_index[slot]), name))
+            slot = (slot + 1) & (size - 1);
+
+        if (!stdev->mixer_ctl_index[slot])
+            stdev->mixer_ctl_index[slot] = ctl;
+    }
+
+    ALOGI("%s: %u controls are indexed", __func__, num_ctls);
+}
+
+static void free_mixer_ctl_index(struct sound_trigger_device *stdev)
+{
+    free(stdev->mixer_ctl_index);
+    stdev->mixer_ctl_index = NULL;
+    stdev->mixer_ctl_index_size = 0;
+}
+
+static struct mixer_ctl *get_mixer_ctl(struct sound_trigger_device *stdev, const char *name)
+{
+    unsigned int size = stdev->mixer_ctl_index_size;
+    unsigned int slot;
+
+    if (!size)
+        return mixer_get_ctl_by_name(stdev->mixer, name);
+
+    slot = mixer_ctl_hash(name) & (size - 1);
+    while (stdev->mixer_ctl_index[slot]) {
+        if (!strcmp(mixer_ctl_get_name(stdev->mixer_ctl_index[slot]), name))
+            return stdev->mixer_ctl_index[slot];
+        slot = (slot + 1) & (size - 1);
+    }
+
+    return NULL;
+}
 
 // Utility function for configuration MIC mixer controls
-int set_mixer_ctrls(
+// All controls are checked before any of them is changed. With update_only, a control
+// already at the value is not written again, it is for the path like as MIC routing.
+static int apply_mixer_ctrls(
         struct sound_trigger_device *stdev,
         char *path_name[],
         int *path_ctlvalue,
         int ctrl_count,
-        bool reverse)
+        bool reverse,
+        bool update_only)
 {
-    int i = (reverse ? (ctrl_count - 1): 0);
-    int ret = 0;
     struct mixer_ctl *mixerctl = NULL;
+    int ret = 0;
+    int i, n, value;
 
     ALOGV("%s, path: %s", __func__, path_name[0]);
 
-    if (stdev->mixer) {
-        //for (i=0; i < ctrl_count; i++) {
-        while(ctrl_count) {
-            ALOGVV("%s, ctrl_count: %d Loop index: %d", __func__, ctrl_count, i);
-            /* Get required control from mixer */
-            mixerctl = mixer_get_ctl_by_name(stdev->mixer, path_name[i]);
-            if (mixerctl) {
-                /* Enable the control */
-                if (path_ctlvalue)
-                    ret = mixer_ctl_set_value(mixerctl, 0, path_ctlvalue[i]);
-                else
-                    ret = mixer_ctl_set_value(mixerctl, 0, 0);
-
-                if (ret) {
-                    ALOGE("%s: %s Failed to configure\n", __func__, path_name[i]);
-                    ret = -EINVAL;
-                    break;
-                } else {
-                    ALOGV("%s: %s configured value: %d\n", __func__, path_name[i],
-                        (path_ctlvalue ? path_ctlvalue[i] : 0));
-                }
-             } else {
-                ALOGE("%s: %s control doesn't exist\n", __func__, path_name[i]);
-                ret = -EINVAL;
-                break;
-            }
-            ctrl_count--;
-            if (reverse)
-                i--;
-            else
-                i++;
-        }
-    } else{
+    if (!stdev->mixer) {
         ALOGE("%s: Failed to open mixer\n", __func__);
         return -EINVAL;
     }
 
+    for (i = 0; i < ctrl_count; i++) {
+        if (!get_mixer_ctl(stdev, path_name[i])) {
+            ALOGE("%s: %s control doesn't exist\n", __func__, path_name[i]);
+            return -EINVAL;
+        }
+    }
+
+    for (n = 0; n < ctrl_count; n++) {
+        i = (reverse ? (ctrl_count - 1 - n) : n);
+        ALOGVV("%s, ctrl_count: %d Loop index: %d", __func__, ctrl_count, i);
+
+        mixerctl = get_mixer_ctl(stdev, path_name[i]);
+        value = (path_ctlvalue ? path_ctlvalue[i] : 0);
+
+        if (update_only && mixer_ctl_get_value(mixerctl, 0) == value) {
+            ALOGVV("%s: %s is already %d\n", __func__, path_name[i], value);
+            continue;
+        }
+
+        ret = mixer_ctl_set_value(mixerctl, 0, value);
+        if (ret) {
+            ALOGE("%s: %s Failed to configure\n", __func__, path_name[i]);
+            ret = -EINVAL;
+            break;
+        } else {
+            ALOGV("%s: %s configured value: %d\n", __func__, path_name[i], value);
+        }
+    }
+
+    return ret;
+}
+
+// Commands to VTS firmware, they are written always
+int set_mixer_ctrls(
+        struct sound_trigger_device *stdev,
+        char *path_name[],
+        int *path_ctlvalue,
+        int ctrl_count,
+        bool reverse)
+{
+    int ret;
+
+    // VTS does not take controls while a model binary is uploading
+    pthread_mutex_lock(&stdev->model_upload_lock);
+    ret = apply_mixer_ctrls(stdev, path_name, path_ctlvalue, ctrl_count, reverse, false);
+    pthread_mutex_unlock(&stdev->model_upload_lock);
+
+    return ret;
+}
+
+// Routing path, only controls to be changed are written
+static int update_mixer_ctrls(
+        struct sound_trigger_device *stdev,
+        char *path_name[],
+        int *path_ctlvalue,
+        int ctrl_count,
+        bool reverse)
+{
+    int ret;
+
+    pthread_mutex_lock(&stdev->model_upload_lock);
+    ret = apply_mixer_ctrls(stdev, path_name, path_ctlvalue, ctrl_count, reverse, true);
+    pthread_mutex_unlock(&stdev->model_upload_lock);
+
     return ret;
 }
 
@@ -350,6 +759,7 @@ static void ParseExtraConfigData(
 	 * Information that can be set in extra data,
 	 * 1. Backlog_size: How many ms of previous data to be captured from the trigger word
 	 * 2. Voice trigger mode: ODM specific, other default trigger mode will be used
+	 * 3. Preroll_ms: How many ms of captured data can be held for the reader
 	*/
 
     // get backlog_size
@@ -369,6 +779,15 @@ static void ParseExtraConfigData(
         stdev->odmvoicemodel_mode = value;
         str_parms_del(parms, "voice_trigger_mode");
     }
+
+    // get preroll_ms, captured audio held for the streaming and recording readers
+    ret = str_parms_get_int(parms, "preroll_ms", &value);
+    if (ret >= 0) {
+        ALOGV("preroll_ms = (%d)", value);
+        if (value > 0)
+            stdev->preroll_ms = value;
+        str_parms_del(parms, "preroll_ms");
+    }
     str_parms_destroy(parms);
 }
 
@@ -393,7 +812,7 @@ static void stdev_vts_set_mic(
                 ctrl_values = headset_mic_ctlvalue;
             }
 
-            if (set_mixer_ctrls(stdev, active_mic_ctrls, ctrl_values, MAIN_MIC_CONTROL_COUNT, false)) {
+            if (update_mixer_ctrls(stdev, active_mic_ctrls, ctrl_values, MAIN_MIC_CONTROL_COUNT, false)) {
                 ALOGW("%s: Enabling MIC control configuration Failed", __func__);
             }
             stdev->is_mic_configured = 1;
@@ -407,7 +826,7 @@ static void stdev_vts_set_mic(
 
         /* Reset MIC controls for disabling VTS */
         if (stdev->is_mic_configured) {
-            if (set_mixer_ctrls(stdev, active_mic_ctrls, NULL, MAIN_MIC_CONTROL_COUNT, true)) {
+            if (update_mixer_ctrls(stdev, active_mic_ctrls, NULL, MAIN_MIC_CONTROL_COUNT, true)) {
                 ALOGW("%s: Enabling MIC control configuration Failed", __func__);
             }
             stdev->is_mic_configured = 0;
@@ -430,6 +849,7 @@ static void stdev_vts_set_power(
 
     if (stdev->streaming_pcm) {
         ALOGW("%s: Streaming PCM node is not closed", __func__);
+        sample_ring_stop(&stdev->streaming_ring, true);
         pcm_close(stdev->streaming_pcm);
         stdev->streaming_pcm = NULL;
     }
@@ -557,6 +977,8 @@ static int stdev_init_mixer(struct sound_trigger_device *stdev)
         goto err;
     }
 
+    build_mixer_ctl_index(stdev);
+
     return 0;
 
 err:
@@ -572,6 +994,7 @@ static void stdev_close_mixer(struct sound_trigger_device *stdev)
 
     stdev_vts_set_power(stdev, 0);
     stdev_join_callback_thread(stdev, false);
+    free_mixer_ctl_index(stdev);
     mixer_close(stdev->mixer);
 }
 
@@ -703,6 +1126,214 @@ static int vts_load_sound_model(
     return ret;
 }
 
+// Model binary cache
+// VTS keeps the last uploaded binary of each model index, so loading the same model again
+// (e.g. after unload/load by the framework) only needs the FNV-1a hash of the binary.
+static uint64_t model_binary_hash(const char *data, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static void stdev_update_load_stats(
+        struct sound_trigger_device *stdev,
+        int model_index,
+        int64_t load_time,
+        bool cache_hit)
+{
+    struct model_load_stats *stats = &stdev->model_stats[model_index];
+
+    stats->load_count++;
+    if (cache_hit)
+        stats->cache_hits++;
+    stats->last_load_time = load_time;
+    if (load_time > stats->max_load_time)
+        stats->max_load_time = load_time;
+
+    ALOGI("%s: model %d loaded in %lld us%s (max %lld us, cache hits %u/%u)", __func__,
+          model_index, (long long)load_time, cache_hit ? " from cache" : "",
+          (long long)stats->max_load_time, stats->cache_hits, stats->load_count);
+}
+
+// Fails the recognition which was requested while the upload was pending. The client gets a
+// failure event and has to start it again. Must be called with the stdev->lock held.
+static void stdev_fail_deferred_recognition(
+        struct sound_trigger_device *stdev,
+        int model_index)
+{
+    recognition_callback_t callback = stdev->recognition_callbacks[model_index];
+    void *cookie = stdev->recognition_cookies[model_index];
+    struct sound_trigger_recognition_event *event = NULL;
+
+    stdev->recognition_callbacks[model_index] = NULL;
+    stdev->recognition_cookies[model_index] = NULL;
+    if (stdev->model_execstate[model_index] == MODEL_STATE_RUNNING)
+        stdev->model_execstate[model_index] = MODEL_STATE_NONE;
+
+    if (!callback)
+        return;
+
+    if (model_index == HOTWORD_INDEX)
+        event = sound_trigger_hotword_event_alloc(stdev);
+    else
+        event = sound_trigger_odmvoice_event_alloc(stdev);
+
+    if (event) {
+        event->status = RECOGNITION_STATUS_FAILURE;
+        event->capture_available = false;
+        ALOGI("%s: send failure callback model %d", __func__, model_index);
+        callback(event, cookie);
+        free(event);
+    } else {
+        ALOGE("%s: out of memory for failure event of model %d", __func__, model_index);
+    }
+}
+
+// Uploads a model binary to VTS without the stdev->lock, then finishes the load and starts
+// the recognition which was requested while the upload was pending. Controls to VTS wait for
+// the upload on the model_upload_lock.
+static void *model_load_thread_loop(void *context)
+{
+    struct model_load_job *job = (struct model_load_job *)context;
+    struct sound_trigger_device *stdev = job->stdev;
+    int model_index = job->model_index;
+    int ret;
+
+    prctl(PR_SET_NAME, (unsigned long)"sound trigger model load", 0, 0, 0);
+
+    pthread_mutex_lock(&stdev->model_upload_lock);
+    ret = vts_load_sound_model(stdev, job->data, job->data_size, model_index);
+    pthread_mutex_unlock(&stdev->model_upload_lock);
+
+    pthread_mutex_lock(&stdev->lock);
+    if (ret) {
+        ALOGE("%s: model %d upload failed %d", __func__, model_index, ret);
+        stdev->model_loadstate[model_index] = MODEL_LOAD_FAILED;
+        if (stdev->recognition_deferred[model_index])
+            stdev_fail_deferred_recognition(stdev, model_index);
+    } else {
+        stdev->loaded_model_hash[model_index] = job->hash;
+        stdev->loaded_model_size[model_index] = job->data_size;
+        stdev->model_loadstate[model_index] = MODEL_LOAD_DONE;
+        stdev_update_load_stats(stdev, model_index,
+                                stdev_get_time_us() - job->request_time, false);
+
+        if (stdev->recognition_deferred[model_index] &&
+                stdev->recognition_callbacks[model_index] != NULL &&
+                (!stdev->is_streaming || (stdev->is_streaming & (0x1 << model_index)))) {
+            ALOGI("%s: Starting deferred VTS Recognition of model %d", __func__, model_index);
+            stdev_vts_set_power(stdev, 0);
+            stdev_vts_set_power(stdev, stdev_active_callback_bitmask(stdev));
+        }
+    }
+    stdev->recognition_deferred[model_index] = false;
+    pthread_mutex_unlock(&stdev->lock);
+
+    free(job->data);
+    free(job);
+
+    return (void *)(long)ret;
+}
+
+// Waits for the loader thread of the model. Must be called with the stdev->lock held, the lock
+// is released while joining as the thread takes it to finish the load.
+static void stdev_join_model_load_thread(
+        struct sound_trigger_device *stdev,
+        int model_index)
+{
+    pthread_t thread;
+
+    if (!stdev->model_load_thread_active[model_index])
+        return;
+
+    thread = stdev->model_load_thread[model_index];
+    stdev->model_load_thread_active[model_index] = false;
+
+    pthread_mutex_unlock(&stdev->lock);
+    pthread_join(thread, (void **)NULL);
+    pthread_mutex_lock(&stdev->lock);
+}
+
+// Loads a model binary, unless VTS has the same binary for the model index already. Large
+// binaries are uploaded by a loader thread. Must be called with the stdev->lock held.
+static int stdev_load_model_binary(
+        struct sound_trigger_device *stdev,
+        char *buffer,
+        size_t buffer_len,
+        int model_index)
+{
+    int64_t start_time = stdev_get_time_us();
+    struct model_load_job *job = NULL;
+    uint64_t hash;
+    int ret;
+
+    /* Loader thread of the previous load is done as the model was unloaded, release it */
+    stdev_join_model_load_thread(stdev, model_index);
+
+    hash = model_binary_hash(buffer, buffer_len);
+    if (stdev->model_loadstate[model_index] == MODEL_LOAD_DONE &&
+            stdev->loaded_model_size[model_index] == buffer_len &&
+            stdev->loaded_model_hash[model_index] == hash) {
+        stdev_update_load_stats(stdev, model_index, stdev_get_time_us() - start_time, true);
+        return 0;
+    }
+
+    /* Binary in VTS is going to be overwritten */
+    stdev->model_loadstate[model_index] = MODEL_LOAD_NONE;
+    stdev->loaded_model_size[model_index] = 0;
+    stdev->recognition_deferred[model_index] = false;
+
+    if (buffer_len >= MODEL_ASYNC_LOAD_MIN_SIZE) {
+        job = (struct model_load_job *)calloc(1, sizeof(struct model_load_job));
+        if (job)
+            job->data = (char *)malloc(buffer_len);
+
+        if (job && job->data) {
+            memcpy(job->data, buffer, buffer_len);
+            job->stdev = stdev;
+            job->model_index = model_index;
+            job->data_size = buffer_len;
+            job->hash = hash;
+            job->request_time = start_time;
+
+            stdev->model_loadstate[model_index] = MODEL_LOAD_PENDING;
+            if (pthread_create(&stdev->model_load_thread[model_index],
+                               (const pthread_attr_t *) NULL, model_load_thread_loop, job) == 0) {
+                stdev->model_load_thread_active[model_index] = true;
+                ALOGV("%s: model %d size %zu is uploading asynchronously", __func__,
+                      model_index, buffer_len);
+                return 0;
+            }
+            ALOGW("%s: Failed to create loader thread, upload synchronously", __func__);
+            stdev->model_loadstate[model_index] = MODEL_LOAD_NONE;
+        }
+
+        if (job)
+            free(job->data);
+        free(job);
+    }
+
+    pthread_mutex_lock(&stdev->model_upload_lock);
+    ret = vts_load_sound_model(stdev, buffer, buffer_len, model_index);
+    pthread_mutex_unlock(&stdev->model_upload_lock);
+    if (ret)
+        return ret;
+
+    stdev->loaded_model_hash[model_index] = hash;
+    stdev->loaded_model_size[model_index] = buffer_len;
+    stdev->model_loadstate[model_index] = MODEL_LOAD_DONE;
+    stdev_update_load_stats(stdev, model_index, stdev_get_time_us() - start_time, false);
+
+    return 0;
+}
+
 // Returns a bitmask where each bit is set if there is a recognition callback function set for that
 // index. Must be called with the stdev->lock held.
 static inline int stdev_active_callback_bitmask(struct sound_trigger_device* stdev)
@@ -918,8 +1549,8 @@ static int stdev_load_sound_model(
         goto exit;
     }
 
-    ret = vts_load_sound_model(stdev, ((char *)sound_model) + sound_model->data_offset,
-                               sound_model->data_size, model_index);
+    ret = stdev_load_model_binary(stdev, ((char *)sound_model) + sound_model->data_offset,
+                                  sound_model->data_size, model_index);
     if (ret) {
         goto exit;
     }
@@ -952,6 +1583,9 @@ static int stdev_unload_sound_model(
         goto exit;
     }
 
+    // Let a pending upload finish before the recognition is stopped and the model is gone.
+    stdev_join_model_load_thread(stdev, handle);
+
     // If we still have a recognition callback, that means we should cancel the
     // recognition first.
     if (stdev->recognition_callbacks[handle] != NULL ||
@@ -973,6 +1607,8 @@ static int stdev_start_recognition(
         void *cookie)
 {
     struct sound_trigger_device *stdev = (struct sound_trigger_device *)dev;
+    int64_t start_time = stdev_get_time_us();
+    struct model_load_stats *stats;
     int ret = 0;
 
     ALOGI("%s Handle %d", __func__, handle);
@@ -982,6 +1618,11 @@ static int stdev_start_recognition(
         ret = -ENOSYS;
         goto exit;
     }
+    if (stdev->model_loadstate[handle] == MODEL_LOAD_FAILED) {
+        ALOGE("%s: Model binary upload failed", __func__);
+        ret = -EIO;
+        goto exit;
+    }
     if (stdev->recognition_callbacks[handle] != NULL) {
          ALOGW("%s:model recognition is already started Checking for error state", __func__);
          /* Error handling if models stop-recognition failed */
@@ -1029,8 +1670,12 @@ static int stdev_start_recognition(
     stdev->recognition_callbacks[handle] = callback;
     stdev->recognition_cookies[handle] = cookie;
 
-    // Reconfigure the VTS to run any algorithm that have a callback.
-    if (!stdev->is_streaming ||
+    // Reconfigure the VTS to run any algorithm that have a callback. If the model binary is
+    // still uploading, the loader thread does it when the upload is done.
+    if (stdev->model_loadstate[handle] == MODEL_LOAD_PENDING) {
+        ALOGI("%s: Model binary is uploading, VTS Recognition is deferred", __func__);
+        stdev->recognition_deferred[handle] = true;
+    } else if (!stdev->is_streaming ||
             (stdev->is_streaming & (0x1 << handle))) {
         ALOGI("Starting VTS Recognition\n");
         stdev_vts_set_power(stdev, 0);
@@ -1039,7 +1684,14 @@ static int stdev_start_recognition(
 
     stdev->model_stopfailedhandles[handle] = HANDLE_NONE;
     stdev->model_execstate[handle] = MODEL_STATE_RUNNING;
-    ALOGI("%s Handle Exit %d", __func__, handle);
+
+    stats = &stdev->model_stats[handle];
+    stats->start_count++;
+    stats->last_start_time = stdev_get_time_us() - start_time;
+    if (stats->last_start_time > stats->max_start_time)
+        stats->max_start_time = stats->last_start_time;
+    ALOGI("%s Handle Exit %d, started in %lld us (max %lld us)", __func__, handle,
+          (long long)stats->last_start_time, (long long)stats->max_start_time);
 exit:
     pthread_mutex_unlock(&stdev->lock);
     return ret;
@@ -1230,6 +1882,16 @@ int sound_trigger_open_for_streaming()
         goto exit;
     }
 
+    /* a new session, the previous reader is gone */
+    sample_ring_stop(&stdev->streaming_ring, true);
+    ret = sample_ring_start(&stdev->streaming_ring, stdev->streaming_pcm,
+                            "sound trigger streaming", stdev->preroll_ms);
+    if (ret) {
+        pcm_close(stdev->streaming_pcm);
+        stdev->streaming_pcm = NULL;
+        goto exit;
+    }
+
     stdev->is_seamless_recording = true;
     ret = 1;
 exit:
@@ -1254,36 +1916,15 @@ size_t sound_trigger_read_samples(
         return -EINVAL;
     }
 
-    pthread_mutex_lock(&stdev->lock);
-
-    if (!stdev->sthal_opened) {
-        ALOGE("%s: stdev has not been opened", __func__);
-        ret = -EFAULT;
-        goto exit;
-    }
-
-    if (stdev->voicecall_state == VOICECALL_STARTED) {
-        ALOGI("%s VoiceCall in progress", __func__);
-        ret = -EBUSY;
-        goto exit;
-    }
-
-    if (!stdev->is_streaming) {
-        ALOGE("%s: VTS is not streaming currently", __func__);
-        ret = -EINVAL;
-        goto exit;
-    }
-
-    if(stdev->streaming_pcm)
-        ret = pcm_read(stdev->streaming_pcm, buffer, buffer_len);
+    /* Samples come from the capture thread, the stdev->lock is not needed.
+     * The session ends when streaming stops, VTS powers off or a voice call starts. */
+    ret = sample_ring_read(&stdev->streaming_ring, buffer, buffer_len);
     if (ret == 0) {
         ALOGVV("%s: --Sent %zu bytes to buffer", __func__, buffer_len);
     } else {
-        ALOGE("%s: Read Fail = %s", __func__, pcm_get_error(stdev->streaming_pcm));
+        ALOGE("%s: Read Fail = %d", __func__, (int)ret);
     }
 
-exit:
-    pthread_mutex_unlock(&stdev->lock);
     return ret;
 }
 
@@ -1328,6 +1969,7 @@ int sound_trigger_close_for_streaming(int audio_handle __unused)
     }
 
     /* close streaming pcm node */
+    sample_ring_stop(&stdev->streaming_ring, true);
     pcm_close(stdev->streaming_pcm);
     stdev->streaming_pcm = NULL;
 
@@ -1373,6 +2015,7 @@ int sound_trigger_open_recording()
 
         /* workaround to forcefully close current execution */
         /* close streaming pcm node */
+        sample_ring_stop(&stdev->recording_ring, true);
         if(stdev->recording_pcm) {
             pcm_close(stdev->recording_pcm);
             stdev->recording_pcm = NULL;
@@ -1401,6 +2044,14 @@ int sound_trigger_open_recording()
         goto exit;
     }
 
+    ret = sample_ring_start(&stdev->recording_ring, stdev->recording_pcm,
+                            "sound trigger recording", stdev->preroll_ms);
+    if (ret) {
+        pcm_close(stdev->recording_pcm);
+        stdev->recording_pcm = NULL;
+        goto exit;
+    }
+
     stdev->is_recording = true;
     ret = 1;
 exit:
@@ -1419,36 +2070,15 @@ size_t sound_trigger_read_recording_samples(
 
     //ALOGV("%s", __func__);
 
-    pthread_mutex_lock(&stdev->lock);
-
-    if (!stdev->sthal_opened) {
-        ALOGE("%s: stdev has not been opened", __func__);
-        ret = -EFAULT;
-        goto exit;
-    }
-
-    if (stdev->voicecall_state == VOICECALL_STARTED) {
-        ALOGI("%s VoiceCall in progress", __func__);
-        ret = -EBUSY;
-        goto exit;
-    }
-
-    if (!stdev->is_recording) {
-        ALOGE("%s: VTS Recording PCM Node is not opened", __func__);
-        ret = -EINVAL;
-        goto exit;
-    }
-
-    if(stdev->recording_pcm)
-        ret = pcm_read(stdev->recording_pcm, buffer, buffer_len);
+    /* Samples come from the capture thread, the stdev->lock is not needed.
+     * The session ends when recording is closed or a voice call starts. */
+    ret = sample_ring_read(&stdev->recording_ring, buffer, buffer_len);
     if (ret == 0) {
         ALOGVV("%s: --Sent %zu bytes to buffer", __func__, buffer_len);
     } else {
-        ALOGE("%s: Read Fail = %s", __func__, pcm_get_error(stdev->recording_pcm));
+        ALOGE("%s: Read Fail = %d", __func__, (int)ret);
     }
 
-exit:
-    pthread_mutex_unlock(&stdev->lock);
     return ret;
 }
 
@@ -1489,6 +2119,7 @@ int sound_trigger_close_recording()
     }
 
     /* close streaming pcm node */
+    sample_ring_stop(&stdev->recording_ring, true);
     pcm_close(stdev->recording_pcm);
     stdev->recording_pcm = NULL;
 
@@ -1527,7 +2158,8 @@ int sound_trigger_headset_status(int is_connected)
         //Check if recording is in progress
         if (stdev->is_recording) {
             ALOGI("%s: Close VTS Record PCM to reconfigure active Mic", __func__);
-            // Close record PCM before changing MIC
+            // Close record PCM before changing MIC, the reader waits for the reopened one
+            sample_ring_stop(&stdev->recording_ring, false);
             if (stdev->recording_pcm) {
                 pcm_close(stdev->recording_pcm);
                 stdev->recording_pcm = NULL;
@@ -1538,7 +2170,8 @@ int sound_trigger_headset_status(int is_connected)
         //Check if seamless capture is in progress
         if (stdev->is_streaming) {
             ALOGI("%s: Close VTS Seamless PCM to reconfigure active Mic", __func__);
-            // Close seamless PCM before changing MIC
+            // Close seamless PCM before changing MIC, the reader waits for the reopened one
+            sample_ring_stop(&stdev->streaming_ring, false);
             if (stdev->streaming_pcm) {
                 pcm_close(stdev->streaming_pcm);
                 stdev->streaming_pcm = NULL;
@@ -1580,10 +2213,14 @@ int sound_trigger_headset_status(int is_connected)
                 stdev->recording_pcm = pcm_open(VTS_SOUND_CARD, VTS_RECORD_DEVICE_NODE, PCM_IN, &pcm_config_vt_capture);
                 if (stdev->recording_pcm && !pcm_is_ready(stdev->recording_pcm)) {
                     ALOGE("%s: failed to open recording PCM", __func__);
+                    sample_ring_stop(&stdev->recording_ring, true);
                     ret = -EFAULT;
                     goto exit;
                 }
             }
+            if (sample_ring_start(&stdev->recording_ring, stdev->recording_pcm,
+                                  "sound trigger recording", stdev->preroll_ms))
+                sample_ring_stop(&stdev->recording_ring, true);
             ALOGI("%s: VTS Record reconfiguration & open PCM Completed", __func__);
         }
 
@@ -1594,6 +2231,8 @@ int sound_trigger_headset_status(int is_connected)
                 stdev->streaming_pcm = pcm_open(VTS_SOUND_CARD, VTS_TRICAP_DEVICE_NODE, PCM_IN, &pcm_config_vt_capture);
                 if (stdev->streaming_pcm && !pcm_is_ready(stdev->streaming_pcm)) {
                     ALOGE("%s: failed to open streaming PCM", __func__);
+                    sample_ring_stop(&stdev->streaming_ring, true);
+                    sample_ring_stop(&stdev->recording_ring, true);
                     if (stdev->recording_pcm) {
                         pcm_close(stdev->recording_pcm);
                         stdev->recording_pcm = NULL;
@@ -1601,6 +2240,9 @@ int sound_trigger_headset_status(int is_connected)
                     ret = -EFAULT;
                     goto exit;
                 }
+                if (sample_ring_start(&stdev->streaming_ring, stdev->streaming_pcm,
+                                      "sound trigger streaming", stdev->preroll_ms))
+                    sample_ring_stop(&stdev->streaming_ring, true);
             }
         }
     } else {
@@ -1638,6 +2280,7 @@ int sound_trigger_voicecall_status(int callstate)
             if (stdev->is_recording) {
                 ALOGI("%s: Close VTS Record PCM to reconfigure active Mic", __func__);
                 // Close record PCM before changing MIC
+                sample_ring_stop(&stdev->recording_ring, true);
                 if (stdev->recording_pcm) {
                     pcm_close(stdev->recording_pcm);
                     stdev->recording_pcm = NULL;
@@ -1649,6 +2292,7 @@ int sound_trigger_voicecall_status(int callstate)
             if (stdev->is_streaming) {
                 ALOGI("%s: Close VTS Seamless PCM to reconfigure active Mic", __func__);
                 // Close seamless PCM before changing MIC
+                sample_ring_stop(&stdev->streaming_ring, true);
                 if (stdev->streaming_pcm) {
                     pcm_close(stdev->streaming_pcm);
                     stdev->streaming_pcm = NULL;
@@ -1689,7 +2333,11 @@ static int stdev_close(hw_device_t *device)
         ret = -EFAULT;
         goto exit;
     }
+    for (i = 0; i < MAX_SOUND_MODELS; ++i)
+        stdev_join_model_load_thread(stdev, i);
     stdev_join_callback_thread(stdev, false);
+    sample_ring_stop(&stdev->streaming_ring, true);
+    sample_ring_stop(&stdev->recording_ring, true);
     stdev_close_mixer(stdev);
 #ifdef MMAP_INTERFACE_ENABLED
     if (munmap(stdev->mapped_addr,VTSDRV_MISC_MODEL_BIN_MAXSZ) < 0) {
@@ -1708,6 +2356,8 @@ static int stdev_close(hw_device_t *device)
         }
     }
 
+    sample_ring_release(&stdev->streaming_ring);
+    sample_ring_release(&stdev->recording_ring);
     stdev->sthal_opened = false;
 
 exit:
@@ -1783,12 +2433,17 @@ static int stdev_open(
     stdev->recording_pcm = NULL;
     stdev->voicecall_state = VOICECALL_STOPPED;
     stdev->recog_cbstate = RECOG_CB_NONE;
+    stdev->preroll_ms = SAMPLE_RING_PREROLL_MS;
 
     int i;
     for (i = 0; i < MAX_SOUND_MODELS; ++i) {
       stdev->model_handles[i] = -1;
       stdev->model_execstate[i] = MODEL_STATE_NONE;
       stdev->model_stopfailedhandles[i] = HANDLE_NONE;
+      /* VTS is reset below, so no model binary is in VTS */
+      stdev->model_loadstate[i] = MODEL_LOAD_NONE;
+      stdev->loaded_model_size[i] = 0;
+      stdev->recognition_deferred[i] = false;
     }
 
     *device = &stdev->device.common; // same address as stdev
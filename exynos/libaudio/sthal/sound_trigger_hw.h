@@ -18,6 +18,8 @@
 #define __EXYNOS_SOUNDTRIGGERHAL_H__
 
 #include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <tinyalsa/asoundlib.h>
 
 #include <hardware/hardware.h>
@@ -36,6 +38,18 @@
 #define MODEL_CONTROL_COUNT     3
 #define MODEL_BACKLOG_CONTROL_COUNT     1
 
+/* Mixer control index, slots are twice of the controls at least */
+#define MIXER_CTL_INDEX_MIN     64
+
+/* Models from this size are uploaded to VTS by a loader thread */
+#define MODEL_ASYNC_LOAD_MIN_SIZE   (64 * 1024)
+
+/* Captured audio kept ahead of the reader, the backlog burst after a trigger has to fit */
+#define SAMPLE_RING_PREROLL_MS      2000
+#define SAMPLE_RING_WAIT_MS         20      // sleep of reader or capture thread at most
+#define SAMPLE_RING_READ_TIMEOUT_MS 1000
+#define SAMPLE_RING_MAX_ERRORS      10      // consecutive PCM read errors to give up
+
 static const struct sound_trigger_properties hw_properties = {
     "Samsung SLSI", // implementor
     "Exynos Primary SoundTrigger HAL, OK Google and ODMVoice", // description
@@ -100,6 +114,13 @@ typedef enum {
         RECOG_CB_CALLED         = 2,    //Recognition event callback of STHW Service Called
 }RECOG_CBSTATE;
 
+typedef enum {
+        MODEL_LOAD_NONE             = 0,    // Model binary is not in VTS
+        MODEL_LOAD_PENDING          = 1,    // Loader thread is uploading model binary
+        MODEL_LOAD_DONE             = 2,    // Model binary is in VTS
+        MODEL_LOAD_FAILED           = 3,    // Upload of model binary failed
+}MODEL_LOADSTATE;
+
 typedef enum {
         MODEL_STATE_NONE            = 0,    // Model is not stated
         MODEL_STATE_RUNNING         = 1,    // Model is not stated
@@ -185,6 +206,53 @@ struct pcm_config pcm_config_vt_capture = {
     .format = PCM_FORMAT_S16_LE,
 };
 
+struct model_load_job {
+    struct sound_trigger_device *stdev;
+    int model_index;
+    char *data;             // copy of model binary, owned by the loader thread
+    size_t data_size;
+    uint64_t hash;
+    int64_t request_time;   // us, when load_sound_model was called
+};
+
+/* Latency metrics of each model, us */
+struct model_load_stats {
+    unsigned int load_count;
+    unsigned int cache_hits;
+    int64_t last_load_time;
+    int64_t max_load_time;
+    unsigned int start_count;
+    int64_t last_start_time;
+    int64_t max_start_time;
+};
+
+/*
+ * Single producer single consumer ring between the capture thread reading a VTS PCM node
+ * and the reader in the audio HAL. head is only written by the capture thread and tail only
+ * by the reader, both count bytes from the session start and never wrap.
+ * wait_lock/wait_cond are used to sleep only, data is never copied under them.
+ */
+struct sample_ring {
+    char *buffer;
+    size_t size;            // power of 2
+    size_t buffer_alloc;
+    size_t period_bytes;
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_bool opened;     // session of the reader, survives PCM reopen on MIC change
+    atomic_bool running;    // capture thread is reading the PCM
+    atomic_int waiters;
+    int readers;            // callers in sample_ring_read(), under wait_lock
+    unsigned int overruns;  // capture thread waited for the reader
+
+    struct pcm *pcm;
+    pthread_t thread;
+    bool thread_active;
+    const char *name;
+    pthread_mutex_t wait_lock;
+    pthread_cond_t wait_cond;
+};
+
 struct sound_trigger_device {
     struct sound_trigger_hw_device device;
     sound_model_handle_t model_handles[MAX_SOUND_MODELS];
@@ -200,6 +268,8 @@ struct sound_trigger_device {
     int uevent_socket;
     struct sound_trigger_recognition_config *configs[MAX_SOUND_MODELS];
     struct mixer         *mixer;
+    struct mixer_ctl     **mixer_ctl_index;    // hashed by name, built once at mixer open
+    unsigned int         mixer_ctl_index_size;
 #ifdef MMAP_INTERFACE_ENABLED
     int vtsdev_fd;
     void *mapped_addr;
@@ -227,6 +297,20 @@ struct sound_trigger_device {
     int recog_cbstate;
     int model_execstate[MAX_SOUND_MODELS];
     sound_model_handle_t model_stopfailedhandles[MAX_SOUND_MODELS];
+
+    /* Model binaries in VTS, keyed by content hash to skip the same upload */
+    uint64_t loaded_model_hash[MAX_SOUND_MODELS];
+    size_t loaded_model_size[MAX_SOUND_MODELS];
+    int model_loadstate[MAX_SOUND_MODELS];
+    bool recognition_deferred[MAX_SOUND_MODELS];    // started while upload is pending
+    pthread_t model_load_thread[MAX_SOUND_MODELS];
+    bool model_load_thread_active[MAX_SOUND_MODELS];
+    pthread_mutex_t model_upload_lock;    // uploads share the mapped buffer and sysfs nodes
+    struct model_load_stats model_stats[MAX_SOUND_MODELS];
+
+    struct sample_ring streaming_ring;
+    struct sample_ring recording_ring;
+    int preroll_ms;
 };
 
 #endif  // __EXYNOS_SOUNDTRIGGERHAL_H__
@@ -21,6 +21,8 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <ctype.h>
 #include <unistd.h>
 #include <string.h>
@@ -37,10 +39,42 @@
 
 #define MAX_INSTANCE 10
 
+struct stream_slot {
+    void *addr;
+    u32 size;       // valid bytes
+    u32 offset;     // bytes already written to the driver
+};
+
+/*
+ * Input slots from in_head are queued to the driver, the next one is handed to the caller.
+ * Output slots from out_head are filled with PCM, the first out_held ones are with the caller.
+ */
+struct stream_info {
+    pthread_mutex_t lock;
+    int fd_flags;
+    u32 depth;
+    u32 ibuf_size;
+    u32 obuf_size;
+
+    struct stream_slot in_slot[ADEC_STREAM_MAX_DEPTH];
+    u32 in_head;
+    u32 in_queued;
+
+    struct stream_slot out_slot[ADEC_STREAM_MAX_DEPTH];
+    u32 out_head;
+    u32 out_filled;
+    u32 out_held;
+
+    int eos_pending;
+    int eos_sent;
+    int error;
+};
+
 struct instance_info {
     unsigned int handle;
     void *ibuf_addr;
     void *obuf_addr;
+    struct stream_info *stream;
 };
 static struct instance_info inst_info[MAX_INSTANCE];
 static struct audio_mem_info_t ibuf_info;
@@ -123,6 +157,9 @@ int ADec_Destroy(u32 ulHandle)
         return -1;
     }
 
+    if (inst_info[index].stream)
+        ADec_StreamClose(ulHandle);
+
     ALOGD("%s: index:%d,ibuf_addr:%p,obuf_addr:%p", __func__,
            index, inst_info[index].ibuf_addr, inst_info[index].obuf_addr);
     inst_info[index].handle = -1;
@@ -307,3 +344,407 @@ int ADec_GetOMemPoolInfo(u32 ulHandle, audio_mem_info_t* pOMemPoolInfo)
 
     return 0;
 }
+
+static struct stream_info *ADec_getStream(u32 ulHandle)
+{
+    int index = ADec_getIdx(ulHandle);
+
+    if (index == -1 || inst_info[index].stream == NULL) {
+        ALOGE("%s: stream is not opened. handle:%d", __func__, ulHandle);
+        return NULL;
+    }
+
+    return inst_info[index].stream;
+}
+
+/*
+ * Moves as much as the driver takes without blocking: queued input is written in order,
+ * EOS follows once the input is empty, and PCM is read into free output slots.
+ * Called with the stream lock held.
+ */
+static void ADec_streamPump(u32 ulHandle, struct stream_info *stream)
+{
+    struct stream_slot *slot;
+    int ret;
+
+    while (stream->in_queued > 0) {
+        slot = &stream->in_slot[stream->in_head];
+        ret = write(ulHandle, (char *)slot->addr + slot->offset, slot->size - slot->offset);
+        if (ret < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                ALOGE("%s: write failed: %s", __func__, strerror(errno));
+                stream->error = SEIREN_ERROR_IBUF_OVERFLOW;
+            }
+            break;
+        }
+        if (ret == 0)
+            break;
+
+        slot->offset += ret;
+        if (slot->offset >= slot->size) {
+            slot->size = slot->offset = 0;
+            stream->in_head = (stream->in_head + 1) % stream->depth;
+            stream->in_queued--;
+        }
+    }
+
+    if (stream->eos_pending && stream->in_queued == 0) {
+        ADec_SendEOS(ulHandle);
+        stream->eos_pending = 0;
+        stream->eos_sent = 1;
+    }
+
+    while (stream->out_filled < stream->depth) {
+        slot = &stream->out_slot[(stream->out_head + stream->out_filled) % stream->depth];
+        ret = read(ulHandle, slot->addr, stream->obuf_size);
+        if (ret < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                ALOGE("%s: read failed: %s", __func__, strerror(errno));
+                stream->error = SEIREN_ERROR_OBUF_READ;
+            }
+            break;
+        }
+        if (ret == 0)
+            break;
+
+        slot->size = ret;
+        stream->out_filled++;
+    }
+}
+
+static u32 ADec_streamEvents(struct stream_info *stream)
+{
+    u32 events = ADEC_STREAM_EVENT_NONE;
+
+    if (stream->in_queued < stream->depth && !stream->eos_pending && !stream->eos_sent)
+        events |= ADEC_STREAM_EVENT_INPUT;
+    if (stream->out_filled > stream->out_held)
+        events |= ADEC_STREAM_EVENT_OUTPUT;
+    if (stream->eos_sent)
+        events |= ADEC_STREAM_EVENT_EOS;
+    if (stream->error)
+        events |= ADEC_STREAM_EVENT_ERROR;
+
+    return events;
+}
+
+int ADec_StreamOpen(u32 ulHandle, u32 depth)
+{
+    int index = ADec_getIdx(ulHandle);
+    struct stream_info *stream;
+    audio_mem_info_t pool;
+    u32 i;
+
+    if (index == -1) {
+        ALOGE("Can't find index.");
+        return -1;
+    }
+
+    if (inst_info[index].stream) {
+        ALOGE("%s: already opened. handle:%d", __func__, ulHandle);
+        return SEIREN_ERROR_ALREADY_OPEN;
+    }
+
+    if (depth < ADEC_STREAM_MIN_DEPTH)
+        depth = ADEC_STREAM_MIN_DEPTH;
+    if (depth > ADEC_STREAM_MAX_DEPTH)
+        depth = ADEC_STREAM_MAX_DEPTH;
+
+    stream = calloc(1, sizeof(*stream));
+    if (stream == NULL)
+        return SEIREN_ERROR_OPEN_FAIL;
+
+    memset(&pool, 0, sizeof(pool));
+    if (ioctl(ulHandle, (GET_IBUF_POOL_INFO << 16) | SEIREN_IOCTL_CH_GET_PARAMS, &pool) != 0 ||
+        pool.mem_size == 0) {
+        ALOGE("%s: failed to get input pool info", __func__);
+        free(stream);
+        return SEIREN_ERROR_IBUF_INFO;
+    }
+    stream->ibuf_size = pool.mem_size;
+
+    memset(&pool, 0, sizeof(pool));
+    if (ioctl(ulHandle, (GET_OBUF_POOL_INFO << 16) | SEIREN_IOCTL_CH_GET_PARAMS, &pool) != 0 ||
+        pool.mem_size == 0) {
+        ALOGE("%s: failed to get output pool info", __func__);
+        free(stream);
+        return SEIREN_ERROR_OBUF_INFO;
+    }
+    stream->obuf_size = pool.mem_size;
+
+    stream->depth = depth;
+    for (i = 0; i < depth; i++) {
+        stream->in_slot[i].addr = malloc(stream->ibuf_size);
+        stream->out_slot[i].addr = malloc(stream->obuf_size);
+        if (stream->in_slot[i].addr == NULL || stream->out_slot[i].addr == NULL)
+            goto EXIT_ERROR;
+    }
+
+    stream->fd_flags = fcntl(ulHandle, F_GETFL);
+    if (stream->fd_flags < 0 || fcntl(ulHandle, F_SETFL, stream->fd_flags | O_NONBLOCK) < 0) {
+        ALOGE("%s: failed to set non-blocking mode: %s", __func__, strerror(errno));
+        goto EXIT_ERROR;
+    }
+
+    pthread_mutex_init(&stream->lock, NULL);
+    inst_info[index].stream = stream;
+
+    ALOGD("%s: handle:%d, depth:%u, ibuf_size:%u, obuf_size:%u", __func__,
+           ulHandle, depth, stream->ibuf_size, stream->obuf_size);
+
+    return 0;
+
+EXIT_ERROR:
+    for (i = 0; i < depth; i++) {
+        free(stream->in_slot[i].addr);
+        free(stream->out_slot[i].addr);
+    }
+    free(stream);
+    return SEIREN_ERROR_OPEN_FAIL;
+}
+
+int ADec_StreamClose(u32 ulHandle)
+{
+    int index = ADec_getIdx(ulHandle);
+    struct stream_info *stream;
+    u32 i;
+
+    if (index == -1 || inst_info[index].stream == NULL)
+        return -1;
+
+    stream = inst_info[index].stream;
+    inst_info[index].stream = NULL;
+
+    fcntl(ulHandle, F_SETFL, stream->fd_flags);
+
+    for (i = 0; i < stream->depth; i++) {
+        free(stream->in_slot[i].addr);
+        free(stream->out_slot[i].addr);
+    }
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+
+    ALOGD("%s: called. handle:%d", __func__, ulHandle);
+
+    return 0;
+}
+
+int ADec_StreamGetInputBuffer(u32 ulHandle, audio_mem_info_t* pInputInfo)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    struct stream_slot *slot;
+    int ret = 0;
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->in_queued >= stream->depth) {
+        ret = SEIREN_ERROR_NOT_READY;
+        goto EXIT;
+    }
+
+    slot = &stream->in_slot[(stream->in_head + stream->in_queued) % stream->depth];
+    pInputInfo->virt_addr = slot->addr;
+    pInputInfo->mem_size = stream->ibuf_size;
+    pInputInfo->data_size = 0;
+    pInputInfo->block_count = stream->depth;
+EXIT:
+    pthread_mutex_unlock(&stream->lock);
+
+    return ret;
+}
+
+int ADec_StreamQueueInput(u32 ulHandle, audio_mem_info_t* pInputInfo)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    struct stream_slot *slot;
+    int ret = 0;
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->in_queued >= stream->depth) {
+        ret = SEIREN_ERROR_IBUF_OVERFLOW;
+        goto EXIT;
+    }
+
+    slot = &stream->in_slot[(stream->in_head + stream->in_queued) % stream->depth];
+    if (pInputInfo->virt_addr != slot->addr || pInputInfo->data_size > stream->ibuf_size) {
+        ALOGE("%s: invalid input buffer %p, size %u", __func__,
+               pInputInfo->virt_addr, pInputInfo->data_size);
+        ret = SEIREN_ERROR_INVALID_SETTING;
+        goto EXIT;
+    }
+
+    if (pInputInfo->data_size > 0) {
+        /* input after a delivered EOS starts the next stream, e.g. repeating a song */
+        stream->eos_sent = 0;
+        slot->size = pInputInfo->data_size;
+        slot->offset = 0;
+        stream->in_queued++;
+        ADec_streamPump(ulHandle, stream);
+    }
+
+    ALOGV("%s: handle:%d, size:%d, queued:%u", __func__,
+           ulHandle, pInputInfo->data_size, stream->in_queued);
+EXIT:
+    pthread_mutex_unlock(&stream->lock);
+
+    return ret;
+}
+
+int ADec_StreamDequeuePCM(u32 ulHandle, audio_mem_info_t* pOutputInfo)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    struct stream_slot *slot;
+    int ret = 0;
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->out_filled <= stream->out_held)
+        ADec_streamPump(ulHandle, stream);
+
+    if (stream->out_filled <= stream->out_held) {
+        pOutputInfo->data_size = 0;
+        ret = SEIREN_ERROR_NOT_READY;
+        goto EXIT;
+    }
+
+    slot = &stream->out_slot[(stream->out_head + stream->out_held) % stream->depth];
+    stream->out_held++;
+
+    pOutputInfo->virt_addr = slot->addr;
+    pOutputInfo->mem_size = stream->obuf_size;
+    pOutputInfo->data_size = slot->size;
+    pOutputInfo->block_count = stream->depth;
+
+    ALOGV("%s: handle:%d, pcm_size:%d", __func__, ulHandle, pOutputInfo->data_size);
+EXIT:
+    pthread_mutex_unlock(&stream->lock);
+
+    return ret;
+}
+
+int ADec_StreamReleasePCM(u32 ulHandle, audio_mem_info_t* pOutputInfo)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    struct stream_slot *slot;
+    int ret = 0;
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    slot = &stream->out_slot[stream->out_head];
+    if (stream->out_held == 0 || pOutputInfo->virt_addr != slot->addr) {
+        ALOGE("%s: PCM buffer %p is not the oldest one", __func__, pOutputInfo->virt_addr);
+        ret = SEIREN_ERROR_INVALID_SETTING;
+        goto EXIT;
+    }
+
+    slot->size = 0;
+    stream->out_head = (stream->out_head + 1) % stream->depth;
+    stream->out_filled--;
+    stream->out_held--;
+EXIT:
+    pthread_mutex_unlock(&stream->lock);
+
+    return ret;
+}
+
+int ADec_StreamSendEOS(u32 ulHandle)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->eos_pending = 1;
+    stream->eos_sent = 0;
+    ADec_streamPump(ulHandle, stream);
+    pthread_mutex_unlock(&stream->lock);
+
+    return 0;
+}
+
+int ADec_StreamFlush(u32 ulHandle, SEIREN_PORTTYPE portType)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    u32 i;
+
+    if (stream == NULL)
+        return -1;
+
+    pthread_mutex_lock(&stream->lock);
+    if (portType == PORT_IN) {
+        for (i = 0; i < stream->depth; i++)
+            stream->in_slot[i].size = stream->in_slot[i].offset = 0;
+        stream->in_head = 0;
+        stream->in_queued = 0;
+        stream->eos_pending = 0;
+        stream->eos_sent = 0;
+    } else {
+        /* PCM which the caller still holds stays valid until it is released */
+        stream->out_filled = stream->out_held;
+    }
+    stream->error = 0;
+    ADec_Flush(ulHandle, portType);
+    pthread_mutex_unlock(&stream->lock);
+
+    return 0;
+}
+
+int ADec_StreamWait(u32 ulHandle, int timeout_ms, u32* pulEvents)
+{
+    struct stream_info *stream = ADec_getStream(ulHandle);
+    struct pollfd pfd;
+    u32 wanted;
+    int ret;
+
+    if (stream == NULL)
+        return -1;
+
+    wanted = *pulEvents | ADEC_STREAM_EVENT_ERROR;
+
+    pthread_mutex_lock(&stream->lock);
+    ADec_streamPump(ulHandle, stream);
+    *pulEvents = ADec_streamEvents(stream) & wanted;
+
+    pfd.fd = ulHandle;
+    pfd.events = 0;
+    pfd.revents = 0;
+    if (stream->in_queued > 0 || stream->eos_pending)
+        pfd.events |= POLLOUT | POLLWRNORM;
+    if (stream->out_filled < stream->depth)
+        pfd.events |= POLLIN | POLLRDNORM;
+    pthread_mutex_unlock(&stream->lock);
+
+    if (*pulEvents != ADEC_STREAM_EVENT_NONE || pfd.events == 0)
+        return 0;
+
+    /* the only sleep of the stream, it is woken by whichever direction gets ready first */
+    ret = poll(&pfd, 1, timeout_ms);
+    if (ret < 0) {
+        if (errno == EINTR)
+            return 0;
+        ALOGE("%s: poll failed: %s", __func__, strerror(errno));
+        return SEIREN_ERROR_NOT_READY;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        ALOGE("%s: poll revents 0x%x", __func__, pfd.revents);
+        stream->error = SEIREN_ERROR_NOT_READY;
+    }
+    if (ret > 0)
+        ADec_streamPump(ulHandle, stream);
+    *pulEvents = ADec_streamEvents(stream) & wanted;
+    pthread_mutex_unlock(&stream->lock);
+
+    return 0;
+}
@@ -116,6 +116,31 @@ typedef struct audio_pcm_config_info_t {
     u32 nNumOfChannel;
 } audio_pcm_config_info_t;
 
+/*
+ * Streaming interface
+ *
+ * ADec_StreamOpen() puts the channel in non-blocking mode and allocates 'depth' input
+ * and output slots of the pool block size. The caller fills free input slots and
+ * queues them, ADec_StreamWait() sleeps in a single poll() for both directions and
+ * then writes queued input and reads PCM into free output slots as far as the driver
+ * allows, so input stays queued while PCM drains. Filled PCM slots are dequeued by
+ * the caller and given back with ADec_StreamReleasePCM() in the same order.
+ *
+ * ADec_StreamWait() takes the ADEC_STREAM_EVENT mask the caller waits for in
+ * *pulEvents and returns the ones which are set, it does not sleep if one of them
+ * is set already. ADec_StreamSendEOS() issues EOS after the queued input is written.
+ */
+#define ADEC_STREAM_MIN_DEPTH            2
+#define ADEC_STREAM_MAX_DEPTH            8
+
+typedef enum {
+    ADEC_STREAM_EVENT_NONE   = 0x0,
+    ADEC_STREAM_EVENT_INPUT  = 0x1,    // free input slot is available
+    ADEC_STREAM_EVENT_OUTPUT = 0x2,    // decoded PCM is available
+    ADEC_STREAM_EVENT_EOS    = 0x4,    // EOS was delivered to the driver
+    ADEC_STREAM_EVENT_ERROR  = 0x8,
+} ADEC_STREAM_EVENT;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -134,6 +159,16 @@ int ADec_GetPCMParams(u32 ulHandle, u32 *pulValues);
 int ADec_GetIMemPoolInfo(u32 ulHandle, audio_mem_info_t* pIMemPoolInfo);
 int ADec_GetOMemPoolInfo(u32 ulHandle, audio_mem_info_t* pOMemPoolInfo);
 
+int ADec_StreamOpen(u32 ulHandle, u32 depth);
+int ADec_StreamClose(u32 ulHandle);
+int ADec_StreamGetInputBuffer(u32 ulHandle, audio_mem_info_t* pInputInfo);
+int ADec_StreamQueueInput(u32 ulHandle, audio_mem_info_t* pInputInfo);
+int ADec_StreamDequeuePCM(u32 ulHandle, audio_mem_info_t* pOutputInfo);
+int ADec_StreamReleasePCM(u32 ulHandle, audio_mem_info_t* pOutputInfo);
+int ADec_StreamSendEOS(u32 ulHandle);
+int ADec_StreamFlush(u32 ulHandle, SEIREN_PORTTYPE portType);
+int ADec_StreamWait(u32 ulHandle, int timeout_ms, u32* pulEvents);
+
 #ifdef __cplusplus
 }
 #endif
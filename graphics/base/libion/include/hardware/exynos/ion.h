@@ -65,6 +65,8 @@ int exynos_ion_sync_fd_partial(int ion_fd, int fd, off_t offset, size_t len);
 
 int exynos_ion_sync_start(int ion_fd, int fd, int direction);
 int exynos_ion_sync_end(int ion_fd, int fd, int direction);
+int exynos_ion_sync_start_partial(int ion_fd, int fd, int direction, off_t offset, size_t len);
+int exynos_ion_sync_end_partial(int ion_fd, int fd, int direction, off_t offset, size_t len);
 
 const char *exynos_ion_get_heap_name(unsigned int legacy_heap_id);
 
@@ -406,3 +406,33 @@ int exynos_ion_sync_start(int ion_fd, int fd, int direction) {
 int exynos_ion_sync_end(int ion_fd, int fd, int direction) {
     return exynos_ion_sync(ion_fd, fd, direction, DMA_BUF_SYNC_END);
 }
+
+/*
+ * Range-limited and direction-aware variants of exynos_ion_sync_start/end.
+ * Legacy ION maintains only @len bytes from @offset and skips maintenance
+ * that the direction does not need: invalidation before CPU reads and
+ * cleaning after CPU writes. DMA_BUF_IOCTL_SYNC has no range, so modern ION
+ * passes the direction to the exporter for the whole buffer.
+ * @len of 0 selects the whole buffer.
+ */
+static int exynos_ion_sync_partial(int ion_fd, int fd, int direction, int sync,
+                                   off_t offset, size_t len) {
+    if (!ion_is_legacy(ion_fd))
+        return exynos_ion_sync(ion_fd, fd, direction, sync);
+
+    if (!(direction & ((sync == DMA_BUF_SYNC_START) ? ION_SYNC_READ : ION_SYNC_WRITE)))
+        return 0;
+
+    if (len == 0)
+        return exynos_ion_sync_fd(ion_fd, fd);
+
+    return exynos_ion_sync_fd_partial(ion_fd, fd, offset, len);
+}
+
+int exynos_ion_sync_start_partial(int ion_fd, int fd, int direction, off_t offset, size_t len) {
+    return exynos_ion_sync_partial(ion_fd, fd, direction, DMA_BUF_SYNC_START, offset, len);
+}
+
+int exynos_ion_sync_end_partial(int ion_fd, int fd, int direction, off_t offset, size_t len) {
+    return exynos_ion_sync_partial(ion_fd, fd, direction, DMA_BUF_SYNC_END, offset, len);
+}
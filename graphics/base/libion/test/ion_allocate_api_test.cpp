@@ -122,3 +122,36 @@ TEST_F(AllocateAPI, Allocate)
         }
     }
 }
+
+TEST_F(AllocateAPI, SyncPartial)
+{
+    static const size_t size = mb(1);
+    static const struct {
+        off_t offset;
+        size_t len;
+    } ranges[] = {
+        {0, 0}, {0, kb(4)}, {kb(4), kb(64)}, {static_cast<off_t>(size - kb(4)), kb(4)},
+    };
+    static const int directions[] = {
+        ION_SYNC_READ, ION_SYNC_WRITE, ION_SYNC_READ | ION_SYNC_WRITE,
+    };
+
+    int fd = exynos_ion_alloc(getIonFd(), size, EXYNOS_ION_HEAP_SYSTEM_MASK, ION_FLAG_CACHED);
+    ASSERT_LE(0, fd) << ": " << strerror(errno);
+
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ASSERT_NE(MAP_FAILED, p) << ": " << strerror(errno);
+
+    for (int direction : directions) {
+        for (auto range : ranges) {
+            SCOPED_TRACE(::testing::Message() << "direction: " << direction << ", offset: " << range.offset << ", len: " << range.len);
+
+            EXPECT_EQ(0, exynos_ion_sync_start_partial(getIonFd(), fd, direction, range.offset, range.len));
+            memset(reinterpret_cast<char *>(p) + range.offset, 0xA5, range.len);
+            EXPECT_EQ(0, exynos_ion_sync_end_partial(getIonFd(), fd, direction, range.offset, range.len));
+        }
+    }
+
+    EXPECT_EQ(0, munmap(p, size));
+    EXPECT_EQ(0, close(fd));
+}
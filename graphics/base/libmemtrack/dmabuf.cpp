@@ -1,10 +1,11 @@
-#include <fstream>
-#include <sstream>
-#include <regex>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
-#include <algorithm>
 
 #include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <sys/stat.h>
 
 #include <hardware/memtrack.h>
@@ -30,61 +31,242 @@ struct DmabufBuffer {
     DmabufBuffer(unsigned int _id, size_t _size, size_t _pss)
         : id(_id), type(MEMTRACK_FLAG_SMAPS_UNACCOUNTED | MEMTRACK_FLAG_SHARED_PSS), size(_size), pss(_pss)
     { }
-    void setPoolType(string _type) { type |= (_type == "carveout") ? MEMTRACK_FLAG_DEDICATED : MEMTRACK_FLAG_SYSTEM; }
+    void setPoolType(bool dedicated) { type |= dedicated ? MEMTRACK_FLAG_DEDICATED : MEMTRACK_FLAG_SYSTEM; }
     void setFlags(unsigned int flags) { type |= (flags & ION_FLAG_PROTECTED) ? MEMTRACK_FLAG_SECURE : MEMTRACK_FLAG_NONSECURE; }
 };
 
+/*
+ * Minimal line scanners used instead of std::regex. They work in place on
+ * the line buffer, so parsing a debugfs line never allocates memory.
+ */
+static inline const char *skip_spaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+static inline const char *skip_token(const char *p)
+{
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\n')
+        p++;
+    return p;
+}
+
+static const char *parse_decimal(const char *p, unsigned long &val)
+{
+    if (*p < '0' || *p > '9')
+        return nullptr;
+
+    for (val = 0; *p >= '0' && *p <= '9'; p++)
+        val = val * 10 + (*p - '0');
+
+    return p;
+}
+
+static const char *parse_hex(const char *p, unsigned long &val)
+{
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        p += 2;
+
+    const char *start = p;
+
+    for (val = 0; ; p++) {
+        if (*p >= '0' && *p <= '9')
+            val = (val << 4) | (*p - '0');
+        else if (*p >= 'a' && *p <= 'f')
+            val = (val << 4) | (*p - 'a' + 10);
+        else if (*p >= 'A' && *p <= 'F')
+            val = (val << 4) | (*p - 'A' + 10);
+        else
+            break;
+    }
+
+    return (p == start) ? nullptr : p;
+}
+
+/*
+ * Reads one line into @line. The rest of a line longer than the buffer is
+ * discarded so that its tail is never mistaken for the start of a new line.
+ */
+static bool read_line(FILE *fp, char *line, size_t len)
+{
+    if (!fgets(line, len, fp))
+        return false;
+
+    if (!strchr(line, '\n')) {
+        int c;
+        while ((c = fgetc(fp)) != EOF && c != '\n')
+            ;
+    }
+
+    return true;
+}
+
+// exp_name      size     share
+// ion-102   69271552  34635776
+static bool parse_footprint_line(const char *p, unsigned long &id, unsigned long &size, unsigned long &pss)
+{
+    p = skip_spaces(p);
+    if (strncmp(p, "ion-", 4))
+        return false;
+
+    p = parse_decimal(p + 4, id);
+    if (!p || (*p != ' ' && *p != '\t'))
+        return false;
+
+    p = parse_decimal(skip_spaces(p), size);
+    if (!p || (*p != ' ' && *p != '\t'))
+        return false;
+
+    return parse_decimal(skip_spaces(p), pss) != nullptr;
+}
+
 const char DMABUF_FOOTPRINT_PATH[] = "/sys/kernel/debug/dma_buf/footprint/";
 static bool build_dmabuf_footprint(vector<DmabufBuffer> &buffers, pid_t pid)
 {
-    ostringstream dmabuf_path;
-    dmabuf_path << DMABUF_FOOTPRINT_PATH << pid;
+    char path[64];
+    char line[256];
+
+    snprintf(path, sizeof(path), "%s%d", DMABUF_FOOTPRINT_PATH, pid);
+
+    FILE *fp = fopen(path, "re");
+    if (!fp)
+        return false;
+
+    unsigned long id, size, pss;
+
+    while (read_line(fp, line, sizeof(line)))
+        if (parse_footprint_line(line, id, size, pss))
+            buffers.emplace_back(id, size, pss);
+
+    fclose(fp);
+
+    return true;
+}
+
+struct IonBufferInfo {
+    unsigned int flags;
+    size_t size;
+    bool dedicated;
+};
+
+// [  id]            heap heaptype flags size(kb) : iommu_mapped...
+// [ 106] ion_system_heap   system  0x40    16912 : 19080000.dsim(0)
+static bool parse_ion_buffer_line(const char *p, unsigned long &id, IonBufferInfo &info)
+{
+    unsigned long val;
 
-    ifstream dmabuf(dmabuf_path.str());
-    if (!dmabuf)
+    if (*p++ != '[')
         return false;
-    //
-    // exp_name      size     share
-    // ion-102   69271552  34635776
-    regex rex("\\s*ion-(\\d+)\\s+(\\d+)\\s+(\\d+).*");
-    smatch mch;
-    // 1-id, 2-size, 3-pss
-    for (string line; getline(dmabuf, line); )
-        if (regex_match(line, mch, rex))
-            buffers.emplace_back(stoul(mch[1], 0, 10), stoul(mch[2], 0, 10), stoul(mch[3], 0, 10));
+
+    p = parse_decimal(skip_spaces(p), id);
+    if (!p || *p++ != ']')
+        return false;
+
+    // heap name
+    const char *tok = skip_spaces(p);
+    p = skip_token(tok);
+    if (p == tok)
+        return false;
+
+    // heap type
+    tok = skip_spaces(p);
+    p = skip_token(tok);
+    if (p == tok)
+        return false;
+    info.dedicated = (p - tok == 8) && !strncmp(tok, "carveout", 8);
+
+    p = parse_hex(skip_spaces(p), val);
+    if (!p)
+        return false;
+    info.flags = static_cast<unsigned int>(val);
+
+    p = parse_decimal(skip_spaces(p), val);
+    if (!p)
+        return false;
+    info.size = val * 1024;
 
     return true;
 }
 
+/*
+ * Snapshot of /sys/kernel/debug/ion/buffers indexed by buffer id.
+ * dumpsys meminfo queries every process back to back, so the table is parsed
+ * once and then reused by all queries that arrive within the snapshot period.
+ */
 const char ION_BUFFERS_PATH[] = "/sys/kernel/debug/ion/buffers";
+#define ION_SNAPSHOT_PERIOD chrono::milliseconds(1000)
+
+class IonBufferSnapshot {
+public:
+    IonBufferSnapshot() : mValid(false) { }
+
+    template <typename Func>
+    bool access(Func func)
+    {
+        lock_guard<mutex> lock(mLock);
+
+        auto now = chrono::steady_clock::now();
+        if (!mValid || (now - mTimestamp) > ION_SNAPSHOT_PERIOD) {
+            mValid = reload();
+            mTimestamp = now;
+        }
+
+        if (!mValid)
+            return false;
+
+        func(mBuffers);
+
+        return true;
+    }
+
+private:
+    bool reload()
+    {
+        FILE *fp = fopen(ION_BUFFERS_PATH, "re");
+        if (!fp)
+            return false;
+
+        char line[256];
+        unsigned long id;
+        IonBufferInfo info;
+
+        mBuffers.clear();
+
+        while (read_line(fp, line, sizeof(line)))
+            if (parse_ion_buffer_line(line, id, info))
+                mBuffers[static_cast<unsigned int>(id)] = info;
+
+        fclose(fp);
+
+        return true;
+    }
+
+    mutex mLock;
+    bool mValid;
+    chrono::steady_clock::time_point mTimestamp;
+    unordered_map<unsigned int, IonBufferInfo> mBuffers;
+};
+
+static IonBufferSnapshot ion_snapshot;
+
 static bool complete_dmabuf_footprint(int type, vector<DmabufBuffer> &buffers)
 {
-    ifstream ion(ION_BUFFERS_PATH);
-    if (!ion)
-        return false;
+    return ion_snapshot.access([type, &buffers] (const unordered_map<unsigned int, IonBufferInfo> &table) {
+        for (auto &item: buffers) {
+            auto elem = table.find(item.id);
+            if ((elem == table.end()) || (elem->second.size != item.size))
+                continue;
 
-    // [  id]            heap heaptype flags size(kb) : iommu_mapped...
-    // [ 106] ion_system_heap   system  0x40    16912 : 19080000.dsim(0)
-    regex rexion("\\[ *(\\d+)\\] +[[:alnum:]\\-_]+ +(\\w+) +([x[:xdigit:]]+) +(\\d+).*");
-    smatch mch;
-    // 1-id, 2-heaptype, 3-flags, 4-size
-    for (string line; getline(ion, line); ) {
-        if (regex_match(line, mch, rexion)) {
-            unsigned int id = stoul(mch[1], 0, 10);
-            unsigned int flags = stoul(mch[3], 0, 16);
-            size_t len = stoul(mch[4], 0, 10) * 1024;
-            auto elem = find_if(begin(buffers), end(buffers), [id, len] (auto &item) {
-                                    return (item.id == id) && (item.size == len);
-                                });
+            const IonBufferInfo &info = elem->second;
             // passes if type = OTHER && not flag & hwrender or type == GRAPHIC && flag & hwrender
-            if ((elem != end(buffers)) && ((type == MEMTRACK_TYPE_OTHER) == !(flags & ION_FLAG_MAY_HWRENDER))) {
-                elem->setFlags(flags);
-                elem->setPoolType(mch[2]);
+            if ((type == MEMTRACK_TYPE_OTHER) == !(info.flags & ION_FLAG_MAY_HWRENDER)) {
+                item.setFlags(info.flags);
+                item.setPoolType(info.dedicated);
             }
         }
-    }
-
-    return true;
+    });
 }
 
 int dmabuf_memtrack_get_memory(pid_t pid, int type, struct memtrack_record *records, size_t *num_records)
@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <log/log.h>
@@ -29,19 +30,18 @@
 #include <sys/types.h>
 #include <dirent.h>
 
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 /* Some general defines. */
 #define MALI_DEBUG_FS_PATH 		"/d/mali/mem/"
 #define MALI_DEBUG_MEM_FILE		"/mem_profile"
 
-#define MAX_FILES_PER_PID 		8
-// strlen(MALI_DEBUG_FS_PATH) = 12
-// strlen(MALI_DEBUG_MEM_FILE) = 12
-// max pid len = 5 (0 ~ 65535)
-// max pid suffix len = 5 (5 digits)
-// + underscore between pid and suffix
-#define MAX_FILES_PER_NAME		36
-static int libmemtrack_gbl_input_filename_counter = 	0;
-static char libmemtrack_gbl_input_filename[MAX_FILES_PER_PID][MAX_FILES_PER_NAME];
+/* The directory index is rescanned at most once per this period. */
+#define MALI_INDEX_PERIOD		std::chrono::milliseconds(1000)
 
 #define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
 #define min(x, y) ((x) < (y) ? (x) : (y))
@@ -59,167 +59,169 @@ struct memtrack_record record_templates[] = {
     },
 };
 
-static void scan_directory_for_filenames(pid_t pid)
+/*
+ * Index of the Mali debugfs directory: pid -> mem_profile paths.
+ * As per ARM, there can be multiple entries (<pid>_<suffix>) per process.
+ * The index is shared by all callers and guarded by mali_index_lock;
+ * callers copy the paths of their pid out and read the files unlocked.
+ */
+static std::mutex mali_index_lock;
+static std::unordered_map<pid_t, std::vector<std::string>> mali_index;
+static std::chrono::steady_clock::time_point mali_index_timestamp;
+static bool mali_index_valid = false;
+
+static void scan_directory_locked(void)
 {
-    /* As per ARM, there can be multiple files */
     DIR *directory;
     struct dirent *entries;
-    char pid_string[12] = {0};
-    int pid_len;
+
+    mali_index.clear();
 
     /* Open directory. */
     directory = opendir(MALI_DEBUG_FS_PATH);
-
-    pid_len = snprintf(pid_string, sizeof(pid_string), "%d_", pid);
-
-    libmemtrack_gbl_input_filename_counter = 0;
-
-    if (directory != NULL) {
-        /* Keep reading the directory. */
-        while ((entries = readdir(directory))) {
-            /* Check if the PID is present in the direcotry entry.
-             * If it is present, then keep the filename for reading
-             * contents. Also concatenate the directory path, so that
-             * file can be opened.
-             * */
-            if (!strncmp(entries->d_name, pid_string, pid_len)) {
-                snprintf(libmemtrack_gbl_input_filename[libmemtrack_gbl_input_filename_counter], MAX_FILES_PER_NAME, "%s%s%s", MALI_DEBUG_FS_PATH, entries->d_name, MALI_DEBUG_MEM_FILE);
-                libmemtrack_gbl_input_filename_counter++;
-            }
-        }
-        /* Close directory before leaving. */
-        (void) closedir(directory);
-    } else {
+    if (directory == NULL) {
         ALOGE("libmemtrack-hw -- Couldn't open the directory - %s \r\n", MALI_DEBUG_FS_PATH);
+        return;
+    }
+
+    /* Keep reading the directory. */
+    while ((entries = readdir(directory))) {
+        char *end;
+        long pid = strtol(entries->d_name, &end, 10);
+
+        /* Only <pid>_<suffix> entries carry a memory profile. */
+        if ((end == entries->d_name) || (*end != '_') || (pid <= 0))
+            continue;
+
+        std::string path(MALI_DEBUG_FS_PATH);
+        path += entries->d_name;
+        path += MALI_DEBUG_MEM_FILE;
+        mali_index[static_cast<pid_t>(pid)].push_back(std::move(path));
     }
 
-    return;
+    /* Close directory before leaving. */
+    (void) closedir(directory);
 }
 
-int mali_memtrack_get_memory(pid_t pid, int __unused type,
-                             struct memtrack_record *records,
-                             size_t *num_records)
+static void refresh_directory_index_locked(void)
 {
-    size_t allocated_records = min(*num_records, ARRAY_SIZE(record_templates));
-    FILE *fp;
-    int local_count;
-    long long int temp_val = 0, total_memory_size = 0, native_buf_mem_size = 0;
+    auto now = std::chrono::steady_clock::now();
+
+    if (!mali_index_valid || (now - mali_index_timestamp) > MALI_INDEX_PERIOD) {
+        scan_directory_locked();
+        mali_index_timestamp = now;
+        mali_index_valid = true;
+    }
+}
+
+static void lookup_filenames_locked(pid_t pid, std::vector<std::string> &filenames)
+{
+    auto elem = mali_index.find(pid);
+
+    filenames.clear();
+    if (elem != mali_index.end())
+        filenames = elem->second;
+}
+
+static void read_mem_profile(FILE *fp, long long int *total_memory_size,
+                             long long int *native_buf_mem_size)
+{
+    long long int temp_val = 0;
     bool native_buffer_read = false;
     char line[1024] = {0};
 
-    *num_records = ARRAY_SIZE(record_templates);
+    while (1) {
+        char memory_type[16] = {0};
+        char memory_type_2[16] = {0};
+        int ret = 0;
+
+        if (native_buffer_read == false) {
+            if (fgets(line, sizeof(line), fp) == NULL) {
+                /* Unable to read Native buffer.
+                 * Probably DDK doesn't support Native Buffer.
+                 * Reset to start of file and look for Total
+                 * Memory. */
+                fseek(fp, 0, SEEK_SET);
+
+                /* Also, set Native buffer flag and memory sizes. */
+                native_buffer_read = true;
+                continue;
+            }
 
-    /* fastpath to return the necessary number of records */
-    if (allocated_records == 0) {
-        return 0;
-    }
+            /* Search for Total memory. */
+            /* Format:
+             *
+             * Channel: Native Buffer (Total memory: 44285952)
+             *
+             */
+            ret = sscanf(line, "%*s %15s %15s %*s %*s %lld \n", memory_type, memory_type_2, &temp_val);
+
+            if (ret != 3)
+                continue;
+
+            if ((strcmp(memory_type, "Native") == 0) &&
+                    (strcmp(memory_type_2, "Buffer") == 0)) {
+                /* Set native buffer memory read flag to true. */
+                native_buffer_read = true;
+                if ((INT64_MAX - temp_val) > *native_buf_mem_size)
+                    *native_buf_mem_size += temp_val;
+                else
+                    *native_buf_mem_size = INT64_MAX;
+            } else {
+                /* Ignore case. Nothing to do here. */
+                /* Continue reading file until NativeBuffer is found. */
+            }
+        } else {
+            if (fgets(line, sizeof(line), fp) == NULL) {
+                /* Unable to find, so break the loop here.*/
+                break;
+            }
+
+            /* Search for Total memory. */
+            /* Format:
+             *
+             * Total allocated memory: 36146960
+             *
+             */
+            ret = sscanf(line, "%15s %*s %*s %lld \n", memory_type, &temp_val);
+
+            if (ret != 2)
+                continue;
+
+            if (strcmp(memory_type, "Total") == 0) {
+                /* Store total memory. */
+                if ((INT64_MAX - temp_val) > *total_memory_size)
+                    *total_memory_size += temp_val;
+                else
+                    *total_memory_size = INT64_MAX;
+            } else {
+                /* Ignore case. Nothing to do here. */
+            }
+        } /* end if (native_buffer_read == false) */
+    } /* End while(1) */
+}
+
+static void fill_records(const std::vector<std::string> &filenames,
+                         struct memtrack_record *records,
+                         size_t allocated_records)
+{
+    long long int total_memory_size = 0, native_buf_mem_size = 0;
 
     memcpy(records, record_templates,
            sizeof(struct memtrack_record) * allocated_records);
 
-    /* First, scan the directoy. */
-    scan_directory_for_filenames(pid);
+    for (auto &filename : filenames) {
+        FILE *fp = fopen(filename.c_str(), "r");
 
-    local_count = 0;
-    total_memory_size = 0;
-    native_buf_mem_size = 0;
+        /* Unable to open the file. Move to next file. */
+        if (fp == NULL)
+            continue;
 
-    while (local_count < libmemtrack_gbl_input_filename_counter) {
-        fp = fopen(&libmemtrack_gbl_input_filename[local_count][0], "r");
+        read_mem_profile(fp, &total_memory_size, &native_buf_mem_size);
 
-        if (fp == NULL) {
-            /* Unable to open the file. Either move to next file, or
-             * return to caller. */
-            local_count++;
-            continue;
-        }
-
-        while (1) {
-            char memory_type[16] = {0};
-            char memory_type_2[16] = {0};
-            int ret = 0;
-
-            if (native_buffer_read == false) {
-                if (fgets(line, sizeof(line), fp) == NULL) {
-                    if (native_buffer_read == false) {
-                        /* Unable to read Native buffer.
-                         * Probably DDK doesn't support Native Buffer.
-                         * Reset to start of file and look for Total
-                         * Memory. */
-                        fseek(fp, 0, SEEK_SET);
-
-                        /* Also, set Native buffer flag and memory sizes. */
-                        native_buffer_read = true;
-                        continue;
-                    }
-                }
-
-                /* Search for Total memory. */
-                /* Format:
-                 *
-                 * Channel: Native Buffer (Total memory: 44285952)
-                 *
-                 */
-                ret = sscanf(line, "%*s %15s %15s %*s %*s %lld \n", memory_type, memory_type_2, &temp_val);
-
-                if (ret != 3)
-                    continue;
-
-                if ((strcmp(memory_type, "Native") == 0) &&
-                        (strcmp(memory_type_2, "Buffer") == 0)) {
-                    /* Set native buffer memory read flag to true. */
-                    native_buffer_read = true;
-                    if ((INT64_MAX - temp_val) > native_buf_mem_size)
-                        native_buf_mem_size += temp_val;
-                    else
-                        native_buf_mem_size = INT64_MAX;
-                } else {
-                    /* Ignore case. Nothing to do here. */
-                    /* Continue reading file until NativeBuffer is found. */
-                }
-            } else {
-                if (fgets(line, sizeof(line), fp) == NULL) {
-                    /* Unable to find, so break the loop here.*/
-                    break;
-                }
-
-                /* Search for Total memory. */
-                /* Format:
-                 *
-                 * Total allocated memory: 36146960
-                 *
-                 */
-                ret = sscanf(line, "%15s %*s %*s %lld \n", memory_type, &temp_val);
-
-                if (ret != 2)
-                    continue;
-
-                if (strcmp(memory_type, "Total") == 0) {
-                    /* Store total memory. */
-                    if ((INT64_MAX - temp_val) > total_memory_size)
-                        total_memory_size += temp_val;
-                    else
-                        total_memory_size = INT64_MAX;
-                } else {
-                    /* Ignore case. Nothing to do here. */
-                }
-            } /* end if (native_buffer_read == false) */
-
-        } /* End while(1) */
-
-        if (fp != NULL) {
-            /* Close the opened file. */
-            fclose(fp);
-
-            /* Reset some of the local variables here. */
-            fp = NULL;
-            native_buffer_read = false;
-        }
-
-        /* Manage local variables and counters. */
-        local_count++;
-
-    } /* while (local_count <= libmemtrack_gbl_input_filename_counter) */
+        /* Close the opened file. */
+        fclose(fp);
+    }
 
     /* Arrange and return memory size details. */
     if (allocated_records > 0)
@@ -232,6 +234,30 @@ int mali_memtrack_get_memory(pid_t pid, int __unused type,
         else
             records[1].size_in_bytes = 0;
     }
+}
+
+int mali_memtrack_get_memory(pid_t pid, int __unused type,
+                             struct memtrack_record *records,
+                             size_t *num_records)
+{
+    size_t allocated_records = min(*num_records, ARRAY_SIZE(record_templates));
+    std::vector<std::string> filenames;
+
+    *num_records = ARRAY_SIZE(record_templates);
+
+    /* fastpath to return the necessary number of records */
+    if (allocated_records == 0) {
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mali_index_lock);
+
+        refresh_directory_index_locked();
+        lookup_filenames_locked(pid, filenames);
+    }
+
+    fill_records(filenames, records, allocated_records);
 
     return 0;
 }
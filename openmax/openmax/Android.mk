@@ -43,6 +43,7 @@ include $(EXYNOS_OMX_COMPONENT)/video/dec/mpeg4/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/vp8/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/mpeg2/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/vc1/Android.mk
+include $(EXYNOS_OMX_COMPONENT)/video/dec/test/Android.mk
 
 include $(EXYNOS_OMX_COMPONENT)/video/enc/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/enc/h264/Android.mk
@@ -79,3 +80,5 @@ endif
 ifeq ($(BOARD_USE_WMA_CODEC), true)
 include $(EXYNOS_OMX_COMPONENT)/audio/dec/wma/Android.mk
 endif
+
+include $(EXYNOS_OMX_TOP)/benchmark/Android.mk
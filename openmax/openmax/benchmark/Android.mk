@@ -0,0 +1,36 @@
+LOCAL_PATH := $(call my-dir)
+
+# pipeline benchmark, only meaningful on top of the fake MFC device
+ifeq ($(BOARD_USE_FAKE_MFC), true)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	omx_pipeline_benchmark.c
+
+LOCAL_MODULE := omx_pipeline_benchmark
+ifeq ($(BOARD_USES_VENDORIMAGE), true)
+LOCAL_PROPRIETARY_MODULE := true
+endif
+
+LOCAL_CFLAGS :=
+
+LOCAL_SHARED_LIBRARIES := libc libExynosOMX_Core
+
+LOCAL_C_INCLUDES := \
+	$(EXYNOS_OMX_INC)/exynos \
+	$(EXYNOS_OMX_TOP)/core
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_CFLAGS += -DUSE_KHRONOS_OMX_HEADER
+LOCAL_C_INCLUDES += $(EXYNOS_OMX_INC)/khronos
+else
+ifeq ($(BOARD_USE_ANDROID), true)
+LOCAL_HEADER_LIBRARIES := media_plugin_headers
+LOCAL_CFLAGS += -DUSE_ANDROID
+endif
+endif
+
+include $(BUILD_EXECUTABLE)
+endif
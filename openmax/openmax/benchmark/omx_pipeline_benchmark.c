@@ -0,0 +1,723 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        omx_pipeline_benchmark.c
+ * @brief       OMX video pipeline benchmark on the fake MFC
+ * @version     1.0.0
+ * @history
+ *   2019.05.08 : Create
+ */
+
+/*
+ * Pushes a synthetic stream through an Exynos OMX video component and
+ * reports per-stage latency and CPU cost. libExynosVideoApi has to be built
+ * with BOARD_USE_FAKE_MFC, the MFC is then emulated in process with the
+ * latency given by -f, so the numbers are the cost of the OMX and videocodec
+ * layers only.
+ *
+ *   omx_pipeline_benchmark -c OMX.Exynos.AVC.Decoder -n 300 -f "lat=2000,delay=2"
+ *   omx_pipeline_benchmark -c OMX.Exynos.AVC.Encoder -w 1280 -h 720 -r 30
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "Exynos_OMX_Def.h"
+#include "Exynos_OMX_Core.h"
+
+#define BENCH_FAKE_MFC_ENV      "EXYNOS_VIDEO_FAKE_MFC"   /* see ExynosVideo_OSAL_Fake.h */
+#define BENCH_MAX_BUFFERS       32
+#define BENCH_FRAME_INTERVAL    33333   /* us, timestamp step */
+#define BENCH_TIMEOUT           5       /* sec without any progress */
+
+#define INPUT_PORT_INDEX        0
+#define OUTPUT_PORT_INDEX       1
+
+typedef struct _BENCH_PORT {
+    OMX_BUFFERHEADERTYPE   *pBuffers[BENCH_MAX_BUFFERS];
+    OMX_BOOL                bOwned[BENCH_MAX_BUFFERS];  /* held by the component */
+    OMX_U32                 nBuffers;
+    OMX_U32                 returned[BENCH_MAX_BUFFERS];
+    OMX_U32                 nReturned;
+} BENCH_PORT;
+
+typedef struct _BENCH_CONTEXT {
+    OMX_HANDLETYPE          hComponent;
+    OMX_BOOL                bEncoder;
+
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+
+    BENCH_PORT              port[2];
+    OMX_STATETYPE           eState;
+    OMX_U32                 nPortCmdDone;
+    OMX_BOOL                bPortChanged;
+    OMX_BOOL                bEOS;
+    OMX_BOOL                bError;
+
+    OMX_U32                 nFrames;
+    OMX_U32                 nFrameSize;
+    OMX_U32                 nOutFrames;
+    long long              *pETBTime;
+    long long              *pEBDTime;
+    long long              *pFBDTime;
+} BENCH_CONTEXT;
+
+static long long Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((long long)ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+}
+
+static void Bench_InitHeader(OMX_PTR pHeader, OMX_U32 nSize)
+{
+    OMX_VERSIONTYPE *pVersion = (OMX_VERSIONTYPE *)((char *)pHeader + sizeof(OMX_U32));
+
+    memset(pHeader, 0, nSize);
+    *((OMX_U32 *)pHeader) = nSize;
+    pVersion->s.nVersionMajor = VERSIONMAJOR_NUMBER;
+    pVersion->s.nVersionMinor = VERSIONMINOR_NUMBER;
+}
+
+static OMX_ERRORTYPE Bench_EventHandler(
+    OMX_HANDLETYPE  hComponent,
+    OMX_PTR         pAppData,
+    OMX_EVENTTYPE   eEvent,
+    OMX_U32         nData1,
+    OMX_U32         nData2,
+    OMX_PTR         pEventData)
+{
+    BENCH_CONTEXT *pCtx = (BENCH_CONTEXT *)pAppData;
+
+    pthread_mutex_lock(&pCtx->lock);
+
+    switch (eEvent) {
+    case OMX_EventCmdComplete:
+        if (nData1 == OMX_CommandStateSet)
+            pCtx->eState = (OMX_STATETYPE)nData2;
+        else if ((nData1 == OMX_CommandPortDisable) || (nData1 == OMX_CommandPortEnable))
+            pCtx->nPortCmdDone++;
+        break;
+    case OMX_EventError:
+        fprintf(stderr, "component error 0x%x (%u)\n", (unsigned int)nData1, (unsigned int)nData2);
+        pCtx->bError = OMX_TRUE;
+        break;
+    case OMX_EventPortSettingsChanged:
+        if ((nData1 == OUTPUT_PORT_INDEX) &&
+            ((nData2 == 0) || (nData2 == OMX_IndexParamPortDefinition)))
+            pCtx->bPortChanged = OMX_TRUE;
+        break;
+    default:
+        break;
+    }
+
+    pthread_cond_broadcast(&pCtx->cond);
+    pthread_mutex_unlock(&pCtx->lock);
+
+    return OMX_ErrorNone;
+}
+
+static void Bench_ReturnBuffer(BENCH_CONTEXT *pCtx, OMX_U32 nPortIndex, OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    BENCH_PORT *pPort  = &pCtx->port[nPortIndex];
+    OMX_U32     nIndex = (OMX_U32)(unsigned long)pBuffer->pAppPrivate;
+
+    pPort->bOwned[nIndex] = OMX_FALSE;
+    pPort->returned[pPort->nReturned++] = nIndex;
+}
+
+static OMX_ERRORTYPE Bench_EmptyBufferDone(
+    OMX_HANDLETYPE          hComponent,
+    OMX_PTR                 pAppData,
+    OMX_BUFFERHEADERTYPE   *pBuffer)
+{
+    BENCH_CONTEXT *pCtx   = (BENCH_CONTEXT *)pAppData;
+    long long      nNow   = Bench_Now();
+    OMX_U32        nFrame = (OMX_U32)(pBuffer->nTimeStamp / BENCH_FRAME_INTERVAL);
+
+    pthread_mutex_lock(&pCtx->lock);
+
+    if (!(pBuffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG) &&
+        (nFrame < pCtx->nFrames) &&
+        (pCtx->pEBDTime[nFrame] == 0))
+        pCtx->pEBDTime[nFrame] = nNow;
+
+    Bench_ReturnBuffer(pCtx, INPUT_PORT_INDEX, pBuffer);
+
+    pthread_cond_broadcast(&pCtx->cond);
+    pthread_mutex_unlock(&pCtx->lock);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE Bench_FillBufferDone(
+    OMX_HANDLETYPE          hComponent,
+    OMX_PTR                 pAppData,
+    OMX_BUFFERHEADERTYPE   *pBuffer)
+{
+    BENCH_CONTEXT *pCtx   = (BENCH_CONTEXT *)pAppData;
+    long long      nNow   = Bench_Now();
+    OMX_U32        nFrame = (OMX_U32)((pBuffer->nTimeStamp + (BENCH_FRAME_INTERVAL / 2)) / BENCH_FRAME_INTERVAL);
+
+    pthread_mutex_lock(&pCtx->lock);
+
+    if ((pBuffer->nFilledLen > 0) &&
+        !(pBuffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+        pCtx->nOutFrames++;
+        if ((nFrame < pCtx->nFrames) &&
+            (pCtx->pFBDTime[nFrame] == 0))
+            pCtx->pFBDTime[nFrame] = nNow;
+    }
+
+    if (pBuffer->nFlags & OMX_BUFFERFLAG_EOS)
+        pCtx->bEOS = OMX_TRUE;
+
+    Bench_ReturnBuffer(pCtx, OUTPUT_PORT_INDEX, pBuffer);
+
+    pthread_cond_broadcast(&pCtx->cond);
+    pthread_mutex_unlock(&pCtx->lock);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE sBenchCallbacks = {
+    .EventHandler    = Bench_EventHandler,
+    .EmptyBufferDone = Bench_EmptyBufferDone,
+    .FillBufferDone  = Bench_FillBufferDone,
+};
+
+/* waits with the lock held, false on timeout or component error */
+static OMX_BOOL Bench_Wait(BENCH_CONTEXT *pCtx)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += BENCH_TIMEOUT;
+
+    if (pthread_cond_timedwait(&pCtx->cond, &pCtx->lock, &deadline) == ETIMEDOUT) {
+        fprintf(stderr, "timeout\n");
+        return OMX_FALSE;
+    }
+
+    return (pCtx->bError == OMX_TRUE)? OMX_FALSE:OMX_TRUE;
+}
+
+static OMX_BOOL Bench_WaitState(BENCH_CONTEXT *pCtx, OMX_STATETYPE eState)
+{
+    OMX_BOOL bRet = OMX_TRUE;
+
+    pthread_mutex_lock(&pCtx->lock);
+    while ((pCtx->eState != eState) && (bRet == OMX_TRUE))
+        bRet = Bench_Wait(pCtx);
+    pthread_mutex_unlock(&pCtx->lock);
+
+    return bRet;
+}
+
+static OMX_BOOL Bench_WaitPortCmd(BENCH_CONTEXT *pCtx, OMX_U32 nCount)
+{
+    OMX_BOOL bRet = OMX_TRUE;
+
+    pthread_mutex_lock(&pCtx->lock);
+    while ((pCtx->nPortCmdDone < nCount) && (bRet == OMX_TRUE))
+        bRet = Bench_Wait(pCtx);
+    pthread_mutex_unlock(&pCtx->lock);
+
+    return bRet;
+}
+
+static OMX_ERRORTYPE Bench_GetPort(BENCH_CONTEXT *pCtx, OMX_U32 nPortIndex, OMX_PARAM_PORTDEFINITIONTYPE *pPortDef)
+{
+    Bench_InitHeader(pPortDef, sizeof(*pPortDef));
+    pPortDef->nPortIndex = nPortIndex;
+
+    return OMX_GetParameter(pCtx->hComponent, OMX_IndexParamPortDefinition, pPortDef);
+}
+
+static OMX_ERRORTYPE Bench_AllocatePort(BENCH_CONTEXT *pCtx, OMX_U32 nPortIndex)
+{
+    BENCH_PORT                   *pPort = &pCtx->port[nPortIndex];
+    OMX_PARAM_PORTDEFINITIONTYPE  portDef;
+    OMX_ERRORTYPE                 ret   = OMX_ErrorNone;
+    OMX_U32 i;
+
+    ret = Bench_GetPort(pCtx, nPortIndex, &portDef);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    if (portDef.nBufferCountActual > BENCH_MAX_BUFFERS)
+        return OMX_ErrorInsufficientResources;
+
+    pPort->nBuffers  = 0;
+    pPort->nReturned = 0;
+    for (i = 0; i < portDef.nBufferCountActual; i++) {
+        ret = OMX_AllocateBuffer(pCtx->hComponent, &pPort->pBuffers[i], nPortIndex, pCtx, portDef.nBufferSize);
+        if (ret != OMX_ErrorNone)
+            return ret;
+
+        pPort->pBuffers[i]->pAppPrivate = (OMX_PTR)(unsigned long)i;
+        pPort->bOwned[i] = OMX_FALSE;
+        pPort->nBuffers++;
+    }
+
+    return OMX_ErrorNone;
+}
+
+static void Bench_FreePort(BENCH_CONTEXT *pCtx, OMX_U32 nPortIndex)
+{
+    BENCH_PORT *pPort = &pCtx->port[nPortIndex];
+    OMX_U32 i;
+
+    for (i = 0; i < pPort->nBuffers; i++)
+        OMX_FreeBuffer(pCtx->hComponent, nPortIndex, pPort->pBuffers[i]);
+
+    pPort->nBuffers  = 0;
+    pPort->nReturned = 0;
+}
+
+static OMX_ERRORTYPE Bench_FillAll(BENCH_CONTEXT *pCtx)
+{
+    BENCH_PORT    *pPort = &pCtx->port[OUTPUT_PORT_INDEX];
+    OMX_ERRORTYPE  ret   = OMX_ErrorNone;
+    OMX_U32 i;
+
+    pthread_mutex_lock(&pCtx->lock);
+    pPort->nReturned = 0;
+    for (i = 0; i < pPort->nBuffers; i++)
+        pPort->bOwned[i] = OMX_TRUE;
+    pthread_mutex_unlock(&pCtx->lock);
+
+    for (i = 0; (i < pPort->nBuffers) && (ret == OMX_ErrorNone); i++)
+        ret = OMX_FillThisBuffer(pCtx->hComponent, pPort->pBuffers[i]);
+
+    return ret;
+}
+
+/* output port reconfiguration on resolution change */
+static OMX_ERRORTYPE Bench_Reconfigure(BENCH_CONTEXT *pCtx)
+{
+    BENCH_PORT    *pPort = &pCtx->port[OUTPUT_PORT_INDEX];
+    OMX_ERRORTYPE  ret   = OMX_ErrorNone;
+    OMX_U32        nDone = pCtx->nPortCmdDone;
+    OMX_BOOL       bOwned;
+    OMX_U32 i;
+
+    ret = OMX_SendCommand(pCtx->hComponent, OMX_CommandPortDisable, OUTPUT_PORT_INDEX, NULL);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    pthread_mutex_lock(&pCtx->lock);
+    do {
+        bOwned = OMX_FALSE;
+        for (i = 0; i < pPort->nBuffers; i++)
+            bOwned = (pPort->bOwned[i] == OMX_TRUE)? OMX_TRUE:bOwned;
+    } while ((bOwned == OMX_TRUE) && (Bench_Wait(pCtx) == OMX_TRUE));
+    pthread_mutex_unlock(&pCtx->lock);
+
+    Bench_FreePort(pCtx, OUTPUT_PORT_INDEX);
+    if (Bench_WaitPortCmd(pCtx, nDone + 1) != OMX_TRUE)
+        return OMX_ErrorTimeout;
+
+    ret = OMX_SendCommand(pCtx->hComponent, OMX_CommandPortEnable, OUTPUT_PORT_INDEX, NULL);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    ret = Bench_AllocatePort(pCtx, OUTPUT_PORT_INDEX);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    if (Bench_WaitPortCmd(pCtx, nDone + 2) != OMX_TRUE)
+        return OMX_ErrorTimeout;
+
+    return Bench_FillAll(pCtx);
+}
+
+static OMX_ERRORTYPE Bench_SetupPorts(BENCH_CONTEXT *pCtx, OMX_U32 nWidth, OMX_U32 nHeight)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE portDef;
+    OMX_ERRORTYPE                ret = OMX_ErrorNone;
+    OMX_U32 i;
+
+    ret = Bench_GetPort(pCtx, INPUT_PORT_INDEX, &portDef);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    pCtx->bEncoder = (portDef.format.video.eCompressionFormat == OMX_VIDEO_CodingUnused)? OMX_TRUE:OMX_FALSE;
+
+    for (i = INPUT_PORT_INDEX; i <= OUTPUT_PORT_INDEX; i++) {
+        ret = Bench_GetPort(pCtx, i, &portDef);
+        if (ret != OMX_ErrorNone)
+            return ret;
+
+        portDef.format.video.nFrameWidth  = nWidth;
+        portDef.format.video.nFrameHeight = nHeight;
+        portDef.format.video.nStride      = (OMX_S32)nWidth;
+        portDef.format.video.nSliceHeight = nHeight;
+        if (pCtx->bEncoder == OMX_TRUE) {
+            portDef.format.video.xFramerate = (1000000 / BENCH_FRAME_INTERVAL) << 16;
+            portDef.format.video.nBitrate   = 4000000;
+        }
+
+        ret = OMX_SetParameter(pCtx->hComponent, OMX_IndexParamPortDefinition, &portDef);
+        if (ret != OMX_ErrorNone)
+            return ret;
+    }
+
+    /* frame size follows the buffer size the component decided */
+    ret = Bench_GetPort(pCtx, INPUT_PORT_INDEX, &portDef);
+    if (ret != OMX_ErrorNone)
+        return ret;
+
+    if (pCtx->bEncoder == OMX_TRUE)
+        pCtx->nFrameSize = (nWidth * nHeight * 3) / 2;
+
+    if ((pCtx->nFrameSize == 0) || (pCtx->nFrameSize > portDef.nBufferSize))
+        pCtx->nFrameSize = portDef.nBufferSize / 2;
+
+    return OMX_ErrorNone;
+}
+
+/* synthetic input : start code stream for decoders, flat NV12 for encoders */
+static void Bench_FillInput(BENCH_CONTEXT *pCtx, OMX_BUFFERHEADERTYPE *pBuffer, OMX_U32 nFrame)
+{
+    OMX_U8 *pData = pBuffer->pBuffer;
+
+    pBuffer->nOffset    = 0;
+    pBuffer->nFlags     = OMX_BUFFERFLAG_ENDOFFRAME;
+    pBuffer->nTimeStamp = (OMX_TICKS)nFrame * BENCH_FRAME_INTERVAL;
+
+    if (nFrame >= pCtx->nFrames) {
+        pBuffer->nFilledLen = 0;
+        pBuffer->nFlags    |= OMX_BUFFERFLAG_EOS;
+        return;
+    }
+
+    if (pCtx->bEncoder == OMX_TRUE) {
+        memset(pData, (int)(nFrame & 0xff), pCtx->nFrameSize);
+        pBuffer->nFilledLen = pCtx->nFrameSize;
+        return;
+    }
+
+    memset(pData, 0xaa, pCtx->nFrameSize);
+    pData[0] = 0x00;
+    pData[1] = 0x00;
+    pData[2] = 0x00;
+    pData[3] = 0x01;
+    pData[4] = (nFrame == 0)? 0x65:0x41;
+    pBuffer->nFilledLen = pCtx->nFrameSize;
+}
+
+static OMX_ERRORTYPE Bench_QueueInput(BENCH_CONTEXT *pCtx, OMX_U32 nIndex, OMX_U32 *pSent)
+{
+    BENCH_PORT           *pPort   = &pCtx->port[INPUT_PORT_INDEX];
+    OMX_BUFFERHEADERTYPE *pBuffer = pPort->pBuffers[nIndex];
+
+    if ((pCtx->bEncoder == OMX_FALSE) && (*pSent == 0)) {
+        /* codec config first, it does not count as a frame */
+        static const OMX_U8 header[] = {
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x80, 0x1f, 0xda, 0x01, 0x40, 0x16, 0xe8,
+            0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x06, 0xe2,
+        };
+
+        memcpy(pBuffer->pBuffer, header, sizeof(header));
+        pBuffer->nOffset    = 0;
+        pBuffer->nFilledLen = sizeof(header);
+        pBuffer->nTimeStamp = 0;
+        pBuffer->nFlags     = OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_ENDOFFRAME;
+    } else {
+        OMX_U32 nFrame = (pCtx->bEncoder == OMX_TRUE)? *pSent:(*pSent - 1);
+
+        Bench_FillInput(pCtx, pBuffer, nFrame);
+        if (nFrame < pCtx->nFrames)
+            pCtx->pETBTime[nFrame] = Bench_Now();
+    }
+
+    pPort->bOwned[nIndex] = OMX_TRUE;
+    (*pSent)++;
+
+    return OMX_EmptyThisBuffer(pCtx->hComponent, pBuffer);
+}
+
+static int Bench_CompareLL(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void Bench_PrintLatency(const char *pName, long long *pFrom, long long *pTo, OMX_U32 nFrames)
+{
+    long long *pLatency = (long long *)malloc(sizeof(long long) * nFrames);
+    OMX_U32    nCount   = 0;
+    OMX_U32 i;
+
+    if (pLatency == NULL)
+        return;
+
+    for (i = 0; i < nFrames; i++) {
+        if ((pFrom[i] != 0) && (pTo[i] != 0))
+            pLatency[nCount++] = pTo[i] - pFrom[i];
+    }
+
+    if (nCount > 0) {
+        qsort(pLatency, nCount, sizeof(long long), Bench_CompareLL);
+        printf("  %-10s %4u samples  p50 %7lld us  p95 %7lld us  max %7lld us\n", pName, (unsigned int)nCount,
+               pLatency[nCount / 2], pLatency[((nCount * 95) / 100 < nCount)? (nCount * 95) / 100:nCount - 1],
+               pLatency[nCount - 1]);
+    }
+
+    free(pLatency);
+}
+
+static double Bench_Seconds(struct timeval *pTime)
+{
+    return (double)pTime->tv_sec + ((double)pTime->tv_usec / 1E6);
+}
+
+static void Bench_Usage(const char *pName)
+{
+    fprintf(stderr,
+            "usage: %s [-c component] [-n frames] [-w width] [-h height]\n"
+            "          [-s bytes per frame] [-r fps, 0 : as fast as possible]\n"
+            "          [-f fake MFC config, ex. \"lat=3000,delay=2,resize_at=60\"]\n",
+            pName);
+}
+
+int main(int argc, char **argv)
+{
+    BENCH_CONTEXT   ctx;
+    OMX_ERRORTYPE   ret         = OMX_ErrorNone;
+    const char     *pComponent  = "OMX.Exynos.AVC.Decoder";
+    const char     *pFakeConfig = "1";
+    OMX_U32         nWidth      = 1920;
+    OMX_U32         nHeight     = 1080;
+    OMX_U32         nFPS        = 0;
+    OMX_U32         nSent       = 0;
+    OMX_U32         returned[BENCH_MAX_BUFFERS];
+    OMX_U32         nReturned   = 0;
+    OMX_BOOL        bPortChanged;
+    OMX_BOOL        bEOS        = OMX_FALSE;
+    long long       nStart, nEnd;
+    struct rusage   usageStart, usageEnd;
+    int opt;
+    OMX_U32 i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.nFrames = 300;
+
+    while ((opt = getopt(argc, argv, "c:n:w:h:s:r:f:")) != -1) {
+        switch (opt) {
+        case 'c': pComponent  = optarg; break;
+        case 'n': ctx.nFrames = (OMX_U32)atoi(optarg); break;
+        case 'w': nWidth      = (OMX_U32)atoi(optarg); break;
+        case 'h': nHeight     = (OMX_U32)atoi(optarg); break;
+        case 's': ctx.nFrameSize = (OMX_U32)atoi(optarg); break;
+        case 'r': nFPS        = (OMX_U32)atoi(optarg); break;
+        case 'f': pFakeConfig = optarg; break;
+        default:
+            Bench_Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (ctx.nFrames == 0) {
+        Bench_Usage(argv[0]);
+        return 1;
+    }
+
+    /* decoders report the stream resolution through the fake, keep it consistent */
+    {
+        char sConfig[256];
+
+        snprintf(sConfig, sizeof(sConfig), "w=%u,h=%u,%s",
+                 (unsigned int)nWidth, (unsigned int)nHeight, pFakeConfig);
+        setenv(BENCH_FAKE_MFC_ENV, sConfig, 1);
+    }
+
+    ctx.pETBTime = (long long *)calloc(ctx.nFrames, sizeof(long long));
+    ctx.pEBDTime = (long long *)calloc(ctx.nFrames, sizeof(long long));
+    ctx.pFBDTime = (long long *)calloc(ctx.nFrames, sizeof(long long));
+    if ((ctx.pETBTime == NULL) || (ctx.pEBDTime == NULL) || (ctx.pFBDTime == NULL)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    pthread_mutex_init(&ctx.lock, NULL);
+    pthread_cond_init(&ctx.cond, NULL);
+    ctx.eState = OMX_StateLoaded;
+
+    ret = Exynos_OMX_Init();
+    if (ret != OMX_ErrorNone) {
+        fprintf(stderr, "Exynos_OMX_Init: 0x%x\n", ret);
+        return 1;
+    }
+
+    ret = Exynos_OMX_GetHandle(&ctx.hComponent, (OMX_STRING)pComponent, &ctx, &sBenchCallbacks);
+    if (ret != OMX_ErrorNone) {
+        fprintf(stderr, "%s: GetHandle 0x%x\n", pComponent, ret);
+        goto EXIT_DEINIT;
+    }
+
+    ret = Bench_SetupPorts(&ctx, nWidth, nHeight);
+    if (ret != OMX_ErrorNone) {
+        fprintf(stderr, "port setup: 0x%x\n", ret);
+        goto EXIT_FREE_HANDLE;
+    }
+
+    /* Loaded -> Idle -> Executing */
+    OMX_SendCommand(ctx.hComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
+    if ((Bench_AllocatePort(&ctx, INPUT_PORT_INDEX) != OMX_ErrorNone) ||
+        (Bench_AllocatePort(&ctx, OUTPUT_PORT_INDEX) != OMX_ErrorNone) ||
+        (Bench_WaitState(&ctx, OMX_StateIdle) != OMX_TRUE)) {
+        fprintf(stderr, "failed to go to Idle\n");
+        goto EXIT_FREE_BUFFER;
+    }
+
+    OMX_SendCommand(ctx.hComponent, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+    if (Bench_WaitState(&ctx, OMX_StateExecuting) != OMX_TRUE) {
+        fprintf(stderr, "failed to go to Executing\n");
+        goto EXIT_IDLE;
+    }
+
+    for (i = 0; i < ctx.port[INPUT_PORT_INDEX].nBuffers; i++)
+        ctx.port[INPUT_PORT_INDEX].returned[ctx.port[INPUT_PORT_INDEX].nReturned++] = i;
+
+    getrusage(RUSAGE_SELF, &usageStart);
+    nStart = Bench_Now();
+
+    Bench_FillAll(&ctx);
+
+    while (bEOS == OMX_FALSE) {
+        OMX_U32 nLastFrame = (ctx.bEncoder == OMX_TRUE)? ctx.nFrames:ctx.nFrames + 1;
+
+        pthread_mutex_lock(&ctx.lock);
+        while ((ctx.bPortChanged == OMX_FALSE) &&
+               (ctx.bEOS == OMX_FALSE) &&
+               (ctx.port[OUTPUT_PORT_INDEX].nReturned == 0) &&
+               ((ctx.port[INPUT_PORT_INDEX].nReturned == 0) || (nSent > nLastFrame))) {
+            if (Bench_Wait(&ctx) != OMX_TRUE) {
+                ctx.bError = OMX_TRUE;
+                break;
+            }
+        }
+
+        if (ctx.bError == OMX_TRUE) {
+            pthread_mutex_unlock(&ctx.lock);
+            break;
+        }
+
+        bEOS         = ctx.bEOS;
+        bPortChanged = ctx.bPortChanged;
+        ctx.bPortChanged = OMX_FALSE;
+
+        /* outputs go back right away unless the port is about to be disabled */
+        nReturned = ctx.port[OUTPUT_PORT_INDEX].nReturned;
+        memcpy(returned, ctx.port[OUTPUT_PORT_INDEX].returned, sizeof(OMX_U32) * nReturned);
+        ctx.port[OUTPUT_PORT_INDEX].nReturned = 0;
+        for (i = 0; (i < nReturned) && (bPortChanged == OMX_FALSE) && (bEOS == OMX_FALSE); i++)
+            ctx.port[OUTPUT_PORT_INDEX].bOwned[returned[i]] = OMX_TRUE;
+        pthread_mutex_unlock(&ctx.lock);
+
+        if (bPortChanged == OMX_TRUE) {
+            if (Bench_Reconfigure(&ctx) != OMX_ErrorNone) {
+                fprintf(stderr, "failed to reconfigure output port\n");
+                break;
+            }
+            continue;
+        }
+
+        for (i = 0; (i < nReturned) && (bEOS == OMX_FALSE); i++)
+            OMX_FillThisBuffer(ctx.hComponent, ctx.port[OUTPUT_PORT_INDEX].pBuffers[returned[i]]);
+
+        while (nSent <= nLastFrame) {
+            OMX_U32 nIndex;
+
+            if (nFPS > 0) {
+                long long nDue = nStart + (((long long)nSent * 1000000LL) / nFPS);
+                long long nNow = Bench_Now();
+
+                if (nDue > nNow)
+                    usleep((useconds_t)(nDue - nNow));
+            }
+
+            pthread_mutex_lock(&ctx.lock);
+            if (ctx.port[INPUT_PORT_INDEX].nReturned == 0) {
+                pthread_mutex_unlock(&ctx.lock);
+                break;
+            }
+            nIndex = ctx.port[INPUT_PORT_INDEX].returned[--ctx.port[INPUT_PORT_INDEX].nReturned];
+            pthread_mutex_unlock(&ctx.lock);
+
+            if (Bench_QueueInput(&ctx, nIndex, &nSent) != OMX_ErrorNone) {
+                fprintf(stderr, "EmptyThisBuffer failed\n");
+                break;
+            }
+        }
+    }
+
+    nEnd = Bench_Now();
+    getrusage(RUSAGE_SELF, &usageEnd);
+
+    {
+        double wall = (double)(nEnd - nStart) / 1E6;
+        double user = Bench_Seconds(&usageEnd.ru_utime) - Bench_Seconds(&usageStart.ru_utime);
+        double sys  = Bench_Seconds(&usageEnd.ru_stime) - Bench_Seconds(&usageStart.ru_stime);
+
+        printf("%s: %u/%u frames%s in %.3f s, %.1f fps\n", pComponent,
+               (unsigned int)ctx.nOutFrames, (unsigned int)ctx.nFrames,
+               (bEOS == OMX_TRUE)? "":" (no EOS)", wall, (wall > 0)? (double)ctx.nOutFrames / wall:0);
+        Bench_PrintLatency("ETB->EBD", ctx.pETBTime, ctx.pEBDTime, ctx.nFrames);
+        Bench_PrintLatency("ETB->FBD", ctx.pETBTime, ctx.pFBDTime, ctx.nFrames);
+        printf("  CPU user %.3f s, sys %.3f s, %.1f%% of a core, %.1f us per frame\n", user, sys,
+               (wall > 0)? ((user + sys) * 100.0) / wall:0,
+               (ctx.nOutFrames > 0)? ((user + sys) * 1E6) / ctx.nOutFrames:0);
+    }
+
+EXIT_IDLE:
+    OMX_SendCommand(ctx.hComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
+    Bench_WaitState(&ctx, OMX_StateIdle);
+
+EXIT_FREE_BUFFER:
+    OMX_SendCommand(ctx.hComponent, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+    Bench_FreePort(&ctx, INPUT_PORT_INDEX);
+    Bench_FreePort(&ctx, OUTPUT_PORT_INDEX);
+    Bench_WaitState(&ctx, OMX_StateLoaded);
+
+EXIT_FREE_HANDLE:
+    Exynos_OMX_FreeHandle(ctx.hComponent);
+
+EXIT_DEINIT:
+    Exynos_OMX_Deinit();
+
+    free(ctx.pETBTime);
+    free(ctx.pEBDTime);
+    free(ctx.pFBDTime);
+
+    return (bEOS == OMX_TRUE)? 0:1;
+}
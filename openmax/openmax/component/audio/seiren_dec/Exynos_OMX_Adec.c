@@ -752,6 +752,185 @@ EXIT:
     return ret;
 }
 
+/*
+ * Queued Seiren stream
+ *
+ * Once a decoder opened it, input chunks are copied into the stream slots and queued,
+ * and the buffer loop goes back for the next chunk while the previous one is still
+ * being decoded. PCM is read ahead into the output slots, so a chunk costs a single
+ * wait instead of a blocking write and a blocking read.
+ * The timestamp of each queued chunk is given to the PCM dequeued for it.
+ * Without the stream, these call the synchronous ADec functions.
+ */
+OMX_ERRORTYPE Exynos_OMX_AudioDecodeStreamOpen(OMX_COMPONENTTYPE *pOMXComponent, u32 fd)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if (ADec_StreamOpen(fd, SEIREN_STREAM_DEPTH) != 0) {
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "ADec_StreamOpen failed, synchronous decoding is used");
+        pAudioDec->bSeirenStream = OMX_FALSE;
+        return OMX_ErrorUndefined;
+    }
+
+    pAudioDec->nStreamTimeStampHead = 0;
+    pAudioDec->nStreamPending = 0;
+    pAudioDec->bSeirenStream = OMX_TRUE;
+
+    return OMX_ErrorNone;
+}
+
+int Exynos_OMX_AudioDecodeSendStream(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pInputInfo, EXYNOS_OMX_DATA *pInputData)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    audio_mem_info_t               slot;
+    u32                            events = ADEC_STREAM_EVENT_INPUT;
+    OMX_U32                        index;
+    int                            consumed_size = 0;
+    int                            ret;
+
+    if (pAudioDec->bSeirenStream == OMX_FALSE)
+        return ADec_SendStream(fd, pInputInfo, &consumed_size);
+
+    if (pInputInfo->data_size <= 0)
+        return 0;
+
+    ret = ADec_StreamGetInputBuffer(fd, &slot);
+    if (ret == SEIREN_ERROR_NOT_READY) {
+        /* every slot is queued, the chunk is kept by the caller if none is written in time */
+        ADec_StreamWait(fd, SEIREN_STREAM_WAIT_TIME, &events);
+        if (!(events & ADEC_STREAM_EVENT_INPUT))
+            return SEIREN_ERROR_NOT_READY;
+        ret = ADec_StreamGetInputBuffer(fd, &slot);
+    }
+    if (ret != 0)
+        return ret;
+
+    Exynos_OSAL_Memcpy(slot.virt_addr, pInputInfo->virt_addr, pInputInfo->data_size);
+    slot.data_size = pInputInfo->data_size;
+    ret = ADec_StreamQueueInput(fd, &slot);
+    if (ret != 0)
+        return ret;
+
+    /* codec config does not give PCM of its own */
+    if (!(pInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+        if (pAudioDec->nStreamPending >= SEIREN_STREAM_TIMESTAMP_NUM) {
+            pAudioDec->nStreamTimeStampHead = (pAudioDec->nStreamTimeStampHead + 1) % SEIREN_STREAM_TIMESTAMP_NUM;
+            pAudioDec->nStreamPending--;
+        }
+        index = (pAudioDec->nStreamTimeStampHead + pAudioDec->nStreamPending) % SEIREN_STREAM_TIMESTAMP_NUM;
+        pAudioDec->streamTimeStamp[index] = pInputData->timeStamp;
+        pAudioDec->nStreamPending++;
+    }
+
+    return 0;
+}
+
+int Exynos_OMX_AudioDecodeSendEOS(OMX_COMPONENTTYPE *pOMXComponent, u32 fd)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if (pAudioDec->bSeirenStream == OMX_FALSE)
+        return ADec_SendEOS(fd);
+
+    /* EOS is issued after the queued input */
+    return ADec_StreamSendEOS(fd);
+}
+
+int Exynos_OMX_AudioDecodeRecvPCM(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pOutputInfo, EXYNOS_OMX_DATA *pOutputData)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    u32                            events = ADEC_STREAM_EVENT_OUTPUT;
+    int                            ret;
+
+    if (pAudioDec->bSeirenStream == OMX_FALSE)
+        return ADec_RecvPCM(fd, pOutputInfo);
+
+    /* while the pipeline is not full, a free input slot is worth more than waiting for PCM */
+    if (pAudioDec->nStreamPending < SEIREN_STREAM_DEPTH)
+        events |= ADEC_STREAM_EVENT_INPUT;
+
+    pOutputInfo->virt_addr = NULL;
+    pOutputInfo->data_size = 0;
+
+    ret = ADec_StreamWait(fd, SEIREN_STREAM_WAIT_TIME, &events);
+    if (ret != 0)
+        return ret;
+
+    if (events & ADEC_STREAM_EVENT_ERROR)
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Seiren stream error");
+
+    if (!(events & ADEC_STREAM_EVENT_OUTPUT))
+        return 0;
+
+    ret = ADec_StreamDequeuePCM(fd, pOutputInfo);
+    if (ret != 0)
+        return ret;
+
+    if (pAudioDec->nStreamPending > 0) {
+        pOutputData->timeStamp = pAudioDec->streamTimeStamp[pAudioDec->nStreamTimeStampHead];
+        pAudioDec->nStreamTimeStampHead = (pAudioDec->nStreamTimeStampHead + 1) % SEIREN_STREAM_TIMESTAMP_NUM;
+        pAudioDec->nStreamPending--;
+    }
+
+    return 0;
+}
+
+int Exynos_OMX_AudioDecodeReleasePCM(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pOutputInfo)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if ((pAudioDec->bSeirenStream == OMX_FALSE) ||
+        (pOutputInfo->virt_addr == NULL))
+        return 0;
+
+    return ADec_StreamReleasePCM(fd, pOutputInfo);
+}
+
+int Exynos_OMX_AudioDecodeGetOutputStatus(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, unsigned long long *pStopped)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    u32                            events = ADEC_STREAM_EVENT_OUTPUT;
+    int                            ret;
+
+    ret = ADec_GetParams(fd, ADEC_PARAM_GET_OUTPUT_STATUS, pStopped);
+    if ((ret != 0) || (pAudioDec->bSeirenStream == OMX_FALSE) || (*pStopped != 1))
+        return ret;
+
+    /* the driver is drained, but PCM may still wait in the output slots */
+    ADec_StreamWait(fd, 0, &events);
+    if (events & ADEC_STREAM_EVENT_OUTPUT)
+        *pStopped = 0;
+
+    return 0;
+}
+
+int Exynos_OMX_AudioDecodeFlush(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, SEIREN_PORTTYPE type)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_DATABUFFER         *outputUseBuffer = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].dataBuffer;
+    int                            ret;
+
+    if (pAudioDec->bSeirenStream == OMX_FALSE)
+        return ADec_Flush(fd, type);
+
+    ret = ADec_StreamFlush(fd, type);
+
+    /* timestamps are taken by the buffer thread with the output buffer mutex held */
+    Exynos_OSAL_MutexLock(outputUseBuffer->bufferMutex);
+    pAudioDec->nStreamTimeStampHead = 0;
+    pAudioDec->nStreamPending = 0;
+    Exynos_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
+
+    return ret;
+}
+
 OMX_ERRORTYPE Exynos_OMX_BufferProcess(OMX_HANDLETYPE hComponent)
 {
     OMX_ERRORTYPE             ret = OMX_ErrorNone;
@@ -957,7 +1136,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
 
     if (bEvent == OMX_TRUE && ret == OMX_ErrorNone) {
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "bEVENT!!!!!!OMX_FLUSH_SEIREN");
-        pAudioDec->exynos_codec_flushSeiren(pOMXComponent, nPortIndex);
+        pAudioDec->exynos_codec_flushSeiren(pOMXComponent, (nPortIndex == INPUT_PORT_INDEX) ? PORT_IN : PORT_OUT);
     }
 
     if (nPortIndex == INPUT_PORT_INDEX) {
@@ -50,6 +50,11 @@
 
 #define AUDIO_DATA_PLANE                    0
 
+/* queued Seiren stream, see Exynos_OMX_AudioDecodeStreamOpen() */
+#define SEIREN_STREAM_DEPTH                 2
+#define SEIREN_STREAM_WAIT_TIME             100     /* ms */
+#define SEIREN_STREAM_TIMESTAMP_NUM         (ADEC_STREAM_MAX_DEPTH * 2)
+
 typedef struct _SRP_DEC_INPUT_BUFFER
 {
     void *PhyAddr;      // physical address
@@ -67,6 +72,12 @@ typedef struct _EXYNOS_OMX_AUDIODEC_COMPONENT
     SRP_DEC_INPUT_BUFFER SRPDecInputBuffer[MAX_AUDIO_INPUTBUFFER_NUM];
     OMX_U32  indexInputBuffer;
 
+    /* Seiren stream */
+    OMX_BOOL  bSeirenStream;
+    OMX_TICKS streamTimeStamp[SEIREN_STREAM_TIMESTAMP_NUM];
+    OMX_U32   nStreamTimeStampHead;
+    OMX_U32   nStreamPending;   /* queued chunks whose PCM is not dequeued yet */
+
     /* Buffer Process */
     OMX_BOOL       bExitBufferProcessThread;
     OMX_HANDLETYPE hBufferProcessThread;
@@ -136,6 +147,14 @@ OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
 OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
 
+OMX_ERRORTYPE Exynos_OMX_AudioDecodeStreamOpen(OMX_COMPONENTTYPE *pOMXComponent, u32 fd);
+int Exynos_OMX_AudioDecodeSendStream(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pInputInfo, EXYNOS_OMX_DATA *pInputData);
+int Exynos_OMX_AudioDecodeSendEOS(OMX_COMPONENTTYPE *pOMXComponent, u32 fd);
+int Exynos_OMX_AudioDecodeRecvPCM(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pOutputInfo, EXYNOS_OMX_DATA *pOutputData);
+int Exynos_OMX_AudioDecodeReleasePCM(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, audio_mem_info_t *pOutputInfo);
+int Exynos_OMX_AudioDecodeGetOutputStatus(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, unsigned long long *pStopped);
+int Exynos_OMX_AudioDecodeFlush(OMX_COMPONENTTYPE *pOMXComponent, u32 fd, SEIREN_PORTTYPE type);
+
 #ifdef __cplusplus
 }
 #endif
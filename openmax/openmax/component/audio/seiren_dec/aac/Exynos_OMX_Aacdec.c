@@ -499,12 +499,12 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     int                            returnCodec = 0;
     unsigned long long             isSeirenStopped = 0;
     OMX_BOOL                       isSeirenIbufOverflow = OMX_FALSE;
+    OMX_BOOL                       bInputPending = OMX_FALSE;
 
     u32 fd = pAacDec->hSeirenAacHandle.hSeirenHandle;
     audio_mem_info_t input_mem_pool = pAacDec->hSeirenAacHandle.input_mem_pool;
     audio_mem_info_t output_mem_pool = pAacDec->hSeirenAacHandle.output_mem_pool;
     unsigned long long sample_rate, channels;
-    int consumed_size = 0;
     sample_rate = channels = 0;
 
     FunctionIn();
@@ -539,17 +539,20 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
 
             /* AAC setup-data(or DSI) could be various length. But it only needs 2byte */
             input_mem_pool.data_size = 2;
-            ADec_SendStream(fd, &input_mem_pool, &consumed_size);
+            Exynos_OMX_AudioDecodeSendStream(pOMXComponent, fd, &input_mem_pool, pInputData);
             goto EXIT;
         }
-        returnCodec = ADec_SendStream(fd, &input_mem_pool, &consumed_size);
+        returnCodec = Exynos_OMX_AudioDecodeSendStream(pOMXComponent, fd, &input_mem_pool, pInputData);
 
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "ProcessedSize : %d    return : %d", consumed_size, returnCodec);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "return : %d", returnCodec);
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS)
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "EOS!!");
-        if (returnCodec >= 0) {
+        if (returnCodec == SEIREN_ERROR_NOT_READY) {
+            /* every stream slot is queued, the chunk is sent again once PCM is taken */
+            bInputPending = OMX_TRUE;
+        } else if (returnCodec >= 0) {
             if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-                ADec_SendEOS(fd);
+                Exynos_OMX_AudioDecodeSendEOS(pOMXComponent, fd);
                 pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_TRUE;
             }
         } else if (returnCodec < 0) {
@@ -619,7 +622,7 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     }
 
     /* Get decoded data from Seiren */
-    ADec_RecvPCM(fd, &output_mem_pool);
+    Exynos_OMX_AudioDecodeRecvPCM(pOMXComponent, fd, &output_mem_pool, pOutputData);
     if (output_mem_pool.data_size > 0) {
         pOutputData->dataLen = output_mem_pool.data_size;
         Exynos_OSAL_Memcpy(pOutputData->buffer.addr[AUDIO_DATA_PLANE],
@@ -627,6 +630,7 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     } else {
         pOutputData->dataLen = 0;
     }
+    Exynos_OMX_AudioDecodeReleasePCM(pOMXComponent, fd, &output_mem_pool);
 
 #ifdef Seiren_DUMP_TO_FILE
     if (pOutputData->dataLen > 0)
@@ -636,7 +640,7 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     /* Delay EOS signal until all the PCM is returned from the Seiren driver. */
     if (pAacDec->hSeirenAacHandle.bSeirenSendEOS == OMX_TRUE) {
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-            returnCodec = ADec_GetParams(fd, ADEC_PARAM_GET_OUTPUT_STATUS, &isSeirenStopped);
+            returnCodec = Exynos_OMX_AudioDecodeGetOutputStatus(pOMXComponent, fd, &isSeirenStopped);
             if (returnCodec != 0)
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Fail Seiren_STOP_EOS_STATE");
             if (isSeirenStopped == 1) {
@@ -653,6 +657,9 @@ OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
         }
     }
 EXIT:
+    if ((ret == OMX_ErrorNone) && (bInputPending == OMX_TRUE))
+        ret = (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet;
+
     FunctionOut();
 
     return ret;
@@ -720,7 +727,7 @@ OMX_ERRORTYPE Exynos_Seiren_AacDec_flushSeiren(OMX_COMPONENTTYPE *pOMXComponent,
     EXYNOS_AAC_HANDLE             *pAacDec = (EXYNOS_AAC_HANDLE *)pAudioDec->hCodecHandle;
 
     int fd = pAacDec->hSeirenAacHandle.hSeirenHandle;
-    return ADec_Flush(fd, type);
+    return Exynos_OMX_AudioDecodeFlush(pOMXComponent, fd, type);
 }
 
 OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent, OMX_STRING componentName)
@@ -817,6 +824,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
         goto EXIT_ERROR_6;
     }
 
+    /* Queue input ahead of the PCM, synchronous calls are kept if the stream can't be opened */
+    Exynos_OMX_AudioDecodeStreamOpen(pOMXComponent, fd);
+
     /* Set componentVersion */
     pExynosComponent->componentVersion.s.nVersionMajor = VERSIONMAJOR_NUMBER;
     pExynosComponent->componentVersion.s.nVersionMinor = VERSIONMINOR_NUMBER;
@@ -487,12 +487,12 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     int                            returnCodec = 0;
     unsigned long long             isSeirenStopped = 0;
     OMX_BOOL                       isSeirenIbufOverflow = OMX_FALSE;
+    OMX_BOOL                       bInputPending = OMX_FALSE;
 
     u32 fd = pMp3Dec->hSeirenMp3Handle.hSeirenHandle;
     audio_mem_info_t input_mem_pool = pMp3Dec->hSeirenMp3Handle.input_mem_pool;
     audio_mem_info_t output_mem_pool = pMp3Dec->hSeirenMp3Handle.output_mem_pool;
     unsigned long long sample_rate, channels;
-    int consumed_size = 0;
     unsigned char* pt = NULL;
     sample_rate = channels = 0;
 
@@ -513,13 +513,16 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
         input_mem_pool.data_size = pInputData->dataLen;
         pt = (unsigned char*)input_mem_pool.virt_addr;
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "\e[1;33m %02X %02X %02X %02X %02X %02X %lld \e[0m", *pt,*(pt+1),*(pt+2),*(pt+3),*(pt+4), *(pt+5), pInputData->timeStamp);
-        returnCodec = ADec_SendStream(fd, &input_mem_pool, &consumed_size);
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "ProcessedSize : %d    return : %d", consumed_size, returnCodec);
+        returnCodec = Exynos_OMX_AudioDecodeSendStream(pOMXComponent, fd, &input_mem_pool, pInputData);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "return : %d", returnCodec);
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS)
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "EOS!!");
-        if (returnCodec >= 0) {
+        if (returnCodec == SEIREN_ERROR_NOT_READY) {
+            /* every stream slot is queued, the chunk is sent again once PCM is taken */
+            bInputPending = OMX_TRUE;
+        } else if (returnCodec >= 0) {
             if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-                ADec_SendEOS(fd);
+                Exynos_OMX_AudioDecodeSendEOS(pOMXComponent, fd);
                 pMp3Dec->hSeirenMp3Handle.bSeirenSendEOS = OMX_TRUE;
             }
         } else if (returnCodec < 0) {
@@ -589,11 +592,11 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     }
 
     /* Get decoded data from Seiren */
-    ADec_RecvPCM(fd, &output_mem_pool);
+    Exynos_OMX_AudioDecodeRecvPCM(pOMXComponent, fd, &output_mem_pool, pOutputData);
 
     pt = (unsigned char*)output_mem_pool.virt_addr;
     /* Trim first samples for MP3 gapless CTS test */
-    if (pAudioDec->bFirstFrame) {
+    if (pAudioDec->bFirstFrame && (output_mem_pool.data_size > 0)) {
         pAudioDec->bFirstFrame = OMX_FALSE;
         /* Need to check Gapless playback or not */
         const int gapless_frames = 529;
@@ -611,6 +614,7 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     } else {
         pOutputData->dataLen = 0;
     }
+    Exynos_OMX_AudioDecodeReleasePCM(pOMXComponent, fd, &output_mem_pool);
 
 #ifdef Seiren_DUMP_TO_FILE
     if (pOutputData->dataLen > 0)
@@ -620,7 +624,7 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
     /* Delay EOS signal until all the PCM is returned from the Seiren driver. */
     if (pMp3Dec->hSeirenMp3Handle.bSeirenSendEOS == OMX_TRUE) {
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-            returnCodec = ADec_GetParams(fd, ADEC_PARAM_GET_OUTPUT_STATUS, &isSeirenStopped);
+            returnCodec = Exynos_OMX_AudioDecodeGetOutputStatus(pOMXComponent, fd, &isSeirenStopped);
             if (returnCodec != 0)
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Fail Seiren_STOP_EOS_STATE");
             if (isSeirenStopped == 1) {
@@ -637,6 +641,9 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, E
         }
     }
 EXIT:
+    if ((ret == OMX_ErrorNone) && (bInputPending == OMX_TRUE))
+        ret = (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet;
+
     FunctionOut();
 
     return ret;
@@ -704,7 +711,7 @@ OMX_ERRORTYPE Exynos_Seiren_Mp3Dec_flushSeiren(OMX_COMPONENTTYPE *pOMXComponent,
     EXYNOS_MP3_HANDLE             *pMp3Dec = (EXYNOS_MP3_HANDLE *)pAudioDec->hCodecHandle;
 
     int fd = pMp3Dec->hSeirenMp3Handle.hSeirenHandle;
-    return ADec_Flush(fd, type);
+    return Exynos_OMX_AudioDecodeFlush(pOMXComponent, fd, type);
 }
 
 OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent, OMX_STRING componentName)
@@ -807,6 +814,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
         goto EXIT_ERROR_6;
     }
 
+    /* Queue input ahead of the PCM, synchronous calls are kept if the stream can't be opened */
+    Exynos_OMX_AudioDecodeStreamOpen(pOMXComponent, fd);
+
     /* Set componentVersion */
     pExynosComponent->componentVersion.s.nVersionMajor = VERSIONMAJOR_NUMBER;
     pExynosComponent->componentVersion.s.nVersionMinor = VERSIONMINOR_NUMBER;
@@ -49,7 +49,8 @@ include $(CLEAR_VARS)
 LOCAL_MODULE_TAGS := optional
 
 LOCAL_SRC_FILES := \
-	Exynos_OMX_Resourcemanager.c
+	Exynos_OMX_Resourcemanager.c \
+	Exynos_OMX_SessionPool.c
 
 LOCAL_PRELINK_MODULE := false
 LOCAL_MODULE := libExynosOMX_Resourcemanager
@@ -60,11 +61,12 @@ endif
 LOCAL_CFLAGS :=
 
 LOCAL_STATIC_LIBRARIES := libExynosOMX_OSAL
-LOCAL_SHARED_LIBRARIES := libcutils libutils liblog
+LOCAL_SHARED_LIBRARIES := libcutils libutils liblog libdl libion_exynos
 
 LOCAL_C_INCLUDES := \
 	$(EXYNOS_OMX_INC)/exynos \
-	$(EXYNOS_OMX_TOP)/osal
+	$(EXYNOS_OMX_TOP)/osal \
+	$(EXYNOS_VIDEO_CODEC)/include
 
 ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
 LOCAL_CFLAGS += -DUSE_KHRONOS_OMX_HEADER
@@ -96,6 +98,14 @@ ifdef BOARD_USE_MAX_COMPONENT_NUM
 LOCAL_CFLAGS += -DMAX_COMPONENT_NUM=$(BOARD_USE_MAX_COMPONENT_NUM)
 endif
 
+ifdef BOARD_USE_MAX_MFC_INSTANCE_NUM
+LOCAL_CFLAGS += -DMAX_MFC_INSTANCE_NUM=$(BOARD_USE_MAX_MFC_INSTANCE_NUM)
+endif
+
+ifdef BOARD_USE_MAX_MFC_MBPS
+LOCAL_CFLAGS += -DMAX_MFC_MBPS=$(BOARD_USE_MAX_MFC_MBPS)
+endif
+
 LOCAL_CFLAGS += -Wno-unused-variable -Wno-unused-label -Wno-unused-function
 
 include $(BUILD_SHARED_LIBRARY)
@@ -36,6 +36,7 @@
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Latency.h"
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OMX_Resourcemanager.h"
@@ -1008,6 +1009,7 @@ static OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(
 
             //if (currentState != OMX_StateLoaded)
             pExynosComponent->exynos_codec_componentTerminate(pOMXComponent);
+            Exynos_OMX_Release_Resource_Load(pOMXComponent);
 
             ret = OMX_ErrorInvalidState;
 
@@ -1061,6 +1063,7 @@ static OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(
             }
 
             pExynosComponent->exynos_codec_componentTerminate(pOMXComponent);
+            Exynos_OMX_Release_Resource_Load(pOMXComponent);
 
 #ifdef TUNNELING_SUPPORT
             for (i = 0; i < (pExynosComponent->portParam.nPorts); i++) {
@@ -1104,6 +1107,13 @@ static OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(
     {
         switch (currentState) {
         case OMX_StateLoaded:
+            /* admit the MFC load before any port state changes, a rejected component stays as it was */
+            ret = Exynos_OMX_Check_Resource_Load(pOMXComponent);
+            if (ret != OMX_ErrorNone) {
+                Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to Exynos_OMX_Check_Resource_Load() (0x%x)", pExynosComponent, __FUNCTION__, ret);
+                goto EXIT;
+            }
+
             for (i = 0; i < (int)pExynosComponent->portParam.nPorts; i++) {
                 pExynosPort = &(pExynosComponent->pExynosPort[i]);
 
@@ -1114,8 +1124,10 @@ static OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(
                     CHECK_PORT_BUFFER_SUPPLIER(pExynosPort) &&
                     CHECK_PORT_ENABLED(pExynosPort)) {
                     ret = pExynosComponent->exynos_AllocateTunnelBuffer(pExynosPort, i);
-                    if (ret!=OMX_ErrorNone)
+                    if (ret!=OMX_ErrorNone) {
+                        Exynos_OMX_Release_Resource_Load(pOMXComponent);
                         goto EXIT;
+                    }
                 }
 #endif
             }
@@ -1125,6 +1137,7 @@ static OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(
             ret = pExynosComponent->exynos_codec_componentInit(pOMXComponent);
             if (ret != OMX_ErrorNone) {
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to exynos_codec_componentInit() (0x%x)", pExynosComponent, __FUNCTION__, ret);
+                Exynos_OMX_Release_Resource_Load(pOMXComponent);
 #ifdef TUNNELING_SUPPORT
                 /*
                  * if (CHECK_PORT_TUNNELED == OMX_TRUE) thenTunnel Buffer Free
@@ -1224,6 +1237,8 @@ FAIL_TO_IDLE:
                     pExynosComponent->pExynosPort[i].bufferSemID = NULL;
                 }
 
+                Exynos_OMX_Release_Resource_Load(pOMXComponent);
+
                 ret = OMX_ErrorInsufficientResources;
                 goto EXIT;
             }
@@ -2470,6 +2485,10 @@ OMX_ERRORTYPE Exynos_OMX_BaseComponent_Constructor(
 
     Exynos_OSAL_QueueCreate(&pExynosComponent->dynamicConfigQ, MAX_QUEUE_ELEMENTS);
 
+    /* not fatal, the component just works without the measurement */
+    if (Exynos_OSAL_LatencyCreate(&pExynosComponent->hLatency, (OMX_PTR)pExynosComponent) != OMX_ErrorNone)
+        pExynosComponent->hLatency = NULL;
+
     pOMXComponent->GetComponentVersion = &Exynos_OMX_GetComponentVersion;
     pOMXComponent->SendCommand         = &Exynos_OMX_SendCommand;
     pOMXComponent->GetState            = &Exynos_OMX_GetState;
@@ -2539,6 +2558,9 @@ OMX_ERRORTYPE Exynos_OMX_BaseComponent_Destructor(
     pExynosComponent->hSemaMsgWait = NULL;
     Exynos_OSAL_QueueTerminate(&pExynosComponent->messageQ);
 
+    Exynos_OSAL_LatencyTerminate(pExynosComponent->hLatency);
+    pExynosComponent->hLatency = NULL;
+
     Exynos_OSAL_Free(pExynosComponent);
     pExynosComponent = NULL;
 
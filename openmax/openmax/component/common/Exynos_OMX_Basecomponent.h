@@ -103,6 +103,9 @@ typedef struct _EXYNOS_OMX_BASECOMPONENT
 
     OMX_PTR                     vendorExts[MAX_VENDOR_EXT_NUM];
 
+    /* per-stage latency, NULL if debug.omx.latency is not set */
+    OMX_HANDLETYPE              hLatency;
+
     OMX_ERRORTYPE (*exynos_codec_componentInit)(OMX_COMPONENTTYPE *pOMXComponent);
     OMX_ERRORTYPE (*exynos_codec_componentTerminate)(OMX_COMPONENTTYPE *pOMXComponent);
 
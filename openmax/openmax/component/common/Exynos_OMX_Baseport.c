@@ -35,6 +35,7 @@
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_Memory.h"
+#include "Exynos_OSAL_Latency.h"
 
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Basecomponent.h"
@@ -134,6 +135,12 @@ OMX_ERRORTYPE Exynos_OMX_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent, OM
 
     Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
 
+    if ((bBufferFind == OMX_TRUE) &&
+        (bufferHeader != NULL) &&
+        (bufferHeader->nFilledLen > 0) &&
+        (!(bufferHeader->nFlags & OMX_BUFFERFLAG_CODECCONFIG)))
+        Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, bufferHeader->nTimeStamp, LATENCY_MARK_FBD);
+
     if ((bBufferFind == OMX_TRUE) &&
         (bufferHeader != NULL) &&
         (bufferHeader->pBuffer != NULL) &&
@@ -562,6 +569,9 @@ OMX_ERRORTYPE Exynos_OMX_EmptyThisBuffer(
     Exynos_OSAL_CountIncrease(pExynosPort->hBufferCount, pBuffer, INPUT_PORT_INDEX);
 #endif
 
+    if (!(pBuffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG))
+        Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, pBuffer->nTimeStamp, LATENCY_MARK_ETB);
+
     message = Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_MESSAGE));
     if (message == NULL) {
         ret = OMX_ErrorInsufficientResources;
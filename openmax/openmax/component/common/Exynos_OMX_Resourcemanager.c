@@ -30,7 +30,9 @@
 
 #include "Exynos_OMX_Def.h"
 #include "Exynos_OMX_Resourcemanager.h"
+#include "Exynos_OMX_SessionPool.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_Baseport.h"
 #include "Exynos_OSAL_Memory.h"
 #include "Exynos_OSAL_Mutex.h"
 
@@ -46,6 +48,12 @@
 #define MAX_RESOURCE_VIDEO_SECURE 2
 /* Add new resource block */
 
+#define MAX_RESOURCE_VIDEO_INSTANCE RESOURCE_VIDEO_INSTANCE  /* contexts shared by all MFC sessions */
+#define MAX_RESOURCE_VIDEO_LOAD     RESOURCE_VIDEO_MBPS      /* MFC throughput in macroblocks/sec */
+
+#define DEFAULT_VIDEO_FRAMERATE     30
+#define VIDEO_ENC_LOAD_WEIGHT       200  /* encoding costs about twice as much as decoding */
+
 typedef enum _EXYNOS_OMX_RESOURCE
 {
     VIDEO_DEC,
@@ -60,6 +68,7 @@ typedef struct _EXYNOS_OMX_RM_COMPONENT_LIST
 {
     OMX_COMPONENTTYPE   *pOMXStandComp;
     OMX_U32              groupPriority;
+    OMX_U32              nLoad;         /* admitted MFC load in macroblocks/sec, 0 until Loaded to Idle */
     struct _EXYNOS_OMX_RM_COMPONENT_LIST *pNext;
 } EXYNOS_OMX_RM_COMPONENT_LIST;
 
@@ -176,6 +185,7 @@ OMX_ERRORTYPE addElementList(
         ((EXYNOS_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->pNext = NULL;
         ((EXYNOS_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->pOMXStandComp = pOMXComponent;
         ((EXYNOS_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->groupPriority = pExynosComponent->compPriority.nGroupPriority;
+        ((EXYNOS_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->nLoad = 0;
         goto EXIT;
     } else {
         *ppList = (EXYNOS_OMX_RM_COMPONENT_LIST *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_RM_COMPONENT_LIST));
@@ -188,6 +198,7 @@ OMX_ERRORTYPE addElementList(
         pTempComp->pNext = NULL;
         pTempComp->pOMXStandComp = pOMXComponent;
         pTempComp->groupPriority = pExynosComponent->compPriority.nGroupPriority;
+        pTempComp->nLoad = 0;
     }
 
 EXIT:
@@ -310,6 +321,166 @@ EXIT:
 }
 
 
+EXYNOS_OMX_RM_COMPONENT_LIST *findElementList(
+    EXYNOS_OMX_RM_COMPONENT_LIST    *pList,
+    OMX_COMPONENTTYPE               *pOMXComponent)
+{
+    EXYNOS_OMX_RM_COMPONENT_LIST *pTempComp = pList;
+
+    while (pTempComp != NULL) {
+        if (pTempComp->pOMXStandComp == pOMXComponent)
+            break;
+
+        pTempComp = pTempComp->pNext;
+    }
+
+    return pTempComp;
+}
+
+static OMX_BOOL isVideoCodec(EXYNOS_CODEC_TYPE codecType)
+{
+    switch (codecType) {
+    case HW_VIDEO_DEC_CODEC:
+    case HW_VIDEO_ENC_CODEC:
+    case HW_VIDEO_DEC_SECURE_CODEC:
+    case HW_VIDEO_ENC_SECURE_CODEC:
+        return OMX_TRUE;
+    default:
+        return OMX_FALSE;
+    }
+}
+
+/* relative cost of a macroblock per codec, AVC is 100 */
+static OMX_U32 getCodecLoadWeight(OMX_VIDEO_CODINGTYPE eCompressionFormat)
+{
+    switch ((int)eCompressionFormat) {
+    case OMX_VIDEO_CodingMPEG2:
+    case OMX_VIDEO_CodingH263:
+    case OMX_VIDEO_CodingMPEG4:
+        return 75;
+    case OMX_VIDEO_CodingHEVC:
+    case OMX_VIDEO_CodingVP9:
+        return 125;
+    case OMX_VIDEO_CodingAVC:
+    case OMX_VIDEO_CodingVP8:
+    case OMX_VIDEO_CodingWMV:
+    default:
+        return 100;
+    }
+}
+
+/*
+ * MFC load of a configured video component in macroblocks/sec,
+ * derived from the port resolution, frame rate and coding type
+ */
+static OMX_U32 calcVideoLoad(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    OMX_VIDEO_PORTDEFINITIONTYPE *pInputVideo   = NULL;
+    OMX_VIDEO_PORTDEFINITIONTYPE *pOutputVideo  = NULL;
+    OMX_VIDEO_CODINGTYPE          eCodingType   = OMX_VIDEO_CodingUnused;
+    OMX_U64 nWidth    = 0;
+    OMX_U64 nHeight   = 0;
+    OMX_U64 nFrameMBs = 0;
+    OMX_U64 nLoad     = 0;
+    OMX_U32 nFramerate = 0;
+
+    pInputVideo  = &(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].portDefinition.format.video);
+    pOutputVideo = &(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].portDefinition.format.video);
+
+    nWidth  = (pInputVideo->nFrameWidth > pOutputVideo->nFrameWidth)? pInputVideo->nFrameWidth:pOutputVideo->nFrameWidth;
+    nHeight = (pInputVideo->nFrameHeight > pOutputVideo->nFrameHeight)? pInputVideo->nFrameHeight:pOutputVideo->nFrameHeight;
+    nFrameMBs = ((nWidth + 15) / 16) * ((nHeight + 15) / 16);
+
+    nFramerate = (pInputVideo->xFramerate > pOutputVideo->xFramerate)? pInputVideo->xFramerate:pOutputVideo->xFramerate;
+    nFramerate = nFramerate >> 16;
+    if (nFramerate == 0)
+        nFramerate = DEFAULT_VIDEO_FRAMERATE;
+
+    if ((pExynosComponent->codecType == HW_VIDEO_DEC_CODEC) ||
+        (pExynosComponent->codecType == HW_VIDEO_DEC_SECURE_CODEC))
+        eCodingType = pInputVideo->eCompressionFormat;
+    else
+        eCodingType = pOutputVideo->eCompressionFormat;
+
+    nLoad = (nFrameMBs * nFramerate * getCodecLoadWeight(eCodingType)) / 100;
+
+    if ((pExynosComponent->codecType == HW_VIDEO_ENC_CODEC) ||
+        (pExynosComponent->codecType == HW_VIDEO_ENC_SECURE_CODEC))
+        nLoad = (nLoad * VIDEO_ENC_LOAD_WEIGHT) / 100;
+
+    return (nLoad > 0xFFFFFFFF)? 0xFFFFFFFF:(OMX_U32)nLoad;
+}
+
+static OMX_U32 getVideoLoad()
+{
+    EXYNOS_OMX_RM_COMPONENT_LIST *pTempComp = NULL;
+    OMX_U32 nLoad = 0;
+    int i = 0;
+
+    for (i = 0; i < RESOURCE_MAX; i++) {
+        if (i == AUDIO_DEC)
+            continue;
+
+        for (pTempComp = gpRMList[i]; pTempComp != NULL; pTempComp = pTempComp->pNext)
+            nLoad += pTempComp->nLoad;
+    }
+
+    return nLoad;
+}
+
+static int getVideoInstanceNum()
+{
+    EXYNOS_OMX_RM_COMPONENT_LIST *pTempComp = NULL;
+    int numElem = 0;
+    int i = 0;
+
+    for (i = 0; i < RESOURCE_MAX; i++) {
+        if (i == AUDIO_DEC)
+            continue;
+
+        for (pTempComp = gpRMList[i]; pTempComp != NULL; pTempComp = pTempComp->pNext)
+            numElem++;
+    }
+
+    return numElem;
+}
+
+/*
+ * finds the lowest priority video component holding MFC load that can be
+ * moved back to Loaded, only idle components can give their load back
+ */
+static EXYNOS_OMX_RM_COMPONENT_LIST *searchLowPriorityLoad(
+    OMX_COMPONENTTYPE   *pOMXComponent,
+    OMX_U32              inComp_priority)
+{
+    EXYNOS_OMX_RM_COMPONENT_LIST *pTempComp         = NULL;
+    EXYNOS_OMX_RM_COMPONENT_LIST *pCandidateComp    = NULL;
+    EXYNOS_OMX_BASECOMPONENT     *pExynosComponent  = NULL;
+    int i = 0;
+
+    for (i = 0; i < RESOURCE_MAX; i++) {
+        if (i == AUDIO_DEC)
+            continue;
+
+        for (pTempComp = gpRMList[i]; pTempComp != NULL; pTempComp = pTempComp->pNext) {
+            if ((pTempComp->pOMXStandComp == pOMXComponent) ||
+                (pTempComp->nLoad == 0) ||
+                (pTempComp->groupPriority <= inComp_priority))
+                continue;
+
+            pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pTempComp->pOMXStandComp->pComponentPrivate;
+            if (pExynosComponent->currentState != OMX_StateIdle)
+                continue;
+
+            if ((pCandidateComp == NULL) ||
+                (pCandidateComp->groupPriority < pTempComp->groupPriority))
+                pCandidateComp = pTempComp;
+        }
+    }
+
+    return pCandidateComp;
+}
+
 OMX_ERRORTYPE Exynos_OMX_ResourceManager_Init()
 {
     OMX_ERRORTYPE ret = OMX_ErrorNone;
@@ -325,6 +496,10 @@ OMX_ERRORTYPE Exynos_OMX_ResourceManager_Init()
         Exynos_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
     }
 
+    /* not mandatory, thumbnail sessions are opened as usual without it */
+    if (Exynos_OMX_SessionPool_Init() != OMX_ErrorNone)
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%s] session pool is not available", __FUNCTION__);
+
     FunctionOut();
 
     return ret;
@@ -339,6 +514,8 @@ OMX_ERRORTYPE Exynos_OMX_ResourceManager_Deinit()
 
     FunctionIn();
 
+    Exynos_OMX_SessionPool_Deinit();
+
     Exynos_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
     for (i = 0; i < RESOURCE_MAX; i++) {
@@ -383,6 +560,7 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
     EXYNOS_OMX_RM_COMPONENT_LIST *pRMComponentList      = NULL;
     EXYNOS_OMX_RM_COMPONENT_LIST *pComponentTemp        = NULL;
     EXYNOS_OMX_RM_COMPONENT_LIST *pComponentCandidate   = NULL;
+    OMX_COMPONENTTYPE            *pCandidateComp        = NULL;
     int numElem       = 0;
     int lowCompDetect = 0;
     int maxResource   = 0;
@@ -425,6 +603,20 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
         numElem = 0;
     }
 
+    if (isVideoCodec(pExynosComponent->codecType) == OMX_TRUE) {
+        /* warm contexts of the session pool are not on the list, but are opened at the driver */
+        if ((getVideoInstanceNum() + Exynos_OMX_SessionPool_GetWarmNum()) >= MAX_RESOURCE_VIDEO_INSTANCE)
+            Exynos_OMX_SessionPool_Trim();
+
+        if (getVideoInstanceNum() >= MAX_RESOURCE_VIDEO_INSTANCE) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s][%s] no more MFC instance (%d)",
+                                                pExynosComponent, __FUNCTION__, pExynosComponent->componentName, MAX_RESOURCE_VIDEO_INSTANCE);
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT;
+        }
+    }
+
+    /* non-secure video sessions are counted against the MFC contexts above, their load is admitted on Loaded to Idle */
     if (numElem >= maxResource) {
         lowCompDetect = searchLowPriority(pRMComponentList,
                                           pExynosComponent->compPriority.nGroupPriority,
@@ -433,19 +625,25 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
             ret = OMX_ErrorInsufficientResources;
             goto EXIT;
         } else {
-            ret = removeComponent(pComponentCandidate->pOMXStandComp);
+            /* unlinked first, the preempted component must not be found on the list while it is moved to Loaded */
+            pCandidateComp = pComponentCandidate->pOMXStandComp;
+            ret = removeElementList(&pRMComponentList, pCandidateComp);
+            if (ret != OMX_ErrorNone)
+                goto EXIT;
+
+            ret = setRMList(pExynosComponent, gpRMList, pRMComponentList);
+            if (ret != OMX_ErrorNone)
+                goto EXIT;
+
+            ret = removeComponent(pCandidateComp);
             if (ret != OMX_ErrorNone) {
                 ret = OMX_ErrorInsufficientResources;
                 goto EXIT;
-            } else {
-                ret = removeElementList(&pRMComponentList, pComponentCandidate->pOMXStandComp);
-                if (ret != OMX_ErrorNone)
-                    goto EXIT;
-
-                ret = addElementList(&pRMComponentList, pOMXComponent);
-                if (ret != OMX_ErrorNone)
-                    goto EXIT;
             }
+
+            ret = addElementList(&pRMComponentList, pOMXComponent);
+            if (ret != OMX_ErrorNone)
+                goto EXIT;
         }
     } else {
         ret = addElementList(&pRMComponentList, pOMXComponent);
@@ -582,3 +780,144 @@ EXIT:
     return ret;
 }
 
+
+/*
+ * admits the MFC load of a video component on Loaded to Idle, once its ports
+ * are configured. lower priority idle components are preempted if the load
+ * does not fit in MAX_RESOURCE_VIDEO_LOAD.
+ */
+OMX_ERRORTYPE Exynos_OMX_Check_Resource_Load(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE                 ret                   = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT     *pExynosComponent      = NULL;
+    EXYNOS_OMX_RM_COMPONENT_LIST *pRMComponent          = NULL;
+    EXYNOS_OMX_RM_COMPONENT_LIST *pComponentCandidate   = NULL;
+    EXYNOS_OMX_RM_COMPONENT_LIST *pCandidateList        = NULL;
+    EXYNOS_OMX_BASECOMPONENT     *pCandidateExynos      = NULL;
+    OMX_COMPONENTTYPE            *pCandidateComp        = NULL;
+    OMX_U32 nLoad          = 0;
+    OMX_U32 nUsedLoad      = 0;
+    OMX_U32 nCandidateLoad = 0;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(ghVideoRMComponentListMutex);
+
+    pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    if (isVideoCodec(pExynosComponent->codecType) != OMX_TRUE) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    pRMComponent = findElementList(getRMList(pExynosComponent, gpRMList, NULL), pOMXComponent);
+    if (pRMComponent == NULL) {
+        /* preempted by a higher priority component */
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    pRMComponent->nLoad = 0;
+    nLoad     = calcVideoLoad(pExynosComponent);
+    nUsedLoad = getVideoLoad();
+
+    /* a single session is always admitted, even beyond the nominal capacity */
+    while ((nUsedLoad > 0) &&
+           (nUsedLoad + nLoad > MAX_RESOURCE_VIDEO_LOAD)) {
+        pComponentCandidate = searchLowPriorityLoad(pOMXComponent, pExynosComponent->compPriority.nGroupPriority);
+        if (pComponentCandidate == NULL) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s][%s] MFC is overloaded (%u + %u > %u MB/s)",
+                                                pExynosComponent, __FUNCTION__, pExynosComponent->componentName,
+                                                nUsedLoad, nLoad, (OMX_U32)MAX_RESOURCE_VIDEO_LOAD);
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT;
+        }
+
+        pCandidateComp  = pComponentCandidate->pOMXStandComp;
+        nCandidateLoad  = pComponentCandidate->nLoad;
+
+        Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s][%s] preempts %p to release %u MB/s",
+                                                pExynosComponent, __FUNCTION__, pExynosComponent->componentName,
+                                                pCandidateComp, nCandidateLoad);
+
+        /*
+         * unlinked first, as in Exynos_OMX_Get_Resource(). the preempted component
+         * fails its next Loaded to Idle and its node is not touched after it is freed.
+         */
+        pCandidateExynos = (EXYNOS_OMX_BASECOMPONENT *)pCandidateComp->pComponentPrivate;
+        pCandidateList   = getRMList(pCandidateExynos, gpRMList, NULL);
+        ret = removeElementList(&pCandidateList, pCandidateComp);
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        ret = setRMList(pCandidateExynos, gpRMList, pCandidateList);
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        nUsedLoad -= nCandidateLoad;
+
+        ret = removeComponent(pCandidateComp);
+        if (ret != OMX_ErrorNone) {
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT;
+        }
+    }
+
+    pRMComponent->nLoad = nLoad;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s][%s] MFC load %u MB/s, utilization %u/%u MB/s",
+                                            pExynosComponent, __FUNCTION__, pExynosComponent->componentName,
+                                            nLoad, nUsedLoad + nLoad, (OMX_U32)MAX_RESOURCE_VIDEO_LOAD);
+
+    ret = OMX_ErrorNone;
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
+/* gives the MFC load back on Idle to Loaded, the instance stays registered */
+OMX_ERRORTYPE Exynos_OMX_Release_Resource_Load(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE                 ret               = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT     *pExynosComponent  = NULL;
+    EXYNOS_OMX_RM_COMPONENT_LIST *pRMComponent      = NULL;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(ghVideoRMComponentListMutex);
+
+    pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    pRMComponent = findElementList(getRMList(pExynosComponent, gpRMList, NULL), pOMXComponent);
+    if (pRMComponent != NULL)
+        pRMComponent->nLoad = 0;
+
+    Exynos_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_OMX_Get_Resource_Utilization(
+    OMX_U32 *pnUsedLoad,
+    OMX_U32 *pnMaxLoad)
+{
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    if ((pnUsedLoad == NULL) ||
+        (pnMaxLoad == NULL)) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    Exynos_OSAL_MutexLock(ghVideoRMComponentListMutex);
+    *pnUsedLoad = getVideoLoad();
+    *pnMaxLoad  = MAX_RESOURCE_VIDEO_LOAD;
+    Exynos_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+EXIT:
+    return ret;
+}
@@ -42,6 +42,9 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_OMX_Check_Resource_Load(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_OMX_Release_Resource_Load(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_OMX_Get_Resource_Utilization(OMX_U32 *pnUsedLoad, OMX_U32 *pnMaxLoad);
 
 #ifdef __cplusplus
 };
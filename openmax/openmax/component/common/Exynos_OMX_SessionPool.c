@@ -0,0 +1,890 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file       Exynos_OMX_SessionPool.c
+ * @brief      warm MFC decoder sessions for thumbnail extraction
+ * @version    1.0.0
+ * @history
+ *    2019.06.03 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dlfcn.h>
+
+#include "Exynos_OMX_Def.h"
+#include "Exynos_OMX_Macros.h"
+#include "Exynos_OMX_SessionPool.h"
+#include "ExynosVideoApi.h"
+#include "Exynos_OSAL_Memory.h"
+#include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Thread.h"
+#include "Exynos_OSAL_SharedMemory.h"
+#include "Exynos_OSAL_Library.h"
+
+#undef  EXYNOS_LOG_TAG
+#define EXYNOS_LOG_TAG    "EXYNOS_SESSIONPOOL"
+//#define EXYNOS_LOG_OFF
+#include "Exynos_OSAL_Log.h"
+
+typedef ExynosVideoErrorType (*SESSIONPOOL_FINALIZE)(void *pHandle);
+
+/*
+ * a context has to be finalized by the copy of the video API that opened it,
+ * that copy is linked into the component library. hLibrary pins that library.
+ */
+typedef struct _SESSIONPOOL_CONTEXT
+{
+    void                   *hMFCHandle;
+    SESSIONPOOL_FINALIZE    Finalize;
+    OMX_HANDLETYPE          hLibrary;
+} SESSIONPOOL_CONTEXT;
+
+typedef struct _SESSIONPOOL_CODEC
+{
+    OMX_BOOL                 bValid;
+    OMX_BOOL                 bRefilling;
+    ExynosVideoInstInfo      instInfo;
+    void                  *(*Init)(ExynosVideoInstInfo *pVideoInfo);
+    SESSIONPOOL_FINALIZE     Finalize;
+    OMX_HANDLETYPE           hLibrary;
+    void                    *hMFCHandle[SESSIONPOOL_WARM_NUM];
+    int                      nWarm;
+    OMX_U64                  lastUsedTime;
+} SESSIONPOOL_CODEC;
+
+typedef struct _SESSIONPOOL_BUFFER
+{
+    OMX_PTR          pVirAddr;
+    unsigned long    fd;
+    OMX_U32          nSize;
+    OMX_BOOL         bInUse;
+} SESSIONPOOL_BUFFER;
+
+typedef struct _EXYNOS_OMX_SESSION_POOL
+{
+    OMX_HANDLETYPE           hMutex;
+    OMX_HANDLETYPE           hEvent;
+    OMX_HANDLETYPE           hThread;
+    OMX_HANDLETYPE           hSharedMemory;
+    OMX_BOOL                 bExit;
+
+    SESSIONPOOL_CODEC        codec[SESSIONPOOL_CODEC_NUM];
+    SESSIONPOOL_CONTEXT      retire[SESSIONPOOL_RETIRE_NUM];   /* used contexts waiting for Finalize */
+    int                      nRetire;
+
+    SESSIONPOOL_BUFFER       buffer[SESSIONPOOL_BUFFER_NUM];
+    OMX_U64                  lastBufferTime;
+} EXYNOS_OMX_SESSION_POOL;
+
+#define SESSIONPOOL_FINALIZE_NUM    (SESSIONPOOL_RETIRE_NUM + (SESSIONPOOL_CODEC_NUM * (SESSIONPOOL_WARM_NUM + 1)))
+
+/* stream buffers are allocated by the class, so that a set fits any stream of the same class */
+static const OMX_U32 gStreamSizeClass[] = {
+    (1024 * 1024 * 3 / 2),              /* up to HD */
+    ALIGN(1920 * 1088 * 3 / 2, 4096),   /* FHD */
+    ALIGN(3840 * 2176 * 3 / 2, 4096),   /* UHD */
+};
+
+/* callers hold a reference while they use the pool, Deinit waits for them */
+static EXYNOS_OMX_SESSION_POOL *gpSessionPool = NULL;
+static int                      gSessionPoolRef = 0;
+static pthread_mutex_t          gSessionPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t           gSessionPoolCond = PTHREAD_COND_INITIALIZER;
+
+static EXYNOS_OMX_SESSION_POOL *SessionPool_Acquire()
+{
+    EXYNOS_OMX_SESSION_POOL *pPool = NULL;
+
+    pthread_mutex_lock(&gSessionPoolLock);
+    pPool = gpSessionPool;
+    if (pPool != NULL)
+        gSessionPoolRef++;
+    pthread_mutex_unlock(&gSessionPoolLock);
+
+    return pPool;
+}
+
+static void SessionPool_Release(EXYNOS_OMX_SESSION_POOL *pPool)
+{
+    if (pPool == NULL)
+        return;
+
+    pthread_mutex_lock(&gSessionPoolLock);
+    gSessionPoolRef--;
+    if (gSessionPoolRef == 0)
+        pthread_cond_broadcast(&gSessionPoolCond);
+    pthread_mutex_unlock(&gSessionPoolLock);
+}
+
+static OMX_U64 SessionPool_GetTime()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((OMX_U64)now.tv_sec * 1000) + ((OMX_U64)now.tv_nsec / 1000000);
+}
+
+static OMX_U32 SessionPool_GetSizeClass(OMX_U32 nSize)
+{
+    int i;
+
+    for (i = 0; i < (int)(sizeof(gStreamSizeClass) / sizeof(gStreamSizeClass[0])); i++) {
+        if (nSize <= gStreamSizeClass[i])
+            return gStreamSizeClass[i];
+    }
+
+    return 0;
+}
+
+/* takes a reference to the library that has pFunc, it is already loaded by the caller */
+static OMX_HANDLETYPE SessionPool_PinLibrary(void *pFunc)
+{
+    OMX_HANDLETYPE hLibrary = NULL;
+    Dl_info        info;
+
+    if ((dladdr(pFunc, &info) == 0) ||
+        (info.dli_fname == NULL)) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to find the library of %p", __FUNCTION__, pFunc);
+        return NULL;
+    }
+
+    hLibrary = Exynos_OSAL_dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD);
+    if (hLibrary == NULL)
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to pin %s : %s", __FUNCTION__, info.dli_fname, Exynos_OSAL_dlerror());
+
+    return hLibrary;
+}
+
+/* finalizes contexts in order, and then drops the library that each of them pins */
+static void SessionPool_Finalize(
+    SESSIONPOOL_CONTEXT *pContext,
+    int                  nContext)
+{
+    int i;
+
+    for (i = 0; i < nContext; i++) {
+        if (pContext[i].hMFCHandle != NULL)
+            pContext[i].Finalize(pContext[i].hMFCHandle);
+
+        if (pContext[i].hLibrary != NULL)
+            Exynos_OSAL_dlclose(pContext[i].hLibrary);
+    }
+}
+
+/*
+ * a warm context only knows the device, the instance info it was opened with,
+ * and the video API that opened it.
+ */
+static OMX_BOOL SessionPool_IsSameCodec(
+    SESSIONPOOL_CODEC   *pCodec,
+    ExynosVideoInstInfo *pInfo,
+    void              *(*Init)(ExynosVideoInstInfo *pVideoInfo))
+{
+    if ((pCodec->instInfo.eCodecType == pInfo->eCodecType) &&
+        (pCodec->instInfo.eSecurityType == pInfo->eSecurityType) &&
+        (pCodec->instInfo.nMemoryType == pInfo->nMemoryType) &&
+        (pCodec->instInfo.HwVersion == pInfo->HwVersion) &&
+        (pCodec->Init == Init))
+        return OMX_TRUE;
+
+    return OMX_FALSE;
+}
+
+/* the next refill uses the latest borrower's info without what belongs to its session */
+static void SessionPool_SetInstInfo(
+    SESSIONPOOL_CODEC   *pCodec,
+    ExynosVideoInstInfo *pInfo)
+{
+    Exynos_OSAL_Memcpy(&pCodec->instInfo, pInfo, sizeof(ExynosVideoInstInfo));
+
+    pCodec->instInfo.nWidth     = 0;
+    pCodec->instInfo.nHeight    = 0;
+    pCodec->instInfo.nBitrate   = 0;
+    pCodec->instInfo.xFramerate = 0;
+    pCodec->instInfo.bOTFMode   = VIDEO_FALSE;
+}
+
+/* moves warm contexts and the library reference of pCodec to pContext */
+static int SessionPool_DropCodec(
+    SESSIONPOOL_CODEC   *pCodec,
+    SESSIONPOOL_CONTEXT *pContext)
+{
+    int nContext = 0;
+
+    if (pCodec->bValid != OMX_TRUE)
+        return 0;
+
+    while (pCodec->nWarm > 0) {
+        pContext[nContext].hMFCHandle = pCodec->hMFCHandle[--pCodec->nWarm];
+        pContext[nContext].Finalize   = pCodec->Finalize;
+        pContext[nContext].hLibrary   = NULL;
+        nContext++;
+    }
+
+    pContext[nContext].hMFCHandle = NULL;
+    pContext[nContext].Finalize   = NULL;
+    pContext[nContext].hLibrary   = pCodec->hLibrary;
+    nContext++;
+
+    pCodec->hLibrary = NULL;
+    pCodec->Init     = NULL;
+    pCodec->Finalize = NULL;
+    pCodec->bValid   = OMX_FALSE;
+
+    return nContext;
+}
+
+static OMX_BOOL SessionPool_IsEmpty(EXYNOS_OMX_SESSION_POOL *pPool)
+{
+    int i;
+
+    if (pPool->nRetire > 0)
+        return OMX_FALSE;
+
+    for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++) {
+        if (pPool->codec[i].bValid == OMX_TRUE)
+            return OMX_FALSE;
+    }
+
+    for (i = 0; i < SESSIONPOOL_BUFFER_NUM; i++) {
+        if (pPool->buffer[i].pVirAddr != NULL)
+            return OMX_FALSE;
+    }
+
+    return OMX_TRUE;
+}
+
+static void SessionPool_FreeBuffers(
+    EXYNOS_OMX_SESSION_POOL *pPool,
+    OMX_BOOL                 bIncludeInUse)
+{
+    int i;
+
+    for (i = 0; i < SESSIONPOOL_BUFFER_NUM; i++) {
+        SESSIONPOOL_BUFFER *pBuffer = &pPool->buffer[i];
+
+        if ((pBuffer->pVirAddr == NULL) ||
+            ((pBuffer->bInUse == OMX_TRUE) && (bIncludeInUse == OMX_FALSE)))
+            continue;
+
+        Exynos_OSAL_SharedMemory_Free(pPool->hSharedMemory, pBuffer->pVirAddr);
+        Exynos_OSAL_Memset(pBuffer, 0, sizeof(SESSIONPOOL_BUFFER));
+    }
+}
+
+static OMX_ERRORTYPE Exynos_OMX_SessionPoolThread(OMX_PTR threadData)
+{
+    OMX_ERRORTYPE            ret    = OMX_ErrorNone;
+    EXYNOS_OMX_SESSION_POOL *pPool  = (EXYNOS_OMX_SESSION_POOL *)threadData;
+    OMX_U32                  nWait  = DEF_MAX_WAIT_TIME;
+
+    FunctionIn();
+
+    if (pPool == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    while (1) {
+        SESSIONPOOL_CONTEXT  finalize[SESSIONPOOL_FINALIZE_NUM];
+        SESSIONPOOL_CONTEXT  refill;
+        ExynosVideoInstInfo  instInfo;
+        void              *(*Init)(ExynosVideoInstInfo *pVideoInfo) = NULL;
+        OMX_BOOL             bExit      = OMX_FALSE;
+        OMX_BOOL             bMore      = OMX_FALSE;
+        OMX_U64              now        = 0;
+        int                  nFinalize  = 0;
+        int                  nRefill    = -1;
+        int                  i;
+
+        Exynos_OSAL_SignalWait(pPool->hEvent, nWait);
+        Exynos_OSAL_SignalReset(pPool->hEvent);
+
+        Exynos_OSAL_MutexLock(pPool->hMutex);
+
+        bExit = pPool->bExit;
+        now   = SessionPool_GetTime();
+
+        for (i = 0; i < pPool->nRetire; i++)
+            finalize[nFinalize++] = pPool->retire[i];
+        pPool->nRetire = 0;
+
+        for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++) {
+            SESSIONPOOL_CODEC *pCodec = &pPool->codec[i];
+
+            if (pCodec->bValid != OMX_TRUE)
+                continue;
+
+            if ((bExit == OMX_TRUE) ||
+                ((now - pCodec->lastUsedTime) >= SESSIONPOOL_IDLE_TIMEOUT)) {
+                nFinalize += SessionPool_DropCodec(pCodec, &finalize[nFinalize]);
+            } else if ((pCodec->nWarm < SESSIONPOOL_WARM_NUM) &&
+                       (pCodec->bRefilling == OMX_FALSE) &&
+                       (nRefill < 0)) {
+                /* the codec can be dropped while Init is running, so it has its own reference */
+                refill.hLibrary = SessionPool_PinLibrary((void *)pCodec->Init);
+                if (refill.hLibrary == NULL)
+                    continue;
+
+                Exynos_OSAL_Memcpy(&instInfo, &pCodec->instInfo, sizeof(ExynosVideoInstInfo));
+                Init            = pCodec->Init;
+                refill.Finalize = pCodec->Finalize;
+                pCodec->bRefilling = OMX_TRUE;
+                nRefill = i;
+            }
+        }
+
+        if ((bExit == OMX_TRUE) ||
+            ((now - pPool->lastBufferTime) >= SESSIONPOOL_IDLE_TIMEOUT))
+            SessionPool_FreeBuffers(pPool, OMX_FALSE);
+
+        Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+        /* teardown of used sessions is done here instead of the component */
+        SessionPool_Finalize(finalize, nFinalize);
+
+        if (nFinalize > 0)
+            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%s] %d contexts are finalized", __FUNCTION__, nFinalize);
+
+        if (bExit == OMX_TRUE)
+            break;
+
+        if (nRefill >= 0) {
+            SESSIONPOOL_CODEC *pCodec = &pPool->codec[nRefill];
+
+            refill.hMFCHandle = Init(&instInfo);
+
+            Exynos_OSAL_MutexLock(pPool->hMutex);
+
+            pCodec->bRefilling = OMX_FALSE;
+            if ((refill.hMFCHandle != NULL) &&
+                (pCodec->bValid == OMX_TRUE) &&
+                (SessionPool_IsSameCodec(pCodec, &instInfo, Init) == OMX_TRUE) &&
+                (pCodec->nWarm < SESSIONPOOL_WARM_NUM)) {
+                pCodec->hMFCHandle[pCodec->nWarm++] = refill.hMFCHandle;
+                refill.hMFCHandle = NULL;
+
+                /* keep going until it is full, but not on a failure of Init */
+                bMore = OMX_TRUE;
+            }
+
+            Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+            SessionPool_Finalize(&refill, 1);
+
+            if (bMore == OMX_TRUE)
+                Exynos_OSAL_SignalSet(pPool->hEvent);
+        }
+
+        Exynos_OSAL_MutexLock(pPool->hMutex);
+        nWait = (SessionPool_IsEmpty(pPool) == OMX_TRUE)? DEF_MAX_WAIT_TIME:SESSIONPOOL_IDLE_TIMEOUT;
+        Exynos_OSAL_MutexUnlock(pPool->hMutex);
+    }
+
+    Exynos_OSAL_ThreadExit(NULL);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_OMX_SessionPool_Init()
+{
+    OMX_ERRORTYPE            ret    = OMX_ErrorNone;
+    EXYNOS_OMX_SESSION_POOL *pPool  = NULL;
+
+    FunctionIn();
+
+    pthread_mutex_lock(&gSessionPoolLock);
+
+    if (gpSessionPool != NULL) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    pPool = (EXYNOS_OMX_SESSION_POOL *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_SESSION_POOL));
+    if (pPool == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    Exynos_OSAL_Memset(pPool, 0, sizeof(EXYNOS_OMX_SESSION_POOL));
+
+    ret = Exynos_OSAL_MutexCreate(&pPool->hMutex);
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    ret = Exynos_OSAL_SignalCreate(&pPool->hEvent);
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    /* without it, only contexts are kept */
+    pPool->hSharedMemory = Exynos_OSAL_SharedMemory_Open();
+
+    gpSessionPool = pPool;
+    ret = OMX_ErrorNone;
+
+EXIT:
+    if ((ret != OMX_ErrorNone) &&
+        (pPool != NULL)) {
+        if (pPool->hEvent != NULL)
+            Exynos_OSAL_SignalTerminate(pPool->hEvent);
+
+        if (pPool->hMutex != NULL)
+            Exynos_OSAL_MutexTerminate(pPool->hMutex);
+
+        Exynos_OSAL_Free(pPool);
+    }
+
+    pthread_mutex_unlock(&gSessionPoolLock);
+
+    FunctionOut();
+
+    return ret;
+}
+
+void Exynos_OMX_SessionPool_Deinit()
+{
+    EXYNOS_OMX_SESSION_POOL *pPool = NULL;
+
+    FunctionIn();
+
+    /* no one can get the pool from now on, and the last user is waited for */
+    pthread_mutex_lock(&gSessionPoolLock);
+    pPool = gpSessionPool;
+    gpSessionPool = NULL;
+    while (gSessionPoolRef > 0)
+        pthread_cond_wait(&gSessionPoolCond, &gSessionPoolLock);
+    pthread_mutex_unlock(&gSessionPoolLock);
+
+    if (pPool == NULL)
+        goto EXIT;
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+    pPool->bExit = OMX_TRUE;
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+    /* the thread finalizes all contexts on the way out */
+    if (pPool->hThread != NULL) {
+        Exynos_OSAL_SignalSet(pPool->hEvent);
+        Exynos_OSAL_ThreadTerminate(pPool->hThread);
+        pPool->hThread = NULL;
+    }
+
+    if (pPool->hSharedMemory != NULL) {
+        SessionPool_FreeBuffers(pPool, OMX_TRUE);
+        Exynos_OSAL_SharedMemory_Close(pPool->hSharedMemory);
+        pPool->hSharedMemory = NULL;
+    }
+
+    Exynos_OSAL_SignalTerminate(pPool->hEvent);
+    Exynos_OSAL_MutexTerminate(pPool->hMutex);
+    Exynos_OSAL_Free(pPool);
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
+
+/*
+ * returns OMX_ErrorNone if the session is managed by the pool.
+ * *phMFCHandle can be NULL even then, the caller opens its own context with pDecOps,
+ * and Exynos_OMX_SessionPool_PutDecoder() is used to close it anyway.
+ * a warm context is always one that pDecOps->Init opened.
+ */
+OMX_ERRORTYPE Exynos_OMX_SessionPool_GetDecoder(
+    ExynosVideoInstInfo *pVideoInstInfo,
+    ExynosVideoDecOps   *pDecOps,
+    void               **phMFCHandle)
+{
+    OMX_ERRORTYPE            ret        = OMX_ErrorNone;
+    EXYNOS_OMX_SESSION_POOL *pPool      = NULL;
+    SESSIONPOOL_CODEC       *pCodec     = NULL;
+    SESSIONPOOL_CONTEXT      drop[SESSIONPOOL_WARM_NUM + 1];
+    OMX_HANDLETYPE           hLibrary   = NULL;
+    int                      nDrop      = 0;
+    int                      i;
+
+    FunctionIn();
+
+    if ((pVideoInstInfo == NULL) ||
+        (pDecOps == NULL) ||
+        (pDecOps->Init == NULL) ||
+        (pDecOps->Finalize == NULL) ||
+        (phMFCHandle == NULL)) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    *phMFCHandle = NULL;
+
+    pPool = SessionPool_Acquire();
+    if (pPool == NULL) {
+        ret = OMX_ErrorNotReady;
+        goto EXIT;
+    }
+
+    if (pVideoInstInfo->eSecurityType != VIDEO_NORMAL) {
+        ret = OMX_ErrorUnsupportedSetting;
+        goto EXIT;
+    }
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+
+    if (pPool->hThread == NULL) {
+        if (Exynos_OSAL_ThreadCreate(&pPool->hThread,
+                                     Exynos_OMX_SessionPoolThread,
+                                     pPool) != OMX_ErrorNone) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to create a thread", __FUNCTION__);
+            pPool->hThread = NULL;
+            Exynos_OSAL_MutexUnlock(pPool->hMutex);
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT;
+        }
+    }
+
+    for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++) {
+        if ((pPool->codec[i].bValid == OMX_TRUE) &&
+            (SessionPool_IsSameCodec(&pPool->codec[i], pVideoInstInfo, pDecOps->Init) == OMX_TRUE)) {
+            pCodec = &pPool->codec[i];
+            break;
+        }
+    }
+
+    if (pCodec == NULL) {
+        /* the codec keeps the library of the ops until it is dropped */
+        hLibrary = SessionPool_PinLibrary((void *)pDecOps->Init);
+        if (hLibrary == NULL) {
+            Exynos_OSAL_MutexUnlock(pPool->hMutex);
+            ret = OMX_ErrorUndefined;
+            goto EXIT;
+        }
+
+        /* an empty slot or the least recently used one */
+        for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++) {
+            if (pPool->codec[i].bValid != OMX_TRUE) {
+                pCodec = &pPool->codec[i];
+                break;
+            }
+
+            if ((pCodec == NULL) ||
+                (pPool->codec[i].lastUsedTime < pCodec->lastUsedTime))
+                pCodec = &pPool->codec[i];
+        }
+
+        nDrop = SessionPool_DropCodec(pCodec, drop);
+
+        pCodec->Init     = pDecOps->Init;
+        pCodec->Finalize = pDecOps->Finalize;
+        pCodec->hLibrary = hLibrary;
+        pCodec->bValid   = OMX_TRUE;
+    }
+
+    SessionPool_SetInstInfo(pCodec, pVideoInstInfo);
+
+    if (pCodec->nWarm > 0)
+        *phMFCHandle = pCodec->hMFCHandle[--pCodec->nWarm];
+
+    pCodec->lastUsedTime = SessionPool_GetTime();
+
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+    SessionPool_Finalize(drop, nDrop);
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%s] codec(0x%x) : %s", __FUNCTION__,
+                                        pVideoInstInfo->eCodecType, (*phMFCHandle != NULL)? "warm":"cold");
+
+    /* refill */
+    Exynos_OSAL_SignalSet(pPool->hEvent);
+
+    ret = OMX_ErrorNone;
+
+EXIT:
+    SessionPool_Release(pPool);
+
+    FunctionOut();
+
+    return ret;
+}
+
+/* pDecOps has to be the one that was given to Exynos_OMX_SessionPool_GetDecoder() */
+void Exynos_OMX_SessionPool_PutDecoder(
+    ExynosVideoDecOps   *pDecOps,
+    void                *hMFCHandle)
+{
+    EXYNOS_OMX_SESSION_POOL *pPool   = NULL;
+    SESSIONPOOL_CONTEXT      context;
+
+    FunctionIn();
+
+    if ((pDecOps == NULL) ||
+        (pDecOps->Finalize == NULL) ||
+        (hMFCHandle == NULL))
+        goto EXIT;
+
+    context.hMFCHandle = hMFCHandle;
+    context.Finalize   = pDecOps->Finalize;
+    context.hLibrary   = NULL;
+
+    pPool = SessionPool_Acquire();
+    if (pPool != NULL) {
+        Exynos_OSAL_MutexLock(pPool->hMutex);
+        if ((pPool->hThread != NULL) &&
+            (pPool->nRetire < SESSIONPOOL_RETIRE_NUM)) {
+            /* the component library can be unloaded before the thread gets to it */
+            context.hLibrary = SessionPool_PinLibrary((void *)pDecOps->Finalize);
+            if (context.hLibrary != NULL) {
+                pPool->retire[pPool->nRetire++] = context;
+                context.hMFCHandle = NULL;
+            }
+        }
+        Exynos_OSAL_MutexUnlock(pPool->hMutex);
+    }
+
+    if (context.hMFCHandle != NULL)
+        context.Finalize(context.hMFCHandle);
+    else
+        Exynos_OSAL_SignalSet(pPool->hEvent);
+
+EXIT:
+    SessionPool_Release(pPool);
+
+    FunctionOut();
+
+    return;
+}
+
+/*
+ * lends nCount stream buffers of the class that nSize belongs to.
+ * returns the size of them, 0 means that the caller has to allocate by itself.
+ */
+OMX_U32 Exynos_OMX_SessionPool_GetStreamBuffers(
+    OMX_U32          nSize,
+    int              nCount,
+    OMX_PTR          pVirAddr[],
+    unsigned long    fd[])
+{
+    EXYNOS_OMX_SESSION_POOL *pPool      = NULL;
+    OMX_U32                  nClassSize = 0;
+    int                      nGot       = 0;
+    int                      i, j;
+
+    FunctionIn();
+
+    pPool = SessionPool_Acquire();
+    if ((pPool == NULL) ||
+        (pPool->hSharedMemory == NULL) ||
+        (pVirAddr == NULL) ||
+        (fd == NULL))
+        goto EXIT;
+
+    nClassSize = SessionPool_GetSizeClass(nSize);
+    if (nClassSize == 0)
+        goto EXIT;
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+
+    for (i = 0; i < nCount; i++) {
+        SESSIONPOOL_BUFFER *pBuffer = NULL;
+
+        for (j = 0; j < SESSIONPOOL_BUFFER_NUM; j++) {
+            if ((pPool->buffer[j].pVirAddr != NULL) &&
+                (pPool->buffer[j].bInUse == OMX_FALSE) &&
+                (pPool->buffer[j].nSize == nClassSize)) {
+                pBuffer = &pPool->buffer[j];
+                break;
+            }
+        }
+
+        if (pBuffer == NULL) {
+            /* an empty slot, or a slot having an idle buffer of other class */
+            for (j = 0; j < SESSIONPOOL_BUFFER_NUM; j++) {
+                if (pPool->buffer[j].pVirAddr == NULL) {
+                    pBuffer = &pPool->buffer[j];
+                    break;
+                }
+
+                if ((pBuffer == NULL) &&
+                    (pPool->buffer[j].bInUse == OMX_FALSE))
+                    pBuffer = &pPool->buffer[j];
+            }
+
+            if (pBuffer == NULL)
+                break;
+
+            if (pBuffer->pVirAddr != NULL) {
+                Exynos_OSAL_SharedMemory_Free(pPool->hSharedMemory, pBuffer->pVirAddr);
+                Exynos_OSAL_Memset(pBuffer, 0, sizeof(SESSIONPOOL_BUFFER));
+            }
+
+            pBuffer->pVirAddr = Exynos_OSAL_SharedMemory_Alloc(pPool->hSharedMemory, nClassSize, CACHED_MEMORY);
+            if (pBuffer->pVirAddr == NULL)
+                break;
+
+            pBuffer->fd    = Exynos_OSAL_SharedMemory_VirtToION(pPool->hSharedMemory, pBuffer->pVirAddr);
+            pBuffer->nSize = nClassSize;
+        }
+
+        pBuffer->bInUse = OMX_TRUE;
+        pVirAddr[i]     = pBuffer->pVirAddr;
+        fd[i]           = pBuffer->fd;
+        nGot++;
+    }
+
+    if (nGot < nCount) {
+        /* all or nothing */
+        for (i = 0; i < nGot; i++) {
+            for (j = 0; j < SESSIONPOOL_BUFFER_NUM; j++) {
+                if (pPool->buffer[j].pVirAddr == pVirAddr[i])
+                    pPool->buffer[j].bInUse = OMX_FALSE;
+            }
+        }
+
+        nClassSize = 0;
+    }
+
+    pPool->lastBufferTime = SessionPool_GetTime();
+
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+EXIT:
+    SessionPool_Release(pPool);
+
+    FunctionOut();
+
+    return nClassSize;
+}
+
+void Exynos_OMX_SessionPool_PutStreamBuffers(
+    OMX_U32  nSize,
+    int      nCount,
+    OMX_PTR  pVirAddr[])
+{
+    EXYNOS_OMX_SESSION_POOL *pPool = NULL;
+
+    int i, j;
+
+    FunctionIn();
+
+    pPool = SessionPool_Acquire();
+    if ((pPool == NULL) ||
+        (pVirAddr == NULL))
+        goto EXIT;
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+
+    for (i = 0; i < nCount; i++) {
+        for (j = 0; j < SESSIONPOOL_BUFFER_NUM; j++) {
+            if ((pVirAddr[i] != NULL) &&
+                (pPool->buffer[j].pVirAddr == pVirAddr[i]) &&
+                (pPool->buffer[j].nSize == nSize)) {
+                pPool->buffer[j].bInUse = OMX_FALSE;
+                break;
+            }
+        }
+    }
+
+    pPool->lastBufferTime = SessionPool_GetTime();
+
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+    /* wake it up to arm the idle timer */
+    Exynos_OSAL_SignalSet(pPool->hEvent);
+
+EXIT:
+    SessionPool_Release(pPool);
+
+    FunctionOut();
+
+    return;
+}
+
+/* warm contexts hold MFC instances as well as the running sessions */
+OMX_U32 Exynos_OMX_SessionPool_GetWarmNum()
+{
+    EXYNOS_OMX_SESSION_POOL *pPool = NULL;
+    OMX_U32                  nWarm = 0;
+
+    int i;
+
+    pPool = SessionPool_Acquire();
+    if (pPool == NULL)
+        return 0;
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+
+    for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++) {
+        nWarm += pPool->codec[i].nWarm;
+        if (pPool->codec[i].bRefilling == OMX_TRUE)
+            nWarm++;
+    }
+
+    nWarm += pPool->nRetire;
+
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+    SessionPool_Release(pPool);
+
+    return nWarm;
+}
+
+/* gives all warm contexts back to the driver at once */
+void Exynos_OMX_SessionPool_Trim()
+{
+    EXYNOS_OMX_SESSION_POOL *pPool = NULL;
+    SESSIONPOOL_CONTEXT      finalize[SESSIONPOOL_FINALIZE_NUM];
+    int                      nFinalize = 0;
+
+    int i;
+
+    FunctionIn();
+
+    pPool = SessionPool_Acquire();
+    if (pPool == NULL)
+        goto EXIT;
+
+    Exynos_OSAL_MutexLock(pPool->hMutex);
+
+    for (i = 0; i < pPool->nRetire; i++)
+        finalize[nFinalize++] = pPool->retire[i];
+    pPool->nRetire = 0;
+
+    for (i = 0; i < SESSIONPOOL_CODEC_NUM; i++)
+        nFinalize += SessionPool_DropCodec(&pPool->codec[i], &finalize[nFinalize]);
+
+    Exynos_OSAL_MutexUnlock(pPool->hMutex);
+
+    SessionPool_Finalize(finalize, nFinalize);
+
+    if (nFinalize > 0)
+        Exynos_OSAL_Log(EXYNOS_LOG_INFO, "[%s] %d contexts are released", __FUNCTION__, nFinalize);
+
+EXIT:
+    SessionPool_Release(pPool);
+
+    FunctionOut();
+
+    return;
+}
@@ -0,0 +1,72 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file       Exynos_OMX_SessionPool.h
+ * @brief      warm MFC decoder sessions for thumbnail extraction
+ * @version    1.0.0
+ * @history
+ *    2019.06.03 : Create
+ */
+
+#ifndef EXYNOS_OMX_SESSIONPOOL
+#define EXYNOS_OMX_SESSIONPOOL
+
+
+#include "Exynos_OMX_Def.h"
+#include "OMX_Component.h"
+
+/*
+ * thumbnail extraction opens a lot of short sessions one after another.
+ * the pool lives in the resource manager library, which stays loaded while the
+ * component libraries are loaded and unloaded per instance, and keeps
+ *  - decoder contexts that are opened and queried but not configured yet,
+ *    they are refilled and finalized on the pool thread, not on the caller.
+ *    the pool has no video API of its own, contexts are opened and finalized
+ *    by the ops of the component, whose library is pinned while they are kept.
+ *  - stream buffers grouped by resolution class.
+ * anything unused for SESSIONPOOL_IDLE_TIMEOUT is released.
+ */
+#define SESSIONPOOL_WARM_NUM        2       /* warm contexts per codec */
+#define SESSIONPOOL_CODEC_NUM       4
+#define SESSIONPOOL_RETIRE_NUM      8
+#define SESSIONPOOL_BUFFER_NUM      12
+#define SESSIONPOOL_IDLE_TIMEOUT    5000    /* ms */
+
+/* ExynosVideoApi.h is not visible to the resource manager */
+struct _ExynosVideoInstInfo;
+struct _ExynosVideoDecOps;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OMX_ERRORTYPE Exynos_OMX_SessionPool_Init();
+void Exynos_OMX_SessionPool_Deinit();
+
+OMX_ERRORTYPE Exynos_OMX_SessionPool_GetDecoder(struct _ExynosVideoInstInfo *pVideoInstInfo, struct _ExynosVideoDecOps *pDecOps, void **phMFCHandle);
+void Exynos_OMX_SessionPool_PutDecoder(struct _ExynosVideoDecOps *pDecOps, void *hMFCHandle);
+OMX_U32 Exynos_OMX_SessionPool_GetStreamBuffers(OMX_U32 nSize, int nCount, OMX_PTR pVirAddr[], unsigned long fd[]);
+void Exynos_OMX_SessionPool_PutStreamBuffers(OMX_U32 nSize, int nCount, OMX_PTR pVirAddr[]);
+OMX_U32 Exynos_OMX_SessionPool_GetWarmNum();
+void Exynos_OMX_SessionPool_Trim();
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -3,6 +3,7 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
 	Exynos_OMX_VdecControl.c \
+	Exynos_OMX_VdecReorder.c \
 	Exynos_OMX_Vdec.c
 
 LOCAL_MODULE := libExynosOMX_Vdec
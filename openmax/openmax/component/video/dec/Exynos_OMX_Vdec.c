@@ -34,11 +34,13 @@
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_SessionPool.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
+#include "Exynos_OSAL_Latency.h"
 
 #include "Exynos_OSAL_Platform.h"
 
@@ -219,7 +221,11 @@ void Exynos_Free_CodecBuffers(
                                                 pExynosComponent, __FUNCTION__,
                                                 (nPortIndex == INPUT_PORT_INDEX)? "input":"output",
                                                 i, j, ppCodecBuffer[i]->fd[j]);
-                    Exynos_OSAL_SharedMemory_Free(pVideoDec->hSharedMemory, ppCodecBuffer[i]->pVirAddr[j]);
+                    if ((nPortIndex == INPUT_PORT_INDEX) &&
+                        (pVideoDec->bPooledInputBuffers == OMX_TRUE))
+                        Exynos_OMX_SessionPool_PutStreamBuffers(ppCodecBuffer[i]->bufferSize[j], 1, &ppCodecBuffer[i]->pVirAddr[j]);
+                    else
+                        Exynos_OSAL_SharedMemory_Free(pVideoDec->hSharedMemory, ppCodecBuffer[i]->pVirAddr[j]);
                 }
             }
 
@@ -228,6 +234,9 @@ void Exynos_Free_CodecBuffers(
         }
     }
 
+    if (nPortIndex == INPUT_PORT_INDEX)
+        pVideoDec->bPooledInputBuffers = OMX_FALSE;
+
     FunctionOut();
 }
 
@@ -243,6 +252,10 @@ OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(
     MEMORY_TYPE                      eMemoryType        = CACHED_MEMORY;
     CODEC_DEC_BUFFER               **ppCodecBuffer      = NULL;
 
+    OMX_PTR       pPoolAddr[MFC_INPUT_BUFFER_NUM_MAX];
+    unsigned long nPoolFd[MFC_INPUT_BUFFER_NUM_MAX];
+    OMX_U32       nPoolSize = 0;
+
     int nPlaneCnt = 0;
     int i, j;
 
@@ -261,6 +274,16 @@ OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(
     if (pExynosComponent->codecType == HW_VIDEO_DEC_SECURE_CODEC)
         eMemoryType = SECURE_MEMORY;
 
+    /* thumbnail sessions come and go, stream buffers are kept by the session pool */
+    if ((nPortIndex == INPUT_PORT_INDEX) &&
+        (pVideoDec->bThumbnailMode == OMX_TRUE) &&
+        (eMemoryType == CACHED_MEMORY) &&
+        (nPlaneCnt == 1) &&
+        (nBufferCnt <= MFC_INPUT_BUFFER_NUM_MAX)) {
+        nPoolSize = Exynos_OMX_SessionPool_GetStreamBuffers(nAllocLen[0], nBufferCnt, pPoolAddr, nPoolFd);
+        pVideoDec->bPooledInputBuffers = (nPoolSize > 0)? OMX_TRUE:OMX_FALSE;
+    }
+
     for (i = 0; i < nBufferCnt; i++) {
         ppCodecBuffer[i] = (CODEC_DEC_BUFFER *)Exynos_OSAL_Malloc(sizeof(CODEC_DEC_BUFFER));
         if (ppCodecBuffer[i] == NULL) {
@@ -270,6 +293,14 @@ OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(
         }
         Exynos_OSAL_Memset(ppCodecBuffer[i], 0, sizeof(CODEC_DEC_BUFFER));
 
+        if (nPoolSize > 0) {
+            ppCodecBuffer[i]->pVirAddr[0]   = pPoolAddr[i];
+            ppCodecBuffer[i]->fd[0]         = nPoolFd[i];
+            ppCodecBuffer[i]->bufferSize[0] = nPoolSize;
+            ppCodecBuffer[i]->dataSize      = 0;
+            continue;
+        }
+
         for (j = 0; j < nPlaneCnt; j++) {
             ppCodecBuffer[i]->pVirAddr[j] =
                 (void *)Exynos_OSAL_SharedMemory_Alloc(pVideoDec->hSharedMemory, nAllocLen[j], eMemoryType);
@@ -298,6 +329,11 @@ OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(
     return OMX_ErrorNone;
 
 EXIT:
+    /* the ones not attached to a codec buffer yet */
+    if ((nPoolSize > 0) &&
+        (i < nBufferCnt))
+        Exynos_OMX_SessionPool_PutStreamBuffers(nPoolSize, nBufferCnt - i, &pPoolAddr[i]);
+
     Exynos_Free_CodecBuffers(pOMXComponent, nPortIndex);
 
     FunctionOut();
@@ -305,152 +341,6 @@ EXIT:
     return ret;
 }
 
-void Exynos_SetReorderTimestamp(
-    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
-    OMX_U32                     *nIndex,
-    OMX_TICKS                    timeStamp,
-    OMX_U32                      nFlags) {
-
-    int i;
-
-    FunctionIn();
-
-    if ((pExynosComponent == NULL) || (nIndex == NULL)) {
-        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
-        goto EXIT;
-    }
-
-    /* find a empty slot */
-    for (i = 0; i < MAX_TIMESTAMP; i++) {
-        if (pExynosComponent->bTimestampSlotUsed[*nIndex] == OMX_FALSE)
-            break;
-
-        (*nIndex)++;
-        (*nIndex) %= MAX_TIMESTAMP;
-    }
-
-    if (i >= MAX_TIMESTAMP)
-        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] Can not find empty slot of timestamp. Timestamp slot is full.",
-                                            pExynosComponent, __FUNCTION__);
-
-    pExynosComponent->timeStamp[*nIndex]          = timeStamp;
-    pExynosComponent->nFlags[*nIndex]             = nFlags;
-    pExynosComponent->bTimestampSlotUsed[*nIndex] = OMX_TRUE;
-
-EXIT:
-    FunctionOut();
-
-    return;
-}
-
-void Exynos_GetReorderTimestamp(
-    EXYNOS_OMX_BASECOMPONENT            *pExynosComponent,
-    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP  *sCurrentTimestamp,
-    OMX_S32                              nFrameIndex,
-    OMX_S32                              eFrameType) {
-
-    EXYNOS_OMX_BASEPORT         *pExynosOutputPort  = NULL;
-    int i = 0;
-
-    FunctionIn();
-
-    if ((pExynosComponent == NULL) || (sCurrentTimestamp == NULL)) {
-        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
-        goto EXIT;
-    }
-
-    pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
-
-    Exynos_OSAL_Memset(sCurrentTimestamp, 0, sizeof(EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP));
-    sCurrentTimestamp->timeStamp = DEFAULT_TIMESTAMP_VAL;
-
-    for (i = 0; i < MAX_TIMESTAMP; i++) {
-        /* NOTE: In case of CODECCONFIG, no return any frame */
-        if ((pExynosComponent->bTimestampSlotUsed[i] == OMX_TRUE) &&
-            (pExynosComponent->nFlags[i] != (OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_ENDOFFRAME))) {
-
-            /* NOTE: In case of EOS, timestamp is not valid */
-            if ((sCurrentTimestamp->timeStamp == DEFAULT_TIMESTAMP_VAL) ||
-                ((sCurrentTimestamp->timeStamp > pExynosComponent->timeStamp[i]) &&
-                    (((pExynosComponent->nFlags[i] & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS) ||
-                     (pExynosComponent->bBehaviorEOS == OMX_TRUE))) ||
-                ((sCurrentTimestamp->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-                sCurrentTimestamp->timeStamp = pExynosComponent->timeStamp[i];
-                sCurrentTimestamp->nFlags    = pExynosComponent->nFlags[i];
-                sCurrentTimestamp->nIndex    = i;
-            }
-        }
-    }
-
-    if (sCurrentTimestamp->timeStamp == DEFAULT_TIMESTAMP_VAL)
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] could not find a valid timestamp", pExynosComponent, __FUNCTION__);
-
-    /* PTS : all index is same as tag */
-    /* DTS : only in case of I-Frame, the index is same as tag */
-    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] disp_pic_frame_type: %d", pExynosComponent, __FUNCTION__, eFrameType);
-    if ((ExynosVideoFrameType)eFrameType & VIDEO_FRAME_I) {
-        /* Timestamp is weird */
-        if (sCurrentTimestamp->nIndex != nFrameIndex) {
-            Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] Timestamp is not same in spite of I-Frame", pExynosComponent, __FUNCTION__);
-
-            /* trust a tag index returned from D/D */
-            sCurrentTimestamp->timeStamp = pExynosComponent->timeStamp[nFrameIndex];
-            sCurrentTimestamp->nFlags    = pExynosComponent->nFlags[nFrameIndex];
-            sCurrentTimestamp->nIndex    = nFrameIndex;
-
-            /* delete past timestamps */
-            for(i = 0; i < MAX_TIMESTAMP; i++) {
-                if ((pExynosComponent->bTimestampSlotUsed[i] == OMX_TRUE) &&
-                    ((sCurrentTimestamp->timeStamp > pExynosComponent->timeStamp[i]) &&
-                        ((pExynosComponent->nFlags[i] & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS))) {
-                    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] clear an past timestamp %lld us (%.2f secs)",
-                                                            pExynosComponent, __FUNCTION__,
-                                                            pExynosComponent->timeStamp[i], (double)(pExynosComponent->timeStamp[i] / 1E6));
-                    pExynosComponent->nFlags[i]             = 0x00;
-                    pExynosComponent->bTimestampSlotUsed[i] = OMX_FALSE;
-                }
-
-                if ((pExynosComponent->bTimestampSlotUsed[i] == OMX_FALSE) &&
-                    (sCurrentTimestamp->timeStamp < pExynosComponent->timeStamp[i])) {
-                    pExynosComponent->bTimestampSlotUsed[i] = OMX_TRUE;
-                    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] revive an past timestamp %lld us (%.2f secs) by I-frame sync",
-                                                            pExynosComponent, __FUNCTION__,
-                                                            pExynosComponent->timeStamp[i], (double)(pExynosComponent->timeStamp[i] / 1E6));
-                }
-            }
-        }
-
-        if (sCurrentTimestamp->timeStamp == DEFAULT_TIMESTAMP_VAL)
-            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] the index of frame(%d) about I-frame is wrong",
-                                                pExynosComponent, __FUNCTION__, nFrameIndex);
-
-        sCurrentTimestamp->nFlags |= OMX_BUFFERFLAG_SYNCFRAME;
-    }
-
-    if (eFrameType & VIDEO_FRAME_CORRUPT)
-        sCurrentTimestamp->nFlags |= OMX_BUFFERFLAG_DATACORRUPT;
-
-    if (sCurrentTimestamp->timeStamp != DEFAULT_TIMESTAMP_VAL) {
-        if (pExynosOutputPort->latestTimeStamp <= sCurrentTimestamp->timeStamp) {
-            pExynosOutputPort->latestTimeStamp = sCurrentTimestamp->timeStamp;
-        } else {
-            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] timestamp(%lld) is smaller than latest timeStamp(%lld), uses latestTimeStamp",
-                                pExynosComponent, __FUNCTION__,
-                                sCurrentTimestamp->timeStamp, pExynosOutputPort->latestTimeStamp);
-            sCurrentTimestamp->timeStamp = pExynosOutputPort->latestTimeStamp;
-        }
-    } else {
-        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] can't find a valid timestamp, uses latestTimeStamp(%lld)",
-                                pExynosComponent, __FUNCTION__, pExynosOutputPort->latestTimeStamp);
-        sCurrentTimestamp->timeStamp = pExynosOutputPort->latestTimeStamp;
-    }
-
-EXIT:
-    FunctionOut();
-
-    return;
-}
-
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex)
 {
     OMX_BOOL ret = OMX_FALSE;
@@ -910,6 +800,23 @@ EXIT:
     return ret;
 }
 
+static EXYNOS_OMX_BUFFERHEADERTYPE *Exynos_GetExtendBufferHeader(
+    EXYNOS_OMX_BASEPORT     *pExynosPort,
+    OMX_BUFFERHEADERTYPE    *pBufferHeader)
+{
+    int i;
+
+    if (pBufferHeader == NULL)
+        return NULL;
+
+    for (i = 0; i < MAX_BUFFER_NUM; i++) {
+        if (pExynosPort->extendBufferHeader[i].OMXBufferHeader == pBufferHeader)
+            return &(pExynosPort->extendBufferHeader[i]);
+    }
+
+    return NULL;
+}
+
 OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *srcInputData)
 {
     OMX_BOOL                         ret                = OMX_FALSE;
@@ -933,6 +840,8 @@ OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
 
     if (inputUseBuffer->dataValid == OMX_TRUE) {
         if (exynosInputPort->bufferProcessType & BUFFER_SHARE) {
+            EXYNOS_OMX_BUFFERHEADERTYPE *pExtBufferHeader = NULL;
+
             Exynos_Shared_BufferToData(exynosInputPort, inputUseBuffer, srcInputData);
 
             if (pExynosComponent->codecType == HW_VIDEO_DEC_SECURE_CODEC) {
@@ -967,7 +876,18 @@ OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 srcInputData->buffer.addr[0] = dataBuffer;
             }
 
-            if (exynosInputPort->eMetaDataType == METADATA_TYPE_DISABLED) {
+            if (pExynosComponent->codecType != HW_VIDEO_DEC_SECURE_CODEC)
+                pExtBufferHeader = Exynos_GetExtendBufferHeader(exynosInputPort, srcInputData->bufferHeader);
+
+            if ((pExtBufferHeader != NULL) &&
+                (pExtBufferHeader->buf_fd[0] != 0)) {
+                /* zero-copy input : fd(and va of native handle) was resolved when the buffer was registered */
+                srcInputData->buffer.fd[0] = pExtBufferHeader->buf_fd[0];
+
+                if ((exynosInputPort->eMetaDataType == METADATA_TYPE_HANDLE) &&
+                    (pExtBufferHeader->pYUVBuf[0] != NULL))
+                    srcInputData->buffer.addr[0] = pExtBufferHeader->pYUVBuf[0];
+            } else if (exynosInputPort->eMetaDataType == METADATA_TYPE_DISABLED) {
                 srcInputData->buffer.fd[0] =
                     Exynos_OSAL_SharedMemory_VirtToION(pVideoDec->hSharedMemory,
                                 srcInputData->buffer.addr[0]);
@@ -1050,6 +970,81 @@ EXIT:
     return ret;
 }
 
+static OMX_BOOL Exynos_ImgConvStage_Dequeue(EXYNOS_OMX_IMG_CONV_STAGE *pStage, EXYNOS_OMX_DATABUFFER *pDataBuffer)
+{
+    OMX_BOOL ret = OMX_FALSE;
+
+    Exynos_OSAL_MutexLock(pStage->hQueueMutex);
+    if (pStage->nCount > 0) {
+        Exynos_OSAL_Memcpy(pDataBuffer, &pStage->ring[pStage->nHead], sizeof(EXYNOS_OMX_DATABUFFER));
+        pStage->nHead = (pStage->nHead + 1) % MAX_BUFFER_NUM;
+        pStage->nCount--;
+        ret = OMX_TRUE;
+    }
+    Exynos_OSAL_MutexUnlock(pStage->hQueueMutex);
+
+    return ret;
+}
+
+static void Exynos_ImgConv_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATABUFFER *pDataBuffer)
+{
+    EXYNOS_OMX_BASECOMPONENT        *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEODEC_COMPONENT   *pVideoDec        = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_IMG_CONV_STAGE       *pStage           = &pVideoDec->imgConvStage;
+
+#ifdef USE_ANDROID
+    if (pVideoDec->hImgConv != NULL) {
+        if (pStage->hThread != NULL) {
+            /* the thread converts it while the next one is decoded, and returns in order */
+            Exynos_OSAL_MutexLock(pStage->hQueueMutex);
+            if (pStage->nCount < MAX_BUFFER_NUM) {
+                Exynos_OSAL_Memcpy(&pStage->ring[(pStage->nHead + pStage->nCount) % MAX_BUFFER_NUM],
+                                   pDataBuffer, sizeof(EXYNOS_OMX_DATABUFFER));
+                pStage->nCount++;
+                Exynos_OSAL_MutexUnlock(pStage->hQueueMutex);
+
+                Exynos_ResetDataBuffer(pDataBuffer);
+                Exynos_OSAL_SemaphorePost(pStage->hSemaphore);
+                return;
+            }
+            Exynos_OSAL_MutexUnlock(pStage->hQueueMutex);
+        }
+
+        if ((pDataBuffer->remainDataLen > 0) &&
+            (Exynos_OSAL_ImgConv_Run(pVideoDec->hImgConv, pOMXComponent, (OMX_PTR)pDataBuffer->bufferHeader->pBuffer) == OMX_ErrorNone))
+            pDataBuffer->nFlags |= OMX_BUFFERFLAG_CONVERTEDIMAGE;
+    }
+#endif
+
+    Exynos_OutputBufferReturn(pOMXComponent, pDataBuffer);
+
+    return;
+}
+
+void Exynos_ImgConvStage_Flush(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    EXYNOS_OMX_BASECOMPONENT        *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEODEC_COMPONENT   *pVideoDec        = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_DATABUFFER            dataBuffer;
+
+    FunctionIn();
+
+    if (pVideoDec->imgConvStage.hQueueMutex == NULL)
+        goto EXIT;
+
+    /* not converted, they are going to be dropped */
+    while (Exynos_ImgConvStage_Dequeue(&pVideoDec->imgConvStage, &dataBuffer) == OMX_TRUE) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] return a pending frame(%p)",
+                                            pExynosComponent, __FUNCTION__, dataBuffer.bufferHeader);
+        Exynos_OutputBufferReturn(pOMXComponent, &dataBuffer);
+    }
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
+
 OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *dstOutputData)
 {
     OMX_BOOL                         ret              = OMX_FALSE;
@@ -1117,7 +1112,11 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 (!CHECK_PORT_BEING_FLUSHED(exynosOutputPort))) {
 
                 if (dstOutputData->remainDataLen > 0) {
+                    OMX_U64 nStart = Exynos_OSAL_LatencyGetTime();
+
                     ret = Exynos_CSC_OutputData(pOMXComponent, dstOutputData);
+                    Exynos_OSAL_LatencyRecord(pExynosComponent->hLatency, LATENCY_STAGE_CSC,
+                                              (OMX_U32)(Exynos_OSAL_LatencyGetTime() - nStart));
                 } else {
                     ret = OMX_TRUE;
                 }
@@ -1131,15 +1130,7 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                     if ((outputUseBuffer->remainDataLen > 0) ||
                         (outputUseBuffer->nFlags & OMX_BUFFERFLAG_EOS) ||
                         (CHECK_PORT_BEING_FLUSHED(exynosOutputPort))) {
-#ifdef USE_ANDROID
-                        if ((pVideoDec->hImgConv != NULL) &&
-                            (outputUseBuffer->remainDataLen > 0)) {
-                            if (Exynos_OSAL_ImgConv_Run(pVideoDec->hImgConv, pOMXComponent, (OMX_PTR)outputUseBuffer->bufferHeader->pBuffer) == OMX_ErrorNone) {
-                                outputUseBuffer->nFlags |= OMX_BUFFERFLAG_CONVERTEDIMAGE;
-                            }
-                        }
-#endif
-                        Exynos_OutputBufferReturn(pOMXComponent, outputUseBuffer);
+                        Exynos_ImgConv_OutputBufferReturn(pOMXComponent, outputUseBuffer);
                     }
                 } else {
                     Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to CSC", pExynosComponent, __FUNCTION__);
@@ -1154,7 +1145,7 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 outputUseBuffer->remainDataLen = 0;
                 outputUseBuffer->nFlags = dstOutputData->nFlags;
                 outputUseBuffer->timeStamp = dstOutputData->timeStamp;
-                Exynos_OutputBufferReturn(pOMXComponent, outputUseBuffer);
+                Exynos_ImgConv_OutputBufferReturn(pOMXComponent, outputUseBuffer);
             } else {
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] codec buffer's remaining space(%d) is smaller than output data(%d)",
                                                     pExynosComponent, __FUNCTION__,
@@ -1170,15 +1161,7 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
             if ((outputUseBuffer->remainDataLen > 0) ||
                 (outputUseBuffer->nFlags & OMX_BUFFERFLAG_EOS) ||
                 (CHECK_PORT_BEING_FLUSHED(exynosOutputPort))) {
-#ifdef USE_ANDROID
-                if ((pVideoDec->hImgConv != NULL) &&
-                    (outputUseBuffer->remainDataLen > 0)) {
-                    if (Exynos_OSAL_ImgConv_Run(pVideoDec->hImgConv, pOMXComponent, (OMX_PTR)outputUseBuffer->bufferHeader->pBuffer) == OMX_ErrorNone) {
-                        outputUseBuffer->nFlags |= OMX_BUFFERFLAG_CONVERTEDIMAGE;
-                    }
-                }
-#endif
-                Exynos_OutputBufferReturn(pOMXComponent, outputUseBuffer);
+                Exynos_ImgConv_OutputBufferReturn(pOMXComponent, outputUseBuffer);
             } else {
                 Exynos_OMX_FillThisBufferAgain(pOMXComponent, outputUseBuffer->bufferHeader);
                 Exynos_ResetDataBuffer(outputUseBuffer);
@@ -1204,6 +1187,7 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
     EXYNOS_OMX_BASEPORT             *exynosOutputPort   = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     EXYNOS_OMX_DATABUFFER           *srcInputUseBuffer  = &exynosInputPort->way.port2WayDataBuffer.inputDataBuffer;
     EXYNOS_OMX_DATA                 *pSrcInputData      = &exynosInputPort->processData;
+    OMX_TICKS                        timeStamp          = 0;
 
     OMX_BOOL bCheckInputData = OMX_FALSE;
 
@@ -1289,7 +1273,11 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
                 break;
             }
 
+            timeStamp = pSrcInputData->timeStamp;
             ret = pVideoDec->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
+            if (ret == OMX_ErrorNone)
+                Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, timeStamp, LATENCY_MARK_CODEC_IN);
+
             if (((EXYNOS_OMX_ERRORTYPE)ret == OMX_ErrorCorruptedFrame) ||
                 ((EXYNOS_OMX_ERRORTYPE)ret == OMX_ErrorCorruptedHeader)) {
                 Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] input data is weird(0x%x)",
@@ -1545,6 +1533,8 @@ OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
             if ((dstOutputUseBuffer->dataValid == OMX_TRUE) ||
                 (exynosOutputPort->bufferProcessType == BUFFER_SHARE)) {
                 ret = pVideoDec->exynos_codec_dstOutputProcess(pOMXComponent, pDstOutputData);
+                if (ret == OMX_ErrorNone)
+                    Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, pDstOutputData->timeStamp, LATENCY_MARK_CODEC_OUT);
             }
 
             if (((ret == OMX_ErrorNone) && (dstOutputUseBuffer->dataValid == OMX_TRUE)) ||
@@ -1668,6 +1658,73 @@ EXIT:
     return ret;
 }
 
+OMX_ERRORTYPE Exynos_OMX_ImgConvBufferProcess(OMX_HANDLETYPE hComponent)
+{
+    OMX_ERRORTYPE                    ret                = OMX_ErrorNone;
+    OMX_COMPONENTTYPE               *pOMXComponent      = (OMX_COMPONENTTYPE *)hComponent;
+    EXYNOS_OMX_BASECOMPONENT        *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEODEC_COMPONENT   *pVideoDec          = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_BASEPORT             *exynosOutputPort   = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+    EXYNOS_OMX_IMG_CONV_STAGE       *pStage             = &pVideoDec->imgConvStage;
+    EXYNOS_OMX_DATABUFFER            dataBuffer;
+
+    FunctionIn();
+
+    while (!pVideoDec->bExitBufferProcessThread) {
+        Exynos_OSAL_SemaphoreWait(pStage->hSemaphore);
+        if (pVideoDec->bExitBufferProcessThread)
+            break;
+
+        Exynos_OSAL_MutexLock(pStage->hProcessMutex);
+        if (Exynos_ImgConvStage_Dequeue(pStage, &dataBuffer) != OMX_TRUE) {
+            /* flushed */
+            Exynos_OSAL_MutexUnlock(pStage->hProcessMutex);
+            continue;
+        }
+
+#ifdef USE_ANDROID
+        if ((dataBuffer.remainDataLen > 0) &&
+            (!CHECK_PORT_BEING_FLUSHED(exynosOutputPort)) &&
+            (Exynos_OSAL_ImgConv_Run(pVideoDec->hImgConv, pOMXComponent, (OMX_PTR)dataBuffer.bufferHeader->pBuffer) == OMX_ErrorNone))
+            dataBuffer.nFlags |= OMX_BUFFERFLAG_CONVERTEDIMAGE;
+#endif
+
+        Exynos_OutputBufferReturn(pOMXComponent, &dataBuffer);
+        Exynos_OSAL_MutexUnlock(pStage->hProcessMutex);
+    }
+
+    FunctionOut();
+
+    return ret;
+}
+
+static OMX_ERRORTYPE Exynos_OMX_ImgConvProcessThread(OMX_PTR threadData)
+{
+    OMX_ERRORTYPE        ret            = OMX_ErrorNone;
+    OMX_COMPONENTTYPE   *pOMXComponent  = NULL;
+
+    FunctionIn();
+
+    if (threadData == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+    pOMXComponent = (OMX_COMPONENTTYPE *)threadData;
+
+    ret = Exynos_OMX_Check_SizeVersion(pOMXComponent, sizeof(OMX_COMPONENTTYPE));
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    Exynos_OMX_ImgConvBufferProcess(pOMXComponent);
+
+    Exynos_OSAL_ThreadExit(NULL);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
 static OMX_ERRORTYPE Exynos_OMX_DstOutputProcessThread(OMX_PTR threadData)
 {
     OMX_ERRORTYPE        ret            = OMX_ErrorNone;
@@ -1706,9 +1763,20 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
 
     pVideoDec->bExitBufferProcessThread = OMX_FALSE;
 
-    ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hDstOutputThread,
-                 Exynos_OMX_DstOutputProcessThread,
-                 pOMXComponent);
+    /* image conversion is set before here, it is not changed on running */
+    if (pVideoDec->hImgConv != NULL) {
+        pVideoDec->imgConvStage.nHead  = 0;
+        pVideoDec->imgConvStage.nCount = 0;
+        Exynos_OSAL_Set_SemaphoreCount(pVideoDec->imgConvStage.hSemaphore, 0);
+
+        ret = Exynos_OSAL_ThreadCreate(&pVideoDec->imgConvStage.hThread,
+                     Exynos_OMX_ImgConvProcessThread,
+                     pOMXComponent);
+    }
+    if (ret == OMX_ErrorNone)
+        ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hDstOutputThread,
+                     Exynos_OMX_DstOutputProcessThread,
+                     pOMXComponent);
     if (ret == OMX_ErrorNone)
         ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hSrcOutputThread,
                      Exynos_OMX_SrcOutputProcessThread,
@@ -1794,6 +1862,16 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Terminate(OMX_HANDLETYPE hComponent)
     Exynos_OSAL_Set_SemaphoreCount(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].semWaitPortEnable[OUTPUT_WAY_INDEX], 0);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] dst output thread is terminated", pExynosComponent, __FUNCTION__);
 
+    /* image conversion */
+    if (pVideoDec->imgConvStage.hThread != NULL) {
+        Exynos_OSAL_SemaphorePost(pVideoDec->imgConvStage.hSemaphore);
+        Exynos_OSAL_ThreadTerminate(pVideoDec->imgConvStage.hThread);
+        pVideoDec->imgConvStage.hThread = NULL;
+        Exynos_ImgConvStage_Flush(pOMXComponent);
+        Exynos_OSAL_Set_SemaphoreCount(pVideoDec->imgConvStage.hSemaphore, 0);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] image conversion thread is terminated", pExynosComponent, __FUNCTION__);
+    }
+
     pExynosComponent->checkTimeStamp.needSetStartTimeStamp      = OMX_FALSE;
     pExynosComponent->checkTimeStamp.needCheckStartTimeStamp    = OMX_FALSE;
 
@@ -1864,6 +1942,10 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
     pVideoDec->bSearchBlackBar          = OMX_FALSE;
     pExynosComponent->hComponentHandle = (OMX_HANDLETYPE)pVideoDec;
 
+    Exynos_OSAL_SemaphoreCreate(&pVideoDec->imgConvStage.hSemaphore);
+    Exynos_OSAL_MutexCreate(&pVideoDec->imgConvStage.hQueueMutex);
+    Exynos_OSAL_MutexCreate(&pVideoDec->imgConvStage.hProcessMutex);
+
     pExynosComponent->bSaveFlagEOS = OMX_FALSE;
     pExynosComponent->bBehaviorEOS = OMX_FALSE;
 
@@ -2017,6 +2099,13 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
     Exynos_OSAL_ImgConv_Terminate(pVideoDec->hImgConv);
 #endif
 
+    Exynos_OSAL_MutexTerminate(pVideoDec->imgConvStage.hProcessMutex);
+    pVideoDec->imgConvStage.hProcessMutex = NULL;
+    Exynos_OSAL_MutexTerminate(pVideoDec->imgConvStage.hQueueMutex);
+    pVideoDec->imgConvStage.hQueueMutex = NULL;
+    Exynos_OSAL_SemaphoreTerminate(pVideoDec->imgConvStage.hSemaphore);
+    pVideoDec->imgConvStage.hSemaphore = NULL;
+
     Exynos_OSAL_Free(pVideoDec);
     pExynosComponent->hComponentHandle = pVideoDec = NULL;
 
@@ -114,6 +114,48 @@ typedef struct _EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP
     OMX_U32   nFlags;
 } EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP;
 
+/* every frame MFC can hold at once : the DPB and all queued input buffers */
+#define REORDER_SPILL_NUM                   (MFC_OUTPUT_BUFFER_NUM_MAX + MAX_BUFFER_NUM)
+
+/* a pending timestamp moved out of a full slot table, its tag is reused */
+typedef struct _EXYNOS_OMX_REORDER_SPILL
+{
+    OMX_TICKS timeStamp;
+    OMX_U32   nFlags;
+    OMX_U32   nSequence;
+    OMX_BOOL  bLast;
+} EXYNOS_OMX_REORDER_SPILL;
+
+/* timestamp reordering (bReorderMode) : the MFC tag is the slot index of
+ * timeStamp[]/nFlags[] in the base component, pending slots are kept in
+ * a min-heap ordered by (EOS last, timestamp, arrival) */
+typedef struct _EXYNOS_OMX_REORDER_TABLE
+{
+    OMX_S32   heap[MAX_TIMESTAMP];         /* slot indexes */
+    OMX_S32   heapPos[MAX_TIMESTAMP];      /* slot -> position in heap, -1 : not queued */
+    OMX_S32   nHeapSize;
+    OMX_U64   nUsedMask;                   /* a bit per slot, mirrors bTimestampSlotUsed */
+    OMX_U32   nSequence[MAX_TIMESTAMP];    /* arrival order, tie break of same timestamps */
+    OMX_BOOL  bLast[MAX_TIMESTAMP];        /* EOS without data, comes after all frames */
+    OMX_U32   nNextSequence;
+    OMX_TICKS lastTimeStamp;               /* latest timestamp taken out */
+    EXYNOS_OMX_REORDER_SPILL spill[REORDER_SPILL_NUM];  /* pending frames beyond MAX_TIMESTAMP, unordered */
+    OMX_S32   nSpillNum;
+} EXYNOS_OMX_REORDER_TABLE;
+
+/* output buffers waiting for the image converter, they are returned in order */
+typedef struct _EXYNOS_OMX_IMG_CONV_STAGE
+{
+    OMX_HANDLETYPE          hThread;
+    OMX_HANDLETYPE          hSemaphore;         /* posted for each queued buffer */
+    OMX_HANDLETYPE          hQueueMutex;        /* protects the ring */
+    OMX_HANDLETYPE          hProcessMutex;      /* held while a buffer is converted and returned */
+
+    EXYNOS_OMX_DATABUFFER   ring[MAX_BUFFER_NUM];
+    OMX_U32                 nHead;
+    OMX_U32                 nCount;
+} EXYNOS_OMX_IMG_CONV_STAGE;
+
 typedef enum _EXYNOS_OMX_DATA_TYPE {
     DATA_TYPE_8BIT           = 0x00,
     DATA_TYPE_10BIT          = 0x01,
@@ -130,6 +172,7 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
     OMX_BOOL                bThumbnailMode;
     OMX_BOOL                bDTSMode;                  /* true:Decoding Time Stamp, false:Presentation Time Stamp */
     OMX_BOOL                bReorderMode;              /* true:use Time Stamp reordering, don't care about a mode like as PTS or DTS */
+    EXYNOS_OMX_REORDER_TABLE reorderTable;
     EXYNOS_OMX_DATA_TYPE    eDataType;
     OMX_BOOL                bQosChanged;
     OMX_U32                 nQosRatio;
@@ -139,6 +182,7 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
     OMX_U32                 nMinInBufSize;             /* required min size of input buffer for DRC */
     CODEC_DEC_BUFFER       *pMFCDecInputBuffer[MFC_INPUT_BUFFER_NUM_MAX];
     CODEC_DEC_BUFFER       *pMFCDecOutputBuffer[MFC_OUTPUT_BUFFER_NUM_MAX];
+    OMX_BOOL                bPooledInputBuffers;       /* input codec buffers are lent by the session pool */
 
     /* Buffer Process */
     OMX_BOOL       bExitBufferProcessThread;
@@ -168,6 +212,7 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
 
     /* For Image conversion when it is available */
     OMX_HANDLETYPE hImgConv;
+    EXYNOS_OMX_IMG_CONV_STAGE imgConvStage;
 
     OMX_ERRORTYPE (*exynos_codec_srcInputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
     OMX_ERRORTYPE (*exynos_codec_srcOutputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
@@ -196,6 +241,7 @@ void Exynos_UpdateFrameSize(OMX_COMPONENTTYPE *pOMXComponent);
 void Exynos_Output_SetSupportFormat(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
 void Exynos_SetReorderTimestamp(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 *nIndex, OMX_TICKS timeStamp, OMX_U32 nFlags);
 void Exynos_GetReorderTimestamp(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP *sCurrentTimestamp, OMX_S32 nFrameIndex, OMX_S32 eFrameType);
+void Exynos_ResetReorderTimestamp(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex);
 OMX_ERRORTYPE Exynos_CodecBufferToData(CODEC_DEC_BUFFER *codecBuffer, EXYNOS_OMX_DATA *pData, OMX_U32 nPortIndex);
 OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *srcInputData);
@@ -203,6 +249,8 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_SrcOutputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_DstInputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent);
+OMX_ERRORTYPE Exynos_OMX_ImgConvBufferProcess(OMX_HANDLETYPE hComponent);
+void Exynos_ImgConvStage_Flush(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentInit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex, int nBufferCnt, unsigned int nAllocSize[MAX_BUFFER_PLANE]);
@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include "Exynos_OMX_Macros.h"
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Vdec.h"
@@ -61,6 +62,7 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
     OMX_ERRORTYPE                ret                = OMX_ErrorNone;
     OMX_COMPONENTTYPE           *pOMXComponent      = NULL;
     EXYNOS_OMX_BASECOMPONENT    *pExynosComponent   = NULL;
+    EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec        = NULL;
     EXYNOS_OMX_BASEPORT         *pExynosPort        = NULL;
     OMX_BUFFERHEADERTYPE        *temp_bufferHeader  = NULL;
 
@@ -85,6 +87,12 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
     }
     pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
 
+    if (pExynosComponent->hComponentHandle == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+    pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
     if (nPortIndex >= pExynosComponent->portParam.nPorts) {
         Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] invalid parameter(0x%x)", pExynosComponent, __FUNCTION__, nPortIndex);
         ret = OMX_ErrorBadPortIndex;
@@ -130,6 +138,53 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
             else
                 temp_bufferHeader->nOutputPortIndex = OUTPUT_PORT_INDEX;
 
+            if ((nPortIndex == INPUT_PORT_INDEX) &&
+                (pExynosPort->bufferProcessType & BUFFER_SHARE) &&
+                (pExynosComponent->codecType != HW_VIDEO_DEC_SECURE_CODEC)) {
+                /* zero-copy input : the stream is queued to MFC by its fd as it is */
+                pExynosPort->extendBufferHeader[i].buf_fd[0]  = 0;
+                pExynosPort->extendBufferHeader[i].pYUVBuf[0] = NULL;
+
+                if (pExynosPort->eMetaDataType == METADATA_TYPE_DISABLED) {
+                    pExynosPort->extendBufferHeader[i].buf_fd[0] =
+                        Exynos_OSAL_SharedMemory_VirtToION(pVideoDec->hSharedMemory, pBuffer);
+
+                    /*
+                     * bufferProcessType is fixed at componentInit, which already set up the codec
+                     * buffers of that mode. a buffer that is not from ION is resolved per frame as before.
+                     */
+                    if (pExynosPort->extendBufferHeader[i].buf_fd[0] == 0)
+                        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] input buffer(%p) is not an ION buffer",
+                                                            pExynosComponent, __FUNCTION__, pBuffer);
+                } else if (pExynosPort->eMetaDataType == METADATA_TYPE_HANDLE) {
+                    EXYNOS_OMX_MULTIPLANE_BUFFER bufferInfo;
+                    OMX_PTR pMapBuffer = NULL;
+
+                    Exynos_OSAL_Memset(&bufferInfo, 0, sizeof(bufferInfo));
+
+                    ret = Exynos_OSAL_GetInfoFromMetaData(pBuffer, &bufferInfo, pExynosPort->eMetaDataType);
+                    if ((ret != OMX_ErrorNone) ||
+                        (bufferInfo.fd[0] == 0)) {
+                        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to get fd of input buffer(%p)",
+                                                            pExynosComponent, __FUNCTION__, pBuffer);
+                        ret = OMX_ErrorBadParameter;
+                        goto FAIL_TO_USE;
+                    }
+
+                    /* read-only mapping for the stream parsing(start code, header) */
+                    pMapBuffer = Exynos_OSAL_Mmap(NULL, nSizeBytes, PROT_READ, MAP_SHARED, bufferInfo.fd[0], 0);
+                    if (pMapBuffer == MAP_FAILED) {
+                        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to mmap input buffer(fd:%lu, size:%d)",
+                                                            pExynosComponent, __FUNCTION__, bufferInfo.fd[0], nSizeBytes);
+                        ret = OMX_ErrorInsufficientResources;
+                        goto FAIL_TO_USE;
+                    }
+
+                    pExynosPort->extendBufferHeader[i].buf_fd[0]  = bufferInfo.fd[0];
+                    pExynosPort->extendBufferHeader[i].pYUVBuf[0] = pMapBuffer;
+                }
+            }
+
             if (pExynosPort->eMetaDataType == METADATA_TYPE_GRAPHIC_HANDLE) {
                 EXYNOS_OMX_MULTIPLANE_BUFFER bufferInfo;
                 EXYNOS_OMX_LOCK_RANGE range;
@@ -199,6 +254,12 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
 
     Exynos_OSAL_Free(temp_bufferHeader);
     ret = OMX_ErrorInsufficientResources;
+    goto EXIT;
+
+FAIL_TO_USE:
+    pExynosPort->extendBufferHeader[i].OMXBufferHeader = NULL;
+    pExynosPort->bufferStateAllocate[i] = BUFFER_STATE_FREE;
+    Exynos_OSAL_Free(temp_bufferHeader);
 
 EXIT:
     FunctionOut();
@@ -505,7 +566,16 @@ OMX_ERRORTYPE Exynos_OMX_FreeBuffer(
                     pOMXBufferHdr->pBuffer = NULL;
                     pBufferHdr->pBuffer = NULL;
                 } else if (pExynosPort->bufferStateAllocate[i] & BUFFER_STATE_ASSIGNED) {
-                    ; /* None*/
+                    if ((nPortIndex == INPUT_PORT_INDEX) &&
+                        (pExynosPort->extendBufferHeader[i].pYUVBuf[0] != NULL) &&
+                        (pExynosPort->eMetaDataType == METADATA_TYPE_HANDLE)) {
+                        Exynos_OSAL_Munmap(pExynosPort->extendBufferHeader[i].pYUVBuf[0], pOMXBufferHdr->nAllocLen);
+                    }
+                }
+
+                if (nPortIndex == INPUT_PORT_INDEX) {
+                    pExynosPort->extendBufferHeader[i].pYUVBuf[0] = NULL;
+                    pExynosPort->extendBufferHeader[i].buf_fd[0]  = 0;
                 }
 
                 pExynosPort->assignedBufferNum--;
@@ -953,6 +1023,8 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
 
     pVideoDec->exynos_codec_bufferProcessRun(pOMXComponent, nPortIndex);
     Exynos_OSAL_MutexLock(flushPortBuffer[0]->bufferMutex);
+    if (nPortIndex == OUTPUT_PORT_INDEX)
+        Exynos_OSAL_MutexLock(pVideoDec->imgConvStage.hProcessMutex);
 
     pVideoDec->exynos_codec_stop(pOMXComponent, nPortIndex);
 
@@ -966,6 +1038,9 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
 
     ret = Exynos_OMX_FlushPort(pOMXComponent, nPortIndex);
 
+    if (nPortIndex == OUTPUT_PORT_INDEX)
+        Exynos_ImgConvStage_Flush(pOMXComponent);
+
     if ((ePortState == EXYNOS_OMX_PortStateFlushingForDisable) &&
         (pVideoDec->bReconfigDPB == OMX_TRUE)) {
         ret = pVideoDec->exynos_codec_reconfigAllBuffers(pOMXComponent, nPortIndex);
@@ -981,7 +1056,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
         if (nPortIndex == INPUT_PORT_INDEX) {
             pExynosComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
             pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
-            Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, OMX_FALSE, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+            Exynos_ResetReorderTimestamp(pExynosComponent);
             INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
             Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
             pExynosComponent->getAllDelayBuffer = OMX_FALSE;
@@ -1007,6 +1082,10 @@ EXIT:
     if (flushPortBuffer[1] != NULL)
         Exynos_OSAL_MutexUnlock(flushPortBuffer[1]->bufferMutex);
 
+    if ((flushPortBuffer[0] != NULL) &&
+        (nPortIndex == OUTPUT_PORT_INDEX))
+        Exynos_OSAL_MutexUnlock(pVideoDec->imgConvStage.hProcessMutex);
+
     if (flushPortBuffer[0] != NULL)
         Exynos_OSAL_MutexUnlock(flushPortBuffer[0]->bufferMutex);
 
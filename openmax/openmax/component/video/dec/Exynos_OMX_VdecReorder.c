@@ -0,0 +1,502 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VdecReorder.c
+ * @brief       timestamp reordering for video decoders
+ * @version     1.0.0
+ * @history
+ *   2019.06.05 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Exynos_OMX_Macros.h"
+#include "Exynos_OMX_Vdec.h"
+#include "Exynos_OMX_Basecomponent.h"
+
+#define EXYNOS_LOG_TAG    "EXYNOS_VIDEO_DEC"
+//#define EXYNOS_LOG_OFF
+#include "Exynos_OSAL_Log.h"
+
+#if (MAX_TIMESTAMP > 64)
+#error "slot mask of EXYNOS_OMX_REORDER_TABLE is 64bit"
+#endif
+
+#define REORDER_FULL_MASK       (((MAX_TIMESTAMP) == 64)? (~0ULL):((1ULL << (MAX_TIMESTAMP)) - 1))
+#define REORDER_CODECCONFIG     (OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_ENDOFFRAME)
+
+static EXYNOS_OMX_REORDER_TABLE *Reorder_GetTable(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if (pVideoDec == NULL)
+        return NULL;
+
+    return &pVideoDec->reorderTable;
+}
+
+/* true if entry a has to go out before entry b */
+static OMX_BOOL Reorder_Precedes(
+    EXYNOS_OMX_REORDER_SPILL    *a,
+    EXYNOS_OMX_REORDER_SPILL    *b)
+{
+    if (a->bLast != b->bLast)
+        return (b->bLast == OMX_TRUE)? OMX_TRUE:OMX_FALSE;
+
+    if (a->timeStamp != b->timeStamp)
+        return (a->timeStamp < b->timeStamp)? OMX_TRUE:OMX_FALSE;
+
+    /* sequence may wrap around */
+    return ((OMX_S32)(a->nSequence - b->nSequence) < 0)? OMX_TRUE:OMX_FALSE;
+}
+
+static void Reorder_GetEntry(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nSlot,
+    EXYNOS_OMX_REORDER_SPILL    *pEntry)
+{
+    pEntry->timeStamp = pExynosComponent->timeStamp[nSlot];
+    pEntry->nFlags    = pExynosComponent->nFlags[nSlot];
+    pEntry->nSequence = pTable->nSequence[nSlot];
+    pEntry->bLast     = pTable->bLast[nSlot];
+}
+
+/* true if slot a has to go out before slot b */
+static OMX_BOOL Reorder_IsEarlier(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      a,
+    OMX_S32                      b)
+{
+    EXYNOS_OMX_REORDER_SPILL entryA;
+    EXYNOS_OMX_REORDER_SPILL entryB;
+
+    Reorder_GetEntry(pExynosComponent, pTable, a, &entryA);
+    Reorder_GetEntry(pExynosComponent, pTable, b, &entryB);
+
+    return Reorder_Precedes(&entryA, &entryB);
+}
+
+/* index of the earliest spilled timestamp, -1 if none */
+static OMX_S32 Reorder_SpillEarliest(EXYNOS_OMX_REORDER_TABLE *pTable)
+{
+    OMX_S32 nEarliest = -1;
+    int i;
+
+    for (i = 0; i < pTable->nSpillNum; i++) {
+        if ((nEarliest < 0) ||
+            (Reorder_Precedes(&pTable->spill[i], &pTable->spill[nEarliest]) == OMX_TRUE))
+            nEarliest = i;
+    }
+
+    return nEarliest;
+}
+
+static void Reorder_SpillRemove(
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nSpill)
+{
+    pTable->nSpillNum--;
+    pTable->spill[nSpill] = pTable->spill[pTable->nSpillNum];
+}
+
+static void Reorder_HeapSwap(EXYNOS_OMX_REORDER_TABLE *pTable, OMX_S32 i, OMX_S32 j)
+{
+    OMX_S32 nSlot = pTable->heap[i];
+
+    pTable->heap[i] = pTable->heap[j];
+    pTable->heap[j] = nSlot;
+
+    pTable->heapPos[pTable->heap[i]] = i;
+    pTable->heapPos[pTable->heap[j]] = j;
+}
+
+static void Reorder_HeapUp(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nPos)
+{
+    while (nPos > 0) {
+        OMX_S32 nParent = (nPos - 1) / 2;
+
+        if (Reorder_IsEarlier(pExynosComponent, pTable, pTable->heap[nPos], pTable->heap[nParent]) != OMX_TRUE)
+            break;
+
+        Reorder_HeapSwap(pTable, nPos, nParent);
+        nPos = nParent;
+    }
+}
+
+static void Reorder_HeapDown(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nPos)
+{
+    while (1) {
+        OMX_S32 nLeft     = (2 * nPos) + 1;
+        OMX_S32 nRight    = nLeft + 1;
+        OMX_S32 nEarliest = nPos;
+
+        if ((nLeft < pTable->nHeapSize) &&
+            (Reorder_IsEarlier(pExynosComponent, pTable, pTable->heap[nLeft], pTable->heap[nEarliest]) == OMX_TRUE))
+            nEarliest = nLeft;
+
+        if ((nRight < pTable->nHeapSize) &&
+            (Reorder_IsEarlier(pExynosComponent, pTable, pTable->heap[nRight], pTable->heap[nEarliest]) == OMX_TRUE))
+            nEarliest = nRight;
+
+        if (nEarliest == nPos)
+            break;
+
+        Reorder_HeapSwap(pTable, nPos, nEarliest);
+        nPos = nEarliest;
+    }
+}
+
+static void Reorder_Push(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nSlot)
+{
+    pTable->nSequence[nSlot] = pTable->nNextSequence++;
+    pTable->bLast[nSlot]     = (((pExynosComponent->nFlags[nSlot] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) &&
+                                (pExynosComponent->bBehaviorEOS != OMX_TRUE))? OMX_TRUE:OMX_FALSE;
+
+    pTable->heap[pTable->nHeapSize] = nSlot;
+    pTable->heapPos[nSlot]          = pTable->nHeapSize;
+    pTable->nHeapSize++;
+
+    Reorder_HeapUp(pExynosComponent, pTable, pTable->heapPos[nSlot]);
+}
+
+/* makes a slot free, its timestamp is left for I-frame sync */
+static void Reorder_Release(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable,
+    OMX_S32                      nSlot)
+{
+    OMX_S32 nPos = pTable->heapPos[nSlot];
+
+    if (nPos >= 0) {
+        OMX_S32 nLast = pTable->nHeapSize - 1;
+
+        if (nPos != nLast) {
+            Reorder_HeapSwap(pTable, nPos, nLast);
+            pTable->nHeapSize--;
+            Reorder_HeapUp(pExynosComponent, pTable, nPos);
+            Reorder_HeapDown(pExynosComponent, pTable, pTable->heapPos[pTable->heap[nPos]]);
+        } else {
+            pTable->nHeapSize--;
+        }
+
+        pTable->heapPos[nSlot] = -1;
+    }
+
+    pTable->nUsedMask &= ~(1ULL << nSlot);
+    pExynosComponent->bTimestampSlotUsed[nSlot] = OMX_FALSE;
+    pExynosComponent->nFlags[nSlot]             = 0x00;
+}
+
+/*
+ * all slots are in use. slots which are never given back, codec config or
+ * frames which are not displayed, are reclaimed. if every slot is a pending
+ * frame, MFC holds more frames than MAX_TIMESTAMP (deep DPB with many queued
+ * inputs), so the earliest one is moved to the spill area and its tag is reused.
+ */
+static void Reorder_Reclaim(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    EXYNOS_OMX_REORDER_TABLE    *pTable)
+{
+    int i;
+
+    for (i = 0; i < MAX_TIMESTAMP; i++) {
+        if (!(pTable->nUsedMask & (1ULL << i)))
+            continue;
+
+        if ((pTable->heapPos[i] < 0) ||
+            ((pTable->lastTimeStamp != DEFAULT_TIMESTAMP_VAL) &&
+             (pExynosComponent->timeStamp[i] < pTable->lastTimeStamp) &&
+             ((pExynosComponent->nFlags[i] & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS))) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] reclaim a stale timestamp %lld us, flags 0x%x, slot %d",
+                                                    pExynosComponent, __FUNCTION__,
+                                                    pExynosComponent->timeStamp[i], pExynosComponent->nFlags[i], i);
+            Reorder_Release(pExynosComponent, pTable, i);
+        }
+    }
+
+    if ((pTable->nUsedMask == REORDER_FULL_MASK) &&
+        (pTable->nHeapSize > 0)) {
+        OMX_S32 nSlot = pTable->heap[0];
+
+        if (pTable->nSpillNum < REORDER_SPILL_NUM) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] timestamp slot is full, spills the earliest one(%lld us), slot %d",
+                                                    pExynosComponent, __FUNCTION__, pExynosComponent->timeStamp[nSlot], nSlot);
+            Reorder_GetEntry(pExynosComponent, pTable, nSlot, &pTable->spill[pTable->nSpillNum]);
+            pTable->nSpillNum++;
+        } else {
+            /* can not be, MFC never holds more than REORDER_SPILL_NUM frames */
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] timestamp spill is full, drops the earliest one(%lld us)",
+                                                pExynosComponent, __FUNCTION__, pExynosComponent->timeStamp[nSlot]);
+        }
+
+        Reorder_Release(pExynosComponent, pTable, nSlot);
+    }
+}
+
+void Exynos_ResetReorderTimestamp(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_REORDER_TABLE *pTable = NULL;
+
+    FunctionIn();
+
+    if (pExynosComponent == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
+        goto EXIT;
+    }
+
+    Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, OMX_FALSE, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+
+    pTable = Reorder_GetTable(pExynosComponent);
+    if (pTable == NULL)
+        goto EXIT;
+
+    Exynos_OSAL_Memset(pTable, 0, sizeof(EXYNOS_OMX_REORDER_TABLE));
+    INIT_ARRAY_TO_VAL(pTable->heapPos, -1, MAX_TIMESTAMP);
+    pTable->lastTimeStamp = DEFAULT_TIMESTAMP_VAL;
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
+
+void Exynos_SetReorderTimestamp(
+    EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
+    OMX_U32                     *nIndex,
+    OMX_TICKS                    timeStamp,
+    OMX_U32                      nFlags) {
+
+    EXYNOS_OMX_REORDER_TABLE *pTable    = NULL;
+    OMX_U64                   nFreeMask = 0;
+    OMX_U32                   nHint     = 0;
+    OMX_S32                   nSlot     = 0;
+
+    FunctionIn();
+
+    if ((pExynosComponent == NULL) || (nIndex == NULL)) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
+        goto EXIT;
+    }
+
+    pTable = Reorder_GetTable(pExynosComponent);
+    if (pTable == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
+        goto EXIT;
+    }
+
+    if (pTable->nUsedMask == REORDER_FULL_MASK)
+        Reorder_Reclaim(pExynosComponent, pTable);
+
+    /* the first empty slot from *nIndex like as a circular queue */
+    nHint     = (*nIndex) % MAX_TIMESTAMP;
+    nFreeMask = (~pTable->nUsedMask) & REORDER_FULL_MASK;
+    if (nFreeMask == 0) {
+        /* only codec configs without any frames, can not be */
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Can not find empty slot of timestamp", pExynosComponent, __FUNCTION__);
+        goto EXIT;
+    }
+
+    if ((nFreeMask >> nHint) != 0)
+        nSlot = nHint + __builtin_ctzll(nFreeMask >> nHint);
+    else
+        nSlot = __builtin_ctzll(nFreeMask);
+
+    *nIndex = (OMX_U32)nSlot;
+
+    pExynosComponent->timeStamp[nSlot]          = timeStamp;
+    pExynosComponent->nFlags[nSlot]             = nFlags;
+    pExynosComponent->bTimestampSlotUsed[nSlot] = OMX_TRUE;
+    pTable->nUsedMask |= (1ULL << nSlot);
+
+    /* NOTE: In case of CODECCONFIG, no return any frame */
+    if (nFlags != REORDER_CODECCONFIG)
+        Reorder_Push(pExynosComponent, pTable, nSlot);
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
+
+/*
+ * takes the earliest pending timestamp out. the slot is given back, so the
+ * caller doesn't have to clear it.
+ */
+void Exynos_GetReorderTimestamp(
+    EXYNOS_OMX_BASECOMPONENT            *pExynosComponent,
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP  *sCurrentTimestamp,
+    OMX_S32                              nFrameIndex,
+    OMX_S32                              eFrameType) {
+
+    EXYNOS_OMX_BASEPORT         *pExynosOutputPort  = NULL;
+    EXYNOS_OMX_REORDER_TABLE    *pTable             = NULL;
+    EXYNOS_OMX_REORDER_SPILL     entry;
+    OMX_S32 nSpill = -1;
+    int i = 0;
+
+    FunctionIn();
+
+    if ((pExynosComponent == NULL) || (sCurrentTimestamp == NULL)) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
+        goto EXIT;
+    }
+
+    pTable = Reorder_GetTable(pExynosComponent);
+    if (pTable == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] invalid parameter", __FUNCTION__);
+        goto EXIT;
+    }
+
+    pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    Exynos_OSAL_Memset(sCurrentTimestamp, 0, sizeof(EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP));
+    sCurrentTimestamp->timeStamp = DEFAULT_TIMESTAMP_VAL;
+    sCurrentTimestamp->nIndex    = -1;
+
+    nSpill = Reorder_SpillEarliest(pTable);
+
+    if (pTable->nHeapSize > 0) {
+        OMX_S32 nSlot = pTable->heap[0];
+
+        Reorder_GetEntry(pExynosComponent, pTable, nSlot, &entry);
+        if ((nSpill < 0) ||
+            (Reorder_Precedes(&pTable->spill[nSpill], &entry) != OMX_TRUE)) {
+            sCurrentTimestamp->timeStamp = entry.timeStamp;
+            sCurrentTimestamp->nFlags    = entry.nFlags;
+            sCurrentTimestamp->nIndex    = nSlot;
+            nSpill = -1;
+        }
+    }
+
+    if (nSpill >= 0) {
+        /* its tag was reused, so there is no slot to give back */
+        sCurrentTimestamp->timeStamp = pTable->spill[nSpill].timeStamp;
+        sCurrentTimestamp->nFlags    = pTable->spill[nSpill].nFlags;
+    }
+
+    if (sCurrentTimestamp->timeStamp == DEFAULT_TIMESTAMP_VAL)
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] could not find a valid timestamp", pExynosComponent, __FUNCTION__);
+
+    /* PTS : all index is same as tag */
+    /* DTS : only in case of I-Frame, the index is same as tag */
+    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] disp_pic_frame_type: %d", pExynosComponent, __FUNCTION__, eFrameType);
+    if ((ExynosVideoFrameType)eFrameType & VIDEO_FRAME_I) {
+        /* Timestamp is weird */
+        if ((sCurrentTimestamp->nIndex != nFrameIndex) &&
+            (nFrameIndex >= 0) && (nFrameIndex < MAX_TIMESTAMP)) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] Timestamp is not same in spite of I-Frame", pExynosComponent, __FUNCTION__);
+
+            /* trust a tag index returned from D/D */
+            sCurrentTimestamp->timeStamp = pExynosComponent->timeStamp[nFrameIndex];
+            sCurrentTimestamp->nFlags    = pExynosComponent->nFlags[nFrameIndex];
+            sCurrentTimestamp->nIndex    = nFrameIndex;
+            nSpill = -1;
+
+            /* resync, it is rare so a full scan is fine */
+            for (i = 0; i < MAX_TIMESTAMP; i++) {
+                if (i == nFrameIndex)
+                    continue;
+
+                /* delete past timestamps */
+                if ((pExynosComponent->bTimestampSlotUsed[i] == OMX_TRUE) &&
+                    ((sCurrentTimestamp->timeStamp > pExynosComponent->timeStamp[i]) &&
+                        ((pExynosComponent->nFlags[i] & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS))) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] clear an past timestamp %lld us (%.2f secs)",
+                                                            pExynosComponent, __FUNCTION__,
+                                                            pExynosComponent->timeStamp[i], (double)(pExynosComponent->timeStamp[i] / 1E6));
+                    Reorder_Release(pExynosComponent, pTable, i);
+                } else if ((pExynosComponent->bTimestampSlotUsed[i] == OMX_FALSE) &&
+                           (pExynosComponent->timeStamp[i] != DEFAULT_TIMESTAMP_VAL) &&
+                           (sCurrentTimestamp->timeStamp < pExynosComponent->timeStamp[i])) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] revive an past timestamp %lld us (%.2f secs) by I-frame sync",
+                                                            pExynosComponent, __FUNCTION__,
+                                                            pExynosComponent->timeStamp[i], (double)(pExynosComponent->timeStamp[i] / 1E6));
+                    pExynosComponent->bTimestampSlotUsed[i] = OMX_TRUE;
+                    pTable->nUsedMask |= (1ULL << i);
+                    Reorder_Push(pExynosComponent, pTable, i);
+                }
+            }
+
+            for (i = 0; i < pTable->nSpillNum;) {
+                if ((sCurrentTimestamp->timeStamp > pTable->spill[i].timeStamp) &&
+                    ((pTable->spill[i].nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] clear an past spilled timestamp %lld us (%.2f secs)",
+                                                            pExynosComponent, __FUNCTION__,
+                                                            pTable->spill[i].timeStamp, (double)(pTable->spill[i].timeStamp / 1E6));
+                    Reorder_SpillRemove(pTable, i);
+                } else {
+                    i++;
+                }
+            }
+        }
+
+        if (sCurrentTimestamp->timeStamp == DEFAULT_TIMESTAMP_VAL)
+            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] the index of frame(%d) about I-frame is wrong",
+                                                pExynosComponent, __FUNCTION__, nFrameIndex);
+
+        sCurrentTimestamp->nFlags |= OMX_BUFFERFLAG_SYNCFRAME;
+    }
+
+    if (eFrameType & VIDEO_FRAME_CORRUPT)
+        sCurrentTimestamp->nFlags |= OMX_BUFFERFLAG_DATACORRUPT;
+
+    if (sCurrentTimestamp->nIndex >= 0) {
+        if (pTable->nUsedMask & (1ULL << sCurrentTimestamp->nIndex))
+            Reorder_Release(pExynosComponent, pTable, sCurrentTimestamp->nIndex);
+
+        if (sCurrentTimestamp->timeStamp != DEFAULT_TIMESTAMP_VAL)
+            pTable->lastTimeStamp = sCurrentTimestamp->timeStamp;
+    } else if (nSpill >= 0) {
+        Reorder_SpillRemove(pTable, nSpill);
+
+        if (sCurrentTimestamp->timeStamp != DEFAULT_TIMESTAMP_VAL)
+            pTable->lastTimeStamp = sCurrentTimestamp->timeStamp;
+    }
+
+    if (sCurrentTimestamp->timeStamp != DEFAULT_TIMESTAMP_VAL) {
+        if (pExynosOutputPort->latestTimeStamp <= sCurrentTimestamp->timeStamp) {
+            pExynosOutputPort->latestTimeStamp = sCurrentTimestamp->timeStamp;
+        } else {
+            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] timestamp(%lld) is smaller than latest timeStamp(%lld), uses latestTimeStamp",
+                                pExynosComponent, __FUNCTION__,
+                                sCurrentTimestamp->timeStamp, pExynosOutputPort->latestTimeStamp);
+            sCurrentTimestamp->timeStamp = pExynosOutputPort->latestTimeStamp;
+        }
+    } else {
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] can't find a valid timestamp, uses latestTimeStamp(%lld)",
+                                pExynosComponent, __FUNCTION__, pExynosOutputPort->latestTimeStamp);
+        sCurrentTimestamp->timeStamp = pExynosOutputPort->latestTimeStamp;
+    }
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
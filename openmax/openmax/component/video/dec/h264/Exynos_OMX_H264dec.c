@@ -31,6 +31,7 @@
 #include "Exynos_OMX_Macros.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OMX_Baseport.h"
+#include "Exynos_OMX_SessionPool.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
 #include "Exynos_OSAL_ETC.h"
@@ -446,7 +447,14 @@ OMX_ERRORTYPE H264CodecOpen(EXYNOS_H264DEC_HANDLE *pH264Dec, ExynosVideoInstInfo
 #else
     pVideoInstInfo->nMemoryType = VIDEO_MEMORY_USERPTR;
 #endif
-    pH264Dec->hMFCH264Handle.hMFCHandle = pH264Dec->hMFCH264Handle.pDecOps->Init(pVideoInstInfo);
+    pH264Dec->hMFCH264Handle.hMFCHandle = NULL;
+    if ((pH264Dec->hMFCH264Handle.bPooledSession == OMX_TRUE) &&
+        (Exynos_OMX_SessionPool_GetDecoder(pVideoInstInfo, pDecOps, &pH264Dec->hMFCH264Handle.hMFCHandle) != OMX_ErrorNone))
+        pH264Dec->hMFCH264Handle.bPooledSession = OMX_FALSE;
+
+    if (pH264Dec->hMFCH264Handle.hMFCHandle == NULL)
+        pH264Dec->hMFCH264Handle.hMFCHandle = pH264Dec->hMFCH264Handle.pDecOps->Init(pVideoInstInfo);
+
     if (pH264Dec->hMFCH264Handle.hMFCHandle == NULL) {
         Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to init", __FUNCTION__);
         ret = OMX_ErrorInsufficientResources;
@@ -506,8 +514,12 @@ OMX_ERRORTYPE H264CodecClose(EXYNOS_H264DEC_HANDLE *pH264Dec)
     pOutbufOps = pH264Dec->hMFCH264Handle.pOutbufOps;
 
     if (hMFCHandle != NULL) {
-        pDecOps->Finalize(hMFCHandle);
+        if (pH264Dec->hMFCH264Handle.bPooledSession == OMX_TRUE)
+            Exynos_OMX_SessionPool_PutDecoder(pDecOps, hMFCHandle);  /* finalized on the pool thread */
+        else
+            pDecOps->Finalize(hMFCHandle);
         pH264Dec->hMFCH264Handle.hMFCHandle = NULL;
+        pH264Dec->hMFCH264Handle.bPooledSession = OMX_FALSE;
         pH264Dec->hMFCH264Handle.bConfiguredMFCSrc = OMX_FALSE;
         pH264Dec->hMFCH264Handle.bConfiguredMFCDst = OMX_FALSE;
     }
@@ -2481,6 +2493,7 @@ OMX_ERRORTYPE Exynos_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pVideoInstInfo->xFramerate  = pExynosInputPort->portDefinition.format.video.xFramerate;
 
     /* H.264 Codec Open */
+    pH264Dec->hMFCH264Handle.bPooledSession = pVideoDec->bThumbnailMode;
     ret = H264CodecOpen(pH264Dec, pVideoInstInfo);
     if (ret != OMX_ErrorNone) {
         goto EXIT;
@@ -2528,7 +2541,7 @@ OMX_ERRORTYPE Exynos_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     Exynos_OSAL_SignalCreate(&pH264Dec->hDestinationInStartEvent);
     Exynos_OSAL_SignalCreate(&pH264Dec->hDestinationOutStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, 0, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+    Exynos_ResetReorderTimestamp(pExynosComponent);
     INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
     Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
     pH264Dec->hMFCH264Handle.indexTimestamp = 0;
@@ -3167,9 +3180,6 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         pDstOutputData->timeStamp   = sCurrentTimestamp.timeStamp;
         pDstOutputData->nFlags      = sCurrentTimestamp.nFlags | OMX_BUFFERFLAG_ENDOFFRAME;
 
-        pExynosComponent->nFlags[sCurrentTimestamp.nIndex]               = 0x00;
-        pExynosComponent->bTimestampSlotUsed[sCurrentTimestamp.nIndex]   = OMX_FALSE;
-
         Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] output / buffer header(%p), nFlags: 0x%x, timestamp %lld us (%.2f secs), reordered tag: %d, original tag: %d",
                                                     pExynosComponent, __FUNCTION__,
                                                     pDstOutputData->bufferHeader, pDstOutputData->nFlags,
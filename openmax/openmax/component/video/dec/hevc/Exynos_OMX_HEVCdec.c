@@ -32,6 +32,7 @@
 #include "Exynos_OMX_Macros.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OMX_Baseport.h"
+#include "Exynos_OMX_SessionPool.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
 #include "Exynos_OSAL_ETC.h"
@@ -440,7 +441,13 @@ OMX_ERRORTYPE HevcCodecOpen(
 #else
     pVideoInstInfo->nMemoryType = VIDEO_MEMORY_USERPTR;
 #endif
-    pHevcDec->hMFCHevcHandle.hMFCHandle = pHevcDec->hMFCHevcHandle.pDecOps->Init(pVideoInstInfo);
+    pHevcDec->hMFCHevcHandle.hMFCHandle = NULL;
+    if ((pHevcDec->hMFCHevcHandle.bPooledSession == OMX_TRUE) &&
+        (Exynos_OMX_SessionPool_GetDecoder(pVideoInstInfo, pDecOps, &pHevcDec->hMFCHevcHandle.hMFCHandle) != OMX_ErrorNone))
+        pHevcDec->hMFCHevcHandle.bPooledSession = OMX_FALSE;
+
+    if (pHevcDec->hMFCHevcHandle.hMFCHandle == NULL)
+        pHevcDec->hMFCHevcHandle.hMFCHandle = pHevcDec->hMFCHevcHandle.pDecOps->Init(pVideoInstInfo);
 
     if (pHevcDec->hMFCHevcHandle.hMFCHandle == NULL) {
         Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to init", __FUNCTION__);
@@ -501,8 +508,12 @@ OMX_ERRORTYPE HevcCodecClose(EXYNOS_HEVCDEC_HANDLE *pHevcDec)
     pOutbufOps = pHevcDec->hMFCHevcHandle.pOutbufOps;
 
     if (hMFCHandle != NULL) {
-        pDecOps->Finalize(hMFCHandle);
+        if (pHevcDec->hMFCHevcHandle.bPooledSession == OMX_TRUE)
+            Exynos_OMX_SessionPool_PutDecoder(pDecOps, hMFCHandle);  /* finalized on the pool thread */
+        else
+            pDecOps->Finalize(hMFCHandle);
         pHevcDec->hMFCHevcHandle.hMFCHandle = NULL;
+        pHevcDec->hMFCHevcHandle.bPooledSession = OMX_FALSE;
         pHevcDec->hMFCHevcHandle.bConfiguredMFCSrc = OMX_FALSE;
         pHevcDec->hMFCHevcHandle.bConfiguredMFCDst = OMX_FALSE;
     }
@@ -1480,7 +1491,7 @@ OMX_ERRORTYPE HevcCodecUpdateResolution(OMX_COMPONENTTYPE *pOMXComponent)
 
 EXIT:
     if (ret != OMX_ErrorNone) {
-        Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, 0, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+        Exynos_ResetReorderTimestamp(pExynosComponent);
         INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
         Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
     }
@@ -2657,6 +2668,7 @@ OMX_ERRORTYPE Exynos_HevcDec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pVideoInstInfo->xFramerate    = pExynosInputPort->portDefinition.format.video.xFramerate;
 
     /* HEVC Codec Open */
+    pHevcDec->hMFCHevcHandle.bPooledSession = pVideoDec->bThumbnailMode;
     ret = HevcCodecOpen(pHevcDec, pVideoInstInfo);
     if (ret != OMX_ErrorNone) {
         goto EXIT;
@@ -2703,7 +2715,7 @@ OMX_ERRORTYPE Exynos_HevcDec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     Exynos_OSAL_SignalCreate(&pHevcDec->hDestinationInStartEvent);
     Exynos_OSAL_SignalCreate(&pHevcDec->hDestinationOutStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, 0, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+    Exynos_ResetReorderTimestamp(pExynosComponent);
     INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
     Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
     pHevcDec->hMFCHevcHandle.indexTimestamp = 0;
@@ -3341,9 +3353,6 @@ OMX_ERRORTYPE Exynos_HevcDec_DstOut(
         pDstOutputData->timeStamp   = sCurrentTimestamp.timeStamp;
         pDstOutputData->nFlags      = sCurrentTimestamp.nFlags | OMX_BUFFERFLAG_ENDOFFRAME;
 
-        pExynosComponent->nFlags[sCurrentTimestamp.nIndex]               = 0x00;
-        pExynosComponent->bTimestampSlotUsed[sCurrentTimestamp.nIndex]   = OMX_FALSE;
-
         Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] output / buffer header(%p), nFlags: 0x%x, timestamp %lld us (%.2f secs), reordered tag: %d, original tag: %d",
                                                     pExynosComponent, __FUNCTION__,
                                                     pDstOutputData->bufferHeader, pDstOutputData->nFlags,
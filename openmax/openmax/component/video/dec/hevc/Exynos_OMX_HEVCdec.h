@@ -41,6 +41,7 @@ typedef struct _EXYNOS_MFC_HEVCDEC_HANDLE
     OMX_U32                    outputIndexTimestamp;
     OMX_BOOL                   bConfiguredMFCSrc;
     OMX_BOOL                   bConfiguredMFCDst;
+    OMX_BOOL                   bPooledSession;      /* opened and closed through the session pool */
     OMX_S32                    maxDPBNum;
 
     /* for custom component(MSRND) */
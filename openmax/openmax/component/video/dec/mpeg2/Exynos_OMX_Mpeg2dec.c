@@ -3118,8 +3118,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(
     pExynosPort->portDefinition.format.video.bFlagErrorConcealment = OMX_FALSE;
     pExynosPort->portDefinition.format.video.eColorFormat = OMX_COLOR_FormatUnused;
     pExynosPort->portDefinition.bEnabled = OMX_TRUE;
-    //pExynosPort->bufferProcessType = BUFFER_SHARE;
-    pExynosPort->bufferProcessType = BUFFER_COPY;
+    pExynosPort->bufferProcessType = BUFFER_SHARE;
     pExynosPort->portWayType = WAY2_PORT;
     pExynosPort->ePlaneType = PLANE_SINGLE;
 
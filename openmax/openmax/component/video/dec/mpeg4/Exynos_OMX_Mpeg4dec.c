@@ -2311,7 +2311,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     Exynos_OSAL_SignalCreate(&pMpeg4Dec->hDestinationInStartEvent);
     Exynos_OSAL_SignalCreate(&pMpeg4Dec->hDestinationOutStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, 0, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+    Exynos_ResetReorderTimestamp(pExynosComponent);
     INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
     Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
     pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp = 0;
@@ -2924,9 +2924,6 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         pDstOutputData->timeStamp   = sCurrentTimestamp.timeStamp;
         pDstOutputData->nFlags      = sCurrentTimestamp.nFlags | OMX_BUFFERFLAG_ENDOFFRAME;
 
-        pExynosComponent->nFlags[sCurrentTimestamp.nIndex]               = 0x00;
-        pExynosComponent->bTimestampSlotUsed[sCurrentTimestamp.nIndex]   = OMX_FALSE;
-
         Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] output / buffer header(%p), nFlags: 0x%x, timestamp %lld us (%.2f secs), reordered tag: %d, original tag: %d",
                                                     pExynosComponent, __FUNCTION__,
                                                     pDstOutputData->bufferHeader, pDstOutputData->nFlags,
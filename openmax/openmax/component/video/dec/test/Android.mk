@@ -0,0 +1,42 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	Exynos_OMX_VdecReorder_test.cpp
+
+LOCAL_MODULE := ExynosOMX_VdecReorder_test
+ifeq ($(BOARD_USES_VENDORIMAGE), true)
+LOCAL_PROPRIETARY_MODULE := true
+endif
+
+LOCAL_CFLAGS :=
+
+LOCAL_STATIC_LIBRARIES := libExynosOMX_Vdec libExynosOMX_OSAL
+LOCAL_SHARED_LIBRARIES := \
+    libc \
+    libcutils \
+    libutils \
+    liblog \
+    libion_exynos \
+
+LOCAL_C_INCLUDES := \
+	$(EXYNOS_OMX_INC)/exynos \
+	$(EXYNOS_OMX_TOP)/osal \
+	$(EXYNOS_OMX_COMPONENT)/common \
+	$(EXYNOS_OMX_COMPONENT)/video/dec \
+	$(EXYNOS_VIDEO_CODEC)/include \
+	$(TOP)/hardware/samsung_slsi/exynos/include \
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_CFLAGS += -DUSE_KHRONOS_OMX_HEADER
+LOCAL_C_INCLUDES += $(EXYNOS_OMX_INC)/khronos
+else
+ifeq ($(BOARD_USE_ANDROID), true)
+LOCAL_HEADER_LIBRARIES := media_plugin_headers
+LOCAL_CFLAGS += -DUSE_ANDROID
+endif
+endif
+
+include $(BUILD_NATIVE_TEST)
@@ -0,0 +1,297 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include "Exynos_OMX_Def.h"
+#include "Exynos_OMX_Vdec.h"
+
+class VdecReorderTest : public ::testing::Test {
+protected:
+    EXYNOS_OMX_BASECOMPONENT      component;
+    EXYNOS_OMX_VIDEODEC_COMPONENT videoDec;
+    EXYNOS_OMX_BASEPORT           ports[ALL_PORT_NUM];
+    OMX_U32                       nIndex;
+
+    virtual void SetUp() {
+        memset(&component, 0, sizeof(component));
+        memset(&videoDec, 0, sizeof(videoDec));
+        memset(ports, 0, sizeof(ports));
+
+        component.hComponentHandle = (OMX_HANDLETYPE)&videoDec;
+        component.pExynosPort      = ports;
+        videoDec.bReorderMode      = OMX_TRUE;
+
+        for (int i = 0; i < MAX_TIMESTAMP; i++)
+            component.timeStamp[i] = DEFAULT_TIMESTAMP_VAL;
+
+        Exynos_ResetReorderTimestamp(&component);
+        nIndex = 0;
+    }
+
+    /* like as the decoders : the tag goes to MFC, then the next slot is a hint */
+    OMX_S32 Queue(OMX_TICKS timeStamp, OMX_U32 nFlags = OMX_BUFFERFLAG_ENDOFFRAME) {
+        OMX_S32 nTag;
+
+        Exynos_SetReorderTimestamp(&component, &nIndex, timeStamp, nFlags);
+        nTag = (OMX_S32)nIndex;
+        nIndex = (nIndex + 1) % MAX_TIMESTAMP;
+
+        return nTag;
+    }
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP Display(OMX_S32 nTag, OMX_S32 eFrameType = VIDEO_FRAME_B) {
+        EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current;
+
+        Exynos_GetReorderTimestamp(&component, &current, nTag, eFrameType);
+
+        return current;
+    }
+
+    int UsedSlots() {
+        int nCount = 0;
+
+        for (int i = 0; i < MAX_TIMESTAMP; i++)
+            nCount += (component.bTimestampSlotUsed[i] == OMX_TRUE)? 1:0;
+
+        return nCount;
+    }
+};
+
+TEST_F(VdecReorderTest, OutOfOrderInputIsDisplayedInTimestampOrder) {
+    /* I0 P3 B1 B2 P6 B4 B5 in decoding order */
+    const OMX_TICKS decodeOrder[] = { 0, 100, 33, 66, 200, 133, 166 };
+    const OMX_TICKS displayOrder[] = { 0, 33, 66, 100, 133, 166, 200 };
+    OMX_S32 tags[7];
+
+    for (int i = 0; i < 7; i++)
+        tags[i] = Queue(decodeOrder[i]);
+
+    for (int i = 0; i < 7; i++) {
+        EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(tags[i]);
+
+        EXPECT_EQ(displayOrder[i], current.timeStamp);
+        EXPECT_EQ(OMX_FALSE, component.bTimestampSlotUsed[current.nIndex]);
+    }
+
+    EXPECT_EQ(0, UsedSlots());
+}
+
+TEST_F(VdecReorderTest, TagIsTheFirstFreeSlotFromHint) {
+    EXPECT_EQ(0, Queue(10));
+    EXPECT_EQ(1, Queue(20));
+
+    nIndex = 0;
+    EXPECT_EQ(2, Queue(30));
+
+    Display(0);  /* frees the slot of 10 */
+    nIndex = 0;
+    EXPECT_EQ(0, Queue(40));
+}
+
+TEST_F(VdecReorderTest, DeepReorderKeepsEveryTimestamp) {
+    OMX_TICKS timeStamps[MAX_TIMESTAMP];
+
+    for (int i = 0; i < MAX_TIMESTAMP; i++)
+        timeStamps[i] = (OMX_TICKS)i * 1000;
+
+    srand(7);
+    for (int i = MAX_TIMESTAMP - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        OMX_TICKS t = timeStamps[i];
+
+        timeStamps[i] = timeStamps[j];
+        timeStamps[j] = t;
+    }
+
+    for (int i = 0; i < MAX_TIMESTAMP; i++)
+        Queue(timeStamps[i]);
+
+    EXPECT_EQ(MAX_TIMESTAMP, UsedSlots());
+
+    for (int i = 0; i < MAX_TIMESTAMP; i++)
+        EXPECT_EQ((OMX_TICKS)i * 1000, Display(-1).timeStamp);
+
+    EXPECT_EQ(0, UsedSlots());
+}
+
+TEST_F(VdecReorderTest, SameTimestampsComeOutInArrivalOrder) {
+    OMX_S32 first  = Queue(500);
+    OMX_S32 second = Queue(500);
+
+    EXPECT_EQ(first, Display(-1).nIndex);
+    EXPECT_EQ(second, Display(-1).nIndex);
+}
+
+TEST_F(VdecReorderTest, CodecConfigIsNeverDisplayed) {
+    Queue(0, OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_ENDOFFRAME);
+    Queue(33);
+
+    EXPECT_EQ(33, Display(-1).timeStamp);
+    EXPECT_EQ(1, UsedSlots());
+}
+
+TEST_F(VdecReorderTest, FullTableReclaimsStaleSlotsInsteadOfPendingFrames) {
+    /* codec configs and frames never displayed hold the slots */
+    for (int i = 0; i < MAX_TIMESTAMP - 2; i++)
+        Queue(0, OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_ENDOFFRAME);
+
+    Queue(1000);
+    Queue(2000);
+    EXPECT_EQ(MAX_TIMESTAMP, UsedSlots());
+
+    Queue(3000);
+
+    EXPECT_EQ(1000, Display(-1).timeStamp);
+    EXPECT_EQ(2000, Display(-1).timeStamp);
+    EXPECT_EQ(3000, Display(-1).timeStamp);
+}
+
+TEST_F(VdecReorderTest, FullTableWithPendingFramesLosesNoFrame) {
+    for (int i = 0; i < MAX_TIMESTAMP; i++)
+        Queue((OMX_TICKS)(i + 1) * 10);
+
+    Queue(5);  /* all pending are valid, 10 is spilled */
+    Queue((OMX_TICKS)(MAX_TIMESTAMP + 1) * 10);  /* 5 is spilled */
+
+    EXPECT_EQ(5, Display(-1).timeStamp);
+    for (int i = 0; i <= MAX_TIMESTAMP; i++)
+        EXPECT_EQ((OMX_TICKS)(i + 1) * 10, Display(-1).timeStamp);
+
+    EXPECT_EQ(0, UsedSlots());
+    EXPECT_EQ(0, videoDec.reorderTable.nSpillNum);
+}
+
+TEST_F(VdecReorderTest, ReorderDeeperThanTheSlotsKeepsEveryTimestamp) {
+    const int nFrames = MAX_TIMESTAMP + REORDER_SPILL_NUM;
+    OMX_TICKS timeStamps[MAX_TIMESTAMP + REORDER_SPILL_NUM];
+
+    for (int i = 0; i < nFrames; i++)
+        timeStamps[i] = (OMX_TICKS)i * 1000;
+
+    srand(11);
+    for (int i = nFrames - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        OMX_TICKS t = timeStamps[i];
+
+        timeStamps[i] = timeStamps[j];
+        timeStamps[j] = t;
+    }
+
+    for (int i = 0; i < nFrames; i++)
+        Queue(timeStamps[i]);
+
+    for (int i = 0; i < nFrames; i++)
+        EXPECT_EQ((OMX_TICKS)i * 1000, Display(-1).timeStamp);
+
+    EXPECT_EQ(0, UsedSlots());
+}
+
+TEST_F(VdecReorderTest, IFrameTagClearsPastSpilledTimestamps) {
+    for (int i = 0; i < MAX_TIMESTAMP; i++)
+        Queue((OMX_TICKS)(i + 1) * 10);
+
+    OMX_S32 key = Queue((OMX_TICKS)(MAX_TIMESTAMP + 1) * 10);  /* 10 is spilled */
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(key, VIDEO_FRAME_I);
+
+    EXPECT_EQ((OMX_TICKS)(MAX_TIMESTAMP + 1) * 10, current.timeStamp);
+    EXPECT_EQ(0, UsedSlots());
+    EXPECT_EQ(0, videoDec.reorderTable.nSpillNum);
+}
+
+TEST_F(VdecReorderTest, EmptyEOSComesAfterAllFrames) {
+    Queue(100);
+    Queue(200);
+    OMX_S32 eos = Queue(0, OMX_BUFFERFLAG_EOS);
+    Queue(150);
+
+    EXPECT_EQ(100, Display(-1).timeStamp);
+    EXPECT_EQ(150, Display(-1).timeStamp);
+    EXPECT_EQ(200, Display(-1).timeStamp);
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(eos);
+
+    EXPECT_EQ(eos, current.nIndex);
+    EXPECT_EQ((OMX_U32)OMX_BUFFERFLAG_EOS, current.nFlags & OMX_BUFFERFLAG_EOS);
+    EXPECT_EQ(200, current.timeStamp);  /* no going back in time */
+}
+
+TEST_F(VdecReorderTest, EOSWithDataUnderBehaviorEOSIsOrderedByTimestamp) {
+    Queue(100);
+    Queue(300);
+    component.bBehaviorEOS = OMX_TRUE;  /* set by the SrcIn when EOS carries data */
+    OMX_S32 eos = Queue(200, OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_ENDOFFRAME);
+
+    EXPECT_EQ(100, Display(-1).timeStamp);
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(-1);
+
+    EXPECT_EQ(eos, current.nIndex);
+    EXPECT_EQ(200, current.timeStamp);
+    EXPECT_EQ((OMX_U32)OMX_BUFFERFLAG_EOS, current.nFlags & OMX_BUFFERFLAG_EOS);
+
+    current = Display(-1);
+    EXPECT_EQ(300, current.timeStamp);
+    EXPECT_EQ(0u, current.nFlags & OMX_BUFFERFLAG_EOS);
+}
+
+TEST_F(VdecReorderTest, EOSWithDataWithoutBehaviorEOSComesAfterAllFrames) {
+    Queue(100);
+    OMX_S32 eos = Queue(200, OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_ENDOFFRAME);
+    Queue(300);
+
+    EXPECT_EQ(100, Display(-1).timeStamp);
+    EXPECT_EQ(300, Display(-1).timeStamp);
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(-1);
+
+    EXPECT_EQ(eos, current.nIndex);
+    EXPECT_EQ((OMX_U32)OMX_BUFFERFLAG_EOS, current.nFlags & OMX_BUFFERFLAG_EOS);
+    EXPECT_EQ(300, current.timeStamp);  /* no going back in time */
+}
+
+TEST_F(VdecReorderTest, IFrameTagResyncsTheTable) {
+    Queue(10);
+    Queue(20);
+    OMX_S32 key = Queue(30);
+    Queue(40);
+
+    EXYNOS_OMX_CURRENT_FRAME_TIMESTAMP current = Display(key, VIDEO_FRAME_I);
+
+    EXPECT_EQ(30, current.timeStamp);
+    EXPECT_EQ((OMX_U32)OMX_BUFFERFLAG_SYNCFRAME, current.nFlags & OMX_BUFFERFLAG_SYNCFRAME);
+
+    /* 10 and 20 were in the past of the key frame */
+    EXPECT_EQ(1, UsedSlots());
+    EXPECT_EQ(40, Display(-1).timeStamp);
+}
+
+TEST_F(VdecReorderTest, ResetForgetsPendingTimestamps) {
+    Queue(10);
+    Queue(20);
+
+    Exynos_ResetReorderTimestamp(&component);
+    EXPECT_EQ(0, UsedSlots());
+
+    nIndex = 0;
+    EXPECT_EQ(0, Queue(5));
+    EXPECT_EQ(5, Display(-1).timeStamp);
+}
@@ -2331,7 +2331,7 @@ OMX_ERRORTYPE Exynos_WmvDec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     Exynos_OSAL_SignalCreate(&pWmvDec->hDestinationInStartEvent);
     Exynos_OSAL_SignalCreate(&pWmvDec->hDestinationOutStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->bTimestampSlotUsed, 0, sizeof(OMX_BOOL) * MAX_TIMESTAMP);
+    Exynos_ResetReorderTimestamp(pExynosComponent);
     INIT_ARRAY_TO_VAL(pExynosComponent->timeStamp, DEFAULT_TIMESTAMP_VAL, MAX_TIMESTAMP);
     Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
     pWmvDec->hMFCWmvHandle.indexTimestamp = 0;
@@ -2958,9 +2958,6 @@ OMX_ERRORTYPE Exynos_WmvDec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
         pDstOutputData->timeStamp   = sCurrentTimestamp.timeStamp;
         pDstOutputData->nFlags      = sCurrentTimestamp.nFlags | OMX_BUFFERFLAG_ENDOFFRAME;
 
-        pExynosComponent->nFlags[sCurrentTimestamp.nIndex]               = 0x00;
-        pExynosComponent->bTimestampSlotUsed[sCurrentTimestamp.nIndex]   = OMX_FALSE;
-
         Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] output / buffer header(%p), nFlags: 0x%x, timestamp %lld us (%.2f secs), reordered tag: %d, original tag: %d",
                                                     pExynosComponent, __FUNCTION__,
                                                     pDstOutputData->bufferHeader, pDstOutputData->nFlags,
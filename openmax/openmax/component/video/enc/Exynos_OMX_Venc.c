@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "Exynos_OMX_Macros.h"
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Venc.h"
@@ -38,6 +39,7 @@
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
+#include "Exynos_OSAL_Latency.h"
 #include "ExynosVideoApi.h"
 #include "csc.h"
 
@@ -487,12 +489,11 @@ OMX_BOOL Exynos_CSC_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
     EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
     EXYNOS_OMX_BASEPORT           *pInputPort         = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     EXYNOS_OMX_BASEPORT           *pOutputPort        = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
-    EXYNOS_OMX_DATABUFFER         *pInputUseBuffer    = &pInputPort->way.port2WayDataBuffer.inputDataBuffer;
     CODEC_ENC_BUFFER              *pCodecInputBuffer  = (CODEC_ENC_BUFFER *)pSrcInputData->pPrivate;
     OMX_COLOR_FORMATTYPE           eColorFormat       = pInputPort->portDefinition.format.video.eColorFormat;
     OMX_COLOR_FORMATTYPE           eSrcColorFormat    = OMX_COLOR_FormatUnused;
 
-    void *pInputBuf                 = (void *)pInputUseBuffer->bufferHeader->pBuffer;
+    void *pInputBuf                 = (void *)pSrcInputData->bufferHeader->pBuffer;
     void *pSrcBuf[MAX_BUFFER_PLANE] = { NULL, };
     void *pDstBuf[MAX_BUFFER_PLANE] = { NULL, };
 
@@ -1108,8 +1109,17 @@ OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 goto EXIT;
             }
 
-            if (copySize > 0) {
+            srcInputData->timeStamp     = inputUseBuffer->timeStamp;
+            srcInputData->nFlags        = inputUseBuffer->nFlags;
+            srcInputData->bufferHeader  = inputUseBuffer->bufferHeader;
+
+            if ((copySize > 0) &&
+                (pVideoEnc->cscStage.hThread == NULL)) {
+                OMX_U64 nStart = Exynos_OSAL_LatencyGetTime();
+
                 ret = Exynos_CSC_InputData(pOMXComponent, srcInputData);
+                Exynos_OSAL_LatencyRecord(pExynosComponent->hLatency, LATENCY_STAGE_CSC,
+                                          (OMX_U32)(Exynos_OSAL_LatencyGetTime() - nStart));
                 if (ret != OMX_TRUE) {
                     Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to CSC_InputData", pExynosComponent, __FUNCTION__);
                     Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] send event(OMX_EventError)", pExynosComponent, __FUNCTION__);
@@ -1129,12 +1139,13 @@ OMX_BOOL Exynos_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
             srcInputData->dataLen           += copySize;
             srcInputData->remainDataLen     += copySize;
 
-            srcInputData->timeStamp     = inputUseBuffer->timeStamp;
-            srcInputData->nFlags        = inputUseBuffer->nFlags;
-            srcInputData->bufferHeader  = inputUseBuffer->bufferHeader;
-
-            /* return OMX buffer and reset dataBuffer */
-            Exynos_InputBufferReturn(pOMXComponent, inputUseBuffer);
+            if (pVideoEnc->cscStage.hThread != NULL) {
+                /* CSC thread converts the data and returns OMX buffer */
+                Exynos_ResetDataBuffer(inputUseBuffer);
+            } else {
+                /* return OMX buffer and reset dataBuffer */
+                Exynos_InputBufferReturn(pOMXComponent, inputUseBuffer);
+            }
 
             ret = OMX_TRUE;
         }
@@ -1387,6 +1398,10 @@ OMX_ERRORTYPE Exynos_OMX_ExtensionSetup(OMX_HANDLETYPE hComponent)
 
         for (i = 0; i < MFC_INPUT_BUFFER_NUM_MAX; i++)
             Exynos_CodecBufferEnqueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
+
+        /* conversion is only needed in copy mode, if it fails, src input thread does it */
+        if (pVideoEnc->cscStage.hThread == NULL)
+            Exynos_CSCStage_Create(pOMXComponent);
     } else if (pInputPort->bufferProcessType == BUFFER_SHARE) {
         /*************/
         /*    TBD    */
@@ -1402,6 +1417,213 @@ EXIT:
     return ret;
 }
 
+static OMX_U32 Exynos_CSC_GetTimeUs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (OMX_U32)((now.tv_sec * 1000000LL) + (now.tv_nsec / 1000));
+}
+
+static void Exynos_CSC_SelectMethod(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_BASEPORT           *pInputPort         = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_CSC_STAGE          *pCSCStage          = &pVideoEnc->cscStage;
+
+    CSC_METHOD eCurrent = CSC_METHOD_HW;
+    CSC_METHOD eOther   = CSC_METHOD_SW;
+    CSC_METHOD eTarget  = CSC_METHOD_HW;
+    OMX_U32    nBudget  = 1000000 / 30;  /* us per frame */
+    OMX_BOOL   bStale   = OMX_FALSE;
+
+    if (pCSCStage->bAdaptive != OMX_TRUE)
+        return;
+
+    if (pInputPort->portDefinition.format.video.xFramerate > 0)
+        nBudget = (OMX_U32)(((OMX_U64)1000000 << 16) / pInputPort->portDefinition.format.video.xFramerate);
+
+    csc_get_method(pVideoEnc->csc_handle, &eCurrent);
+    eOther  = (eCurrent == CSC_METHOD_HW)? CSC_METHOD_SW:CSC_METHOD_HW;
+    eTarget = eCurrent;
+    bStale  = ((pCSCStage->nFrameCount - pCSCStage->nSampleFrame[eOther]) >= CSC_STAGE_PROBE_INTERVAL)? OMX_TRUE:OMX_FALSE;
+
+    if ((pCSCStage->nCost[eOther] != 0) &&
+        (bStale == OMX_FALSE) &&
+        ((pCSCStage->nCost[eOther] * 8) < (pCSCStage->nCost[eCurrent] * 7))) {
+        /* the other one is clearly cheaper */
+        eTarget = eOther;
+    } else if ((bStale == OMX_TRUE) &&
+               ((pCSCStage->nCost[eCurrent] > (nBudget / 2)) ||
+                (eCurrent == CSC_METHOD_SW))) {
+        /* G2D/scaler load changes from time to time, so samples the other one again.
+         * H/W is preferred when it is fast enough, because S/W takes CPU time.
+         */
+        eTarget = eOther;
+    }
+
+    if (eTarget != eCurrent) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] CSC %s(%u us) -> %s(%u us), budget(%u us)",
+                                            pExynosComponent, __FUNCTION__,
+                                            (eCurrent == CSC_METHOD_SW)? "SW":"HW", pCSCStage->nCost[eCurrent],
+                                            (eTarget == CSC_METHOD_SW)? "SW":"HW", pCSCStage->nCost[eTarget],
+                                            nBudget);
+        csc_set_method(pVideoEnc->csc_handle, eTarget);
+
+        /* memory type and cacheable are different by method */
+        pVideoEnc->csc_set_format = OMX_FALSE;
+    }
+
+    return;
+}
+
+static void Exynos_CSC_UpdateCost(
+    OMX_COMPONENTTYPE   *pOMXComponent,
+    CSC_METHOD           eRequested,
+    OMX_U32              nElapsed)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_CSC_STAGE          *pCSCStage          = &pVideoEnc->cscStage;
+
+    CSC_METHOD eUsed = CSC_METHOD_HW;
+
+    csc_get_method(pVideoEnc->csc_handle, &eUsed);
+
+    if ((pCSCStage->bAdaptive == OMX_TRUE) &&
+        (eRequested != eUsed)) {
+        /* blur/rotation/cropping/mirror or gralloc source is only for H/W */
+        Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] CSC method is fixed to HW", pExynosComponent, __FUNCTION__);
+        pCSCStage->bAdaptive = OMX_FALSE;
+    }
+
+    if ((pCSCStage->nCost[eUsed] == 0) ||
+        ((pCSCStage->nFrameCount - pCSCStage->nSampleFrame[eUsed]) >= CSC_STAGE_PROBE_INTERVAL))
+        pCSCStage->nCost[eUsed] = nElapsed;
+    else
+        pCSCStage->nCost[eUsed] = ((pCSCStage->nCost[eUsed] * 7) + nElapsed) / 8;
+
+    pCSCStage->nSampleFrame[eUsed] = pCSCStage->nFrameCount;
+    pCSCStage->nFrameCount++;
+
+    return;
+}
+
+static void Exynos_CSCStage_ReturnBuffer(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pData)
+{
+    EXYNOS_OMX_DATABUFFER dataBuffer;
+
+    if (pData->bufferHeader == NULL)
+        return;
+
+    Exynos_OSAL_Memset(&dataBuffer, 0, sizeof(dataBuffer));
+    dataBuffer.bufferHeader = pData->bufferHeader;
+
+    /* return OMX buffer */
+    Exynos_InputBufferReturn(pOMXComponent, &dataBuffer);
+
+    return;
+}
+
+/*
+ * blocks while the input port is paused like as the other buffer threads.
+ * src input thread resets pauseEvent, so it is re-checked in a short period.
+ */
+static void Exynos_CSCStage_WaitPause(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc    = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_BASEPORT           *pInputPort   = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+
+    while (((pExynosComponent->currentState == OMX_StatePause) ||
+            (pExynosComponent->currentState == OMX_StateIdle) ||
+            (pExynosComponent->transientState == EXYNOS_OMX_TransStateLoadedToIdle) ||
+            (pExynosComponent->transientState == EXYNOS_OMX_TransStateExecutingToIdle)) &&
+           (pExynosComponent->transientState != EXYNOS_OMX_TransStateIdleToLoaded) &&
+           (!CHECK_PORT_BEING_FLUSHED(pInputPort)) &&
+           (!pVideoEnc->bExitBufferProcessThread)) {
+        Exynos_OSAL_SignalWait(pInputPort->pauseEvent, CSC_STAGE_PAUSE_CHECK_TIME);
+    }
+
+    return;
+}
+
+static OMX_BOOL Exynos_CSCStage_Dequeue(EXYNOS_OMX_CSC_STAGE *pCSCStage, EXYNOS_OMX_DATA *pData)
+{
+    OMX_BOOL ret = OMX_FALSE;
+
+    Exynos_OSAL_MutexLock(pCSCStage->hQueueMutex);
+    if (pCSCStage->nCount > 0) {
+        Exynos_OSAL_Memcpy(pData, &pCSCStage->ring[pCSCStage->nHead], sizeof(EXYNOS_OMX_DATA));
+        pCSCStage->nHead = (pCSCStage->nHead + 1) % CSC_STAGE_DEPTH;
+        pCSCStage->nCount--;
+        ret = OMX_TRUE;
+    }
+    Exynos_OSAL_MutexUnlock(pCSCStage->hQueueMutex);
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_CSCStage_Queue(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData)
+{
+    OMX_ERRORTYPE                  ret                = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_CSC_STAGE          *pCSCStage          = &pVideoEnc->cscStage;
+    EXYNOS_OMX_DATA               *pJob               = NULL;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(pCSCStage->hQueueMutex);
+    if (pCSCStage->nCount >= CSC_STAGE_DEPTH) {
+        Exynos_OSAL_MutexUnlock(pCSCStage->hQueueMutex);
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] CSC queue is full", pExynosComponent, __FUNCTION__);
+
+        Exynos_CSCStage_ReturnBuffer(pOMXComponent, pSrcInputData);
+        Exynos_CodecBufferEnqueue(pExynosComponent, INPUT_PORT_INDEX, pSrcInputData->pPrivate);
+        ret = OMX_ErrorUndefined;
+        goto EXIT;
+    }
+
+    pJob = &pCSCStage->ring[(pCSCStage->nHead + pCSCStage->nCount) % CSC_STAGE_DEPTH];
+    Exynos_OSAL_Memcpy(pJob, pSrcInputData, sizeof(EXYNOS_OMX_DATA));
+    pJob->extInfo = NULL;  /* owned by processData */
+    pCSCStage->nCount++;
+    Exynos_OSAL_MutexUnlock(pCSCStage->hQueueMutex);
+
+    Exynos_OSAL_SemaphorePost(pCSCStage->hSemaphore);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+void Exynos_CSCStage_Flush(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_DATA                cscData;
+
+    FunctionIn();
+
+    if (pVideoEnc->cscStage.hQueueMutex == NULL)
+        goto EXIT;
+
+    /* codec buffers are collected by exynos_codec_enqueueAllBuffer */
+    while (Exynos_CSCStage_Dequeue(&pVideoEnc->cscStage, &cscData) == OMX_TRUE) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] discard a pending frame(%p)",
+                                            pExynosComponent, __FUNCTION__, cscData.bufferHeader);
+        Exynos_CSCStage_ReturnBuffer(pOMXComponent, &cscData);
+    }
+
+EXIT:
+    FunctionOut();
+
+    return;
+}
+
 OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
 {
     OMX_ERRORTYPE                    ret                = OMX_ErrorNone;
@@ -1411,6 +1633,7 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
     EXYNOS_OMX_BASEPORT             *exynosInputPort    = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     EXYNOS_OMX_DATABUFFER           *srcInputUseBuffer  = &exynosInputPort->way.port2WayDataBuffer.inputDataBuffer;
     EXYNOS_OMX_DATA                 *pSrcInputData      = &exynosInputPort->processData;
+    OMX_TICKS                        timeStamp          = 0;
 
     OMX_BOOL bCheckInputData = OMX_FALSE;
 
@@ -1502,7 +1725,16 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
                 break;
             }
 
-            ret = pVideoEnc->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
+            if ((exynosInputPort->bufferProcessType & BUFFER_COPY) &&
+                (pVideoEnc->cscStage.hThread != NULL)) {
+                /* CSC thread sends it to MFC, the next input is prepared meanwhile */
+                ret = Exynos_CSCStage_Queue(pOMXComponent, pSrcInputData);
+            } else {
+                timeStamp = pSrcInputData->timeStamp;
+                ret = pVideoEnc->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
+                if (ret == OMX_ErrorNone)
+                    Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, timeStamp, LATENCY_MARK_CODEC_IN);
+            }
 
             Exynos_ResetCodecData(pSrcInputData);
             Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
@@ -1770,8 +2002,11 @@ OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
             }
 
             if ((dstOutputUseBuffer->dataValid == OMX_TRUE) ||
-                (exynosOutputPort->bufferProcessType & BUFFER_SHARE))
+                (exynosOutputPort->bufferProcessType & BUFFER_SHARE)) {
                 ret = pVideoEnc->exynos_codec_dstOutputProcess(pOMXComponent, pDstOutputData);
+                if (ret == OMX_ErrorNone)
+                    Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, pDstOutputData->timeStamp, LATENCY_MARK_CODEC_OUT);
+            }
 
             if (exynosOutputPort->bufferProcessType & BUFFER_SHARE) {
                 if (ret == OMX_ErrorNoneReuseBuffer)
@@ -1805,6 +2040,91 @@ EXIT:
     return ret;
 }
 
+OMX_ERRORTYPE Exynos_OMX_CSCBufferProcess(OMX_HANDLETYPE hComponent)
+{
+    OMX_ERRORTYPE                    ret                = OMX_ErrorNone;
+    OMX_COMPONENTTYPE               *pOMXComponent      = (OMX_COMPONENTTYPE *)hComponent;
+    EXYNOS_OMX_BASECOMPONENT        *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_BASEPORT             *exynosInputPort    = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_CSC_STAGE            *pCSCStage          = &pVideoEnc->cscStage;
+    EXYNOS_OMX_DATA                  cscData;
+    OMX_TICKS                        timeStamp          = 0;
+
+    FunctionIn();
+
+    while (!pVideoEnc->bExitBufferProcessThread) {
+        Exynos_OSAL_SemaphoreWait(pCSCStage->hSemaphore);
+        if (pVideoEnc->bExitBufferProcessThread)
+            break;
+
+        /* a job is left in the ring, so flush can discard it meanwhile */
+        Exynos_CSCStage_WaitPause(pExynosComponent);
+        if (pVideoEnc->bExitBufferProcessThread)
+            break;
+
+        Exynos_OSAL_MutexLock(pCSCStage->hProcessMutex);
+        if (Exynos_CSCStage_Dequeue(pCSCStage, &cscData) != OMX_TRUE) {
+            /* already discarded by flush */
+            Exynos_OSAL_MutexUnlock(pCSCStage->hProcessMutex);
+            continue;
+        }
+
+        if (CHECK_PORT_BEING_FLUSHED(exynosInputPort)) {
+            Exynos_CSCStage_ReturnBuffer(pOMXComponent, &cscData);
+            Exynos_OSAL_MutexUnlock(pCSCStage->hProcessMutex);
+            continue;
+        }
+
+        if (cscData.dataLen > 0) {
+            CSC_METHOD eMethod  = CSC_METHOD_HW;
+            OMX_U32    nStart   = 0;
+            OMX_U32    nElapsed = 0;
+            OMX_BOOL   bSuccess = OMX_FALSE;
+
+            Exynos_CSC_SelectMethod(pOMXComponent);
+            csc_get_method(pVideoEnc->csc_handle, &eMethod);
+
+            nStart   = Exynos_CSC_GetTimeUs();
+            bSuccess = Exynos_CSC_InputData(pOMXComponent, &cscData);
+            nElapsed = Exynos_CSC_GetTimeUs() - nStart;
+            Exynos_CSC_UpdateCost(pOMXComponent, eMethod, nElapsed);
+            Exynos_OSAL_LatencyRecord(pExynosComponent->hLatency, LATENCY_STAGE_CSC, nElapsed);
+
+            if (bSuccess != OMX_TRUE) {
+                Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to CSC_InputData", pExynosComponent, __FUNCTION__);
+                Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%p][%s] send event(OMX_EventError)", pExynosComponent, __FUNCTION__);
+
+                pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
+                                                        pExynosComponent->callbackData,
+                                                        OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+
+                Exynos_CSCStage_ReturnBuffer(pOMXComponent, &cscData);
+                Exynos_CodecBufferEnqueue(pExynosComponent, INPUT_PORT_INDEX, cscData.pPrivate);
+                Exynos_OSAL_MutexUnlock(pCSCStage->hProcessMutex);
+                continue;
+            }
+        }
+
+        /* return OMX buffer */
+        Exynos_CSCStage_ReturnBuffer(pOMXComponent, &cscData);
+
+        timeStamp = cscData.timeStamp;
+        ret = pVideoEnc->exynos_codec_srcInputProcess(pOMXComponent, &cscData);
+        Exynos_OSAL_MutexUnlock(pCSCStage->hProcessMutex);
+
+        if (ret == OMX_ErrorNone)
+            Exynos_OSAL_LatencyMark(pExynosComponent->hLatency, timeStamp, LATENCY_MARK_CODEC_IN);
+
+        if ((EXYNOS_OMX_ERRORTYPE)ret == OMX_ErrorCodecInit)
+            pVideoEnc->bExitBufferProcessThread = OMX_TRUE;
+    }
+
+    FunctionOut();
+
+    return ret;
+}
+
 static OMX_ERRORTYPE Exynos_OMX_SrcInputProcessThread(OMX_PTR threadData)
 {
     OMX_ERRORTYPE                ret                = OMX_ErrorNone;
@@ -1913,6 +2233,64 @@ EXIT:
     return ret;
 }
 
+static OMX_ERRORTYPE Exynos_OMX_CSCProcessThread(OMX_PTR threadData)
+{
+    OMX_ERRORTYPE                ret                = OMX_ErrorNone;
+    OMX_COMPONENTTYPE           *pOMXComponent      = NULL;
+
+    FunctionIn();
+
+    if (threadData == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+    pOMXComponent = (OMX_COMPONENTTYPE *)threadData;
+    ret = Exynos_OMX_Check_SizeVersion(pOMXComponent, sizeof(OMX_COMPONENTTYPE));
+    if (ret != OMX_ErrorNone) {
+        goto EXIT;
+    }
+
+    Exynos_OMX_CSCBufferProcess(pOMXComponent);
+
+    Exynos_OSAL_ThreadExit(NULL);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_CSCStage_Create(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE                    ret                = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT        *pExynosComponent   = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc          = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_CSC_STAGE            *pCSCStage          = &pVideoEnc->cscStage;
+
+    FunctionIn();
+
+    pCSCStage->nHead       = 0;
+    pCSCStage->nCount      = 0;
+    pCSCStage->bAdaptive   = OMX_TRUE;
+    pCSCStage->nFrameCount = 0;
+    Exynos_OSAL_Memset(pCSCStage->nCost, 0, sizeof(pCSCStage->nCost));
+    Exynos_OSAL_Memset(pCSCStage->nSampleFrame, 0, sizeof(pCSCStage->nSampleFrame));
+    Exynos_OSAL_Set_SemaphoreCount(pCSCStage->hSemaphore, 0);
+
+    ret = Exynos_OSAL_ThreadCreate(&pCSCStage->hThread,
+                 Exynos_OMX_CSCProcessThread,
+                 pOMXComponent);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "[%p][%s] Failed to create csc thread, converts on src input thread",
+                                            pExynosComponent, __FUNCTION__);
+        pCSCStage->hThread = NULL;
+    }
+
+    FunctionOut();
+
+    return ret;
+}
+
 OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
 {
     OMX_ERRORTYPE                    ret                = OMX_ErrorNone;
@@ -1975,6 +2353,17 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Terminate(OMX_HANDLETYPE hComponent)
     Exynos_OSAL_Set_SemaphoreCount(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].semWaitPortEnable[INPUT_WAY_INDEX], 0);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] src input thread is terminated", pExynosComponent, __FUNCTION__);
 
+    /* csc : only in copy mode */
+    if (pVideoEnc->cscStage.hThread != NULL) {
+        Exynos_OSAL_SignalSet(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].pauseEvent);
+        Exynos_OSAL_SemaphorePost(pVideoEnc->cscStage.hSemaphore);
+        Exynos_OSAL_ThreadTerminate(pVideoEnc->cscStage.hThread);
+        pVideoEnc->cscStage.hThread = NULL;
+        Exynos_CSCStage_Flush(pOMXComponent);
+        Exynos_OSAL_Set_SemaphoreCount(pVideoEnc->cscStage.hSemaphore, 0);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "[%p][%s] csc thread is terminated", pExynosComponent, __FUNCTION__);
+    }
+
     Exynos_OSAL_Get_SemaphoreCount(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].bufferSemID, &countValue);
     if (countValue == 0)
         Exynos_OSAL_SemaphorePost(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].bufferSemID);
@@ -2087,6 +2476,10 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
 
     pVideoEnc->eRotationType    = ROTATE_0;
 
+    Exynos_OSAL_SemaphoreCreate(&pVideoEnc->cscStage.hSemaphore);
+    Exynos_OSAL_MutexCreate(&pVideoEnc->cscStage.hQueueMutex);
+    Exynos_OSAL_MutexCreate(&pVideoEnc->cscStage.hProcessMutex);
+
     /* Input port */
     pExynosPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     pExynosPort->supportFormat = Exynos_OSAL_Malloc(sizeof(OMX_COLOR_FORMATTYPE) * INPUT_PORT_SUPPORTFORMAT_NUM_MAX);
@@ -2223,6 +2616,13 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
     }
     pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
 
+    Exynos_OSAL_MutexTerminate(pVideoEnc->cscStage.hProcessMutex);
+    pVideoEnc->cscStage.hProcessMutex = NULL;
+    Exynos_OSAL_MutexTerminate(pVideoEnc->cscStage.hQueueMutex);
+    pVideoEnc->cscStage.hQueueMutex = NULL;
+    Exynos_OSAL_SemaphoreTerminate(pVideoEnc->cscStage.hSemaphore);
+    pVideoEnc->cscStage.hSemaphore = NULL;
+
     Exynos_OSAL_Free(pVideoEnc);
     pExynosComponent->hComponentHandle = pVideoEnc = NULL;
 
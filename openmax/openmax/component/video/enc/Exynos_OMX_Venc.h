@@ -68,6 +68,10 @@
 
 #define GENERAL_TSVC_ENABLE (1 << 16)
 
+#define CSC_STAGE_DEPTH             MFC_INPUT_BUFFER_NUM_MAX  /* a job holds a codec buffer */
+#define CSC_STAGE_PROBE_INTERVAL    90                        /* frames that a cost sample is trusted */
+#define CSC_STAGE_PAUSE_CHECK_TIME  10                        /* ms, period to re-check the pause state */
+
 typedef struct
 {
     void *pAddrY;
@@ -88,6 +92,24 @@ typedef struct _CODEC_ENC_BUFFER
     int             dataSize;                     /* total data length */
 } CODEC_ENC_BUFFER;
 
+typedef struct _EXYNOS_OMX_CSC_STAGE
+{
+    OMX_HANDLETYPE  hThread;
+    OMX_HANDLETYPE  hSemaphore;         /* posted for each queued job */
+    OMX_HANDLETYPE  hQueueMutex;        /* protects the ring */
+    OMX_HANDLETYPE  hProcessMutex;      /* held while a job is converted and sent to MFC */
+
+    EXYNOS_OMX_DATA ring[CSC_STAGE_DEPTH];
+    OMX_U32         nHead;
+    OMX_U32         nCount;
+
+    /* H/W or S/W is chosen by the measured cost of conversion */
+    OMX_BOOL        bAdaptive;
+    OMX_U32         nCost[2];           /* average time(us) per frame, indexed by CSC_METHOD */
+    OMX_U32         nSampleFrame[2];    /* frame number of the last sample */
+    OMX_U32         nFrameCount;
+} EXYNOS_OMX_CSC_STAGE;
+
 typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
 {
     OMX_HANDLETYPE hCodecHandle;
@@ -131,6 +153,7 @@ typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
     /* CSC handle */
     OMX_PTR  csc_handle;
     OMX_BOOL csc_set_format;
+    EXYNOS_OMX_CSC_STAGE cscStage;
 
     OMX_ERRORTYPE (*exynos_codec_srcInputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
     OMX_ERRORTYPE (*exynos_codec_srcOutputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
@@ -160,11 +183,15 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_SrcOutputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_DstInputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent);
+OMX_ERRORTYPE Exynos_OMX_CSCBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentInit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentDeinit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_Allocate_CodecBuffers(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex, int nBufferCnt, unsigned int nAllocLen[MAX_BUFFER_PLANE]);
 void Exynos_Free_CodecBuffers(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex);
 OMX_ERRORTYPE Exynos_ResetAllPortConfig(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_CSCStage_Create(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_CSCStage_Queue(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData);
+void Exynos_CSCStage_Flush(OMX_COMPONENTTYPE *pOMXComponent);
 
 #ifdef __cplusplus
 }
@@ -770,6 +770,8 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
     pVideoEnc->exynos_codec_bufferProcessRun(pOMXComponent, nPortIndex);
 
     Exynos_OSAL_MutexLock(pDataBuffer[0]->bufferMutex);
+    if (nPortIndex == INPUT_PORT_INDEX)
+        Exynos_OSAL_MutexLock(pVideoEnc->cscStage.hProcessMutex);
     pVideoEnc->exynos_codec_stop(pOMXComponent, nPortIndex);
 
     if (pDataBuffer[1] != NULL)
@@ -779,6 +781,9 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
     if (ret != OMX_ErrorNone)
         goto EXIT;
 
+    if (nPortIndex == INPUT_PORT_INDEX)
+        Exynos_CSCStage_Flush(pOMXComponent);
+
     if (pExynosPort->bufferProcessType & BUFFER_COPY)
         pVideoEnc->exynos_codec_enqueueAllBuffer(pOMXComponent, nPortIndex);
 
@@ -809,6 +814,10 @@ EXIT:
     if (pDataBuffer[1] != NULL)
         Exynos_OSAL_MutexUnlock(pDataBuffer[1]->bufferMutex);
 
+    if ((pDataBuffer[0] != NULL) &&
+        (nPortIndex == INPUT_PORT_INDEX))
+        Exynos_OSAL_MutexUnlock(pVideoEnc->cscStage.hProcessMutex);
+
     if (pDataBuffer[0] != NULL)
         Exynos_OSAL_MutexUnlock(pDataBuffer[0]->bufferMutex);
 
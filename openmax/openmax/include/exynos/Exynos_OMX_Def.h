@@ -41,12 +41,27 @@
 #define REVISION_NUMBER                    2
 #define STEP_NUMBER                        0
 
+/* MFC contexts shared by all video sessions */
+#ifdef MAX_MFC_INSTANCE_NUM
+#define RESOURCE_VIDEO_INSTANCE MAX_MFC_INSTANCE_NUM
+#else
+#define RESOURCE_VIDEO_INSTANCE 32
+#endif
+
+/* MFC throughput in macroblocks/sec, 4K@120fps by default */
+#ifdef MAX_MFC_MBPS
+#define RESOURCE_VIDEO_MBPS MAX_MFC_MBPS
+#else
+#define RESOURCE_VIDEO_MBPS (((3840 / 16) * (2160 / 16)) * 120)
+#endif
+
 #ifdef MAX_COMPONENT_NUM
 #define RESOURCE_VIDEO_DEC MAX_COMPONENT_NUM
 #define RESOURCE_VIDEO_ENC MAX_COMPONENT_NUM
 #else
-#define RESOURCE_VIDEO_DEC 16
-#define RESOURCE_VIDEO_ENC 16
+/* sessions are admitted by load (RESOURCE_VIDEO_MBPS), the count only guards the MFC contexts */
+#define RESOURCE_VIDEO_DEC RESOURCE_VIDEO_INSTANCE
+#define RESOURCE_VIDEO_ENC RESOURCE_VIDEO_INSTANCE
 #endif
 #define RESOURCE_AUDIO_DEC 10
 
@@ -117,6 +117,7 @@ LOCAL_SRC_FILES := \
 	Exynos_OSAL_Semaphore.c \
 	Exynos_OSAL_Library.c \
 	Exynos_OSAL_Log.c \
+	Exynos_OSAL_Latency.c \
 	Exynos_OSAL_SharedMemory.c
 
 LOCAL_PRELINK_MODULE := false
@@ -157,7 +157,7 @@ OMX_ERRORTYPE Exynos_OSAL_SignalSet(OMX_HANDLETYPE eventHandle)
     }
 
     event->signal = OMX_TRUE;
-    pthread_cond_signal(&event->condition);
+    pthread_cond_broadcast(&event->condition);  /* an event can have several waiters */
 
     Exynos_OSAL_MutexUnlock(event->mutex);
 
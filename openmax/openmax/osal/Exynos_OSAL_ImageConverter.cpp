@@ -25,6 +25,12 @@
  *   2019.02.12 : Create
  */
 #include <dlfcn.h>
+#include <math.h>
+#include <unistd.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #include <media/hardware/HardwareAPI.h>
 #include <media/hardware/MetadataBufferType.h>
@@ -35,11 +41,15 @@
 
 #include "Exynos_OSAL_Memory.h"
 #include "Exynos_OSAL_Library.h"
+#include "Exynos_OSAL_Thread.h"
+#include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Platform.h"
 
 #include "Exynos_OSAL_ImageConverter.h"
 
+#include "VendorVideoAPI.h"
+
 #undef  EXYNOS_LOG_TAG
 #define EXYNOS_LOG_TAG    "Exynos_OSAL_ImageConverter"
 //#define EXYNOS_LOG_OFF
@@ -58,6 +68,13 @@ using namespace android;
      (t == ColorAspects::TransferST2084) && \
      (c == ColorAspects::MatrixBT2020))
 
+#define CHECK_HLG(f, r, p, t, c) \
+    ((f == (OMX_COLOR_FORMATTYPE)OMX_COLOR_FormatYUV420Planar16) && \
+     (r == ColorAspects::RangeLimited) && \
+     (p == ColorAspects::PrimariesBT2020) && \
+     (t == ColorAspects::TransferHLG) && \
+     (c == ColorAspects::MatrixBT2020))
+
 #define LUMINANCE_DIV_FACTOR 10000.0
 
 #define LIB_NAME            "libImageFormatConverter.so"
@@ -127,14 +144,455 @@ typedef OMX_BOOL (*ConvertInitFunc)(const unsigned int width, const unsigned int
 typedef void     (*ConvertDeinitFunc)(void *user_data);
 typedef OMX_BOOL (*ConvertRunFunc)(HDR2SDR_config_params_t *In_params, HDR2SDR_config_params_t *Out_params, HDR10PLUS_DYNAMIC_INFO *meta, unsigned int mastering_max_luminance, void *user_data);
 
+/*
+ * built-in tone mapper, used if the library above is not available.
+ * P010 is mapped in place : luma through a LUT of 10bit codes and chroma scaled by the ratio of
+ * luma before and after. frames are split into bands of lines that are processed by a worker pool.
+ */
+#define TONEMAP_LUT_SIZE        1024    /* 10bit */
+#define TONEMAP_LUT_CACHE_NUM   4
+#define TONEMAP_WORKER_MAX      3       /* the caller works as well */
+#define TONEMAP_WORKER_PIXELS   (1920 * 1088)   /* one more worker per FHD of pixels */
+#define TONEMAP_MAX_WIDTH       8192
+#define TONEMAP_MAX_HEIGHT      4352
+#define TONEMAP_TILE_LINES      32      /* even, chroma has a half */
+#define TONEMAP_GAIN_SHIFT      12
+#define TONEMAP_GAIN_MAX        (2 << TONEMAP_GAIN_SHIFT)
+
+#define TONEMAP_SDR_NITS        100.0
+#define TONEMAP_HLG_NITS        1000.0
+#define TONEMAP_DEFAULT_NITS    1000.0
+
+typedef enum _TONEMAP_TRANSFER {
+    TONEMAP_TRANSFER_PQ  = 0,
+    TONEMAP_TRANSFER_HLG = 1,
+} TONEMAP_TRANSFER;
+
+typedef struct _TONEMAP_KEY {
+    OMX_U32 eTransfer;
+    OMX_U32 nSourceNits;        /* peak of content */
+    OMX_U32 nKneeX;             /* HDR10+ curve, nAnchors is 0 if not */
+    OMX_U32 nKneeY;
+    OMX_U32 nAnchors;
+    OMX_U32 anchors[15];
+} TONEMAP_KEY;
+
+typedef struct _TONEMAP_LUT {
+    OMX_BOOL    bValid;
+    OMX_U32     nLastUsed;
+    TONEMAP_KEY key;
+    OMX_U16     luma[TONEMAP_LUT_SIZE];     /* P010 sample */
+    OMX_U16     gain[TONEMAP_LUT_SIZE];     /* for chroma, Q12 */
+} TONEMAP_LUT;
+
+typedef struct _TONEMAP_FRAME {
+    OMX_U16     *pY;
+    OMX_U16     *pUV;
+    OMX_U32      nStride;           /* in samples */
+    OMX_U32      nWidth;
+    OMX_U32      nHeight;
+    TONEMAP_LUT *pLut;
+    OMX_U32      nTileNum;
+    OMX_U32      nNextTile;         /* taken by atomic increment */
+} TONEMAP_FRAME;
+
+typedef struct _TONEMAP_ENGINE {
+    OMX_HANDLETYPE  hWorker[TONEMAP_WORKER_MAX];
+    OMX_U32         nWorkerNum;
+    OMX_U32         nWorkerLimit;       /* by the number of CPUs */
+    OMX_HANDLETYPE  hStartSem;
+    OMX_HANDLETYPE  hDoneSem;
+    OMX_BOOL        bExit;
+
+    TONEMAP_FRAME   frame;
+    TONEMAP_LUT     lut[TONEMAP_LUT_CACHE_NUM];
+    OMX_U32         nUseCount;
+} TONEMAP_ENGINE;
+
 typedef struct _EXYNOS_OMX_IMG_CONV_HANDLE {
     void                *pLibHandle;
     ConvertInitFunc      Init;
     ConvertDeinitFunc    Deinit;
     ConvertRunFunc       Run;
     void                *pUserData;
+
+    TONEMAP_ENGINE      *pToneMap;
 } EXYNOS_OMX_IMG_CONV_HANDLE;
 
+static double ToneMap_PQToNits(double e)
+{
+    const double m1 = 2610.0 / 16384.0;
+    const double m2 = 2523.0 / 4096.0 * 128.0;
+    const double c1 = 3424.0 / 4096.0;
+    const double c2 = 2413.0 / 4096.0 * 32.0;
+    const double c3 = 2392.0 / 4096.0 * 32.0;
+    double p = pow(e, 1.0 / m2);
+
+    return pow(fmax(p - c1, 0.0) / (c2 - (c3 * p)), 1.0 / m1) * 10000.0;
+}
+
+static double ToneMap_NitsToPQ(double nits)
+{
+    const double m1 = 2610.0 / 16384.0;
+    const double m2 = 2523.0 / 4096.0 * 128.0;
+    const double c1 = 3424.0 / 4096.0;
+    const double c2 = 2413.0 / 4096.0 * 32.0;
+    const double c3 = 2392.0 / 4096.0 * 32.0;
+    double y = pow(fmax(nits, 0.0) / 10000.0, m1);
+
+    return pow((c1 + (c2 * y)) / (1.0 + (c3 * y)), m2);
+}
+
+static double ToneMap_HLGToNits(double e)
+{
+    const double a = 0.17883277;
+    const double b = 0.28466892;
+    const double c = 0.55991073;
+    double scene;
+
+    scene = (e <= 0.5)? ((e * e) / 3.0):((exp((e - c) / a) + b) / 12.0);
+
+    /* OOTF with the system gamma of 1000 nits display */
+    return TONEMAP_HLG_NITS * pow(scene, 1.2);
+}
+
+/* BT.2390 EETF : rolls off the highlights to the target in PQ domain */
+static double ToneMap_EETF(double nits, double srcNits, double dstNits)
+{
+    double srcMax = ToneMap_NitsToPQ(srcNits);
+    double maxLum = ToneMap_NitsToPQ(dstNits) / srcMax;
+    double ks     = (1.5 * maxLum) - 0.5;
+    double e1, e2, t;
+
+    if (srcNits <= dstNits)
+        return fmin(nits, dstNits);
+
+    e1 = fmin(ToneMap_NitsToPQ(nits) / srcMax, 1.0);
+    if (e1 < ks) {
+        e2 = e1;
+    } else {
+        t  = (e1 - ks) / (1.0 - ks);
+        e2 = (((2 * t * t * t) - (3 * t * t) + 1) * ks) +
+             (((t * t * t) - (2 * t * t) + t) * (1.0 - ks)) +
+             (((-2 * t * t * t) + (3 * t * t)) * maxLum);
+    }
+
+    return ToneMap_PQToNits(e2 * srcMax);
+}
+
+/* ST 2094-40 : linear under the knee point, bezier curve above */
+static double ToneMap_Bezier(double nits, TONEMAP_KEY *pKey, double dstNits)
+{
+    double x  = fmin(nits / pKey->nSourceNits, 1.0);
+    double kx = pKey->nKneeX / 4095.0;
+    double ky = pKey->nKneeY / 4095.0;
+    double p[17];
+    double t, y;
+    int    n = pKey->nAnchors + 1;
+    int    i, j;
+
+    if (x <= kx) {
+        y = (kx > 0)? ((ky * x) / kx):0;
+        return y * dstNits;
+    }
+
+    p[0] = 0;
+    for (i = 0; i < (int)pKey->nAnchors; i++)
+        p[i + 1] = pKey->anchors[i] / 1023.0;
+    p[n] = 1.0;
+
+    /* de casteljau */
+    t = (x - kx) / (1.0 - kx);
+    for (j = n; j > 0; j--) {
+        for (i = 0; i < j; i++)
+            p[i] = ((1.0 - t) * p[i]) + (t * p[i + 1]);
+    }
+
+    y = ky + ((1.0 - ky) * p[0]);
+
+    return y * dstNits;
+}
+
+static void ToneMap_BuildLut(TONEMAP_LUT *pLut, TONEMAP_KEY *pKey)
+{
+    int i;
+
+    for (i = 0; i < TONEMAP_LUT_SIZE; i++) {
+        double e   = fmin(fmax((i - 64) / 876.0, 0.0), 1.0);  /* limited range */
+        double in  = (pKey->eTransfer == TONEMAP_TRANSFER_HLG)? ToneMap_HLGToNits(e):ToneMap_PQToNits(e);
+        double out = 0;
+        double v   = 0;
+        double gain;
+
+        if (pKey->nAnchors > 0)
+            out = ToneMap_Bezier(in, pKey, TONEMAP_SDR_NITS);
+        else
+            out = ToneMap_EETF(in, pKey->nSourceNits, TONEMAP_SDR_NITS);
+
+        /* BT.1886 display */
+        v = pow(fmin(fmax(out / TONEMAP_SDR_NITS, 0.0), 1.0), 1.0 / 2.4);
+
+        gain = (e > (1.0 / 876.0))? (v / e):1.0;
+        gain = fmin(gain * (1 << TONEMAP_GAIN_SHIFT), TONEMAP_GAIN_MAX);
+
+        pLut->luma[i] = (OMX_U16)((64 + (int)((v * 876.0) + 0.5)) << 6);
+        pLut->gain[i] = (OMX_U16)(gain + 0.5);
+    }
+
+    pLut->key    = *pKey;
+    pLut->bValid = OMX_TRUE;
+}
+
+static TONEMAP_LUT *ToneMap_GetLut(TONEMAP_ENGINE *pEngine, TONEMAP_KEY *pKey)
+{
+    TONEMAP_LUT *pVictim = &pEngine->lut[0];
+    int i;
+
+    pEngine->nUseCount++;
+
+    for (i = 0; i < TONEMAP_LUT_CACHE_NUM; i++) {
+        TONEMAP_LUT *pLut = &pEngine->lut[i];
+
+        if ((pLut->bValid == OMX_TRUE) &&
+            (Exynos_OSAL_Memcmp(&pLut->key, pKey, sizeof(TONEMAP_KEY)) == 0)) {
+            pLut->nLastUsed = pEngine->nUseCount;
+            return pLut;
+        }
+
+        if ((pVictim->bValid == OMX_TRUE) &&
+            ((pLut->bValid != OMX_TRUE) || (pLut->nLastUsed < pVictim->nLastUsed)))
+            pVictim = pLut;
+    }
+
+    /* HDR10+ changes a curve at scene cuts, so a few are kept */
+    ToneMap_BuildLut(pVictim, pKey);
+    pVictim->nLastUsed = pEngine->nUseCount;
+
+    return pVictim;
+}
+
+static void ToneMap_Chroma(OMX_U16 *pUV, OMX_U16 *pY, OMX_U32 nPairs, TONEMAP_LUT *pLut)
+{
+    OMX_U32 x = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; (x + 8) <= nPairs; x += 8) {
+        OMX_U16     gain[8];
+        uint16x8x2_t uv;
+        int16x8_t   g;
+        int         k;
+
+        /* LUT can not be gathered in NEON */
+        for (k = 0; k < 8; k++)
+            gain[k] = pLut->gain[pY[(x + k) * 2] >> 6];
+        g  = vreinterpretq_s16_u16(vld1q_u16(gain));
+        uv = vld2q_u16(pUV + (x * 2));
+
+        for (k = 0; k < 2; k++) {
+            int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(uv.val[k], 6)), vdupq_n_s16(512));
+            int16x4_t l = vrshrn_n_s32(vmull_s16(vget_low_s16(c), vget_low_s16(g)), TONEMAP_GAIN_SHIFT);
+            int16x4_t h = vrshrn_n_s32(vmull_s16(vget_high_s16(c), vget_high_s16(g)), TONEMAP_GAIN_SHIFT);
+
+            c = vaddq_s16(vcombine_s16(l, h), vdupq_n_s16(512));
+            c = vminq_s16(vmaxq_s16(c, vdupq_n_s16(64)), vdupq_n_s16(960));
+            uv.val[k] = vshlq_n_u16(vreinterpretq_u16_s16(c), 6);
+        }
+
+        vst2q_u16(pUV + (x * 2), uv);
+    }
+#endif
+
+    for (; x < nPairs; x++) {
+        int g = pLut->gain[pY[x * 2] >> 6];
+        int k;
+
+        for (k = 0; k < 2; k++) {
+            int c = (((int)(pUV[(x * 2) + k] >> 6) - 512) * g + (1 << (TONEMAP_GAIN_SHIFT - 1))) >> TONEMAP_GAIN_SHIFT;
+
+            c += 512;
+            c  = (c < 64)? 64:((c > 960)? 960:c);
+            pUV[(x * 2) + k] = (OMX_U16)(c << 6);
+        }
+    }
+}
+
+static void ToneMap_Tile(TONEMAP_FRAME *pFrame, OMX_U32 nTile)
+{
+    TONEMAP_LUT *pLut   = pFrame->pLut;
+    OMX_U32      nStart = nTile * TONEMAP_TILE_LINES;
+    OMX_U32      nEnd   = nStart + TONEMAP_TILE_LINES;
+    OMX_U32      y, x;
+
+    if (nEnd > pFrame->nHeight)
+        nEnd = pFrame->nHeight;
+
+    for (y = nStart; y < nEnd; y += 2) {
+        OMX_U16 *pY0 = pFrame->pY + (y * pFrame->nStride);
+        OMX_U16 *pY1 = pY0 + pFrame->nStride;
+
+        /* chroma first, it refers to the luma before mapping */
+        ToneMap_Chroma(pFrame->pUV + ((y / 2) * pFrame->nStride), pY0, pFrame->nWidth / 2, pLut);
+
+        for (x = 0; x < pFrame->nWidth; x++)
+            pY0[x] = pLut->luma[pY0[x] >> 6];
+
+        if ((y + 1) < nEnd) {
+            for (x = 0; x < pFrame->nWidth; x++)
+                pY1[x] = pLut->luma[pY1[x] >> 6];
+        }
+    }
+}
+
+static void ToneMap_ProcessTiles(TONEMAP_FRAME *pFrame)
+{
+    OMX_U32 nTile;
+
+    while ((nTile = __atomic_fetch_add(&pFrame->nNextTile, 1, __ATOMIC_RELAXED)) < pFrame->nTileNum)
+        ToneMap_Tile(pFrame, nTile);
+}
+
+static OMX_ERRORTYPE ToneMap_WorkerThread(OMX_PTR pParam)
+{
+    TONEMAP_ENGINE *pEngine = (TONEMAP_ENGINE *)pParam;
+
+    while (1) {
+        Exynos_OSAL_SemaphoreWait(pEngine->hStartSem);
+        if (pEngine->bExit == OMX_TRUE)
+            break;
+
+        ToneMap_ProcessTiles(&pEngine->frame);
+        Exynos_OSAL_SemaphorePost(pEngine->hDoneSem);
+    }
+
+    Exynos_OSAL_ThreadExit(NULL);
+
+    return OMX_ErrorNone;
+}
+
+static void ToneMap_Terminate(TONEMAP_ENGINE *pEngine)
+{
+    OMX_U32 i;
+
+    if (pEngine == NULL)
+        return;
+
+    pEngine->bExit = OMX_TRUE;
+    for (i = 0; i < pEngine->nWorkerNum; i++)
+        Exynos_OSAL_SemaphorePost(pEngine->hStartSem);
+
+    for (i = 0; i < pEngine->nWorkerNum; i++)
+        Exynos_OSAL_ThreadTerminate(pEngine->hWorker[i]);
+
+    if (pEngine->hStartSem != NULL)
+        Exynos_OSAL_SemaphoreTerminate(pEngine->hStartSem);
+
+    if (pEngine->hDoneSem != NULL)
+        Exynos_OSAL_SemaphoreTerminate(pEngine->hDoneSem);
+
+    Exynos_OSAL_Free(pEngine);
+}
+
+static TONEMAP_ENGINE *ToneMap_Create(
+    OMX_U32 nWidth,
+    OMX_U32 nHeight)
+{
+    TONEMAP_ENGINE *pEngine = NULL;
+    long            nCPU    = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* in place on P010, 4:2:0 needs an even size */
+    if ((nWidth == 0) || (nHeight == 0) ||
+        (nWidth > TONEMAP_MAX_WIDTH) || (nHeight > TONEMAP_MAX_HEIGHT) ||
+        (nWidth & 0x1) || (nHeight & 0x1)) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] unsupported size(%dx%d)", __FUNCTION__, nWidth, nHeight);
+        return NULL;
+    }
+
+    pEngine = (TONEMAP_ENGINE *)Exynos_OSAL_Malloc(sizeof(TONEMAP_ENGINE));
+    if (pEngine == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to Exynos_OSAL_Malloc()", __FUNCTION__);
+        return NULL;
+    }
+    Exynos_OSAL_Memset(pEngine, 0, sizeof(TONEMAP_ENGINE));
+
+    if ((Exynos_OSAL_SemaphoreCreate(&pEngine->hStartSem) != OMX_ErrorNone) ||
+        (Exynos_OSAL_SemaphoreCreate(&pEngine->hDoneSem) != OMX_ErrorNone)) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to Exynos_OSAL_SemaphoreCreate()", __FUNCTION__);
+        ToneMap_Terminate(pEngine);
+        return NULL;
+    }
+
+    pEngine->nWorkerLimit = (nCPU > 1)? (OMX_U32)(nCPU - 1):0;
+    if (pEngine->nWorkerLimit > TONEMAP_WORKER_MAX)
+        pEngine->nWorkerLimit = TONEMAP_WORKER_MAX;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%s] built-in tone mapper, up to %d workers", __FUNCTION__, pEngine->nWorkerLimit);
+
+    return pEngine;
+}
+
+/* workers are added when a frame is big enough to need them, the caller alone covers FHD */
+static void ToneMap_AddWorkers(
+    TONEMAP_ENGINE  *pEngine,
+    OMX_U32          nWidth,
+    OMX_U32          nHeight)
+{
+    OMX_U32 nWorker = (nWidth * nHeight) / TONEMAP_WORKER_PIXELS;
+
+    if (nWorker > pEngine->nWorkerLimit)
+        nWorker = pEngine->nWorkerLimit;
+
+    /* with less workers, it is just slower */
+    while (pEngine->nWorkerNum < nWorker) {
+        if (Exynos_OSAL_ThreadCreate(&pEngine->hWorker[pEngine->nWorkerNum],
+                                     (OMX_PTR)ToneMap_WorkerThread, pEngine) != OMX_ErrorNone) {
+            pEngine->nWorkerLimit = pEngine->nWorkerNum;
+            break;
+        }
+
+        pEngine->nWorkerNum++;
+        Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%s] %d workers for %dx%d", __FUNCTION__, pEngine->nWorkerNum, nWidth, nHeight);
+    }
+}
+
+/* not reentrant, called by one thread at a time */
+static OMX_ERRORTYPE ToneMap_Run(
+    TONEMAP_ENGINE  *pEngine,
+    OMX_U16         *pY,
+    OMX_U16         *pUV,
+    OMX_U32          nStride,
+    OMX_U32          nWidth,
+    OMX_U32          nHeight,
+    TONEMAP_KEY     *pKey)
+{
+    TONEMAP_FRAME *pFrame = &pEngine->frame;
+    OMX_U32        i;
+
+    if ((pY == NULL) ||
+        (pUV == NULL))
+        return OMX_ErrorBadParameter;
+
+    ToneMap_AddWorkers(pEngine, nWidth, nHeight);
+
+    pFrame->pY        = pY;
+    pFrame->pUV       = pUV;
+    pFrame->nStride   = nStride;
+    pFrame->nWidth    = nWidth;
+    pFrame->nHeight   = nHeight;
+    pFrame->pLut      = ToneMap_GetLut(pEngine, pKey);
+    pFrame->nTileNum  = (nHeight + TONEMAP_TILE_LINES - 1) / TONEMAP_TILE_LINES;
+    pFrame->nNextTile = 0;
+
+    for (i = 0; i < pEngine->nWorkerNum; i++)
+        Exynos_OSAL_SemaphorePost(pEngine->hStartSem);
+
+    ToneMap_ProcessTiles(pFrame);
+
+    for (i = 0; i < pEngine->nWorkerNum; i++)
+        Exynos_OSAL_SemaphoreWait(pEngine->hDoneSem);
+
+    return OMX_ErrorNone;
+}
+
 
 OMX_HANDLETYPE Exynos_OSAL_ImgConv_Create(
     OMX_U32 nWidth,
@@ -147,13 +605,17 @@ OMX_HANDLETYPE Exynos_OSAL_ImgConv_Create(
         Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%s] Failed to Exynos_OSAL_Malloc()", __FUNCTION__);
         goto EXIT;
     }
+    Exynos_OSAL_Memset(pHandle, 0, sizeof(EXYNOS_OMX_IMG_CONV_HANDLE));
 
     pHandle->pLibHandle = Exynos_OSAL_dlopen(LIB_NAME, RTLD_NOW|RTLD_GLOBAL);
     if (pHandle->pLibHandle == NULL) {
-        Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%s] Failed to Exynos_OSAL_dlopen() : reason(%s)",
+        Exynos_OSAL_Log(EXYNOS_LOG_ESSENTIAL, "[%s] Failed to Exynos_OSAL_dlopen() : reason(%s), use built-in",
                                 __FUNCTION__, Exynos_OSAL_dlerror());
-        Exynos_OSAL_Free(pHandle);
-        pHandle = NULL;
+        pHandle->pToneMap = ToneMap_Create(nWidth, nHeight);
+        if (pHandle->pToneMap == NULL) {
+            Exynos_OSAL_Free(pHandle);
+            pHandle = NULL;
+        }
         goto EXIT;
     }
 
@@ -189,10 +651,16 @@ void Exynos_OSAL_ImgConv_Terminate(OMX_HANDLETYPE hImgConv)
     if (pHandle == NULL)
         return;
 
-    if (pHandle->Deinit != NULL)
-        pHandle->Deinit(pHandle->pUserData);
+    if (pHandle->pToneMap != NULL)
+        ToneMap_Terminate(pHandle->pToneMap);
+
+    if (pHandle->pLibHandle != NULL) {
+        if (pHandle->Deinit != NULL)
+            pHandle->Deinit(pHandle->pUserData);
+
+        Exynos_OSAL_dlclose(pHandle->pLibHandle);
+    }
 
-    Exynos_OSAL_dlclose(pHandle->pLibHandle);
     Exynos_OSAL_Free(pHandle);
     pHandle = NULL;
 }
@@ -222,6 +690,8 @@ OMX_ERRORTYPE Exynos_OSAL_ImgConv_Run(
     /* parmas for image convert */
     HDR2SDR_config_params_t inConfig, outConfig;
     OMX_U16 max_display_luminance_cd_m2 = 0;
+    ExynosVideoMeta *pMeta = NULL;
+    TONEMAP_KEY      key;
 
     int i;
 
@@ -274,6 +744,70 @@ OMX_ERRORTYPE Exynos_OSAL_ImgConv_Run(
         goto EXIT;
     }
 
+    max_display_luminance_cd_m2 = (int)((pExynosPort->HDRStaticInfo.nMaxDisplayLuminance / LUMINANCE_DIV_FACTOR) + 0.5);
+
+    if (pHandle->pToneMap != NULL) {
+        Exynos_OSAL_Memset(&key, 0, sizeof(key));
+
+        if (CHECK_HDR10(bufferInfo.eColorFormat, CA.sAspects.mRange, CA.sAspects.mPrimaries,
+                        CA.sAspects.mTransfer, CA.sAspects.mMatrixCoeffs)) {
+            key.eTransfer = TONEMAP_TRANSFER_PQ;
+        } else if (CHECK_HLG(bufferInfo.eColorFormat, CA.sAspects.mRange, CA.sAspects.mPrimaries,
+                             CA.sAspects.mTransfer, CA.sAspects.mMatrixCoeffs)) {
+            key.eTransfer = TONEMAP_TRANSFER_HLG;
+        } else {
+            /* it is not HDR */
+            ret = OMX_ErrorUndefined;
+            goto EXIT;
+        }
+
+        /* peak of content : HDR10+ > MaxCLL > mastering display */
+        if (key.eTransfer == TONEMAP_TRANSFER_HLG)
+            key.nSourceNits = (OMX_U32)TONEMAP_HLG_NITS;
+        else if (pExynosPort->HDRStaticInfo.nMaxContentLight > 0)
+            key.nSourceNits = pExynosPort->HDRStaticInfo.nMaxContentLight;
+        else if (max_display_luminance_cd_m2 > 0)
+            key.nSourceNits = max_display_luminance_cd_m2;
+        else
+            key.nSourceNits = (OMX_U32)TONEMAP_DEFAULT_NITS;
+
+        /*
+         * dynamic info is in the private data, only when the handle has it as an extra fd.
+         * otherwise, addr[2] of P010_M is Cr in the chroma plane.
+         */
+        if (((long)bufferInfo.fd[2] > 0) &&
+            (bufferInfo.addr[2] != (OMX_PTR)((char *)bufferInfo.addr[1] + 2)))
+            pMeta = (ExynosVideoMeta *)bufferInfo.addr[2];
+
+        if ((key.eTransfer == TONEMAP_TRANSFER_PQ) &&
+            (pMeta != NULL) &&
+            (pMeta->eType & VIDEO_INFO_TYPE_HDR_DYNAMIC) &&
+            (pMeta->sHdrDynamicInfo.valid != 0)) {
+            unsigned int maxscl = 0;
+
+            for (i = 0; i < 3; i++)
+                maxscl = (pMeta->sHdrDynamicInfo.data.maxscl[i] > maxscl)? pMeta->sHdrDynamicInfo.data.maxscl[i]:maxscl;
+
+            /* 0.1 cd/m2 unit */
+            if (maxscl >= 10)
+                key.nSourceNits = maxscl / 10;
+
+            if ((pMeta->sHdrDynamicInfo.data.tone_mapping.tone_mapping_flag != 0) &&
+                (pMeta->sHdrDynamicInfo.data.tone_mapping.num_bezier_curve_anchors > 0) &&
+                (pMeta->sHdrDynamicInfo.data.tone_mapping.num_bezier_curve_anchors <= 15)) {
+                key.nKneeX   = pMeta->sHdrDynamicInfo.data.tone_mapping.knee_point_x;
+                key.nKneeY   = pMeta->sHdrDynamicInfo.data.tone_mapping.knee_point_y;
+                key.nAnchors = pMeta->sHdrDynamicInfo.data.tone_mapping.num_bezier_curve_anchors;
+                for (i = 0; i < (int)key.nAnchors; i++)
+                    key.anchors[i] = pMeta->sHdrDynamicInfo.data.tone_mapping.bezier_curve_anchors[i];
+            }
+        }
+
+        ret = ToneMap_Run(pHandle->pToneMap, (OMX_U16 *)bufferInfo.addr[0], (OMX_U16 *)bufferInfo.addr[1],
+                          stride, range.nWidth, range.nHeight, &key);
+        goto EXIT;
+    }
+
     if (!CHECK_HDR10(bufferInfo.eColorFormat, CA.sAspects.mRange, CA.sAspects.mPrimaries,
                     CA.sAspects.mTransfer, CA.sAspects.mMatrixCoeffs)) {
         /* it is not HDR10 */
@@ -296,8 +830,6 @@ OMX_ERRORTYPE Exynos_OSAL_ImgConv_Run(
 
     outConfig.color_format = P010_LINEAR;
 
-    max_display_luminance_cd_m2 = (int)((pExynosPort->HDRStaticInfo.nMaxDisplayLuminance / LUMINANCE_DIV_FACTOR) + 0.5);
-
     if (pHandle->Run != NULL) {
         pHandle->Run(&inConfig, &outConfig, NULL, max_display_luminance_cd_m2, pHandle->pUserData);
     } else {
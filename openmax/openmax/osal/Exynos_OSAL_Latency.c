@@ -0,0 +1,340 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OSAL_Latency.c
+ * @brief       per-stage latency histograms of buffer process
+ * @version     1.0.0
+ * @history
+ *   2019.05.13 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cutils/properties.h>
+
+#include "Exynos_OSAL_Memory.h"
+#include "Exynos_OSAL_Latency.h"
+
+#undef  EXYNOS_LOG_TAG
+#define EXYNOS_LOG_TAG    "EXYNOS_LATENCY"
+//#define EXYNOS_LOG_OFF
+#include "Exynos_OSAL_Log.h"
+
+/*
+ * buffers are matched by timestamp between the marks.
+ * the slot of a timestamp is written by the thread calling ETB and the others only
+ * check it, so it is enough to validate the timestamp before and after using a slot.
+ */
+#define LATENCY_SLOT_NUM        64                      /* power of 2 */
+#define LATENCY_SLOT_SHIFT      (64 - 6)
+#define LATENCY_INVALID_TS      ((OMX_TICKS)0x8000000000000000LL)
+
+/*
+ * log-linear buckets : 1us step under 16us, and 8 buckets for each power of 2 above.
+ * the error of a percentile is less than 12.5%.
+ */
+#define LATENCY_LINEAR_NUM      16
+#define LATENCY_SUB_BITS        3
+#define LATENCY_MAX_EXP         24                      /* 16s */
+#define LATENCY_BUCKET_NUM      (LATENCY_LINEAR_NUM + ((LATENCY_MAX_EXP - 4) << LATENCY_SUB_BITS))
+#define LATENCY_MAX_US          (10 * 1000000)          /* a longer one is a lost mark */
+
+typedef struct _LATENCY_SLOT
+{
+    OMX_TICKS timeStamp;
+    OMX_U64   markTime[LATENCY_MARK_MAX];
+} LATENCY_SLOT;
+
+typedef struct _LATENCY_HISTOGRAM
+{
+    OMX_U32 nBucket[LATENCY_BUCKET_NUM];
+    OMX_U32 nCount;
+    OMX_U32 nMax;
+    OMX_U64 nSum;
+} LATENCY_HISTOGRAM;
+
+typedef struct _EXYNOS_OMX_LATENCY
+{
+    OMX_PTR             pOwner;
+    OMX_U64             nDumpPeriod;    /* us, 0 : only at terminate */
+    OMX_U64             nLastDump;
+    LATENCY_SLOT        slot[LATENCY_SLOT_NUM];
+    LATENCY_HISTOGRAM   histogram[LATENCY_STAGE_MAX];
+} EXYNOS_OMX_LATENCY;
+
+static const char *stageName[LATENCY_STAGE_MAX] = {
+    "input",
+    "codec",
+    "output",
+    "total",
+    "csc",
+};
+
+static OMX_U32 Exynos_OSAL_LatencyBucket(OMX_U32 nTimeUs)
+{
+    OMX_U32 nExp = 0;
+
+    if (nTimeUs < LATENCY_LINEAR_NUM)
+        return nTimeUs;
+
+    nExp = 31 - __builtin_clz(nTimeUs);  /* >= 4 */
+    if (nExp >= LATENCY_MAX_EXP)
+        return LATENCY_BUCKET_NUM - 1;
+
+    return LATENCY_LINEAR_NUM +
+           ((nExp - 4) << LATENCY_SUB_BITS) +
+           ((nTimeUs >> (nExp - LATENCY_SUB_BITS)) & ((1 << LATENCY_SUB_BITS) - 1));
+}
+
+static OMX_U32 Exynos_OSAL_LatencyBucketLimit(OMX_U32 nBucket)
+{
+    OMX_U32 nExp = 0;
+    OMX_U32 nSub = 0;
+
+    /* the largest value in a bucket */
+    if (nBucket < LATENCY_LINEAR_NUM)
+        return nBucket;
+
+    nExp = 4 + ((nBucket - LATENCY_LINEAR_NUM) >> LATENCY_SUB_BITS);
+    nSub = (nBucket - LATENCY_LINEAR_NUM) & ((1 << LATENCY_SUB_BITS) - 1);
+
+    return (((1 << LATENCY_SUB_BITS) + nSub + 1) << (nExp - LATENCY_SUB_BITS)) - 1;
+}
+
+static OMX_U32 Exynos_OSAL_LatencyPercentile(
+    OMX_U32 nBucket[LATENCY_BUCKET_NUM],
+    OMX_U32 nCount,
+    OMX_U32 nPercent)
+{
+    OMX_U64 nTarget = (((OMX_U64)nCount * nPercent) + 99) / 100;
+    OMX_U64 nSum    = 0;
+    OMX_U32 i;
+
+    for (i = 0; i < LATENCY_BUCKET_NUM; i++) {
+        nSum += nBucket[i];
+        if ((nSum >= nTarget) &&
+            (nSum > 0))
+            return Exynos_OSAL_LatencyBucketLimit(i);
+    }
+
+    return 0;
+}
+
+OMX_U64 Exynos_OSAL_LatencyGetTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((OMX_U64)now.tv_sec * 1000000) + ((OMX_U64)now.tv_nsec / 1000);
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyCreate(OMX_HANDLETYPE *phLatency, OMX_PTR pOwner)
+{
+    OMX_ERRORTYPE        ret        = OMX_ErrorNone;
+    EXYNOS_OMX_LATENCY  *pLatency   = NULL;
+    int                  nPeriod    = 0;
+    int                  i;
+
+    if (phLatency == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    *phLatency = NULL;
+
+    /* disabled : every hook is just a NULL check */
+    nPeriod = property_get_int32(LATENCY_PROPERTY, 0);
+    if (nPeriod <= 0)
+        goto EXIT;
+
+    pLatency = (EXYNOS_OMX_LATENCY *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_LATENCY));
+    if (pLatency == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "[%p][%s] Failed to Malloc", pOwner, __FUNCTION__);
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    Exynos_OSAL_Memset(pLatency, 0, sizeof(EXYNOS_OMX_LATENCY));
+
+    pLatency->pOwner      = pOwner;
+    pLatency->nDumpPeriod = (nPeriod > 1)? ((OMX_U64)nPeriod * 1000000):0;
+    pLatency->nLastDump   = Exynos_OSAL_LatencyGetTime();
+
+    for (i = 0; i < LATENCY_SLOT_NUM; i++)
+        pLatency->slot[i].timeStamp = LATENCY_INVALID_TS;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_INFO, "[%p][%s] latency measurement is enabled, dump period(%d s)",
+                                        pOwner, __FUNCTION__, (nPeriod > 1)? nPeriod:0);
+
+    *phLatency = (OMX_HANDLETYPE)pLatency;
+
+EXIT:
+    return ret;
+}
+
+void Exynos_OSAL_LatencyTerminate(OMX_HANDLETYPE hLatency)
+{
+    EXYNOS_OMX_LATENCY *pLatency = (EXYNOS_OMX_LATENCY *)hLatency;
+
+    if (pLatency == NULL)
+        return;
+
+    Exynos_OSAL_LatencyDump(hLatency);
+    Exynos_OSAL_Free(pLatency);
+
+    return;
+}
+
+void Exynos_OSAL_LatencyRecord(
+    OMX_HANDLETYPE      hLatency,
+    LATENCY_STAGE_TYPE  eStage,
+    OMX_U32             nTimeUs)
+{
+    EXYNOS_OMX_LATENCY *pLatency   = (EXYNOS_OMX_LATENCY *)hLatency;
+    LATENCY_HISTOGRAM  *pHistogram = NULL;
+    OMX_U32             nMax       = 0;
+
+    if ((pLatency == NULL) ||
+        (eStage >= LATENCY_STAGE_MAX) ||
+        (nTimeUs > LATENCY_MAX_US))
+        return;
+
+    pHistogram = &pLatency->histogram[eStage];
+
+    __atomic_fetch_add(&pHistogram->nBucket[Exynos_OSAL_LatencyBucket(nTimeUs)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&pHistogram->nSum, (OMX_U64)nTimeUs, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&pHistogram->nCount, 1, __ATOMIC_RELAXED);
+
+    nMax = __atomic_load_n(&pHistogram->nMax, __ATOMIC_RELAXED);
+    while ((nTimeUs > nMax) &&
+           (!__atomic_compare_exchange_n(&pHistogram->nMax, &nMax, nTimeUs, OMX_TRUE,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED)));
+
+    return;
+}
+
+void Exynos_OSAL_LatencyMark(
+    OMX_HANDLETYPE      hLatency,
+    OMX_TICKS           timeStamp,
+    LATENCY_MARK_TYPE   eMark)
+{
+    EXYNOS_OMX_LATENCY *pLatency = (EXYNOS_OMX_LATENCY *)hLatency;
+    LATENCY_SLOT       *pSlot    = NULL;
+    OMX_U64             nNow     = 0;
+    OMX_U64             nPrev    = 0;
+    OMX_U64             nETB     = 0;
+    OMX_U64             nLast    = 0;
+    int                 i;
+
+    if ((pLatency == NULL) ||
+        (eMark >= LATENCY_MARK_MAX) ||
+        (timeStamp == LATENCY_INVALID_TS))
+        return;
+
+    nNow  = Exynos_OSAL_LatencyGetTime();
+    pSlot = &pLatency->slot[((OMX_U64)timeStamp * 0x9E3779B97F4A7C15ULL) >> LATENCY_SLOT_SHIFT];
+
+    if (eMark == LATENCY_MARK_ETB) {
+        /* the previous owner of this slot is lost */
+        __atomic_store_n(&pSlot->timeStamp, LATENCY_INVALID_TS, __ATOMIC_RELAXED);
+        for (i = 0; i < LATENCY_MARK_MAX; i++)
+            __atomic_store_n(&pSlot->markTime[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&pSlot->markTime[LATENCY_MARK_ETB], nNow, __ATOMIC_RELAXED);
+        __atomic_store_n(&pSlot->timeStamp, timeStamp, __ATOMIC_RELEASE);
+        return;
+    }
+
+    if (__atomic_load_n(&pSlot->timeStamp, __ATOMIC_ACQUIRE) != timeStamp)
+        return;
+
+    /* only the first one counts, ex) a frame split into several inputs */
+    if (__atomic_exchange_n(&pSlot->markTime[eMark], nNow, __ATOMIC_RELAXED) != 0)
+        return;
+
+    nPrev = __atomic_load_n(&pSlot->markTime[eMark - 1], __ATOMIC_RELAXED);
+    nETB  = __atomic_load_n(&pSlot->markTime[LATENCY_MARK_ETB], __ATOMIC_RELAXED);
+
+    /* re-used by another buffer in the meantime */
+    if (__atomic_load_n(&pSlot->timeStamp, __ATOMIC_ACQUIRE) != timeStamp)
+        return;
+
+    if ((nPrev != 0) &&
+        (nNow >= nPrev))
+        Exynos_OSAL_LatencyRecord(hLatency, (LATENCY_STAGE_TYPE)(eMark - 1), (OMX_U32)(nNow - nPrev));
+
+    if (eMark != LATENCY_MARK_FBD)
+        return;
+
+    if (nNow >= nETB)
+        Exynos_OSAL_LatencyRecord(hLatency, LATENCY_STAGE_TOTAL, (OMX_U32)(nNow - nETB));
+
+    __atomic_compare_exchange_n(&pSlot->timeStamp, &timeStamp, LATENCY_INVALID_TS, OMX_FALSE,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+
+    if (pLatency->nDumpPeriod == 0)
+        return;
+
+    nLast = __atomic_load_n(&pLatency->nLastDump, __ATOMIC_RELAXED);
+    if (((nNow - nLast) >= pLatency->nDumpPeriod) &&
+        (__atomic_compare_exchange_n(&pLatency->nLastDump, &nLast, nNow, OMX_FALSE,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)))
+        Exynos_OSAL_LatencyDump(hLatency);
+
+    return;
+}
+
+void Exynos_OSAL_LatencyDump(OMX_HANDLETYPE hLatency)
+{
+    EXYNOS_OMX_LATENCY *pLatency = (EXYNOS_OMX_LATENCY *)hLatency;
+    OMX_U32             nBucket[LATENCY_BUCKET_NUM];
+    OMX_U32             nCount   = 0;
+    OMX_U64             nSum     = 0;
+    int                 i, j;
+
+    if (pLatency == NULL)
+        return;
+
+    for (i = 0; i < LATENCY_STAGE_MAX; i++) {
+        LATENCY_HISTOGRAM *pHistogram = &pLatency->histogram[i];
+
+        /* a snapshot, the histogram may go on while dumping */
+        nCount = 0;
+        for (j = 0; j < LATENCY_BUCKET_NUM; j++) {
+            nBucket[j] = __atomic_load_n(&pHistogram->nBucket[j], __ATOMIC_RELAXED);
+            nCount += nBucket[j];
+        }
+
+        if (nCount == 0)
+            continue;
+
+        nSum = __atomic_load_n(&pHistogram->nSum, __ATOMIC_RELAXED);
+
+        Exynos_OSAL_Log(EXYNOS_LOG_INFO, "[%p][%s] %-6s : count(%u), avg(%u us), p50(%u us), p90(%u us), p99(%u us), max(%u us)",
+                                            pLatency->pOwner, __FUNCTION__, stageName[i], nCount,
+                                            (OMX_U32)(nSum / nCount),
+                                            Exynos_OSAL_LatencyPercentile(nBucket, nCount, 50),
+                                            Exynos_OSAL_LatencyPercentile(nBucket, nCount, 90),
+                                            Exynos_OSAL_LatencyPercentile(nBucket, nCount, 99),
+                                            __atomic_load_n(&pHistogram->nMax, __ATOMIC_RELAXED));
+    }
+
+    return;
+}
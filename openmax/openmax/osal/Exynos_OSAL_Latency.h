@@ -0,0 +1,72 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file    Exynos_OSAL_Latency.h
+ * @brief   per-stage latency histograms of buffer process
+ * @version    1.0.0
+ * @history
+ *   2019.05.13 : Create
+ */
+
+#ifndef EXYNOS_OSAL_LATENCY
+#define EXYNOS_OSAL_LATENCY
+
+#include "OMX_Types.h"
+#include "OMX_Core.h"
+
+/*
+ * "setprop debug.omx.latency 1" enables the measurement of components created after that.
+ * the histograms are printed when a component is destroyed.
+ * "setprop debug.omx.latency N" (N > 1) prints them every N seconds as well.
+ */
+#define LATENCY_PROPERTY    "debug.omx.latency"
+
+typedef enum _LATENCY_MARK_TYPE {
+    LATENCY_MARK_ETB = 0,       /* EmptyThisBuffer */
+    LATENCY_MARK_CODEC_IN,      /* queued to MFC */
+    LATENCY_MARK_CODEC_OUT,     /* dequeued from MFC */
+    LATENCY_MARK_FBD,           /* FillBufferDone */
+    LATENCY_MARK_MAX,
+} LATENCY_MARK_TYPE;
+
+typedef enum _LATENCY_STAGE_TYPE {
+    LATENCY_STAGE_INPUT = 0,    /* ETB -> MFC in : waiting at input port and CSC of encoder */
+    LATENCY_STAGE_CODEC,        /* MFC in -> MFC out : including DPB delay of decoder */
+    LATENCY_STAGE_OUTPUT,       /* MFC out -> FBD : CSC of decoder and waiting at output port */
+    LATENCY_STAGE_TOTAL,        /* ETB -> FBD */
+    LATENCY_STAGE_CSC,          /* color conversion itself */
+    LATENCY_STAGE_MAX,
+} LATENCY_STAGE_TYPE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyCreate(OMX_HANDLETYPE *phLatency, OMX_PTR pOwner);
+void Exynos_OSAL_LatencyTerminate(OMX_HANDLETYPE hLatency);
+
+OMX_U64 Exynos_OSAL_LatencyGetTime(void);
+void Exynos_OSAL_LatencyMark(OMX_HANDLETYPE hLatency, OMX_TICKS timeStamp, LATENCY_MARK_TYPE eMark);
+void Exynos_OSAL_LatencyRecord(OMX_HANDLETYPE hLatency, LATENCY_STAGE_TYPE eStage, OMX_U32 nTimeUs);
+void Exynos_OSAL_LatencyDump(OMX_HANDLETYPE hLatency);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -62,6 +62,12 @@ ifeq ($(BOARD_USE_SINGLE_PLANE_IN_DRM), true)
 LOCAL_CFLAGS += -DUSE_SINGLE_PALNE_SUPPORT
 endif
 
+# emulated MFC for pipeline benchmarks, enabled at runtime by EXYNOS_VIDEO_FAKE_MFC
+ifeq ($(BOARD_USE_FAKE_MFC), true)
+LOCAL_SRC_FILES += osal/ExynosVideo_OSAL_Fake.c
+LOCAL_CFLAGS += -DUSE_FAKE_MFC
+endif
+
 LOCAL_MODULE := libExynosVideoApi
 LOCAL_MODULE_TAGS := optional
 LOCAL_PRELINK_MODULE := false
@@ -1482,6 +1482,8 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Inbuf(
         }
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
     return ret;
 
 EXIT:
@@ -1502,6 +1504,8 @@ EXIT:
         free(pCtx->videoCtx.pInbuf);
         pCtx->videoCtx.pInbuf  = NULL;
         pCtx->videoCtx.nInbufs = 0;
+
+        Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
     }
 
     return ret;
@@ -1614,6 +1618,8 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Outbuf(
         /* Initialize initial values */
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
     return ret;
 
 EXIT:
@@ -1635,6 +1641,8 @@ EXIT:
 
         free(pCtx->videoCtx.pOutbuf);
         pCtx->videoCtx.pOutbuf = NULL;
+
+        Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
     }
 
     return ret;
@@ -1724,6 +1732,8 @@ static ExynosVideoErrorType MFC_Decoder_Stop_Inbuf(void *pHandle)
     for (i = 0; i <  pCtx->videoCtx.nInbufs; i++)
         pCtx->videoCtx.pInbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -1759,6 +1769,8 @@ static ExynosVideoErrorType MFC_Decoder_Stop_Outbuf(void *pHandle)
         pCtx->videoCtx.pOutbuf[i].nIndexUseCnt = 0;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -1834,6 +1846,7 @@ static ExynosVideoErrorType MFC_Decoder_Register_Inbuf(
             }
 
             pCtx->videoCtx.pInbuf[i].bRegistered = VIDEO_TRUE;
+            Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, i);
             break;
         }
     }
@@ -1883,6 +1896,7 @@ static ExynosVideoErrorType MFC_Decoder_Register_Outbuf(
             }
 
             pCtx->videoCtx.pOutbuf[i].bRegistered = VIDEO_TRUE;
+            Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, i);
             break;
         }
     }
@@ -1917,6 +1931,8 @@ static ExynosVideoErrorType MFC_Decoder_Clear_RegisteredBuffer_Inbuf(void *pHand
         pCtx->videoCtx.pInbuf[i].bRegistered = VIDEO_FALSE;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -1949,6 +1965,8 @@ static ExynosVideoErrorType MFC_Decoder_Clear_RegisteredBuffer_Outbuf(void *pHan
         pCtx->videoCtx.pOutbuf[i].bRegistered = VIDEO_FALSE;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -1960,7 +1978,8 @@ static int MFC_Decoder_Find_Inbuf(
     void          *pHandle,
     unsigned char *pBuffer)
 {
-    CodecOSALVideoContext *pCtx = (CodecOSALVideoContext *)pHandle;
+    CodecOSALVideoContext *pCtx   = (CodecOSALVideoContext *)pHandle;
+    CodecOSAL_BufIndex    *pIndex = NULL;
     int nIndex = -1, i;
 
     if (pCtx == NULL) {
@@ -1968,6 +1987,25 @@ static int MFC_Decoder_Find_Inbuf(
         goto EXIT;
     }
 
+    pIndex = &pCtx->osalCtx.inbufIndex;
+    if (Codec_OSAL_BufIndex_IsEnabled(pIndex)) {
+        if (pBuffer == NULL) {
+            nIndex = Codec_OSAL_BufIndex_FindFree(pIndex, VIDEO_FALSE);
+            goto EXIT;
+        }
+
+        i = Codec_OSAL_BufIndex_FindByAddr(pIndex, pBuffer);
+        if (i < 0)
+            goto EXIT;
+
+        if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
+            nIndex = i;
+            goto EXIT;
+        }
+
+        /* same address is also kept by another slot, fall back to scanning */
+    }
+
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++) {
         if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -1989,7 +2027,8 @@ static int MFC_Decoder_Find_Outbuf(
     void          *pHandle,
     unsigned char *pBuffer)
 {
-    CodecOSALVideoContext *pCtx = (CodecOSALVideoContext *)pHandle;
+    CodecOSALVideoContext *pCtx   = (CodecOSALVideoContext *)pHandle;
+    CodecOSAL_BufIndex    *pIndex = NULL;
     int nIndex = -1, i;
 
     if (pCtx == NULL) {
@@ -1997,6 +2036,25 @@ static int MFC_Decoder_Find_Outbuf(
         goto EXIT;
     }
 
+    pIndex = &pCtx->osalCtx.outbufIndex;
+    if (Codec_OSAL_BufIndex_IsEnabled(pIndex)) {
+        if (pBuffer == NULL) {
+            nIndex = Codec_OSAL_BufIndex_FindFree(pIndex, VIDEO_FALSE);
+            goto EXIT;
+        }
+
+        i = Codec_OSAL_BufIndex_FindByAddr(pIndex, pBuffer);
+        if (i < 0)
+            goto EXIT;
+
+        if (pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) {
+            nIndex = i;
+            goto EXIT;
+        }
+
+        /* same address is also kept by another slot, fall back to scanning */
+    }
+
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++) {
         if (pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -2104,6 +2162,7 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Inbuf(
 
     pCtx->videoCtx.pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (Codec_OSAL_EnqueueBuf(pCtx, &buf) != 0) {
@@ -2111,6 +2170,7 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pInbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pInbuf[buf.index].bQueued  = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2193,12 +2253,14 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Outbuf(
 
     pCtx->videoCtx.pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (Codec_OSAL_EnqueueBuf(pCtx, &buf) != 0) {
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pOutbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
         Codec_OSAL_GetControl(pCtx, CODEC_OSAL_CID_DEC_CHECK_STATE, &state);
         if (state == 1) {
             /* The case of Resolution is changed */
@@ -2260,6 +2322,7 @@ static ExynosVideoBuffer *MFC_Decoder_Dequeue_Inbuf(void *pHandle)
     }
 
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
 
     if (pCtx->videoCtx.bStreamonInbuf == VIDEO_FALSE)
         pInbuf = NULL;
@@ -2414,6 +2477,7 @@ static ExynosVideoBuffer *MFC_Decoder_Dequeue_Outbuf(void *pHandle)
     }
 
     pOutbuf->bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
 
     pthread_mutex_unlock(pMutex);
 
@@ -2436,6 +2500,8 @@ static ExynosVideoErrorType MFC_Decoder_Clear_Queued_Inbuf(void *pHandle)
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++)
         pCtx->videoCtx.pInbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2455,6 +2521,8 @@ static ExynosVideoErrorType MFC_Decoder_Clear_Queued_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++)
         pCtx->videoCtx.pOutbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2499,6 +2567,8 @@ static ExynosVideoErrorType MFC_Decoder_Cleanup_Buffer_Inbuf(void *pHandle)
         pCtx->videoCtx.pInbuf = NULL;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2543,6 +2613,8 @@ static ExynosVideoErrorType MFC_Decoder_Cleanup_Buffer_Outbuf(void *pHandle)
         pCtx->videoCtx.pOutbuf = NULL;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2590,6 +2662,11 @@ static int MFC_Decoder_FindEmpty_Inbuf(void *pHandle)
         goto EXIT;
     }
 
+    if (Codec_OSAL_BufIndex_IsEnabled(&pCtx->osalCtx.inbufIndex)) {
+        nIndex = Codec_OSAL_BufIndex_FindFree(&pCtx->osalCtx.inbufIndex, VIDEO_FALSE);
+        goto EXIT;
+    }
+
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++) {
         if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
             nIndex = i;
@@ -2694,6 +2771,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Inbuf(
 
     pCtx->videoCtx.pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (Codec_OSAL_EnqueueBuf(pCtx, &buf) != 0) {
@@ -2701,6 +2779,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pInbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pInbuf[buf.index].bQueued  = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2754,6 +2833,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionDequeue_Inbuf(
     memset(&pCtx->videoCtx.pInbuf[buf.index], 0, sizeof(ExynosVideoBuffer));
 
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2773,6 +2853,11 @@ static int MFC_Decoder_FindEmpty_Outbuf(void *pHandle)
         goto EXIT;
     }
 
+    if (Codec_OSAL_BufIndex_IsEnabled(&pCtx->osalCtx.outbufIndex)) {
+        nIndex = Codec_OSAL_BufIndex_FindFree(&pCtx->osalCtx.outbufIndex, VIDEO_TRUE);
+        goto EXIT;
+    }
+
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++) {
         if ((pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) &&
             (pCtx->videoCtx.pOutbuf[i].bSlotUsed == VIDEO_FALSE)) {
@@ -2793,20 +2878,33 @@ void MFC_Decoder_BufferIndexFree_Outbuf(
     PrivateDataShareBuffer *pPDSB,
     int                     nIndex)
 {
-    CodecOSALVideoContext *pCtx = (CodecOSALVideoContext *)pHandle;
-    int i, j;
+    CodecOSALVideoContext *pCtx   = (CodecOSALVideoContext *)pHandle;
+    CodecOSAL_BufIndex    *pIndex = &pCtx->osalCtx.outbufIndex;
+    int i, j, nStart, nEnd;
 
     ALOGV("De-queue buf.index:%d, fd:%lu", nIndex, pCtx->videoCtx.pOutbuf[nIndex].planes[0].fd);
 
     if (pCtx->videoCtx.pOutbuf[nIndex].nIndexUseCnt == 0)
         pCtx->videoCtx.pOutbuf[nIndex].bSlotUsed = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(pIndex, pCtx->videoCtx.pOutbuf, nIndex);
 
     for (i = 0; i < VIDEO_BUFFER_MAX_NUM; i++) {
         if (pPDSB->dpbFD[i].fd <= 0)
             break;
 
         ALOGV("pPDSB->dpbFD[%d].fd:%d", i, pPDSB->dpbFD[i].fd);
-        for (j = 0; j < pCtx->videoCtx.nOutbufs; j++) {
+
+        nStart = 0;
+        nEnd   = pCtx->videoCtx.nOutbufs;
+        if (Codec_OSAL_BufIndex_IsEnabled(pIndex)) {
+            nStart = Codec_OSAL_BufIndex_FindByFd(pIndex, (unsigned long)pPDSB->dpbFD[i].fd);
+            if (nStart < 0)
+                continue;
+
+            nEnd = nStart + 1;
+        }
+
+        for (j = nStart; j < nEnd; j++) {
             if ((unsigned long)pPDSB->dpbFD[i].fd == pCtx->videoCtx.pOutbuf[j].planes[0].fd) {
                 if (pCtx->videoCtx.pOutbuf[j].bQueued == VIDEO_FALSE) {
                     if (pCtx->videoCtx.pOutbuf[j].nIndexUseCnt > 0)
@@ -2827,6 +2925,7 @@ void MFC_Decoder_BufferIndexFree_Outbuf(
                     (pCtx->videoCtx.pOutbuf[j].bQueued == VIDEO_FALSE)) {
                     pCtx->videoCtx.pOutbuf[j].bSlotUsed = VIDEO_FALSE;
                 }
+                Codec_OSAL_BufIndex_Update(pIndex, pCtx->videoCtx.pOutbuf, j);
             }
         }
     }
@@ -2925,6 +3024,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Outbuf(
         pCtx->videoCtx.pOutbuf[buf.index].bSlotUsed = VIDEO_TRUE;
         pCtx->videoCtx.pOutbuf[buf.index].nIndexUseCnt++;
     }
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
 
     pthread_mutex_unlock(pMutex);
 
@@ -2936,6 +3036,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Outbuf(
 
         if (pCtx->videoCtx.pOutbuf[buf.index].nIndexUseCnt == 0)
             pCtx->videoCtx.pOutbuf[buf.index].bSlotUsed = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
 
         Codec_OSAL_GetControl(pCtx, CODEC_OSAL_CID_DEC_CHECK_STATE, &state);
         if (state == 1) {
@@ -3112,6 +3213,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionDequeue_Outbuf(
         MFC_Decoder_BufferIndexFree_Outbuf(pHandle, pPDSB, buf.index);
 
     pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
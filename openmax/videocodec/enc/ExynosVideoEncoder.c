@@ -1816,6 +1816,8 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Inbuf(
         }
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
     return ret;
 
 EXIT:
@@ -1837,6 +1839,8 @@ EXIT:
 
         free(pCtx->videoCtx.pInbuf);
         pCtx->videoCtx.pInbuf = NULL;
+
+        Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
     }
 
     return ret;
@@ -1938,6 +1942,8 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Outbuf(
         }
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
     return ret;
 
 EXIT:
@@ -1959,6 +1965,8 @@ EXIT:
 
         free(pCtx->videoCtx.pOutbuf);
         pCtx->videoCtx.pOutbuf = NULL;
+
+        Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
     }
 
     return ret;
@@ -2048,6 +2056,8 @@ static ExynosVideoErrorType MFC_Encoder_Stop_Inbuf(void *pHandle)
     for (i = 0; i <  pCtx->videoCtx.nInbufs; i++)
         pCtx->videoCtx.pInbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2080,6 +2090,8 @@ static ExynosVideoErrorType MFC_Encoder_Stop_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++)
         pCtx->videoCtx.pOutbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2200,6 +2212,7 @@ static ExynosVideoErrorType MFC_Encoder_Register_Inbuf(
             }
 
             pCtx->videoCtx.pInbuf[i].bRegistered = VIDEO_TRUE;
+            Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, i);
             break;
         }
     }
@@ -2242,6 +2255,7 @@ static ExynosVideoErrorType MFC_Encoder_Register_Outbuf(
             }
 
             pCtx->videoCtx.pOutbuf[i].bRegistered = VIDEO_TRUE;
+            Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, i);
             break;
         }
     }
@@ -2276,6 +2290,8 @@ static ExynosVideoErrorType MFC_Encoder_Clear_RegisteredBuffer_Inbuf(void *pHand
         pCtx->videoCtx.pInbuf[i].bRegistered = VIDEO_FALSE;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2301,6 +2317,8 @@ static ExynosVideoErrorType MFC_Encoder_Clear_RegisteredBuffer_Outbuf(void *pHan
         pCtx->videoCtx.pOutbuf[i].bRegistered = VIDEO_FALSE;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2312,7 +2330,8 @@ static int MFC_Encoder_Find_Inbuf(
     void          *pHandle,
     unsigned char *pBuffer)
 {
-    CodecOSALVideoContext *pCtx = (CodecOSALVideoContext *)pHandle;
+    CodecOSALVideoContext *pCtx   = (CodecOSALVideoContext *)pHandle;
+    CodecOSAL_BufIndex    *pIndex = NULL;
     int nIndex = -1, i;
 
     if (pCtx == NULL) {
@@ -2320,6 +2339,25 @@ static int MFC_Encoder_Find_Inbuf(
         goto EXIT;
     }
 
+    pIndex = &pCtx->osalCtx.inbufIndex;
+    if (Codec_OSAL_BufIndex_IsEnabled(pIndex)) {
+        if (pBuffer == NULL) {
+            nIndex = Codec_OSAL_BufIndex_FindFree(pIndex, VIDEO_FALSE);
+            goto EXIT;
+        }
+
+        i = Codec_OSAL_BufIndex_FindByAddr(pIndex, pBuffer);
+        if (i < 0)
+            goto EXIT;
+
+        if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
+            nIndex = i;
+            goto EXIT;
+        }
+
+        /* same address is also kept by another slot, fall back to scanning */
+    }
+
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++) {
         if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -2341,7 +2379,8 @@ static int MFC_Encoder_Find_Outbuf(
     void          *pHandle,
     unsigned char *pBuffer)
 {
-    CodecOSALVideoContext *pCtx = (CodecOSALVideoContext *)pHandle;
+    CodecOSALVideoContext *pCtx   = (CodecOSALVideoContext *)pHandle;
+    CodecOSAL_BufIndex    *pIndex = NULL;
     int nIndex = -1, i;
 
     if (pCtx == NULL) {
@@ -2349,6 +2388,25 @@ static int MFC_Encoder_Find_Outbuf(
         goto EXIT;
     }
 
+    pIndex = &pCtx->osalCtx.outbufIndex;
+    if (Codec_OSAL_BufIndex_IsEnabled(pIndex)) {
+        if (pBuffer == NULL) {
+            nIndex = Codec_OSAL_BufIndex_FindFree(pIndex, VIDEO_FALSE);
+            goto EXIT;
+        }
+
+        i = Codec_OSAL_BufIndex_FindByAddr(pIndex, pBuffer);
+        if (i < 0)
+            goto EXIT;
+
+        if (pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) {
+            nIndex = i;
+            goto EXIT;
+        }
+
+        /* same address is also kept by another slot, fall back to scanning */
+    }
+
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++) {
         if (pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -2453,6 +2511,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Inbuf(
 
     pCtx->videoCtx.pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
 
     if ((pCtx->videoCtx.instInfo.eCodecType == VIDEO_CODING_VP8) ||
         (pCtx->videoCtx.instInfo.eCodecType == VIDEO_CODING_VP9) ||
@@ -2501,6 +2560,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pInbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2582,6 +2642,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Outbuf(
 
     pCtx->videoCtx.pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (Codec_OSAL_EnqueueBuf(pCtx, &buf) != 0) {
@@ -2589,6 +2650,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Outbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pOutbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2673,6 +2735,7 @@ static ExynosVideoBuffer *MFC_Encoder_Dequeue_Inbuf(void *pHandle)
     }
 
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2743,6 +2806,7 @@ static ExynosVideoBuffer *MFC_Encoder_Dequeue_Outbuf(void *pHandle)
     }
 
     pOutbuf->bQueued    = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2764,6 +2828,8 @@ static ExynosVideoErrorType MFC_Encoder_Clear_Queued_Inbuf(void *pHandle)
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++)
         pCtx->videoCtx.pInbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2783,6 +2849,8 @@ static ExynosVideoErrorType MFC_Encoder_Clear_Queued_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++)
         pCtx->videoCtx.pOutbuf[i].bQueued = VIDEO_FALSE;
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2827,6 +2895,8 @@ static ExynosVideoErrorType MFC_Encoder_Cleanup_Buffer_Inbuf(void *pHandle)
         pCtx->videoCtx.pInbuf = NULL;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, pCtx->videoCtx.nInbufs);
+
 EXIT:
     return ret;
 }
@@ -2871,6 +2941,8 @@ static ExynosVideoErrorType MFC_Encoder_Cleanup_Buffer_Outbuf(void *pHandle)
         pCtx->videoCtx.pOutbuf = NULL;
     }
 
+    Codec_OSAL_BufIndex_Rebuild(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, pCtx->videoCtx.nOutbufs);
+
 EXIT:
     return ret;
 }
@@ -2888,6 +2960,11 @@ static int MFC_Encoder_FindEmpty_Inbuf(void *pHandle)
         goto EXIT;
     }
 
+    if (Codec_OSAL_BufIndex_IsEnabled(&pCtx->osalCtx.inbufIndex)) {
+        nIndex = Codec_OSAL_BufIndex_FindFree(&pCtx->osalCtx.inbufIndex, VIDEO_FALSE);
+        goto EXIT;
+    }
+
     for (i = 0; i < pCtx->videoCtx.nInbufs; i++) {
         if (pCtx->videoCtx.pInbuf[i].bQueued == VIDEO_FALSE) {
             nIndex = i;
@@ -2912,6 +2989,11 @@ static int MFC_Encoder_FindEmpty_Outbuf(void *pHandle)
         goto EXIT;
     }
 
+    if (Codec_OSAL_BufIndex_IsEnabled(&pCtx->osalCtx.outbufIndex)) {
+        nIndex = Codec_OSAL_BufIndex_FindFree(&pCtx->osalCtx.outbufIndex, VIDEO_FALSE);
+        goto EXIT;
+    }
+
     for (i = 0; i < pCtx->videoCtx.nOutbufs; i++) {
         if (pCtx->videoCtx.pOutbuf[i].bQueued == VIDEO_FALSE) {
             nIndex = i;
@@ -3014,6 +3096,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Inbuf(
 
     pCtx->videoCtx.pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
 
     if ((pCtx->videoCtx.instInfo.eCodecType == VIDEO_CODING_VP8) ||
         (pCtx->videoCtx.instInfo.eCodecType == VIDEO_CODING_VP9) ||
@@ -3068,6 +3151,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pInbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -3123,6 +3207,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionDequeue_Inbuf(
         memset(&pCtx->videoCtx.pInbuf[buf.index], 0, sizeof(ExynosVideoBuffer));
 
         pCtx->videoCtx.pInbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.inbufIndex, pCtx->videoCtx.pInbuf, buf.index);
 
         pthread_mutex_unlock(pMutex);
     } else {
@@ -3209,6 +3294,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Outbuf(
 
     pCtx->videoCtx.pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (Codec_OSAL_EnqueueBuf(pCtx, &buf) != 0) {
@@ -3216,6 +3302,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Outbuf(
         pthread_mutex_lock(pMutex);
         pCtx->videoCtx.pOutbuf[buf.index].pPrivate = NULL;
         pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -3292,6 +3379,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionDequeue_Outbuf(
     memset(pOutbuf, 0, sizeof(ExynosVideoBuffer));
 
     pCtx->videoCtx.pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+    Codec_OSAL_BufIndex_Update(&pCtx->osalCtx.outbufIndex, pCtx->videoCtx.pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
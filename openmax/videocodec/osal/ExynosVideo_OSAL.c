@@ -31,6 +31,9 @@
 #include "ExynosVideo_OSAL.h"
 #include "ExynosVideo_OSAL_Dec.h"
 #include "ExynosVideo_OSAL_Enc.h"
+#ifdef USE_FAKE_MFC
+#include "ExynosVideo_OSAL_Fake.h"
+#endif
 
 #include "ExynosVideoDec.h"
 #include "ExynosVideoEnc.h"
@@ -299,6 +302,36 @@ unsigned int Codec_OSAL_ColorFormatToPixelFormat(
     return nPixelFormat;
 }
 
+static int V4L2_Open(const char *sDevName, int nFlag)
+{
+    return exynos_v4l2_open_devname(sDevName, nFlag, 0);
+}
+
+static const CodecOSAL_DevOps defV4L2DevOps = {
+    .Open           = V4L2_Open,
+    .Close          = exynos_v4l2_close,
+    .QueryCap       = exynos_v4l2_querycap,
+    .GetFormat      = exynos_v4l2_g_fmt,
+    .SetFormat      = exynos_v4l2_s_fmt,
+    .RequestBuf     = exynos_v4l2_reqbufs,
+    .QueryBuf       = exynos_v4l2_querybuf,
+    .EnqueueBuf     = exynos_v4l2_qbuf,
+    .DequeueBuf     = exynos_v4l2_dqbuf,
+    .StreamOn       = exynos_v4l2_streamon,
+    .StreamOff      = exynos_v4l2_streamoff,
+    .GetCrop        = exynos_v4l2_g_crop,
+    .GetControl     = exynos_v4l2_g_ctrl,
+    .SetControl     = exynos_v4l2_s_ctrl,
+    .GetExtControls = exynos_v4l2_g_ext_ctrl,
+    .SetExtControls = exynos_v4l2_s_ext_ctrl,
+};
+
+/* contexts that never went through Codec_OSAL_DevOpen() talk to V4L2 */
+static inline const CodecOSAL_DevOps *Codec_OSAL_GetDevOps(CodecOSALVideoContext *pCtx)
+{
+    return (pCtx->osalCtx.pDevOps != NULL)? pCtx->osalCtx.pDevOps:&defV4L2DevOps;
+}
+
 int Codec_OSAL_DevOpen(
     const char              *sDevName,
     int                      nFlag,
@@ -306,7 +339,14 @@ int Codec_OSAL_DevOpen(
 {
     if ((sDevName != NULL) &&
         (pCtx != NULL)) {
-        pCtx->videoCtx.hDevice = exynos_v4l2_open_devname(sDevName, nFlag, 0);
+#ifdef USE_FAKE_MFC
+        if (Codec_OSAL_Fake_IsEnabled() == VIDEO_TRUE)
+            pCtx->osalCtx.pDevOps = Codec_OSAL_Fake_GetDevOps();
+        else
+#endif
+            pCtx->osalCtx.pDevOps = &defV4L2DevOps;
+
+        pCtx->videoCtx.hDevice = pCtx->osalCtx.pDevOps->Open(sDevName, nFlag);
         return pCtx->videoCtx.hDevice;
     }
 
@@ -317,7 +357,7 @@ void Codec_OSAL_DevClose(CodecOSALVideoContext *pCtx)
 {
     if ((pCtx != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        exynos_v4l2_close(pCtx->videoCtx.hDevice);
+        Codec_OSAL_GetDevOps(pCtx)->Close(pCtx->videoCtx.hDevice);
     }
 
     return;
@@ -329,7 +369,7 @@ int Codec_OSAL_QueryCap(CodecOSALVideoContext *pCtx)
 
     if ((pCtx != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        if (exynos_v4l2_querycap(pCtx->videoCtx.hDevice, needCaps))
+        if (Codec_OSAL_GetDevOps(pCtx)->QueryCap(pCtx->videoCtx.hDevice, needCaps))
             return 0;
     }
 
@@ -380,7 +420,7 @@ int Codec_OSAL_EnqueueBuf(
 #endif
         memcpy(&(buf.timestamp), &(pBuf->timestamp), sizeof(struct timeval));
 
-        return exynos_v4l2_qbuf(pCtx->videoCtx.hDevice, &buf);
+        return Codec_OSAL_GetDevOps(pCtx)->EnqueueBuf(pCtx->videoCtx.hDevice, &buf);
     }
 
     return -1;
@@ -405,7 +445,7 @@ int Codec_OSAL_DequeueBuf(
         buf.length      = pBuf->nPlane;
         buf.memory      = pBuf->memory;
 
-        if (exynos_v4l2_dqbuf(pCtx->videoCtx.hDevice, &buf) == 0) {
+        if (Codec_OSAL_GetDevOps(pCtx)->DequeueBuf(pCtx->videoCtx.hDevice, &buf) == 0) {
             pBuf->index     = buf.index;
 #ifdef USE_ORIGINAL_HEADER
             pBuf->flags     = buf.reserved2;
@@ -477,7 +517,7 @@ int Codec_OSAL_GetControls(
             ext_ctrl[2].id =  V4L2_CID_MPEG_VIDEO_H264_SEI_FP_INFO;
             ext_ctrl[3].id =  V4L2_CID_MPEG_VIDEO_H264_SEI_FP_GRID_POS;
 
-            if (exynos_v4l2_g_ext_ctrl(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
+            if (Codec_OSAL_GetDevOps(pCtx)->GetExtControls(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
                 ret = -1;
                 goto EXIT;
             }
@@ -562,7 +602,7 @@ int Codec_OSAL_GetControls(
 
             ext_ctrls.count = i;
 
-            if (exynos_v4l2_g_ext_ctrl(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
+            if (Codec_OSAL_GetDevOps(pCtx)->GetExtControls(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
                 ret = VIDEO_ERROR_APIFAIL;
                 goto EXIT;
             }
@@ -1592,7 +1632,7 @@ int Codec_OSAL_SetControls(
             ext_ctrls.ctrl_class = V4L2_CTRL_CLASS_MPEG;
             ext_ctrls.controls = ext_ctrl;
 
-            if (exynos_v4l2_s_ext_ctrl(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
+            if (Codec_OSAL_GetDevOps(pCtx)->SetExtControls(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
                 ret = -1;
                 goto EXIT;
             }
@@ -1795,13 +1835,13 @@ int Codec_OSAL_SetControls(
                 ALOGV("%s: QP[%d] range (%d / %d)", __FUNCTION__, i, values[i][0], values[i][1]);
 
                 /* keep a calling sequence as Max->Min because dirver has a restriction */
-                if (exynos_v4l2_s_ctrl(pCtx->videoCtx.hDevice, cids[i][1], values[i][1]) != 0) {
+                if (Codec_OSAL_GetDevOps(pCtx)->SetControl(pCtx->videoCtx.hDevice, cids[i][1], values[i][1]) != 0) {
                     ALOGE("%s: Failed to s_ctrl for max value", __FUNCTION__);
                     ret = -1;
                     goto EXIT;
                 }
 
-                if (exynos_v4l2_s_ctrl(pCtx->videoCtx.hDevice, cids[i][0], values[i][0]) != 0) {
+                if (Codec_OSAL_GetDevOps(pCtx)->SetControl(pCtx->videoCtx.hDevice, cids[i][0], values[i][0]) != 0) {
                     ALOGE("%s: Failed to s_ctrl for min value", __FUNCTION__);
                     ret = -1;
                     goto EXIT;
@@ -1856,7 +1896,7 @@ int Codec_OSAL_SetControls(
             ext_ctrls.ctrl_class = V4L2_CTRL_CLASS_MPEG;
             ext_ctrls.controls   = ext_ctrl;
 
-            if (exynos_v4l2_s_ext_ctrl(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
+            if (Codec_OSAL_GetDevOps(pCtx)->SetExtControls(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
                 ret = -1;
                 goto EXIT;
             }
@@ -1916,7 +1956,7 @@ int Codec_OSAL_SetControls(
             ext_ctrls.ctrl_class = V4L2_CTRL_CLASS_MPEG;
             ext_ctrls.controls   = ext_ctrl;
 
-            if (exynos_v4l2_s_ext_ctrl(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
+            if (Codec_OSAL_GetDevOps(pCtx)->SetExtControls(pCtx->videoCtx.hDevice, &ext_ctrls) != 0) {
                 ret = -1;
                 goto EXIT;
             }
@@ -1943,7 +1983,7 @@ int Codec_OSAL_GetControl(
     if ((pCtx != NULL) &&
         (pValue != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        return exynos_v4l2_g_ctrl(pCtx->videoCtx.hDevice, uCID, pValue);
+        return Codec_OSAL_GetDevOps(pCtx)->GetControl(pCtx->videoCtx.hDevice, uCID, pValue);
     }
 
     return -1;
@@ -1956,7 +1996,7 @@ int Codec_OSAL_SetControl(
 {
     if ((pCtx != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        return exynos_v4l2_s_ctrl(pCtx->videoCtx.hDevice, uCID, nValue);
+        return Codec_OSAL_GetDevOps(pCtx)->SetControl(pCtx->videoCtx.hDevice, uCID, nValue);
     }
 
     return -1;
@@ -1974,7 +2014,7 @@ int Codec_OSAL_GetCrop(
         memset(&crop, 0, sizeof(crop));
         crop.type = pCrop->type;
 
-        if (exynos_v4l2_g_crop(pCtx->videoCtx.hDevice, &crop) == 0) {
+        if (Codec_OSAL_GetDevOps(pCtx)->GetCrop(pCtx->videoCtx.hDevice, &crop) == 0) {
             pCrop->top      = crop.c.top;
             pCrop->left     = crop.c.left;
             pCrop->width    = crop.c.width;
@@ -2000,7 +2040,7 @@ int Codec_OSAL_GetFormat(
         memset(&fmt, 0, sizeof(fmt));
         fmt.type = pFmt->type;
 
-        if (exynos_v4l2_g_fmt(pCtx->videoCtx.hDevice, &fmt) == 0) {
+        if (Codec_OSAL_GetDevOps(pCtx)->GetFormat(pCtx->videoCtx.hDevice, &fmt) == 0) {
             pFmt->format = fmt.fmt.pix_mp.pixelformat;
             pFmt->width  = fmt.fmt.pix_mp.width;
             pFmt->height = fmt.fmt.pix_mp.height;
@@ -2040,7 +2080,7 @@ int Codec_OSAL_SetFormat(
         for (i = 0; i < pFmt->nPlane; i++)
             fmt.fmt.pix_mp.plane_fmt[i].sizeimage = pFmt->planeSize[i];
 
-        return exynos_v4l2_s_fmt(pCtx->videoCtx.hDevice, &fmt);
+        return Codec_OSAL_GetDevOps(pCtx)->SetFormat(pCtx->videoCtx.hDevice, &fmt);
     }
 
     return -1;
@@ -2053,7 +2093,7 @@ int Codec_OSAL_RequestBuf(
     if ((pCtx != NULL) &&
         (pReqBuf != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        return exynos_v4l2_reqbufs(pCtx->videoCtx.hDevice, pReqBuf);
+        return Codec_OSAL_GetDevOps(pCtx)->RequestBuf(pCtx->videoCtx.hDevice, pReqBuf);
     }
 
     return -1;
@@ -2078,7 +2118,7 @@ int Codec_OSAL_QueryBuf(
         buf.length      = pBuf->nPlane;
         buf.memory      = pBuf->memory;
 
-        if (exynos_v4l2_querybuf(pCtx->videoCtx.hDevice, &buf) == 0) {
+        if (Codec_OSAL_GetDevOps(pCtx)->QueryBuf(pCtx->videoCtx.hDevice, &buf) == 0) {
             for (i = 0; i < (int)buf.length; i++) {
                 pBuf->planes[i].bufferSize  = buf.m.planes[i].length;
                 pBuf->planes[i].offset      = buf.m.planes[i].m.mem_offset;
@@ -2097,7 +2137,7 @@ int Codec_OSAL_SetStreamOn(
 {
     if ((pCtx != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        return exynos_v4l2_streamon(pCtx->videoCtx.hDevice, nPort);
+        return Codec_OSAL_GetDevOps(pCtx)->StreamOn(pCtx->videoCtx.hDevice, nPort);
     }
 
     return -1;
@@ -2109,12 +2149,244 @@ int Codec_OSAL_SetStreamOff(
 {
     if ((pCtx != NULL) &&
         (pCtx->videoCtx.hDevice >= 0)) {
-        return exynos_v4l2_streamoff(pCtx->videoCtx.hDevice, nPort);
+        return Codec_OSAL_GetDevOps(pCtx)->StreamOff(pCtx->videoCtx.hDevice, nPort);
     }
 
     return -1;
 }
 
+static unsigned int BufHash_Pos(unsigned long nKey)
+{
+    /* fibonacci hashing, addresses and fds are both poorly distributed in low bits */
+    return (unsigned int)(((unsigned long long)nKey * 0x9E3779B97F4A7C15ULL) >>
+                          (64 - CODEC_OSAL_BUFINDEX_HASH_BITS));
+}
+
+static int BufHash_Lookup(
+    CodecOSAL_BufHash   *pHash,
+    unsigned long        nKey)
+{
+    unsigned int nPos = BufHash_Pos(nKey);
+    int i;
+
+    for (i = 0; i < CODEC_OSAL_BUFINDEX_HASH_SIZE; i++) {
+        if (pHash->key[nPos] == 0)
+            break;
+
+        if (pHash->key[nPos] == nKey)
+            return pHash->slot[nPos];
+
+        nPos = (nPos + 1) & (CODEC_OSAL_BUFINDEX_HASH_SIZE - 1);
+    }
+
+    return -1;
+}
+
+static void BufHash_Insert(
+    CodecOSAL_BufHash   *pHash,
+    unsigned long        nKey,
+    int                  nSlot)
+{
+    unsigned int nPos = BufHash_Pos(nKey);
+    int i;
+
+    /* the table is twice as large as the slot count, so it never fills up */
+    for (i = 0; i < CODEC_OSAL_BUFINDEX_HASH_SIZE; i++) {
+        if ((pHash->key[nPos] == 0) ||
+            (pHash->key[nPos] == nKey)) {
+            pHash->key[nPos]  = nKey;
+            pHash->slot[nPos] = nSlot;
+            return;
+        }
+
+        nPos = (nPos + 1) & (CODEC_OSAL_BUFINDEX_HASH_SIZE - 1);
+    }
+}
+
+static void BufHash_Remove(
+    CodecOSAL_BufHash   *pHash,
+    unsigned long        nKey)
+{
+    unsigned int nMask = CODEC_OSAL_BUFINDEX_HASH_SIZE - 1;
+    unsigned int nPos  = BufHash_Pos(nKey);
+    unsigned int nNext, nHome;
+    int i;
+
+    for (i = 0; i < CODEC_OSAL_BUFINDEX_HASH_SIZE; i++) {
+        if (pHash->key[nPos] == 0)
+            return;
+
+        if (pHash->key[nPos] == nKey)
+            break;
+
+        nPos = (nPos + 1) & nMask;
+    }
+
+    if (i == CODEC_OSAL_BUFINDEX_HASH_SIZE)
+        return;
+
+    /* backward shift deletion keeps every probe chain contiguous */
+    nNext = nPos;
+    while (1) {
+        nNext = (nNext + 1) & nMask;
+        if (pHash->key[nNext] == 0)
+            break;
+
+        nHome = BufHash_Pos(pHash->key[nNext]);
+        if (((nNext - nHome) & nMask) < ((nNext - nPos) & nMask))
+            continue;
+
+        pHash->key[nPos]  = pHash->key[nNext];
+        pHash->slot[nPos] = pHash->slot[nNext];
+        nPos = nNext;
+    }
+
+    pHash->key[nPos]  = 0;
+    pHash->slot[nPos] = -1;
+}
+
+static void BufIndex_SetKey(
+    CodecOSAL_BufHash   *pHash,
+    unsigned long       *pKeys,
+    int                  nBufferNum,
+    int                  nSlot,
+    unsigned long        nKey)
+{
+    unsigned long nOldKey = pKeys[nSlot];
+    int i;
+
+    if (nOldKey == nKey)
+        return;
+
+    pKeys[nSlot] = nKey;
+
+    if ((nOldKey != 0) &&
+        (BufHash_Lookup(pHash, nOldKey) == nSlot)) {
+        BufHash_Remove(pHash, nOldKey);
+
+        /* the same buffer may still be recorded in another slot */
+        for (i = 0; i < nBufferNum; i++) {
+            if (pKeys[i] == nOldKey) {
+                BufHash_Insert(pHash, nOldKey, i);
+                break;
+            }
+        }
+    }
+
+    if (nKey != 0)
+        BufHash_Insert(pHash, nKey, nSlot);
+}
+
+void Codec_OSAL_BufIndex_Rebuild(
+    CodecOSAL_BufIndex  *pIndex,
+    ExynosVideoBuffer   *pBuffers,
+    int                  nBufferNum)
+{
+    int i;
+
+    if (pIndex == NULL)
+        return;
+
+    memset(pIndex, 0, sizeof(*pIndex));
+    memset(pIndex->addrHash.slot, 0xff, sizeof(pIndex->addrHash.slot));
+    memset(pIndex->fdHash.slot, 0xff, sizeof(pIndex->fdHash.slot));
+
+    if ((pBuffers == NULL) ||
+        (nBufferNum <= 0))
+        return;
+
+    if (nBufferNum > CODEC_OSAL_BUFINDEX_MAX_NUM) {
+        ALOGW("%s: %d buffers are more than %d, index is disabled", __FUNCTION__,
+                    nBufferNum, CODEC_OSAL_BUFINDEX_MAX_NUM);
+        return;
+    }
+
+    pIndex->nBufferNum = nBufferNum;
+
+    for (i = 0; i < nBufferNum; i++)
+        Codec_OSAL_BufIndex_Update(pIndex, pBuffers, i);
+}
+
+void Codec_OSAL_BufIndex_Update(
+    CodecOSAL_BufIndex  *pIndex,
+    ExynosVideoBuffer   *pBuffers,
+    int                  nSlot)
+{
+    ExynosVideoBuffer *pBuffer = NULL;
+    unsigned int nBit;
+
+    if ((pIndex == NULL) ||
+        (pBuffers == NULL) ||
+        (nSlot < 0) ||
+        (nSlot >= pIndex->nBufferNum))
+        return;
+
+    pBuffer = &pBuffers[nSlot];
+    nBit    = 1U << nSlot;
+
+    if (pBuffer->bQueued == VIDEO_TRUE)
+        pIndex->nQueuedMask |= nBit;
+    else
+        pIndex->nQueuedMask &= ~nBit;
+
+    if (pBuffer->bSlotUsed == VIDEO_TRUE)
+        pIndex->nUsedMask |= nBit;
+    else
+        pIndex->nUsedMask &= ~nBit;
+
+    BufIndex_SetKey(&pIndex->addrHash, pIndex->addrKey, pIndex->nBufferNum,
+                    nSlot, (unsigned long)pBuffer->planes[0].addr);
+    BufIndex_SetKey(&pIndex->fdHash, pIndex->fdKey, pIndex->nBufferNum,
+                    nSlot, pBuffer->planes[0].fd);
+}
+
+int Codec_OSAL_BufIndex_IsEnabled(CodecOSAL_BufIndex *pIndex)
+{
+    return ((pIndex != NULL) && (pIndex->nBufferNum > 0))? 1:0;
+}
+
+int Codec_OSAL_BufIndex_FindByAddr(
+    CodecOSAL_BufIndex  *pIndex,
+    void                *pAddr)
+{
+    if ((Codec_OSAL_BufIndex_IsEnabled(pIndex) == 0) ||
+        (pAddr == NULL))
+        return -1;
+
+    return BufHash_Lookup(&pIndex->addrHash, (unsigned long)pAddr);
+}
+
+int Codec_OSAL_BufIndex_FindByFd(
+    CodecOSAL_BufIndex  *pIndex,
+    unsigned long        nFd)
+{
+    if ((Codec_OSAL_BufIndex_IsEnabled(pIndex) == 0) ||
+        (nFd == 0))
+        return -1;
+
+    return BufHash_Lookup(&pIndex->fdHash, nFd);
+}
+
+int Codec_OSAL_BufIndex_FindFree(
+    CodecOSAL_BufIndex  *pIndex,
+    ExynosVideoBoolType  bSkipUsed)
+{
+    unsigned int nValidMask, nBusyMask;
+
+    if (Codec_OSAL_BufIndex_IsEnabled(pIndex) == 0)
+        return -1;
+
+    nValidMask = (pIndex->nBufferNum >= 32)? 0xFFFFFFFFU:((1U << pIndex->nBufferNum) - 1);
+    nBusyMask  = pIndex->nQueuedMask;
+    if (bSkipUsed == VIDEO_TRUE)
+        nBusyMask |= pIndex->nUsedMask;
+
+    if ((~nBusyMask & nValidMask) == 0)
+        return -1;
+
+    return __builtin_ctz(~nBusyMask & nValidMask);
+}
+
 void *Codec_OSAL_MemoryMap(void *addr, size_t len, int prot, int flags, unsigned long fd, off_t offset)
 {
     return mmap(addr, len, prot, flags, fd, offset);
@@ -0,0 +1,1272 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file    ExynosVideo_OSAL_Fake.c
+ * @brief   ExynosVideo OSAL fake MFC device
+ * @version    1.0.0
+ * @history
+ *   2019.05.08 : Create
+ */
+
+/*
+ * In-process emulation of the MFC V4L2 node, used to run the OMX pipeline
+ * where the MFC can not be accessed. A worker thread per instance consumes
+ * the OUTPUT queue in order and fills the CAPTURE queue with the timing and
+ * the state machine of the real device : header parsing, DPB delay,
+ * resolution change and EOS for decoders, header and frame tags for encoders.
+ * No bitstream or pixel is processed. Only shared memory (USERPTR, DMABUF)
+ * is supported because OMX always calls Set_Shareable.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#include "ExynosVideo_OSAL.h"
+#include "ExynosVideo_OSAL_Fake.h"
+
+/* #define LOG_NDEBUG 0 */
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "ExynosVideoFakeMFC"
+
+#define FAKE_MFC_MAX_DEVICES        8
+#define FAKE_MFC_HEADER_TIMEOUT     1000    /* ms */
+#define FAKE_MFC_CONFIG_LEN         256
+
+#ifdef USE_ORIGINAL_HEADER
+#define FAKE_MFC_BUF_FLAGS(pBuf)    ((pBuf)->reserved2)
+#else
+#define FAKE_MFC_BUF_FLAGS(pBuf)    ((pBuf)->input)
+#endif
+
+#define FAKE_ALIGN(x, a)            (((x) + (a) - 1) & ~((a) - 1))
+#define FAKE_MIN(a, b)              (((a) < (b))? (a):(b))
+
+typedef enum _FakeMFCBufState {
+    FAKE_BUF_DEQUEUED = 0,
+    FAKE_BUF_QUEUED,        /* waiting in pending list */
+    FAKE_BUF_ACTIVE,        /* being processed or held in DPB */
+    FAKE_BUF_DONE,          /* waiting for DQBUF */
+} FakeMFCBufState;
+
+typedef enum _FakeMFCState {
+    FAKE_STATE_INIT = 0,    /* header is not parsed yet */
+    FAKE_STATE_RUNNING,
+    FAKE_STATE_RES_CHANGE,  /* waiting for capture buffers to be reallocated */
+} FakeMFCState;
+
+/* values of CODEC_OSAL_CID_DEC_DISPLAY_STATUS */
+typedef enum _FakeMFCDisplayStatus {
+    FAKE_DISPLAY_DECODING_ONLY  = 0,
+    FAKE_DISPLAY_DECODING       = 1,
+    FAKE_DISPLAY_ONLY           = 2,
+    FAKE_DISPLAY_FINISHED       = 3,    /* or resolution change by CHECK_STATE */
+} FakeMFCDisplayStatus;
+
+typedef struct _FakeMFCConfig {
+    unsigned int nWidth;
+    unsigned int nHeight;
+    unsigned int nDPBNum;
+    unsigned int nDisplayDelay;
+    unsigned int nLatency;
+    unsigned int nResizeAt;
+    unsigned int nResizeWidth;
+    unsigned int nResizeHeight;
+    unsigned int nEncFrameSize;
+    unsigned int nGOP;
+    unsigned int nHwVersion;
+} FakeMFCConfig;
+
+typedef struct _FakeMFCBuffer {
+    FakeMFCBufState     eState;
+    struct v4l2_plane   planes[VIDEO_BUFFER_MAX_PLANES];
+    unsigned int        nPlane;
+    unsigned int        nFlags;         /* LAST_FRAME, EMPTY_DATA, ... */
+    unsigned int        nV4L2Flags;     /* V4L2_BUF_FLAG_* */
+    struct timeval      timestamp;
+    int                 nFrameTag;
+    int                 nDisplayStatus;
+    long long           nQueueTime;
+} FakeMFCBuffer;
+
+typedef struct _FakeMFCFifo {
+    int idx[VIDEO_BUFFER_MAX_NUM];
+    int nHead;
+    int nCount;
+} FakeMFCFifo;
+
+typedef struct _FakeMFCStat {
+    unsigned int nFrames;
+    long long    nSumLatency;
+    long long    nMaxLatency;
+} FakeMFCStat;
+
+typedef struct _FakeMFCQueue {
+    ExynosVideoBoolType bStreaming;
+    unsigned int        nMemory;
+    unsigned int        nCount;
+    unsigned int        nOwned;         /* queued and not dequeued yet */
+    unsigned int        nGeneration;    /* bumped by STREAMOFF */
+    unsigned int        nPixelFormat;
+    unsigned int        nWidth;
+    unsigned int        nHeight;
+    unsigned int        nPlane;
+    unsigned int        planeSize[VIDEO_BUFFER_MAX_PLANES];
+    FakeMFCBuffer       buf[VIDEO_BUFFER_MAX_NUM];
+    FakeMFCFifo         pending;
+    FakeMFCFifo         done;
+    FakeMFCStat         stat;
+} FakeMFCQueue;
+
+typedef struct _FakeMFCDevice {
+    int                 hDevice;        /* eventfd, readable while a capture buffer is done */
+    ExynosVideoBoolType bEncoder;
+    FakeMFCConfig       config;
+
+    pthread_t           hThread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      workCond;
+    pthread_cond_t      doneCond;
+    ExynosVideoBoolType bExit;
+
+    FakeMFCQueue        src;
+    FakeMFCQueue        dst;
+
+    FakeMFCState        eState;
+    FakeMFCFifo         dpb;
+    unsigned int        nFrameCount;
+    unsigned int        nStreamWidth;
+    unsigned int        nStreamHeight;
+    ExynosVideoBoolType bResized;
+    ExynosVideoBoolType bFlushPending;
+    int                 nFlushTag;
+    ExynosVideoBoolType bHeaderDone;
+    int                 nHeaderMode;
+    int                 nDisplayDelay;
+
+    int                 nPendingTag;    /* for the next OUTPUT buffer */
+    int                 nDisplayTag;    /* of the last dequeued CAPTURE buffer */
+    int                 nDisplayStatus;
+    int                 nCheckState;
+} FakeMFCDevice;
+
+static const struct {
+    const char *name;
+    size_t      offset;
+} sFakeMFCConfigKeys[] = {
+    { "w",          offsetof(FakeMFCConfig, nWidth)         },
+    { "h",          offsetof(FakeMFCConfig, nHeight)        },
+    { "dpb",        offsetof(FakeMFCConfig, nDPBNum)        },
+    { "delay",      offsetof(FakeMFCConfig, nDisplayDelay)  },
+    { "lat",        offsetof(FakeMFCConfig, nLatency)       },
+    { "resize_at",  offsetof(FakeMFCConfig, nResizeAt)      },
+    { "resize_w",   offsetof(FakeMFCConfig, nResizeWidth)   },
+    { "resize_h",   offsetof(FakeMFCConfig, nResizeHeight)  },
+    { "enc_size",   offsetof(FakeMFCConfig, nEncFrameSize)  },
+    { "gop",        offsetof(FakeMFCConfig, nGOP)           },
+    { "ver",        offsetof(FakeMFCConfig, nHwVersion)     },
+};
+
+/* H.264 SPS/PPS, enough for the OMX to split the codec config */
+static const unsigned char sFakeMFCHeader[] = {
+    0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x80, 0x1f, 0xda, 0x01, 0x40, 0x16, 0xe8,
+    0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x06, 0xe2,
+};
+
+static pthread_mutex_t  sFakeMFCLock = PTHREAD_MUTEX_INITIALIZER;
+static FakeMFCDevice   *sFakeMFCDevices[FAKE_MFC_MAX_DEVICES];
+
+static long long FakeMFC_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((long long)ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+}
+
+static void Fifo_Clear(FakeMFCFifo *pFifo)
+{
+    pFifo->nHead  = 0;
+    pFifo->nCount = 0;
+}
+
+static void Fifo_Push(FakeMFCFifo *pFifo, int nIndex)
+{
+    pFifo->idx[(pFifo->nHead + pFifo->nCount) % VIDEO_BUFFER_MAX_NUM] = nIndex;
+    pFifo->nCount++;
+}
+
+static int Fifo_Pop(FakeMFCFifo *pFifo)
+{
+    int nIndex = pFifo->idx[pFifo->nHead];
+
+    pFifo->nHead = (pFifo->nHead + 1) % VIDEO_BUFFER_MAX_NUM;
+    pFifo->nCount--;
+
+    return nIndex;
+}
+
+static void FakeMFC_ParseConfig(FakeMFCConfig *pConfig)
+{
+    const char *pEnv = getenv(CODEC_OSAL_FAKE_MFC_ENV);
+
+    char  sConfig[FAKE_MFC_CONFIG_LEN];
+    char *pSave  = NULL;
+    char *pToken = NULL;
+    char *pValue = NULL;
+    unsigned int i;
+
+    pConfig->nWidth         = 1920;
+    pConfig->nHeight        = 1080;
+    pConfig->nDPBNum        = 8;
+    pConfig->nDisplayDelay  = 2;
+    pConfig->nLatency       = 3000;
+    pConfig->nResizeAt      = 0;
+    pConfig->nResizeWidth   = 1280;
+    pConfig->nResizeHeight  = 720;
+    pConfig->nEncFrameSize  = 0;
+    pConfig->nGOP           = 30;
+    pConfig->nHwVersion     = (unsigned int)MFC_1220;
+
+    if (pEnv == NULL)
+        return;
+
+    strncpy(sConfig, pEnv, sizeof(sConfig) - 1);
+    sConfig[sizeof(sConfig) - 1] = '\0';
+
+    for (pToken = strtok_r(sConfig, ",", &pSave); pToken != NULL; pToken = strtok_r(NULL, ",", &pSave)) {
+        pValue = strchr(pToken, '=');
+        if (pValue == NULL)
+            continue;
+
+        *pValue++ = '\0';
+        for (i = 0; i < (sizeof(sFakeMFCConfigKeys) / sizeof(sFakeMFCConfigKeys[0])); i++) {
+            if (strcmp(pToken, sFakeMFCConfigKeys[i].name) == 0) {
+                *(unsigned int *)((char *)pConfig + sFakeMFCConfigKeys[i].offset) =
+                                                (unsigned int)strtoul(pValue, NULL, 0);
+                break;
+            }
+        }
+
+        if (i == (sizeof(sFakeMFCConfigKeys) / sizeof(sFakeMFCConfigKeys[0])))
+            ALOGW("%s: unknown key(%s) is ignored", __FUNCTION__, pToken);
+    }
+
+    if (pConfig->nGOP == 0)
+        pConfig->nGOP = 1;
+
+    if (pConfig->nDPBNum > VIDEO_BUFFER_MAX_NUM)
+        pConfig->nDPBNum = VIDEO_BUFFER_MAX_NUM;
+}
+
+static FakeMFCDevice *FakeMFC_Lookup(int hDevice)
+{
+    FakeMFCDevice *pDev = NULL;
+    int i;
+
+    pthread_mutex_lock(&sFakeMFCLock);
+    for (i = 0; i < FAKE_MFC_MAX_DEVICES; i++) {
+        if ((sFakeMFCDevices[i] != NULL) &&
+            (sFakeMFCDevices[i]->hDevice == hDevice)) {
+            pDev = sFakeMFCDevices[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sFakeMFCLock);
+
+    if (pDev == NULL)
+        errno = EBADF;
+
+    return pDev;
+}
+
+static FakeMFCQueue *FakeMFC_GetQueue(FakeMFCDevice *pDev, unsigned int nType)
+{
+    if (nType == (unsigned int)CODEC_OSAL_BUF_TYPE_SRC)
+        return &pDev->src;
+
+    if (nType == (unsigned int)CODEC_OSAL_BUF_TYPE_DST)
+        return &pDev->dst;
+
+    errno = EINVAL;
+
+    return NULL;
+}
+
+/* capture format of decoder follows the stream resolution */
+static void FakeMFC_UpdateDecFormat(FakeMFCDevice *pDev)
+{
+    FakeMFCQueue *pDst  = &pDev->dst;
+    unsigned int  nLuma = 0;
+
+    pDst->nWidth  = pDev->nStreamWidth;
+    pDst->nHeight = pDev->nStreamHeight;
+
+    nLuma = FAKE_ALIGN(pDst->nWidth, 16) * FAKE_ALIGN(pDst->nHeight, 16);
+
+    memset(pDst->planeSize, 0, sizeof(pDst->planeSize));
+    switch (pDst->nPlane) {
+    case 1:
+        pDst->planeSize[0] = (nLuma * 3) / 2;
+        break;
+    case 3:
+        pDst->planeSize[0] = nLuma;
+        pDst->planeSize[1] = nLuma / 4;
+        pDst->planeSize[2] = nLuma / 4;
+        break;
+    default:
+        pDst->nPlane       = 2;
+        pDst->planeSize[0] = nLuma;
+        pDst->planeSize[1] = nLuma / 2;
+        break;
+    }
+}
+
+static void FakeMFC_ResetQueue(FakeMFCDevice *pDev, FakeMFCQueue *pQueue)
+{
+    unsigned long long nCount = 0;
+    unsigned int i;
+
+    for (i = 0; i < pQueue->nCount; i++)
+        pQueue->buf[i].eState = FAKE_BUF_DEQUEUED;
+
+    Fifo_Clear(&pQueue->pending);
+    Fifo_Clear(&pQueue->done);
+    pQueue->nOwned = 0;
+    pQueue->nGeneration++;
+
+    if (pQueue == &pDev->dst) {
+        Fifo_Clear(&pDev->dpb);
+        while (read(pDev->hDevice, &nCount, sizeof(nCount)) == sizeof(nCount));
+    }
+
+    pthread_cond_broadcast(&pDev->doneCond);
+}
+
+static void FakeMFC_Complete(FakeMFCDevice *pDev, FakeMFCQueue *pQueue, int nIndex)
+{
+    unsigned long long nCount = 1;
+
+    pQueue->buf[nIndex].eState = FAKE_BUF_DONE;
+    Fifo_Push(&pQueue->done, nIndex);
+
+    if ((pQueue == &pDev->dst) &&
+        (write(pDev->hDevice, &nCount, sizeof(nCount)) != sizeof(nCount)))
+        ALOGW("%s: failed to signal fd(%d)", __FUNCTION__, pDev->hDevice);
+
+    pthread_cond_broadcast(&pDev->doneCond);
+}
+
+/*
+ * spends the configured latency without the lock.
+ * returns false when the queues were reset meanwhile,
+ * the buffers taken by the caller are not owned by the device anymore.
+ */
+static ExynosVideoBoolType FakeMFC_Process(FakeMFCDevice *pDev)
+{
+    unsigned int nSrcGen = pDev->src.nGeneration;
+    unsigned int nDstGen = pDev->dst.nGeneration;
+
+    if (pDev->config.nLatency > 0) {
+        pthread_mutex_unlock(&pDev->lock);
+        usleep(pDev->config.nLatency);
+        pthread_mutex_lock(&pDev->lock);
+    }
+
+    if ((pDev->bExit == VIDEO_TRUE) ||
+        (nSrcGen != pDev->src.nGeneration) ||
+        (nDstGen != pDev->dst.nGeneration))
+        return VIDEO_FALSE;
+
+    return VIDEO_TRUE;
+}
+
+static int FakeMFC_TakePending(FakeMFCQueue *pQueue)
+{
+    int nIndex = Fifo_Pop(&pQueue->pending);
+
+    pQueue->buf[nIndex].eState = FAKE_BUF_ACTIVE;
+
+    return nIndex;
+}
+
+static void FakeMFC_WritePlane(
+    FakeMFCQueue            *pQueue,
+    struct v4l2_plane       *pPlane,
+    const unsigned char     *pData,
+    unsigned int             nSize)
+{
+    void *pAddr = NULL;
+
+    nSize = FAKE_MIN(nSize, pPlane->length);
+
+    if (pQueue->nMemory == V4L2_MEMORY_USERPTR) {
+        memcpy((void *)pPlane->m.userptr, pData, nSize);
+        return;
+    }
+
+    pAddr = mmap(NULL, pPlane->length, PROT_READ | PROT_WRITE, MAP_SHARED, pPlane->m.fd, 0);
+    if (pAddr == MAP_FAILED) {
+        ALOGW("%s: failed to map fd(%d)", __FUNCTION__, pPlane->m.fd);
+        return;
+    }
+
+    memcpy(pAddr, pData, nSize);
+    munmap(pAddr, pPlane->length);
+}
+
+static void FakeMFC_Display(FakeMFCDevice *pDev, int nIndex, FakeMFCDisplayStatus eStatus)
+{
+    pDev->dst.buf[nIndex].nDisplayStatus = eStatus;
+    FakeMFC_Complete(pDev, &pDev->dst, nIndex);
+}
+
+static void FakeMFC_DrainDPB(FakeMFCDevice *pDev)
+{
+    while (pDev->dpb.nCount > 0)
+        FakeMFC_Display(pDev, Fifo_Pop(&pDev->dpb), FAKE_DISPLAY_ONLY);
+}
+
+/* empty capture buffer with status 3 : decoding finished or resolution changed */
+static void FakeMFC_Signal(FakeMFCDevice *pDev, int nFrameTag)
+{
+    FakeMFCBuffer *pOut = &pDev->dst.buf[FakeMFC_TakePending(&pDev->dst)];
+    unsigned int i;
+
+    for (i = 0; i < pOut->nPlane; i++)
+        pOut->planes[i].bytesused = 0;
+
+    memset(&pOut->timestamp, 0, sizeof(pOut->timestamp));
+    pOut->nFrameTag  = nFrameTag;
+    pOut->nFlags     = 0;
+    pOut->nV4L2Flags = 0;
+
+    FakeMFC_Display(pDev, (int)(pOut - pDev->dst.buf), FAKE_DISPLAY_FINISHED);
+}
+
+static ExynosVideoBoolType FakeMFC_DecodeStep(FakeMFCDevice *pDev)
+{
+    FakeMFCQueue  *pSrc = &pDev->src;
+    FakeMFCQueue  *pDst = &pDev->dst;
+    FakeMFCBuffer *pIn  = NULL;
+    FakeMFCBuffer *pOut = NULL;
+
+    int nSrcIndex, nDstIndex;
+    unsigned int i;
+
+    if (pSrc->bStreaming != VIDEO_TRUE)
+        return VIDEO_FALSE;
+
+    if (pDev->eState == FAKE_STATE_INIT) {
+        if (pSrc->pending.nCount == 0)
+            return VIDEO_FALSE;
+
+        /* the first buffer is consumed for header parsing */
+        nSrcIndex = FakeMFC_TakePending(pSrc);
+        if (FakeMFC_Process(pDev) != VIDEO_TRUE)
+            return VIDEO_TRUE;
+
+        pDev->nStreamWidth  = pDev->config.nWidth;
+        pDev->nStreamHeight = pDev->config.nHeight;
+        FakeMFC_UpdateDecFormat(pDev);
+        pDev->eState = FAKE_STATE_RUNNING;
+
+        FakeMFC_Complete(pDev, pSrc, nSrcIndex);
+        return VIDEO_TRUE;
+    }
+
+    if ((pDev->eState != FAKE_STATE_RUNNING) ||
+        (pDst->bStreaming != VIDEO_TRUE) ||
+        (pDst->pending.nCount == 0))
+        return VIDEO_FALSE;
+
+    if (pDev->bFlushPending == VIDEO_TRUE) {
+        FakeMFC_DrainDPB(pDev);
+        FakeMFC_Signal(pDev, pDev->nFlushTag);
+        pDev->bFlushPending = VIDEO_FALSE;
+        return VIDEO_TRUE;
+    }
+
+    if (pSrc->pending.nCount == 0)
+        return VIDEO_FALSE;
+
+    pIn = &pSrc->buf[pSrc->pending.idx[pSrc->pending.nHead]];
+    if (pIn->nFlags & EMPTY_DATA) {
+        nSrcIndex = FakeMFC_TakePending(pSrc);
+        FakeMFC_DrainDPB(pDev);
+        FakeMFC_Signal(pDev, pIn->nFrameTag);
+        FakeMFC_Complete(pDev, pSrc, nSrcIndex);
+        return VIDEO_TRUE;
+    }
+
+    if ((pDev->config.nResizeAt > 0) &&
+        (pDev->nFrameCount == pDev->config.nResizeAt) &&
+        (pDev->bResized == VIDEO_FALSE)) {
+        /* the frame stays queued and is decoded after reallocation */
+        FakeMFC_DrainDPB(pDev);
+        pDev->nStreamWidth  = pDev->config.nResizeWidth;
+        pDev->nStreamHeight = pDev->config.nResizeHeight;
+        FakeMFC_UpdateDecFormat(pDev);
+        pDev->nCheckState = 1;
+        pDev->bResized    = VIDEO_TRUE;
+        pDev->eState      = FAKE_STATE_RES_CHANGE;
+        FakeMFC_Signal(pDev, -1);
+        return VIDEO_TRUE;
+    }
+
+    nSrcIndex = FakeMFC_TakePending(pSrc);
+    nDstIndex = FakeMFC_TakePending(pDst);
+    if (FakeMFC_Process(pDev) != VIDEO_TRUE)
+        return VIDEO_TRUE;
+
+    pIn  = &pSrc->buf[nSrcIndex];
+    pOut = &pDst->buf[nDstIndex];
+
+    for (i = 0; i < pOut->nPlane; i++)
+        pOut->planes[i].bytesused = FAKE_MIN(pDst->planeSize[i], pOut->planes[i].length);
+
+    pOut->timestamp  = pIn->timestamp;
+    pOut->nFrameTag  = pIn->nFrameTag;
+    pOut->nFlags     = 0;
+    pOut->nV4L2Flags = ((pDev->nFrameCount % pDev->config.nGOP) == 0)? V4L2_BUF_FLAG_KEYFRAME:V4L2_BUF_FLAG_PFRAME;
+    pDev->nFrameCount++;
+
+    /* DPB is bounded by the capture buffers, display early rather than stall */
+    Fifo_Push(&pDev->dpb, nDstIndex);
+    if ((pDev->dpb.nCount > pDev->nDisplayDelay) ||
+        (pDst->pending.nCount == 0))
+        FakeMFC_Display(pDev, Fifo_Pop(&pDev->dpb), FAKE_DISPLAY_DECODING);
+
+    if (pIn->nFlags & LAST_FRAME) {
+        pDev->bFlushPending = VIDEO_TRUE;
+        pDev->nFlushTag     = pIn->nFrameTag;
+    }
+
+    FakeMFC_Complete(pDev, pSrc, nSrcIndex);
+
+    return VIDEO_TRUE;
+}
+
+static ExynosVideoBoolType FakeMFC_EncodeStep(FakeMFCDevice *pDev)
+{
+    FakeMFCQueue  *pSrc = &pDev->src;
+    FakeMFCQueue  *pDst = &pDev->dst;
+    FakeMFCBuffer *pIn  = NULL;
+    FakeMFCBuffer *pOut = NULL;
+
+    int nSrcIndex, nDstIndex;
+    unsigned int nSize = 0;
+
+    if ((pDst->bStreaming != VIDEO_TRUE) ||
+        (pDst->pending.nCount == 0))
+        return VIDEO_FALSE;
+
+    if ((pDev->bHeaderDone == VIDEO_FALSE) &&
+        (pDev->nHeaderMode == CODEC_OSAL_HEADER_MODE_SEPARATE)) {
+        pOut = &pDst->buf[FakeMFC_TakePending(pDst)];
+
+        FakeMFC_WritePlane(pDst, &pOut->planes[0], sFakeMFCHeader, sizeof(sFakeMFCHeader));
+        pOut->planes[0].bytesused = FAKE_MIN(sizeof(sFakeMFCHeader), pOut->planes[0].length);
+        memset(&pOut->timestamp, 0, sizeof(pOut->timestamp));
+        pOut->nFrameTag  = -1;
+        pOut->nFlags     = 0;
+        pOut->nV4L2Flags = 0;
+        pDev->bHeaderDone = VIDEO_TRUE;
+
+        FakeMFC_Complete(pDev, pDst, (int)(pOut - pDst->buf));
+        return VIDEO_TRUE;
+    }
+
+    if ((pSrc->bStreaming != VIDEO_TRUE) ||
+        (pSrc->pending.nCount == 0))
+        return VIDEO_FALSE;
+
+    nSrcIndex = FakeMFC_TakePending(pSrc);
+    nDstIndex = FakeMFC_TakePending(pDst);
+    pIn  = &pSrc->buf[nSrcIndex];
+
+    if (!(pIn->nFlags & EMPTY_DATA) &&
+        (FakeMFC_Process(pDev) != VIDEO_TRUE))
+        return VIDEO_TRUE;
+
+    pOut = &pDst->buf[nDstIndex];
+
+    if (pIn->nFlags & EMPTY_DATA) {
+        pOut->nV4L2Flags = 0;
+    } else {
+        nSize = pDev->config.nEncFrameSize;
+        if (nSize == 0)
+            nSize = (pSrc->nWidth * pSrc->nHeight) / 16;
+
+        if (pDev->bHeaderDone == VIDEO_FALSE) {
+            /* header with the 1st frame */
+            FakeMFC_WritePlane(pDst, &pOut->planes[0], sFakeMFCHeader, sizeof(sFakeMFCHeader));
+            nSize += sizeof(sFakeMFCHeader);
+            pDev->bHeaderDone = VIDEO_TRUE;
+        }
+
+        pOut->nV4L2Flags = ((pDev->nFrameCount % pDev->config.nGOP) == 0)? V4L2_BUF_FLAG_KEYFRAME:V4L2_BUF_FLAG_PFRAME;
+        pDev->nFrameCount++;
+    }
+
+    pOut->planes[0].bytesused = FAKE_MIN(nSize, pOut->planes[0].length);
+    pOut->timestamp = pIn->timestamp;
+    pOut->nFrameTag = pIn->nFrameTag;
+    pOut->nFlags    = pIn->nFlags & LAST_FRAME;
+
+    FakeMFC_Complete(pDev, pSrc, nSrcIndex);
+    FakeMFC_Complete(pDev, pDst, nDstIndex);
+
+    return VIDEO_TRUE;
+}
+
+static void *FakeMFC_Thread(void *pArg)
+{
+    FakeMFCDevice       *pDev      = (FakeMFCDevice *)pArg;
+    ExynosVideoBoolType  bProgress = VIDEO_FALSE;
+
+    pthread_mutex_lock(&pDev->lock);
+    while (pDev->bExit == VIDEO_FALSE) {
+        if (pDev->bEncoder == VIDEO_TRUE)
+            bProgress = FakeMFC_EncodeStep(pDev);
+        else
+            bProgress = FakeMFC_DecodeStep(pDev);
+
+        if (bProgress == VIDEO_FALSE)
+            pthread_cond_wait(&pDev->workCond, &pDev->lock);
+    }
+    pthread_mutex_unlock(&pDev->lock);
+
+    return NULL;
+}
+
+static void FakeMFC_PrintStat(FakeMFCDevice *pDev, const char *pName, FakeMFCStat *pStat)
+{
+    if (pStat->nFrames == 0)
+        return;
+
+    ALOGI("[fd %d] %s: %u buffers, qbuf->dqbuf avg %lld us, max %lld us",
+          pDev->hDevice, pName, pStat->nFrames,
+          pStat->nSumLatency / pStat->nFrames, pStat->nMaxLatency);
+}
+
+static void FakeMFC_Destroy(FakeMFCDevice *pDev)
+{
+    if (pDev->hDevice >= 0)
+        close(pDev->hDevice);
+
+    pthread_cond_destroy(&pDev->doneCond);
+    pthread_cond_destroy(&pDev->workCond);
+    pthread_mutex_destroy(&pDev->lock);
+    free(pDev);
+}
+
+static int FakeMFC_Open(const char *sDevName, int nFlag)
+{
+    FakeMFCDevice *pDev = NULL;
+    int i;
+
+    pDev = (FakeMFCDevice *)calloc(1, sizeof(*pDev));
+    if (pDev == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    FakeMFC_ParseConfig(&pDev->config);
+
+    pDev->bEncoder      = (strstr(sDevName, "-enc") != NULL)? VIDEO_TRUE:VIDEO_FALSE;
+    pDev->eState        = FAKE_STATE_INIT;
+    pDev->nDisplayDelay = (int)pDev->config.nDisplayDelay;
+    pDev->nPendingTag   = -1;
+    pDev->nDisplayTag   = -1;
+    pDev->dst.nPlane    = 2;
+
+    pthread_mutex_init(&pDev->lock, NULL);
+    pthread_cond_init(&pDev->workCond, NULL);
+    pthread_cond_init(&pDev->doneCond, NULL);
+
+    pDev->hDevice = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+    if (pDev->hDevice < 0) {
+        ALOGE("%s: failed to create eventfd", __FUNCTION__);
+        FakeMFC_Destroy(pDev);
+        return -1;
+    }
+
+    pthread_mutex_lock(&sFakeMFCLock);
+    for (i = 0; i < FAKE_MFC_MAX_DEVICES; i++) {
+        if (sFakeMFCDevices[i] == NULL) {
+            sFakeMFCDevices[i] = pDev;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sFakeMFCLock);
+
+    if (i == FAKE_MFC_MAX_DEVICES) {
+        ALOGE("%s: too many instances", __FUNCTION__);
+        FakeMFC_Destroy(pDev);
+        errno = EBUSY;
+        return -1;
+    }
+
+    if (pthread_create(&pDev->hThread, NULL, FakeMFC_Thread, pDev) != 0) {
+        ALOGE("%s: failed to create thread", __FUNCTION__);
+        pthread_mutex_lock(&sFakeMFCLock);
+        sFakeMFCDevices[i] = NULL;
+        pthread_mutex_unlock(&sFakeMFCLock);
+        FakeMFC_Destroy(pDev);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ALOGI("%s: %s is emulated as fd %d (%ux%u, dpb %u, delay %u, %u us/frame)", __FUNCTION__,
+          sDevName, pDev->hDevice, pDev->config.nWidth, pDev->config.nHeight,
+          pDev->config.nDPBNum, pDev->config.nDisplayDelay, pDev->config.nLatency);
+
+    return pDev->hDevice;
+}
+
+static int FakeMFC_Close(int hDevice)
+{
+    FakeMFCDevice *pDev = NULL;
+    int i;
+
+    pthread_mutex_lock(&sFakeMFCLock);
+    for (i = 0; i < FAKE_MFC_MAX_DEVICES; i++) {
+        if ((sFakeMFCDevices[i] != NULL) &&
+            (sFakeMFCDevices[i]->hDevice == hDevice)) {
+            pDev = sFakeMFCDevices[i];
+            sFakeMFCDevices[i] = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sFakeMFCLock);
+
+    if (pDev == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&pDev->lock);
+    pDev->bExit = VIDEO_TRUE;
+    pthread_cond_broadcast(&pDev->workCond);
+    pthread_cond_broadcast(&pDev->doneCond);
+    pthread_mutex_unlock(&pDev->lock);
+
+    pthread_join(pDev->hThread, NULL);
+
+    FakeMFC_PrintStat(pDev, "OUTPUT", &pDev->src.stat);
+    FakeMFC_PrintStat(pDev, "CAPTURE", &pDev->dst.stat);
+
+    FakeMFC_Destroy(pDev);
+
+    return 0;
+}
+
+static bool FakeMFC_QueryCap(int hDevice, unsigned int nCaps)
+{
+    return (FakeMFC_Lookup(hDevice) != NULL)? true:false;
+}
+
+static int FakeMFC_GetFormat(int hDevice, struct v4l2_format *pFmt)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+
+    struct timespec deadline;
+    unsigned int i;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pFmt->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    if ((pDev->bEncoder == VIDEO_FALSE) &&
+        (pQueue == &pDev->dst)) {
+        /* like MFC, wait for the header to be parsed */
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += FAKE_MFC_HEADER_TIMEOUT / 1000;
+
+        while ((pDev->eState == FAKE_STATE_INIT) &&
+               (pDev->bExit == VIDEO_FALSE)) {
+            if (pthread_cond_timedwait(&pDev->doneCond, &pDev->lock, &deadline) == ETIMEDOUT)
+                break;
+        }
+
+        if (pDev->eState == FAKE_STATE_INIT) {
+            errno = EAGAIN;
+            goto EXIT;
+        }
+    }
+
+    pFmt->fmt.pix_mp.pixelformat = pQueue->nPixelFormat;
+    pFmt->fmt.pix_mp.width       = pQueue->nWidth;
+    pFmt->fmt.pix_mp.height      = pQueue->nHeight;
+    pFmt->fmt.pix_mp.num_planes  = pQueue->nPlane;
+    pFmt->fmt.pix_mp.field       = V4L2_FIELD_NONE;
+
+    for (i = 0; i < pQueue->nPlane; i++)
+        pFmt->fmt.pix_mp.plane_fmt[i].sizeimage = pQueue->planeSize[i];
+    pFmt->fmt.pix_mp.plane_fmt[0].bytesperline = FAKE_ALIGN(pQueue->nWidth, 16);
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_SetFormat(int hDevice, struct v4l2_format *pFmt)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+
+    unsigned int i;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pFmt->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    pQueue->nPixelFormat = pFmt->fmt.pix_mp.pixelformat;
+    pQueue->nPlane       = FAKE_MIN(pFmt->fmt.pix_mp.num_planes, VIDEO_BUFFER_MAX_PLANES);
+
+    if ((pDev->bEncoder == VIDEO_FALSE) &&
+        (pQueue == &pDev->dst)) {
+        /* geometry of capture is decided by the stream */
+        if (pDev->eState != FAKE_STATE_INIT)
+            FakeMFC_UpdateDecFormat(pDev);
+    } else {
+        pQueue->nWidth  = pFmt->fmt.pix_mp.width;
+        pQueue->nHeight = pFmt->fmt.pix_mp.height;
+        for (i = 0; i < pQueue->nPlane; i++)
+            pQueue->planeSize[i] = pFmt->fmt.pix_mp.plane_fmt[i].sizeimage;
+    }
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_RequestBuf(int hDevice, struct v4l2_requestbuffers *pReqBuf)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pReqBuf->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    if ((pReqBuf->memory != V4L2_MEMORY_USERPTR) &&
+        (pReqBuf->memory != V4L2_MEMORY_DMABUF)) {
+        ALOGE("%s: only shared memory is supported", __FUNCTION__);
+        errno = EINVAL;
+        goto EXIT;
+    }
+
+    if (pQueue->bStreaming == VIDEO_TRUE) {
+        errno = EBUSY;
+        goto EXIT;
+    }
+
+    if (pReqBuf->count > VIDEO_BUFFER_MAX_NUM)
+        pReqBuf->count = VIDEO_BUFFER_MAX_NUM;
+
+    FakeMFC_ResetQueue(pDev, pQueue);
+    memset(pQueue->buf, 0, sizeof(pQueue->buf));
+    pQueue->nMemory = pReqBuf->memory;
+    pQueue->nCount  = pReqBuf->count;
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_QueryBuf(int hDevice, struct v4l2_buffer *pBuf)
+{
+    /* only needed for MMAP */
+    errno = EINVAL;
+
+    return -1;
+}
+
+static int FakeMFC_EnqueueBuf(int hDevice, struct v4l2_buffer *pBuf)
+{
+    FakeMFCDevice *pDev    = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue  = NULL;
+    FakeMFCBuffer *pBuffer = NULL;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pBuf->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    if ((pBuf->index >= pQueue->nCount) ||
+        (pBuf->memory != pQueue->nMemory) ||
+        (pQueue->buf[pBuf->index].eState != FAKE_BUF_DEQUEUED)) {
+        errno = EINVAL;
+        goto EXIT;
+    }
+
+    pBuffer = &pQueue->buf[pBuf->index];
+    pBuffer->nPlane = FAKE_MIN(pBuf->length, VIDEO_BUFFER_MAX_PLANES);
+    memcpy(pBuffer->planes, pBuf->m.planes, sizeof(struct v4l2_plane) * pBuffer->nPlane);
+
+    pBuffer->nFlags         = FAKE_MFC_BUF_FLAGS(pBuf);
+    pBuffer->nV4L2Flags     = 0;
+    pBuffer->timestamp      = pBuf->timestamp;
+    pBuffer->nFrameTag      = (pQueue == &pDev->src)? pDev->nPendingTag:-1;
+    pBuffer->nDisplayStatus = FAKE_DISPLAY_DECODING_ONLY;
+    pBuffer->nQueueTime     = FakeMFC_Now();
+    pBuffer->eState         = FAKE_BUF_QUEUED;
+
+    Fifo_Push(&pQueue->pending, pBuf->index);
+    pQueue->nOwned++;
+
+    pthread_cond_signal(&pDev->workCond);
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_DequeueBuf(int hDevice, struct v4l2_buffer *pBuf)
+{
+    FakeMFCDevice *pDev    = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue  = NULL;
+    FakeMFCBuffer *pBuffer = NULL;
+
+    unsigned long long nCount = 0;
+    long long nLatency = 0;
+    unsigned int i;
+    int nIndex;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pBuf->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    /* blocking node, same as vb2 : no wait when nothing is owned by the device */
+    while (pQueue->done.nCount == 0) {
+        if ((pQueue->bStreaming != VIDEO_TRUE) ||
+            (pQueue->nOwned == 0) ||
+            (pDev->bExit == VIDEO_TRUE)) {
+            errno = EINVAL;
+            goto EXIT;
+        }
+
+        pthread_cond_wait(&pDev->doneCond, &pDev->lock);
+    }
+
+    nIndex  = Fifo_Pop(&pQueue->done);
+    pBuffer = &pQueue->buf[nIndex];
+    pBuffer->eState = FAKE_BUF_DEQUEUED;
+    pQueue->nOwned--;
+
+    if (pQueue == &pDev->dst) {
+        if (read(pDev->hDevice, &nCount, sizeof(nCount)) != sizeof(nCount))
+            ALOGW("%s: fd(%d) is not signaled", __FUNCTION__, pDev->hDevice);
+
+        pDev->nDisplayTag    = pBuffer->nFrameTag;
+        pDev->nDisplayStatus = pBuffer->nDisplayStatus;
+    }
+
+    pBuf->index     = nIndex;
+    pBuf->flags     = pBuffer->nV4L2Flags;
+    pBuf->field     = V4L2_FIELD_NONE;
+    pBuf->timestamp = pBuffer->timestamp;
+    FAKE_MFC_BUF_FLAGS(pBuf) = pBuffer->nFlags;
+
+    for (i = 0; i < FAKE_MIN(pBuf->length, pBuffer->nPlane); i++)
+        pBuf->m.planes[i] = pBuffer->planes[i];
+
+    nLatency = FakeMFC_Now() - pBuffer->nQueueTime;
+    pQueue->stat.nFrames++;
+    pQueue->stat.nSumLatency += nLatency;
+    if (nLatency > pQueue->stat.nMaxLatency)
+        pQueue->stat.nMaxLatency = nLatency;
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_StreamOn(int hDevice, enum v4l2_buf_type eType)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, eType);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    pQueue->bStreaming = VIDEO_TRUE;
+
+    if ((pQueue == &pDev->dst) &&
+        (pDev->eState == FAKE_STATE_RES_CHANGE)) {
+        pDev->nCheckState = 0;
+        pDev->eState      = FAKE_STATE_RUNNING;
+    }
+
+    pthread_cond_signal(&pDev->workCond);
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_StreamOff(int hDevice, enum v4l2_buf_type eType)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, eType);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    pQueue->bStreaming = VIDEO_FALSE;
+    FakeMFC_ResetQueue(pDev, pQueue);
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_GetCrop(int hDevice, struct v4l2_crop *pCrop)
+{
+    FakeMFCDevice *pDev   = FakeMFC_Lookup(hDevice);
+    FakeMFCQueue  *pQueue = NULL;
+    int ret = -1;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    pQueue = FakeMFC_GetQueue(pDev, pCrop->type);
+    if (pQueue == NULL)
+        goto EXIT;
+
+    pCrop->c.left   = 0;
+    pCrop->c.top    = 0;
+    pCrop->c.width  = pQueue->nWidth;
+    pCrop->c.height = pQueue->nHeight;
+
+    ret = 0;
+
+EXIT:
+    pthread_mutex_unlock(&pDev->lock);
+
+    return ret;
+}
+
+static int FakeMFC_GetControl(int hDevice, unsigned int nCID, int *pValue)
+{
+    FakeMFCDevice *pDev = FakeMFC_Lookup(hDevice);
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+
+    switch (nCID) {
+    case CODEC_OSAL_CID_DEC_NUM_MIN_BUFFERS:
+        *pValue = (int)pDev->config.nDPBNum;
+        break;
+    case CODEC_OSAL_CID_DEC_DISPLAY_STATUS:
+        *pValue = pDev->nDisplayStatus;
+        break;
+    case CODEC_OSAL_CID_DEC_CHECK_STATE:
+        *pValue = pDev->nCheckState;
+        break;
+    case CODEC_OSAL_CID_DEC_ACTUAL_FORMAT:
+        *pValue = (int)pDev->dst.nPixelFormat;
+        break;
+    case CODEC_OSAL_CID_VIDEO_FRAME_TAG:
+        *pValue = pDev->nDisplayTag;
+        break;
+    case CODEC_OSAL_CID_VIDEO_GET_VERSION_INFO:
+        *pValue = (int)pDev->config.nHwVersion;
+        break;
+    default:
+        /* no extra feature is reported */
+        *pValue = 0;
+        break;
+    }
+
+    pthread_mutex_unlock(&pDev->lock);
+
+    return 0;
+}
+
+static void FakeMFC_ApplyControl(FakeMFCDevice *pDev, unsigned int nCID, int nValue)
+{
+    switch (nCID) {
+    case CODEC_OSAL_CID_VIDEO_FRAME_TAG:
+        pDev->nPendingTag = nValue;
+        break;
+    case CODEC_OSAL_CID_DEC_DISPLAY_DELAY:
+        if (nValue >= 0)
+            pDev->nDisplayDelay = nValue;
+        break;
+    case CODEC_OSAL_CID_DEC_IMMEDIATE_DISPLAY:
+        if (nValue != 0)
+            pDev->nDisplayDelay = 0;
+        break;
+    case CODEC_OSAL_CID_ENC_HEADER_MODE:
+        pDev->nHeaderMode = nValue;
+        break;
+    default:
+        break;
+    }
+}
+
+static int FakeMFC_SetControl(int hDevice, unsigned int nCID, int nValue)
+{
+    FakeMFCDevice *pDev = FakeMFC_Lookup(hDevice);
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+    FakeMFC_ApplyControl(pDev, nCID, nValue);
+    pthread_mutex_unlock(&pDev->lock);
+
+    return 0;
+}
+
+static int FakeMFC_GetExtControls(int hDevice, struct v4l2_ext_controls *pCtrls)
+{
+    /* values are left as the caller initialized */
+    return (FakeMFC_Lookup(hDevice) != NULL)? 0:-1;
+}
+
+static int FakeMFC_SetExtControls(int hDevice, struct v4l2_ext_controls *pCtrls)
+{
+    FakeMFCDevice *pDev = FakeMFC_Lookup(hDevice);
+    unsigned int i;
+
+    if (pDev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&pDev->lock);
+    for (i = 0; i < pCtrls->count; i++)
+        FakeMFC_ApplyControl(pDev, pCtrls->controls[i].id, pCtrls->controls[i].value);
+    pthread_mutex_unlock(&pDev->lock);
+
+    return 0;
+}
+
+static const CodecOSAL_DevOps fakeDevOps = {
+    .Open           = FakeMFC_Open,
+    .Close          = FakeMFC_Close,
+    .QueryCap       = FakeMFC_QueryCap,
+    .GetFormat      = FakeMFC_GetFormat,
+    .SetFormat      = FakeMFC_SetFormat,
+    .RequestBuf     = FakeMFC_RequestBuf,
+    .QueryBuf       = FakeMFC_QueryBuf,
+    .EnqueueBuf     = FakeMFC_EnqueueBuf,
+    .DequeueBuf     = FakeMFC_DequeueBuf,
+    .StreamOn       = FakeMFC_StreamOn,
+    .StreamOff      = FakeMFC_StreamOff,
+    .GetCrop        = FakeMFC_GetCrop,
+    .GetControl     = FakeMFC_GetControl,
+    .SetControl     = FakeMFC_SetControl,
+    .GetExtControls = FakeMFC_GetExtControls,
+    .SetExtControls = FakeMFC_SetExtControls,
+};
+
+ExynosVideoBoolType Codec_OSAL_Fake_IsEnabled(void)
+{
+    const char *pEnv = getenv(CODEC_OSAL_FAKE_MFC_ENV);
+
+    if ((pEnv == NULL) ||
+        (pEnv[0] == '\0') ||
+        (strcmp(pEnv, "0") == 0))
+        return VIDEO_FALSE;
+
+    return VIDEO_TRUE;
+}
+
+const CodecOSAL_DevOps *Codec_OSAL_Fake_GetDevOps(void)
+{
+    return &fakeDevOps;
+}
@@ -182,8 +182,58 @@ typedef struct _CodecOSAL_Buffer {
 
 typedef struct v4l2_requestbuffers CodecOSAL_ReqBuf;
 
+#define CODEC_OSAL_BUFINDEX_MAX_NUM     VIDEO_BUFFER_MAX_NUM
+#define CODEC_OSAL_BUFINDEX_HASH_BITS   6   /* 2x of max num, keeps probing short */
+#define CODEC_OSAL_BUFINDEX_HASH_SIZE   (1 << CODEC_OSAL_BUFINDEX_HASH_BITS)
+
+typedef struct _CodecOSAL_BufHash {
+    unsigned long   key[CODEC_OSAL_BUFINDEX_HASH_SIZE];     /* 0 : empty */
+    int             slot[CODEC_OSAL_BUFINDEX_HASH_SIZE];
+} CodecOSAL_BufHash;
+
+/*
+ * mirror of ExynosVideoBuffer[] state for O(1) slot lookup.
+ * it must be refreshed whenever bQueued, bSlotUsed or planes[0] of a slot
+ * is changed. nBufferNum 0 means the index is not usable and callers scan.
+ */
+typedef struct _CodecOSAL_BufIndex {
+    int                 nBufferNum;
+    unsigned int        nQueuedMask;
+    unsigned int        nUsedMask;
+    unsigned long       addrKey[CODEC_OSAL_BUFINDEX_MAX_NUM];
+    unsigned long       fdKey[CODEC_OSAL_BUFINDEX_MAX_NUM];
+    CodecOSAL_BufHash   addrHash;
+    CodecOSAL_BufHash   fdHash;
+} CodecOSAL_BufIndex;
+
+/*
+ * device backend. default one is the MFC node through exynos_v4l2_*,
+ * the others have to keep the V4L2 ioctl semantics including errno.
+ */
+typedef struct _CodecOSAL_DevOps {
+    int  (*Open)(const char *sDevName, int nFlag);
+    int  (*Close)(int hDevice);
+    bool (*QueryCap)(int hDevice, unsigned int nCaps);
+    int  (*GetFormat)(int hDevice, struct v4l2_format *pFmt);
+    int  (*SetFormat)(int hDevice, struct v4l2_format *pFmt);
+    int  (*RequestBuf)(int hDevice, struct v4l2_requestbuffers *pReqBuf);
+    int  (*QueryBuf)(int hDevice, struct v4l2_buffer *pBuf);
+    int  (*EnqueueBuf)(int hDevice, struct v4l2_buffer *pBuf);
+    int  (*DequeueBuf)(int hDevice, struct v4l2_buffer *pBuf);
+    int  (*StreamOn)(int hDevice, enum v4l2_buf_type eType);
+    int  (*StreamOff)(int hDevice, enum v4l2_buf_type eType);
+    int  (*GetCrop)(int hDevice, struct v4l2_crop *pCrop);
+    int  (*GetControl)(int hDevice, unsigned int nCID, int *pValue);
+    int  (*SetControl)(int hDevice, unsigned int nCID, int nValue);
+    int  (*GetExtControls)(int hDevice, struct v4l2_ext_controls *pCtrls);
+    int  (*SetExtControls)(int hDevice, struct v4l2_ext_controls *pCtrls);
+} CodecOSAL_DevOps;
+
 typedef struct _CodecOSALInfo {
     int reserved;
+    const CodecOSAL_DevOps *pDevOps;
+    CodecOSAL_BufIndex inbufIndex;
+    CodecOSAL_BufIndex outbufIndex;
 } CodecOSALInfo;
 
 typedef struct _CodecOSALVideoContext {
@@ -222,6 +272,13 @@ int Codec_OSAL_QueryBuf(CodecOSALVideoContext *pCtx, CodecOSAL_Buffer *pBuf);
 int Codec_OSAL_SetStreamOn(CodecOSALVideoContext *pCtx, int nPort);
 int Codec_OSAL_SetStreamOff(CodecOSALVideoContext *pCtx, int nPort);
 
+void Codec_OSAL_BufIndex_Rebuild(CodecOSAL_BufIndex *pIndex, ExynosVideoBuffer *pBuffers, int nBufferNum);
+void Codec_OSAL_BufIndex_Update(CodecOSAL_BufIndex *pIndex, ExynosVideoBuffer *pBuffers, int nSlot);
+int Codec_OSAL_BufIndex_IsEnabled(CodecOSAL_BufIndex *pIndex);
+int Codec_OSAL_BufIndex_FindByAddr(CodecOSAL_BufIndex *pIndex, void *pAddr);
+int Codec_OSAL_BufIndex_FindByFd(CodecOSAL_BufIndex *pIndex, unsigned long nFd);
+int Codec_OSAL_BufIndex_FindFree(CodecOSAL_BufIndex *pIndex, ExynosVideoBoolType bSkipUsed);
+
 void *Codec_OSAL_MemoryMap(void *addr, size_t len, int prot, int flags, unsigned long fd, off_t offset);
 int Codec_OSAL_MemoryUnmap(void *addr, size_t len);
 #endif
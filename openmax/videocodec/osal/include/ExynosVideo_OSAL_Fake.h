@@ -0,0 +1,52 @@
+/*
+ *
+ * Copyright 2019 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file    ExynosVideo_OSAL_Fake.h
+ * @brief   ExynosVideo OSAL define related with the fake MFC device
+ * @version    1.0.0
+ * @history
+ *   2019.05.08 : Create
+ */
+
+#ifndef _EXYNOS_VIDEO_OSAL_FAKE_H_
+#define _EXYNOS_VIDEO_OSAL_FAKE_H_
+
+#include "ExynosVideoApi.h"
+#include "ExynosVideo_OSAL.h"
+
+/*
+ * the fake device is used instead of the MFC node when this environment
+ * variable is set. the value is a comma separated list of key=value,
+ * any value without a known key (ex. "1") just enables the defaults.
+ *
+ *   w, h                 : stream resolution reported after header parsing
+ *   dpb                  : minimum number of capture buffers
+ *   delay                : decoded frames held before display (DPB delay)
+ *   lat                  : processing time per frame in us
+ *   resize_at            : frame number that triggers a resolution change
+ *   resize_w, resize_h   : resolution after the change
+ *   enc_size             : bytes per encoded frame
+ *   gop                  : key frame interval of encoded frames
+ *   ver                  : HW version reported to the client
+ */
+#define CODEC_OSAL_FAKE_MFC_ENV     "EXYNOS_VIDEO_FAKE_MFC"
+
+ExynosVideoBoolType Codec_OSAL_Fake_IsEnabled(void);
+const CodecOSAL_DevOps *Codec_OSAL_Fake_GetDevOps(void);
+
+#endif
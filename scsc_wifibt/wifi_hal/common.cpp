@@ -50,16 +50,81 @@ wifi_interface_handle getIfaceHandle(interface_info *info)
     return (wifi_interface_handle)info;
 }
 
+static inline unsigned int event_cb_hash(int cmd, uint32_t vendor_id, int subcmd)
+{
+    uint32_t hash = (uint32_t)cmd * 0x9E3779B1U;
+
+    hash ^= vendor_id * 0x85EBCA77U;
+    hash ^= (uint32_t)subcmd * 0xC2B2AE3DU;
+    hash ^= hash >> 15;
+
+    return hash & (EVENT_CB_HASH_SIZE - 1);
+}
+
+static inline bool event_cb_match(cb_info *cbi, int cmd, uint32_t vendor_id, int subcmd)
+{
+    return cbi->nl_cmd == cmd && cbi->vendor_id == vendor_id && cbi->vendor_subcmd == subcmd;
+}
+
+/* Indexes event_cb by (cmd, vendor_id, subcmd), the first handler of a key wins as in the
+ * former linear scan. Must be called with cb_lock and cb_hash_lock for writing held. */
+static void wifi_rebuild_event_cb_hash(hal_info *info)
+{
+    memset(info->event_cb_hash, 0, sizeof(info->event_cb_hash));
+
+    for (int i = 0; i < info->num_event_cb; i++) {
+        cb_info *cbi = &info->event_cb[i];
+        unsigned int slot = event_cb_hash(cbi->nl_cmd, cbi->vendor_id, cbi->vendor_subcmd);
+
+        while (info->event_cb_hash[slot] != 0
+                && !event_cb_match(&info->event_cb[info->event_cb_hash[slot] - 1],
+                        cbi->nl_cmd, cbi->vendor_id, cbi->vendor_subcmd)) {
+            slot = (slot + 1) & (EVENT_CB_HASH_SIZE - 1);
+        }
+        if (info->event_cb_hash[slot] == 0)
+            info->event_cb_hash[slot] = i + 1;
+    }
+}
+
+/* Returns the index of the event handler or -1, must be called with cb_hash_lock held.
+ * Non vendor events have vendor_id and subcmd 0 as their handlers. */
+int wifi_find_event_cb(hal_info *info, int cmd, uint32_t vendor_id, int subcmd)
+{
+    unsigned int slot = event_cb_hash(cmd, vendor_id, subcmd);
+
+    while (info->event_cb_hash[slot] != 0) {
+        int i = info->event_cb_hash[slot] - 1;
+        if (event_cb_match(&info->event_cb[i], cmd, vendor_id, subcmd))
+            return i;
+        slot = (slot + 1) & (EVENT_CB_HASH_SIZE - 1);
+    }
+
+    return -1;
+}
+
+static void wifi_log_event_cb_stats(cb_info *cbi)
+{
+    if (cbi->num_events == 0)
+        return;
+
+    ALOGD("Event handler cmd %d vendor 0x%0x subcmd 0x%0x: %u events, avg %llu us, max %llu us",
+            cbi->nl_cmd, cbi->vendor_id, cbi->vendor_subcmd, cbi->num_events,
+            (unsigned long long)(cbi->dispatch_ns / cbi->num_events / 1000),
+            (unsigned long long)(cbi->max_dispatch_ns / 1000));
+}
+
 wifi_error wifi_register_handler(wifi_handle handle, int cmd, nl_recvmsg_msg_cb_t func, void *arg)
 {
     hal_info *info = (hal_info *)handle;
 
     /* TODO: check for multiple handlers? */
     pthread_mutex_lock(&info->cb_lock);
+    pthread_rwlock_wrlock(&info->cb_hash_lock);
 
     wifi_error result = WIFI_ERROR_OUT_OF_MEMORY;
 
     if (info->num_event_cb < info->alloc_event_cb) {
+        memset(&info->event_cb[info->num_event_cb], 0, sizeof(cb_info));
         info->event_cb[info->num_event_cb].nl_cmd  = cmd;
         info->event_cb[info->num_event_cb].vendor_id  = 0;
         info->event_cb[info->num_event_cb].vendor_subcmd  = 0;
@@ -69,9 +134,11 @@ wifi_error wifi_register_handler(wifi_handle handle, int cmd, nl_recvmsg_msg_cb_
         ALOGI("Successfully added event handler %p:%p for command %d at %d",
                 arg, func, cmd, info->num_event_cb);*/
         info->num_event_cb++;
+        wifi_rebuild_event_cb_hash(info);
         result = WIFI_SUCCESS;
     }
 
+    pthread_rwlock_unlock(&info->cb_hash_lock);
     pthread_mutex_unlock(&info->cb_lock);
     return result;
 }
@@ -84,12 +151,14 @@ wifi_error wifi_register_vendor_handler(wifi_handle handle,
 //ALOGD("GSCAN register handle wifi_register_vendor_handler %p", handle);
     /* TODO: check for multiple handlers? */
     pthread_mutex_lock(&info->cb_lock);
+    pthread_rwlock_wrlock(&info->cb_hash_lock);
     //ALOGI("Added event handler %p", info);
 
     wifi_error result = WIFI_ERROR_OUT_OF_MEMORY;
 
     //    ALOGD("register_vendor_handler: handle = %p", handle);
     if (info->num_event_cb < info->alloc_event_cb) {
+        memset(&info->event_cb[info->num_event_cb], 0, sizeof(cb_info));
         info->event_cb[info->num_event_cb].nl_cmd  = NL80211_CMD_VENDOR;
         info->event_cb[info->num_event_cb].vendor_id  = id;
         info->event_cb[info->num_event_cb].vendor_subcmd  = subcmd;
@@ -99,9 +168,11 @@ wifi_error wifi_register_vendor_handler(wifi_handle handle,
         ALOGI("Added event handler %p:%p for vendor 0x%0x and subcmd 0x%0x at %d",
                 arg, func, id, subcmd, info->num_event_cb);*/
         info->num_event_cb++;
+        wifi_rebuild_event_cb_hash(info);
         result = WIFI_SUCCESS;
     }
 
+    pthread_rwlock_unlock(&info->cb_hash_lock);
     pthread_mutex_unlock(&info->cb_lock);
     return result;
 }
@@ -116,20 +187,24 @@ void wifi_unregister_handler(wifi_handle handle, int cmd)
     }
 
     pthread_mutex_lock(&info->cb_lock);
+    pthread_rwlock_wrlock(&info->cb_hash_lock);
 
     for (int i = 0; i < info->num_event_cb; i++) {
         if (info->event_cb[i].nl_cmd == cmd) {
             /*
             ALOGI("Successfully removed event handler %p:%p for cmd = 0x%0x from %d",
                     info->event_cb[i].cb_arg, info->event_cb[i].cb_func, cmd, i);*/
+            wifi_log_event_cb_stats(&info->event_cb[i]);
 
             memmove(&info->event_cb[i], &info->event_cb[i+1],
                 (info->num_event_cb - i - 1) * sizeof(cb_info));
             info->num_event_cb--;
+            wifi_rebuild_event_cb_hash(info);
             break;
         }
     }
 
+    pthread_rwlock_unlock(&info->cb_hash_lock);
     pthread_mutex_unlock(&info->cb_lock);
 }
 
@@ -138,6 +213,7 @@ void wifi_unregister_vendor_handler(wifi_handle handle, uint32_t id, int subcmd)
     hal_info *info = (hal_info *)handle;
 
     pthread_mutex_lock(&info->cb_lock);
+    pthread_rwlock_wrlock(&info->cb_hash_lock);
 
     for (int i = 0; i < info->num_event_cb; i++) {
 
@@ -147,13 +223,16 @@ void wifi_unregister_vendor_handler(wifi_handle handle, uint32_t id, int subcmd)
             /*
             ALOGI("Successfully removed event handler %p:%p for vendor 0x%0x, subcmd 0x%0x from %d",
                     info->event_cb[i].cb_arg, info->event_cb[i].cb_func, id, subcmd, i);*/
+            wifi_log_event_cb_stats(&info->event_cb[i]);
             memmove(&info->event_cb[i], &info->event_cb[i+1],
                 (info->num_event_cb - i - 1) * sizeof(cb_info));
             info->num_event_cb--;
+            wifi_rebuild_event_cb_hash(info);
             break;
         }
     }
 
+    pthread_rwlock_unlock(&info->cb_hash_lock);
     pthread_mutex_unlock(&info->cb_lock);
 }
 
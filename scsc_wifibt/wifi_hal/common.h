@@ -17,6 +17,7 @@
 #define RECV_BUF_SIZE           (4096)
 #define DEFAULT_EVENT_CB_SIZE   (64)
 #define DEFAULT_CMD_SIZE        (64)
+#define EVENT_CB_HASH_SIZE      (DEFAULT_EVENT_CB_SIZE * 2)    // power of 2
 #define DOT11_OUI_LEN             3
 
 typedef struct {
@@ -231,6 +232,9 @@ typedef struct {
     int vendor_subcmd;
     nl_recvmsg_msg_cb_t cb_func;
     void *cb_arg;
+    uint32_t num_events;                            // events dispatched to the handler
+    uint64_t dispatch_ns;                           // total time spent in the handler
+    uint64_t max_dispatch_ns;
 } cb_info;
 
 typedef struct {
@@ -261,6 +265,11 @@ typedef struct {
     int num_event_cb;                               // number of event callbacks
     int alloc_event_cb;                             // number of allocated callback objects
     pthread_mutex_t cb_lock;                        // mutex for the event_cb access
+    short event_cb_hash[EVENT_CB_HASH_SIZE];        // index + 1 of event_cb by (cmd, vendor, subcmd)
+    pthread_rwlock_t cb_hash_lock;                  // read by the event loop, written with cb_lock
+    uint32_t num_unhandled_events;
+    bool event_sock_nonblocking;                    // event socket is drained in batches
+    uint32_t num_event_overruns;                    // events dropped by the kernel (ENOBUFS)
 
     cmd_info *cmd;                                  // Outstanding commands
     int num_cmd;                                    // number of commands
@@ -280,6 +289,7 @@ wifi_error wifi_register_vendor_handler(wifi_handle handle,
 
 void wifi_unregister_handler(wifi_handle handle, int cmd);
 void wifi_unregister_vendor_handler(wifi_handle handle, uint32_t id, int subcmd);
+int wifi_find_event_cb(hal_info *info, int cmd, uint32_t vendor_id, int subcmd);
 
 wifi_error wifi_register_cmd(wifi_handle handle, int id, WifiCommand *cmd);
 WifiCommand *wifi_unregister_cmd(wifi_handle handle, int id);
@@ -487,8 +487,9 @@ void WifiEvent::log() {
         ALOGD("%s", line);
     }
 
+    nlattr **attrs = attributes();
     for (unsigned i = 0; i < NL80211_ATTR_MAX_INTERNAL; i++) {
-        if (mAttributes[i] != NULL) {
+        if (attrs[i] != NULL) {
             ALOGD("found attribute %s", attributeToString(i));
         }
     }
@@ -499,15 +500,48 @@ const char *WifiEvent::get_cmdString() {
 }
 
 
+/* Only checks the header, attributes are looked up when a handler asks for them */
 int WifiEvent::parse() {
     if (mHeader != NULL) {
         return WIFI_SUCCESS;
     }
-    mHeader = (genlmsghdr *)nlmsg_data(nlmsg_hdr(mMsg));
-    int result = nla_parse(mAttributes, NL80211_ATTR_MAX_INTERNAL, genlmsg_attrdata(mHeader, 0),
-          genlmsg_attrlen(mHeader, 0), NULL);
+    struct nlmsghdr *nlh = nlmsg_hdr(mMsg);
+    if (!genlmsg_valid_hdr(nlh, 0)) {
+        return -NLE_MSG_TOOSHORT;
+    }
+    mHeader = (genlmsghdr *)nlmsg_data(nlh);
+
+    return WIFI_SUCCESS;
+}
+
+/* Same result as nla_parse() for one attribute: the last occurrence wins */
+nlattr *WifiEvent::find_attribute(int attribute) {
+    struct nlattr *found = NULL;
+
+    if (mHeader != NULL && attribute > 0) {
+        struct nlattr *attr;
+        int rem;
+        nla_for_each_attr(attr, genlmsg_attrdata(mHeader, 0), genlmsg_attrlen(mHeader, 0), rem) {
+            if (nla_type(attr) == attribute) {
+                found = attr;
+            }
+        }
+    }
+
+    mAttributes[attribute] = found;
+    mResolved[attribute / 32] |= 1U << (attribute % 32);
+    return found;
+}
 
-    return result;
+nlattr ** WifiEvent::attributes() {
+    if (mHeader == NULL) {
+        memset(mAttributes, 0, sizeof(mAttributes));
+    } else {
+        nla_parse(mAttributes, NL80211_ATTR_MAX_INTERNAL, genlmsg_attrdata(mHeader, 0),
+                genlmsg_attrlen(mHeader, 0), NULL);
+    }
+    memset(mResolved, 0xff, sizeof(mResolved));
+    return mAttributes;
 }
 
 int WifiRequest::create(int family, uint8_t cmd, int flags, int hdrlen) {
@@ -10,13 +10,18 @@ class WifiEvent
 private:
     struct nl_msg *mMsg;
     struct genlmsghdr *mHeader;
+    /* Attributes are looked up on first use, an entry of mAttributes is only valid once
+     * its bit is set in mResolved */
     struct nlattr *mAttributes[NL80211_ATTR_MAX_INTERNAL + 1];
+    uint32_t mResolved[NL80211_ATTR_MAX_INTERNAL / 32 + 1];
+
+    nlattr *find_attribute(int attribute);
 
 public:
     WifiEvent(nl_msg *msg) {
         mMsg = msg;
         mHeader = NULL;
-        memset(mAttributes, 0, sizeof(mAttributes));
+        memset(mResolved, 0, sizeof(mResolved));
     }
     ~WifiEvent() {
         /* don't destroy mMsg; it doesn't belong to us */
@@ -52,36 +57,47 @@ public:
 
     const char *get_cmdString();
 
-    nlattr ** attributes() {
-        return mAttributes;
-    }
+    /* parses every attribute, use get_attribute() where only a few are needed */
+    nlattr ** attributes();
 
     nlattr *get_attribute(int attribute) {
-        return mAttributes[attribute];
+        if (attribute < 0 || attribute > (int)NL80211_ATTR_MAX_INTERNAL) {
+            return NULL;
+        }
+        if (mResolved[attribute / 32] & (1U << (attribute % 32))) {
+            return mAttributes[attribute];
+        }
+        return find_attribute(attribute);
     }
 
     uint8_t get_u8(int attribute) {
-        return mAttributes[attribute] ? nla_get_u8(mAttributes[attribute]) : 0;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_get_u8(attr) : 0;
     }
 
     uint16_t get_u16(int attribute) {
-        return mAttributes[attribute] ? nla_get_u16(mAttributes[attribute]) : 0;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_get_u16(attr) : 0;
     }
 
     uint32_t get_u32(int attribute) {
-        return mAttributes[attribute] ? nla_get_u32(mAttributes[attribute]) : 0;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_get_u32(attr) : 0;
     }
 
     uint64_t get_u64(int attribute) {
-        return mAttributes[attribute] ? nla_get_u64(mAttributes[attribute]) : 0;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_get_u64(attr) : 0;
     }
 
     int get_len(int attribute) {
-        return mAttributes[attribute] ? nla_len(mAttributes[attribute]) : 0;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_len(attr) : 0;
     }
 
     void *get_data(int attribute) {
-        return mAttributes[attribute] ? nla_data(mAttributes[attribute]) : NULL;
+        nlattr *attr = get_attribute(attribute);
+        return attr ? nla_data(attr) : NULL;
     }
 
 private:
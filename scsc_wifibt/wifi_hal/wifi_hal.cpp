@@ -1,6 +1,7 @@
 #include <errno.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <netlink/genl/genl.h>
@@ -35,6 +36,8 @@
 
 #define WIFI_HAL_CMD_SOCK_PORT       644
 #define WIFI_HAL_EVENT_SOCK_PORT     645
+#define WIFI_HAL_EVENT_SOCK_RCVBUF   (4 * 1024 * 1024)  // scan and RTT results come in bursts
+#define WIFI_HAL_EVENT_BATCH_MAX     64                 // datagrams handled per wakeup
 
 #define FEATURE_SET                  0
 #define FEATURE_SET_MATRIX           1
@@ -287,6 +290,28 @@ static nl_sock * wifi_create_nl_socket(int port)
     return sock;
 }
 
+/* The event socket is read in batches from the event loop; make it non blocking so the loop
+ * can tell when it is empty, and give it room for bursts of events between wakeups. */
+static void wifi_configure_event_socket(hal_info *info, struct nl_sock *sock)
+{
+    int fd = nl_socket_get_fd(sock);
+    int rcvbuf = WIFI_HAL_EVENT_SOCK_RCVBUF;
+
+    /* SO_RCVBUFFORCE is not limited by rmem_max, but needs CAP_NET_ADMIN */
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+        if (nl_socket_set_buffer_size(sock, rcvbuf, 0) < 0)
+            ALOGE("Could not set event socket buffer size");
+    }
+
+    /* large enough for most scan results without a retry on truncation */
+    if (nl_socket_set_msg_buf_size(sock, SOCKET_BUFFER_SIZE) < 0)
+        ALOGE("Could not set event message buffer size");
+
+    info->event_sock_nonblocking = (nl_socket_set_nonblocking(sock) == 0);
+    if (!info->event_sock_nonblocking)
+        ALOGE("Could not set event socket non blocking, reading one message per wakeup");
+}
+
 
 wifi_error wifi_configure_nd_offload(wifi_interface_handle handle, u8 enable)
 {
@@ -470,6 +495,7 @@ wifi_error wifi_initialize(wifi_handle *handle)
 
     info->cmd_sock = cmd_sock;
     info->event_sock = event_sock;
+    wifi_configure_event_socket(info, event_sock);
     info->clean_up = false;
     info->in_event_loop = false;
 
@@ -491,6 +517,7 @@ wifi_error wifi_initialize(wifi_handle *handle)
     }
 
     pthread_mutex_init(&info->cb_lock, NULL);
+    pthread_rwlock_init(&info->cb_hash_lock, NULL);
 
     *handle = (wifi_handle) info;
     wifi_add_membership(*handle, "scan");
@@ -546,6 +573,7 @@ static void internal_cleaned_up_handler(wifi_handle handle)
     }
 
     (*cleaned_up_handler)(handle);
+    pthread_rwlock_destroy(&info->cb_hash_lock);
     pthread_mutex_destroy(&info->cb_lock);
     free(info);
 }
@@ -597,17 +625,38 @@ void wifi_cleanup(wifi_handle handle, wifi_cleaned_up_handler handler)
         WifiCommand *cmd = (WifiCommand *)cbi->cb_arg;
         ALOGE("Leaked command %p", cmd);
     }
+    if (info->num_unhandled_events)
+        ALOGD("%u events had no handler", info->num_unhandled_events);
+    if (info->num_event_overruns)
+        ALOGD("%u event socket overruns", info->num_event_overruns);
     pthread_mutex_unlock(&info->cb_lock);
     internal_cleaned_up_handler(handle);
 }
 
+/* Each nl_recvmsgs_report() handles the messages of one datagram and returns 0 once the
+ * non blocking socket is empty, so a burst of events is drained within a single wakeup.
+ * The batch is bounded to let the loop look at the cleanup socket in between. */
 static int internal_pollin_handler(wifi_handle handle)
 {
     hal_info *info = getHalInfo(handle);
     struct nl_cb *cb = nl_socket_get_cb(info->event_sock);
-    int res = nl_recvmsgs(info->event_sock, cb);
+    int batch = info->event_sock_nonblocking ? WIFI_HAL_EVENT_BATCH_MAX : 1;
+    int res = 0;
+
+    for (int i = 0; i < batch; i++) {
+        res = nl_recvmsgs_report(info->event_sock, cb);
+        if (res == -NLE_NOMEM) {
+            /* ENOBUFS: the socket overran and the kernel dropped events, keep reading */
+            info->num_event_overruns++;
+            ALOGE("Event socket overrun, %u so far", info->num_event_overruns);
+            continue;
+        }
+        if (res <= 0)
+            break;
+    }
+
     nl_cb_put(cb);
-    return res;
+    return res < 0 ? res : 0;
 }
 
 /* Run event handler */
@@ -637,9 +686,10 @@ void wifi_event_loop(wifi_handle handle)
         int result = poll(pfd, 2, timeout);
         if (result < 0) {
         } else if (pfd[0].revents & POLLERR) {
+            /* socket overrun (ENOBUFS), the handler reports it and keeps the queued events */
             int prev_err = (int)errno;
-            int result2 = read(pfd[0].fd, buf, sizeof(buf));
-            ALOGE("Poll err:%d | Read after POLL returned %d, error no = %d", prev_err, result2, errno);
+            int result2 = internal_pollin_handler(handle);
+            ALOGE("Poll err:%d | Read after POLL returned %d", prev_err, result2);
         } else if (pfd[0].revents & POLLHUP) {
             ALOGE("Remote side hung up");
             break;
@@ -671,6 +721,14 @@ static int internal_no_seq_check(struct nl_msg *msg, void *arg)
     return NL_OK;
 }
 
+static uint64_t internal_get_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 static int internal_valid_message_handler(nl_msg *msg, void *arg)
 {
     wifi_handle handle = (wifi_handle)arg;
@@ -698,38 +756,48 @@ static int internal_valid_message_handler(nl_msg *msg, void *arg)
      //ALOGI("event received %s, vendor_id = 0x%0x", event.get_cmdString(), vendor_id);
      //event.log();
 
-    pthread_mutex_lock(&info->cb_lock);
+    /* Only this thread dispatches events, so the handler statistics are updated under
+     * the read lock; registration and removal take it for writing. */
+    pthread_rwlock_rdlock(&info->cb_hash_lock);
 
-    for (int i = 0; i < info->num_event_cb; i++) {
-        if (cmd == info->event_cb[i].nl_cmd) {
-            if (cmd == NL80211_CMD_VENDOR
-                && ((vendor_id != info->event_cb[i].vendor_id)
-                || (subcmd != info->event_cb[i].vendor_subcmd)))
-            {
-                /* event for a different vendor, ignore it */
-                continue;
-            }
+    int i = wifi_find_event_cb(info, cmd, vendor_id, subcmd);
+    if (i < 0) {
+        info->num_unhandled_events++;
+        pthread_rwlock_unlock(&info->cb_hash_lock);
+        return NL_OK;
+    }
 
-            cb_info *cbi = &(info->event_cb[i]);
-            nl_recvmsg_msg_cb_t cb_func = cbi->cb_func;
-            void *cb_arg = cbi->cb_arg;
-            WifiCommand *cmd = (WifiCommand *)cbi->cb_arg;
-            if (cmd != NULL) {
-                cmd->addRef();
-            }
+    cb_info *cbi = &(info->event_cb[i]);
+    nl_recvmsg_msg_cb_t cb_func = cbi->cb_func;
+    void *cb_arg = cbi->cb_arg;
+    WifiCommand *wcmd = (WifiCommand *)cbi->cb_arg;
+    if (wcmd != NULL) {
+        wcmd->addRef();
+    }
 
-            pthread_mutex_unlock(&info->cb_lock);
-            if (cb_func)
-                (*cb_func)(msg, cb_arg);
-            if (cmd != NULL) {
-                cmd->releaseRef();
-            }
+    pthread_rwlock_unlock(&info->cb_hash_lock);
+
+    uint64_t start = internal_get_time_ns();
+    if (cb_func)
+        (*cb_func)(msg, cb_arg);
+    uint64_t elapsed = internal_get_time_ns() - start;
+
+    /* The handler may have unregistered itself, look it up again */
+    pthread_rwlock_rdlock(&info->cb_hash_lock);
+    i = wifi_find_event_cb(info, cmd, vendor_id, subcmd);
+    if (i >= 0 && info->event_cb[i].cb_arg == cb_arg) {
+        cbi = &(info->event_cb[i]);
+        cbi->num_events++;
+        cbi->dispatch_ns += elapsed;
+        if (elapsed > cbi->max_dispatch_ns)
+            cbi->max_dispatch_ns = elapsed;
+    }
+    pthread_rwlock_unlock(&info->cb_hash_lock);
 
-            return NL_OK;
-        }
+    if (wcmd != NULL) {
+        wcmd->releaseRef();
     }
 
-    pthread_mutex_unlock(&info->cb_lock);
     return NL_OK;
 }
 